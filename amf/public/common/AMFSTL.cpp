@@ -42,6 +42,8 @@
 #include <string>
 #include <wchar.h>
 #include <stdarg.h>
+#include <atomic>
+#include <thread>
 #if defined(__ANDROID__)
     #include <codecvt>
 #endif
@@ -641,6 +643,49 @@ amf_wstring AMF_STD_CALL amf::amf_string_formatVA(const wchar_t* format, va_list
     return pBuf;
 }
 //----------------------------------------------------------------------------------------
+amf_int AMF_STD_CALL amf::amf_string_formatVA(wchar_t* buffer, amf_size size, const wchar_t* format, va_list args)
+{
+    if (buffer == NULL || size == 0)
+    {
+        return -1;
+    }
+#if (defined(__linux) || defined(__APPLE__)) && (!defined(__ANDROID__))
+    //replace %s with %ls, same as above but on the stack
+    wchar_t formatReplaced[512];
+    amf_size pos = 0;
+    bool percentFlag = false;
+    for (const wchar_t* i = format; *i != L'\0'; ++i)
+    {
+        if (pos + 2 >= amf_countof(formatReplaced))
+        {
+            return -1;
+        }
+        if (percentFlag && (*i == L's'))
+        {
+            formatReplaced[pos++] = L'l';
+            formatReplaced[pos++] = L's';
+        }
+        else if (percentFlag && (*i == L'S'))
+        {
+            formatReplaced[pos++] = L's';
+        }
+        else
+        {
+            formatReplaced[pos++] = *i;
+        }
+        percentFlag = (*i != L'%') ? false : !percentFlag;
+    }
+    formatReplaced[pos] = L'\0';
+    format = formatReplaced;
+#endif //#if defined(__linux)
+    int length = vswprintf(buffer, size, format, args);
+    if (length < 0 || amf_size(length) >= size)
+    {
+        return -1;
+    }
+    return length;
+}
+//----------------------------------------------------------------------------------------
 amf_string AMF_STD_CALL amf::amf_string_formatVA(const char* format, va_list args)
 {
     va_list argcopy;
@@ -697,37 +742,470 @@ int vscwprintf(const wchar_t* format, va_list argptr)
 }
 #endif
 
+//----------------------------------------------------------------------------------------
+// slab pools
+// small requests are rounded up to a size class and served from 64KB slabs carved out of
+// one arena; each thread keeps a free list per class and exchanges batches of blocks with
+// a shared depot, so steady-state allocation touches neither the heap nor a shared lock
+//----------------------------------------------------------------------------------------
+namespace
+{
+    const amf_size  AMF_POOL_SLAB_SHIFT     = 16;
+    const amf_size  AMF_POOL_SLAB_SIZE      = amf_size(1) << AMF_POOL_SLAB_SHIFT;
+    const amf_size  AMF_POOL_ALIGNMENT      = 16;
+    const amf_size  AMF_POOL_MAX_SIZE       = 4096;
+    const amf_size  AMF_POOL_DEFAULT_ARENA  = 64 * 1024 * 1024;
+    const amf_uint32 AMF_POOL_BATCH         = 32;
+    const amf_size  AMF_POOL_CACHE_BYTES    = 16 * 1024;    // per class and thread before blocks go back to the depot
+    const amf_int64 AMF_POOL_PUBLISH_COUNT  = 1024;
+
+    const amf_size s_PoolClassSizes[] =
+    {
+        16, 32, 48, 64, 80, 96, 112, 128,
+        160, 192, 224, 256,
+        320, 384, 448, 512,
+        640, 768, 896, 1024,
+        1280, 1536, 1792, 2048,
+        2560, 3072, 3584, 4096,
+    };
+    const amf_size AMF_POOL_CLASS_COUNT = sizeof(s_PoolClassSizes) / sizeof(s_PoolClassSizes[0]);
+
+    struct AMFPoolBlock
+    {
+        AMFPoolBlock*   pNext;
+    };
+
+    struct AMFPoolDepot
+    {
+        std::atomic<bool>   locked;
+        AMFPoolBlock*       pFree;
+
+        void Lock()
+        {
+            while(locked.exchange(true, std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+        void Unlock()
+        {
+            locked.store(false, std::memory_order_release);
+        }
+    };
+
+    // no constructor or destructor, relies on zero initialization: usable from static constructors and destructors
+    struct AMFPoolState
+    {
+        std::atomic<bool>       enabled;
+        std::atomic<bool>       initialized;
+        std::atomic<amf_uint8*> pArena;
+        std::atomic<amf_uint8*> pArenaEnd;
+        std::atomic<amf_size>   arenaUsed;
+        amf_uint8*              pSlabClass;     // class index per slab
+        amf_uint8               classBySize[AMF_POOL_MAX_SIZE / AMF_POOL_ALIGNMENT + 1];
+        amf_uint32              cacheLimit[AMF_POOL_CLASS_COUNT];
+        AMFPoolDepot            depots[AMF_POOL_CLASS_COUNT];
+
+        std::atomic<amf_int64>  heapAllocations;
+        std::atomic<amf_int64>  heapFrees;
+        std::atomic<amf_int64>  poolAllocations;
+        std::atomic<amf_int64>  poolFrees;
+        std::atomic<amf_int64>  slabs;
+        std::atomic<amf_int64>  depotTransfers;
+    };
+    AMFPoolState s_Pools;
+
+    struct AMFPoolThreadCache
+    {
+        AMFPoolBlock*   pFree[AMF_POOL_CLASS_COUNT];
+        amf_uint32      count[AMF_POOL_CLASS_COUNT];
+        amf_int64       allocations;
+        amf_int64       frees;
+        amf_int64       heapAllocations;
+        amf_int64       heapFrees;
+        bool            retired;
+    };
+    thread_local AMFPoolThreadCache s_PoolCache;
+
+    //----------------------------------------------------------------------------------------
+    void PoolPublishCounters(AMFPoolThreadCache& cache)
+    {
+        s_Pools.poolAllocations.fetch_add(cache.allocations, std::memory_order_relaxed);
+        s_Pools.poolFrees.fetch_add(cache.frees, std::memory_order_relaxed);
+        s_Pools.heapAllocations.fetch_add(cache.heapAllocations, std::memory_order_relaxed);
+        s_Pools.heapFrees.fetch_add(cache.heapFrees, std::memory_order_relaxed);
+        cache.allocations = 0;
+        cache.frees = 0;
+        cache.heapAllocations = 0;
+        cache.heapFrees = 0;
+    }
+    //----------------------------------------------------------------------------------------
+    // moves up to count blocks from the head of *ppList to the depot
+    void PoolReturnToDepot(amf_size cls, AMFPoolBlock** ppList, amf_uint32 count)
+    {
+        AMFPoolBlock* pFirst = *ppList;
+        if(pFirst == nullptr)
+        {
+            return;
+        }
+        AMFPoolBlock* pLast = pFirst;
+        for(amf_uint32 i = 1; i < count && pLast->pNext != nullptr; i++)
+        {
+            pLast = pLast->pNext;
+        }
+        *ppList = pLast->pNext;
+
+        AMFPoolDepot& depot = s_Pools.depots[cls];
+        depot.Lock();
+        pLast->pNext = depot.pFree;
+        depot.pFree = pFirst;
+        depot.Unlock();
+        s_Pools.depotTransfers.fetch_add(1, std::memory_order_relaxed);
+    }
+    //----------------------------------------------------------------------------------------
+    void PoolFlushThreadCache(AMFPoolThreadCache& cache)
+    {
+        for(amf_size cls = 0; cls < AMF_POOL_CLASS_COUNT; cls++)
+        {
+            while(cache.pFree[cls] != nullptr)
+            {
+                PoolReturnToDepot(cls, &cache.pFree[cls], amf_uint32(-1));
+            }
+            cache.count[cls] = 0;
+        }
+        PoolPublishCounters(cache);
+    }
+    //----------------------------------------------------------------------------------------
+    // returns the thread cache to the depot when the thread exits
+    struct AMFPoolThreadHolder
+    {
+        bool attached = false;
+        ~AMFPoolThreadHolder()
+        {
+            PoolFlushThreadCache(s_PoolCache);
+            s_PoolCache.retired = true;
+        }
+    };
+    thread_local AMFPoolThreadHolder s_PoolThreadHolder;
+
+    //----------------------------------------------------------------------------------------
+    // splits a new slab into blocks; returns the list or nullptr when the arena is exhausted
+    AMFPoolBlock* PoolCarveSlab(amf_size cls, amf_uint32* pCount)
+    {
+        amf_size offset = s_Pools.arenaUsed.fetch_add(AMF_POOL_SLAB_SIZE, std::memory_order_relaxed);
+        amf_uint8* pArena = s_Pools.pArena.load(std::memory_order_relaxed);
+        if(offset + AMF_POOL_SLAB_SIZE > amf_size(s_Pools.pArenaEnd.load(std::memory_order_relaxed) - pArena))
+        {
+            return nullptr;
+        }
+        s_Pools.pSlabClass[offset >> AMF_POOL_SLAB_SHIFT] = amf_uint8(cls);
+        s_Pools.slabs.fetch_add(1, std::memory_order_relaxed);
+
+        const amf_size size = s_PoolClassSizes[cls];
+        const amf_uint32 count = amf_uint32(AMF_POOL_SLAB_SIZE / size);
+        amf_uint8* pSlab = pArena + offset;
+        for(amf_uint32 i = 0; i < count - 1; i++)
+        {
+            reinterpret_cast<AMFPoolBlock*>(pSlab + i * size)->pNext = reinterpret_cast<AMFPoolBlock*>(pSlab + (i + 1) * size);
+        }
+        reinterpret_cast<AMFPoolBlock*>(pSlab + (count - 1) * size)->pNext = nullptr;
+        *pCount = count;
+        return reinterpret_cast<AMFPoolBlock*>(pSlab);
+    }
+    //----------------------------------------------------------------------------------------
+    // takes up to a batch of blocks from the depot, carving a new slab if it is empty
+    AMFPoolBlock* PoolTakeFromDepot(amf_size cls, amf_uint32 batch, amf_uint32* pCount)
+    {
+        AMFPoolDepot& depot = s_Pools.depots[cls];
+        depot.Lock();
+        AMFPoolBlock* pFirst = depot.pFree;
+        amf_uint32 count = 0;
+        if(pFirst != nullptr)
+        {
+            AMFPoolBlock* pLast = pFirst;
+            for(count = 1; count < batch && pLast->pNext != nullptr; count++)
+            {
+                pLast = pLast->pNext;
+            }
+            depot.pFree = pLast->pNext;
+            pLast->pNext = nullptr;
+        }
+        depot.Unlock();
+
+        if(pFirst == nullptr)
+        {
+            amf_uint32 carved = 0;
+            pFirst = PoolCarveSlab(cls, &carved);
+            if(pFirst == nullptr)
+            {
+                return nullptr;
+            }
+            // keep a batch, share the rest of the slab through the depot
+            AMFPoolBlock* pLast = pFirst;
+            for(count = 1; count < batch && pLast->pNext != nullptr; count++)
+            {
+                pLast = pLast->pNext;
+            }
+            AMFPoolBlock* pRest = pLast->pNext;
+            pLast->pNext = nullptr;
+            if(pRest != nullptr)
+            {
+                PoolReturnToDepot(cls, &pRest, carved - count);
+            }
+        }
+        else
+        {
+            s_Pools.depotTransfers.fetch_add(1, std::memory_order_relaxed);
+        }
+        *pCount = count;
+        return pFirst;
+    }
+    //----------------------------------------------------------------------------------------
+    inline amf_size PoolClassOf(amf_size count)
+    {
+        return s_Pools.classBySize[(count + AMF_POOL_ALIGNMENT - 1) / AMF_POOL_ALIGNMENT];
+    }
+    //----------------------------------------------------------------------------------------
+    inline bool PoolOwns(const void* ptr)
+    {
+        const amf_uint8* p = static_cast<const amf_uint8*>(ptr);
+        return p >= s_Pools.pArena.load(std::memory_order_relaxed) && p < s_Pools.pArenaEnd.load(std::memory_order_relaxed);
+    }
+    //----------------------------------------------------------------------------------------
+    void* PoolAlloc(amf_size cls)
+    {
+        AMFPoolThreadCache& cache = s_PoolCache;
+        if(cache.retired)
+        {
+            amf_uint32 count = 0;
+            AMFPoolBlock* pBlock = PoolTakeFromDepot(cls, 1, &count);
+            if(pBlock != nullptr)
+            {
+                s_Pools.poolAllocations.fetch_add(1, std::memory_order_relaxed);
+            }
+            return pBlock;
+        }
+        AMFPoolBlock* pBlock = cache.pFree[cls];
+        if(pBlock == nullptr)
+        {
+            s_PoolThreadHolder.attached = true;
+            pBlock = PoolTakeFromDepot(cls, AMF_POOL_BATCH, &cache.count[cls]);
+            if(pBlock == nullptr)
+            {
+                return nullptr;
+            }
+        }
+        cache.pFree[cls] = pBlock->pNext;
+        cache.count[cls]--;
+        if(++cache.allocations >= AMF_POOL_PUBLISH_COUNT)
+        {
+            PoolPublishCounters(cache);
+        }
+        return pBlock;
+    }
+    //----------------------------------------------------------------------------------------
+    void PoolFree(void* ptr)
+    {
+        amf_uint8* pArena = s_Pools.pArena.load(std::memory_order_relaxed);
+        const amf_size cls = s_Pools.pSlabClass[amf_size(static_cast<amf_uint8*>(ptr) - pArena) >> AMF_POOL_SLAB_SHIFT];
+        AMFPoolBlock* pBlock = static_cast<AMFPoolBlock*>(ptr);
+
+        AMFPoolThreadCache& cache = s_PoolCache;
+        if(cache.retired)
+        {
+            pBlock->pNext = nullptr;
+            PoolReturnToDepot(cls, &pBlock, 1);
+            s_Pools.poolFrees.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        s_PoolThreadHolder.attached = true;
+        pBlock->pNext = cache.pFree[cls];
+        cache.pFree[cls] = pBlock;
+        if(++cache.count[cls] >= s_Pools.cacheLimit[cls])
+        {
+            PoolReturnToDepot(cls, &cache.pFree[cls], AMF_POOL_BATCH);
+            cache.count[cls] -= AMF_POOL_BATCH;
+        }
+        if(++cache.frees >= AMF_POOL_PUBLISH_COUNT)
+        {
+            PoolPublishCounters(cache);
+        }
+    }
+    //----------------------------------------------------------------------------------------
+    // heap fallbacks are counted only while the pools are enabled, in the thread cache like pool requests
+    void PoolCountHeap(bool bFree)
+    {
+        AMFPoolThreadCache& cache = s_PoolCache;
+        if(cache.retired)
+        {
+            (bFree ? s_Pools.heapFrees : s_Pools.heapAllocations).fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        s_PoolThreadHolder.attached = true;
+        if(++(bFree ? cache.heapFrees : cache.heapAllocations) >= AMF_POOL_PUBLISH_COUNT)
+        {
+            PoolPublishCounters(cache);
+        }
+    }
+    //----------------------------------------------------------------------------------------
+    void* SystemAlignedAlloc(size_t count, size_t alignment)
+    {
+#if defined(_WIN32)
+        return _aligned_malloc(count, alignment);
+#elif defined (__APPLE__)
+        void* p = nullptr;
+        posix_memalign(&p, alignment, count);
+        return p;
+#elif defined(__linux)
+        return memalign(alignment, count);
+#endif
+    }
+    //----------------------------------------------------------------------------------------
+    void SystemAlignedFree(void* ptr)
+    {
+#if defined(_WIN32)
+        return _aligned_free(ptr);
+#else
+        return free(ptr);
+#endif
+    }
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_alloc_enable_pools(amf_size arenaSize)
+{
+    if(s_Pools.initialized.exchange(true))
+    {
+        return false;
+    }
+    if(arenaSize == 0)
+    {
+        arenaSize = AMF_POOL_DEFAULT_ARENA;
+    }
+    arenaSize = (arenaSize + AMF_POOL_SLAB_SIZE - 1) & ~(AMF_POOL_SLAB_SIZE - 1);
+
+    // the arena and the slab table live until the process exits: pooled blocks may be released from static destructors
+    amf_uint8* pArena = static_cast<amf_uint8*>(SystemAlignedAlloc(arenaSize, AMF_POOL_SLAB_SIZE));
+    amf_uint8* pSlabClass = static_cast<amf_uint8*>(malloc(arenaSize >> AMF_POOL_SLAB_SHIFT));
+    if(pArena == nullptr || pSlabClass == nullptr)
+    {
+        if(pArena != nullptr)
+        {
+            SystemAlignedFree(pArena);
+        }
+        free(pSlabClass);
+        return false;
+    }
+    amf_size cls = 0;
+    for(amf_size i = 0; i < sizeof(s_Pools.classBySize); i++)
+    {
+        while(s_PoolClassSizes[cls] < i * AMF_POOL_ALIGNMENT)
+        {
+            cls++;
+        }
+        s_Pools.classBySize[i] = amf_uint8(cls);
+    }
+    for(cls = 0; cls < AMF_POOL_CLASS_COUNT; cls++)
+    {
+        s_Pools.cacheLimit[cls] = amf_uint32(std::max(amf_size(2 * AMF_POOL_BATCH), AMF_POOL_CACHE_BYTES / s_PoolClassSizes[cls]));
+    }
+    s_Pools.pSlabClass = pSlabClass;
+    s_Pools.pArenaEnd.store(pArena + arenaSize, std::memory_order_relaxed);
+    s_Pools.pArena.store(pArena, std::memory_order_relaxed);
+    s_Pools.enabled.store(true, std::memory_order_release);
+    return true;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_alloc_pools_enabled()
+{
+    return s_Pools.enabled.load(std::memory_order_acquire);
+}
+//----------------------------------------------------------------------------------------
+void AMF_STD_CALL amf_alloc_get_statistics(AMFAllocStatistics* stats)
+{
+    if(stats == nullptr)
+    {
+        return;
+    }
+    if(!s_PoolCache.retired)
+    {
+        PoolPublishCounters(s_PoolCache); // other threads publish in batches and when they exit
+    }
+    stats->heapAllocations = s_Pools.heapAllocations.load(std::memory_order_relaxed);
+    stats->heapFrees = s_Pools.heapFrees.load(std::memory_order_relaxed);
+    stats->poolAllocations = s_Pools.poolAllocations.load(std::memory_order_relaxed);
+    stats->poolFrees = s_Pools.poolFrees.load(std::memory_order_relaxed);
+    stats->slabs = s_Pools.slabs.load(std::memory_order_relaxed);
+    stats->depotTransfers = s_Pools.depotTransfers.load(std::memory_order_relaxed);
+}
 //----------------------------------------------------------------------------------------
 void* AMF_STD_CALL amf_alloc(size_t count)
 {
+    if(s_Pools.enabled.load(std::memory_order_acquire))
+    {
+        if(count <= AMF_POOL_MAX_SIZE)
+        {
+            void* ptr = PoolAlloc(PoolClassOf(count));
+            if(ptr != nullptr)
+            {
+                return ptr;
+            }
+        }
+        PoolCountHeap(false);
+    }
     return malloc(count);
 }
 //----------------------------------------------------------------------------------------
 void AMF_STD_CALL amf_free(void* ptr)
 {
+    if(ptr == nullptr)
+    {
+        return;
+    }
+    if(PoolOwns(ptr))
+    {
+        PoolFree(ptr);
+        return;
+    }
+    if(s_Pools.enabled.load(std::memory_order_relaxed))
+    {
+        PoolCountHeap(true);
+    }
     free(ptr);
 }
 //----------------------------------------------------------------------------------------
 void* AMF_STD_CALL amf_aligned_alloc(size_t count, size_t alignment)
 {
-#if defined(_WIN32)
-    return _aligned_malloc(count, alignment);
-#elif defined (__APPLE__)
-    void* p = nullptr;
-    posix_memalign(&p, alignment, count);
-    return p;
-#elif defined(__linux)
-    return memalign(alignment, count);
-#endif
+    if(s_Pools.enabled.load(std::memory_order_acquire))
+    {
+        if(alignment <= AMF_POOL_ALIGNMENT && count <= AMF_POOL_MAX_SIZE)
+        {
+            void* ptr = PoolAlloc(PoolClassOf(count));
+            if(ptr != nullptr)
+            {
+                return ptr;
+            }
+        }
+        PoolCountHeap(false);
+    }
+    return SystemAlignedAlloc(count, alignment);
 }
 //----------------------------------------------------------------------------------------
 void AMF_STD_CALL amf_aligned_free(void* ptr)
 {
-#if defined(_WIN32)
-    return _aligned_free(ptr);
-#else
-    return free(ptr);
-#endif
+    if(ptr == nullptr)
+    {
+        return;
+    }
+    if(PoolOwns(ptr))
+    {
+        PoolFree(ptr);
+        return;
+    }
+    if(s_Pools.enabled.load(std::memory_order_relaxed))
+    {
+        PoolCountHeap(true);
+    }
+    SystemAlignedFree(ptr);
 }
 //----------------------------------------------------------------------------------------
 #if defined (__ANDROID__)
@@ -66,6 +66,25 @@ extern "C"
     void AMF_STD_CALL amf_free(void* ptr);
     void* AMF_STD_CALL amf_aligned_alloc(size_t count, size_t alignment);
     void AMF_STD_CALL amf_aligned_free(void* ptr);
+
+    // size-class slab pools with per-thread caches behind amf_alloc / amf_aligned_alloc
+    // enable once at init; blocks allocated before enabling are still released correctly
+    // pooled blocks must be released by the module that allocated them
+    bool AMF_STD_CALL amf_alloc_enable_pools(amf_size arenaSize); // 0 - default arena (64MB); false if already enabled or arena allocation failed
+    bool AMF_STD_CALL amf_alloc_pools_enabled();
+
+    // counted only while the pools are enabled; threads publish their request counts in batches
+    typedef struct AMFAllocStatistics
+    {
+        amf_int64   heapAllocations;    // requests served by the C runtime heap
+        amf_int64   heapFrees;
+        amf_int64   poolAllocations;    // requests served by the pools
+        amf_int64   poolFrees;
+        amf_int64   slabs;              // slabs carved from the arena
+        amf_int64   depotTransfers;     // batches moved between thread caches and the shared depot
+    } AMFAllocStatistics;
+
+    void AMF_STD_CALL amf_alloc_get_statistics(AMFAllocStatistics* stats);
 #if defined(__cplusplus)
 }
 #endif
@@ -341,6 +360,8 @@ namespace amf
 
     amf_wstring AMF_STD_CALL amf_string_formatVA(const wchar_t* format, va_list args);
     amf_string AMF_STD_CALL amf_string_formatVA(const char* format, va_list args);
+    // formats into a caller buffer without allocations; returns the length or -1 if it did not fit
+    amf_int AMF_STD_CALL amf_string_formatVA(wchar_t* buffer, amf_size size, const wchar_t* format, va_list args);
 
     amf_int AMF_STD_CALL amf_string_ci_compare(const amf_wstring& left, const amf_wstring& right);
     amf_int AMF_STD_CALL amf_string_ci_compare(const amf_string& left, const amf_string& right);
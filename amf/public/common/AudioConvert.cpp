@@ -0,0 +1,854 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "AudioConvert.h"
+#include <string.h>
+#include <math.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || (defined(__i386__) && defined(__SSE2__))
+    #define AUDIO_SIMD_X86
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define AUDIO_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+using namespace amf;
+
+#define AMF_AUDIO_SCRATCH_SIZE  (16 * 1024)
+
+//-------------------------------------------------------------------------------------------------
+// scalar reference, also used for the SIMD tails
+//-------------------------------------------------------------------------------------------------
+static void S16ToFloat_Scalar(const amf_int16* pIn, amf_float* pOut, amf_size count)
+{
+    const amf_float scale = 1.0f / 32768.0f;
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_float(pIn[x]) * scale;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void S32ToFloat_Scalar(const amf_int32* pIn, amf_float* pOut, amf_size count)
+{
+    const amf_float scale = 1.0f / 2147483648.0f;
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_float(pIn[x]) * scale;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void FloatToS16_Scalar(const amf_float* pIn, amf_int16* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        // clamp the way max/min instructions do, so NaN ends up as the lower bound
+        amf_float v = pIn[x] * 32768.0f;
+        v = v > -32768.0f ? v : -32768.0f;
+        v = v < 32767.0f ? v : 32767.0f;
+        pOut[x] = amf_int16(lrintf(v));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void FloatToS32_Scalar(const amf_float* pIn, amf_int32* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        const amf_float v = pIn[x] * 2147483648.0f;
+        if (v >= 2147483648.0f)
+        {
+            pOut[x] = 0x7FFFFFFF;
+        }
+        else if (v > -2147483648.0f)
+        {
+            pOut[x] = amf_int32(lrintf(v));
+        }
+        else
+        {
+            pOut[x] = amf_int32(0x80000000u);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void S16ToS32_Scalar(const amf_int16* pIn, amf_int32* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_int32(pIn[x]) * 65536;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void S32ToS16_Scalar(const amf_int32* pIn, amf_int16* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_int16(pIn[x] >> 16);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+static void Interleave_Scalar(const T* const* ppIn, T* pOut, amf_int32 channels, amf_size count)
+{
+    for (amf_int32 ch = 0; ch < channels; ch++)
+    {
+        const T* pPlane = ppIn[ch];
+        T* pDst = pOut + ch;
+        for (amf_size x = 0; x < count; x++)
+        {
+            pDst[x * channels] = pPlane[x];
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+static void Deinterleave_Scalar(const T* pIn, T* const* ppOut, amf_int32 channels, amf_size count)
+{
+    for (amf_int32 ch = 0; ch < channels; ch++)
+    {
+        const T* pSrc = pIn + ch;
+        T* pPlane = ppOut[ch];
+        for (amf_size x = 0; x < count; x++)
+        {
+            pPlane[x] = pSrc[x * channels];
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void Interleave16_Scalar(const amf_int16* const* ppIn, amf_int16* pOut, amf_int32 channels, amf_size count)
+{
+    Interleave_Scalar(ppIn, pOut, channels, count);
+}
+//-------------------------------------------------------------------------------------------------
+static void Interleave32_Scalar(const amf_int32* const* ppIn, amf_int32* pOut, amf_int32 channels, amf_size count)
+{
+    Interleave_Scalar(ppIn, pOut, channels, count);
+}
+//-------------------------------------------------------------------------------------------------
+static void Deinterleave16_Scalar(const amf_int16* pIn, amf_int16* const* ppOut, amf_int32 channels, amf_size count)
+{
+    Deinterleave_Scalar(pIn, ppOut, channels, count);
+}
+//-------------------------------------------------------------------------------------------------
+static void Deinterleave32_Scalar(const amf_int32* pIn, amf_int32* const* ppOut, amf_int32 channels, amf_size count)
+{
+    Deinterleave_Scalar(pIn, ppOut, channels, count);
+}
+
+#if defined(AUDIO_SIMD_X86)
+//-------------------------------------------------------------------------------------------------
+// SSE2
+//-------------------------------------------------------------------------------------------------
+static void S16ToFloat_SSE2(const amf_int16* pIn, amf_float* pOut, amf_size count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pIn + x));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(pOut + x, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(pOut + x + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    S16ToFloat_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void S32ToFloat_SSE2(const amf_int32* pIn, amf_float* pOut, amf_size count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(pIn + x));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(pIn + x + 4));
+        _mm_storeu_ps(pOut + x, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+        _mm_storeu_ps(pOut + x + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+    }
+    S32ToFloat_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void FloatToS16_SSE2(const amf_float* pIn, amf_int16* pOut, amf_size count)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 lower = _mm_set1_ps(-32768.0f);
+    const __m128 upper = _mm_set1_ps(32767.0f);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pIn + x), scale), lower), upper);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pIn + x + 4), scale), lower), upper);
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    FloatToS16_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void FloatToS32_SSE2(const amf_float* pIn, amf_int32* pOut, amf_size count)
+{
+    // cvtps returns 0x80000000 on overflow, which is right for the negative side;
+    // flipping all bits of it where the input reached 2^31 gives 0x7FFFFFFF
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    amf_size x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        const __m128 v = _mm_mul_ps(_mm_loadu_ps(pIn + x), scale);
+        const __m128i overflow = _mm_castps_si128(_mm_cmpge_ps(v, scale));
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_xor_si128(_mm_cvtps_epi32(v), overflow));
+    }
+    FloatToS32_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void S16ToS32_SSE2(const amf_int16* pIn, amf_int32* pOut, amf_size count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pIn + x));
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_unpacklo_epi16(zero, v));
+        _mm_storeu_si128((__m128i*)(pOut + x + 4), _mm_unpackhi_epi16(zero, v));
+    }
+    S16ToS32_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void S32ToS16_SSE2(const amf_int32* pIn, amf_int16* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i a = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(pIn + x)), 16);
+        const __m128i b = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(pIn + x + 4)), 16);
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_packs_epi32(a, b));
+    }
+    S32ToS16_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+// stereo and 4 channel layouts get dedicated loops, other channel counts use the scalar ones
+//-------------------------------------------------------------------------------------------------
+static void Interleave16_SSE2(const amf_int16* const* ppIn, amf_int16* pOut, amf_int32 channels, amf_size count)
+{
+    if (channels != 2)
+    {
+        Interleave16_Scalar(ppIn, pOut, channels, count);
+        return;
+    }
+    const amf_int16* pL = ppIn[0];
+    const amf_int16* pR = ppIn[1];
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i l = _mm_loadu_si128((const __m128i*)(pL + x));
+        const __m128i r = _mm_loadu_si128((const __m128i*)(pR + x));
+        _mm_storeu_si128((__m128i*)(pOut + 2 * x), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i*)(pOut + 2 * x + 8), _mm_unpackhi_epi16(l, r));
+    }
+    const amf_int16* tails[2] = { pL + x, pR + x };
+    Interleave16_Scalar(tails, pOut + 2 * x, 2, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Deinterleave16_SSE2(const amf_int16* pIn, amf_int16* const* ppOut, amf_int32 channels, amf_size count)
+{
+    if (channels != 2)
+    {
+        Deinterleave16_Scalar(pIn, ppOut, channels, count);
+        return;
+    }
+    amf_int16* pL = ppOut[0];
+    amf_int16* pR = ppOut[1];
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        // sign-extended halves of each 32-bit pair pack back without saturating
+        const __m128i a = _mm_loadu_si128((const __m128i*)(pIn + 2 * x));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(pIn + 2 * x + 8));
+        const __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+        const __m128i r = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+        _mm_storeu_si128((__m128i*)(pL + x), l);
+        _mm_storeu_si128((__m128i*)(pR + x), r);
+    }
+    amf_int16* tails[2] = { pL + x, pR + x };
+    Deinterleave16_Scalar(pIn + 2 * x, tails, 2, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+// 4x4 transpose of 32-bit lanes, its own inverse
+static inline void Transpose4x4_SSE2(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    const __m128i t0 = _mm_unpacklo_epi32(a, b);
+    const __m128i t1 = _mm_unpacklo_epi32(c, d);
+    const __m128i t2 = _mm_unpackhi_epi32(a, b);
+    const __m128i t3 = _mm_unpackhi_epi32(c, d);
+    a = _mm_unpacklo_epi64(t0, t1);
+    b = _mm_unpackhi_epi64(t0, t1);
+    c = _mm_unpacklo_epi64(t2, t3);
+    d = _mm_unpackhi_epi64(t2, t3);
+}
+//-------------------------------------------------------------------------------------------------
+static void Interleave32_SSE2(const amf_int32* const* ppIn, amf_int32* pOut, amf_int32 channels, amf_size count)
+{
+    amf_size x = 0;
+    if (channels == 2)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            const __m128i l = _mm_loadu_si128((const __m128i*)(ppIn[0] + x));
+            const __m128i r = _mm_loadu_si128((const __m128i*)(ppIn[1] + x));
+            _mm_storeu_si128((__m128i*)(pOut + 2 * x), _mm_unpacklo_epi32(l, r));
+            _mm_storeu_si128((__m128i*)(pOut + 2 * x + 4), _mm_unpackhi_epi32(l, r));
+        }
+    }
+    else if (channels == 4)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(ppIn[0] + x));
+            __m128i b = _mm_loadu_si128((const __m128i*)(ppIn[1] + x));
+            __m128i c = _mm_loadu_si128((const __m128i*)(ppIn[2] + x));
+            __m128i d = _mm_loadu_si128((const __m128i*)(ppIn[3] + x));
+            Transpose4x4_SSE2(a, b, c, d);
+            _mm_storeu_si128((__m128i*)(pOut + 4 * x), a);
+            _mm_storeu_si128((__m128i*)(pOut + 4 * x + 4), b);
+            _mm_storeu_si128((__m128i*)(pOut + 4 * x + 8), c);
+            _mm_storeu_si128((__m128i*)(pOut + 4 * x + 12), d);
+        }
+    }
+    if (x == 0)
+    {
+        Interleave32_Scalar(ppIn, pOut, channels, count);
+        return;
+    }
+    const amf_int32* tails[4] = { ppIn[0] + x, ppIn[1] + x, channels == 4 ? ppIn[2] + x : nullptr, channels == 4 ? ppIn[3] + x : nullptr };
+    Interleave32_Scalar(tails, pOut + channels * x, channels, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Deinterleave32_SSE2(const amf_int32* pIn, amf_int32* const* ppOut, amf_int32 channels, amf_size count)
+{
+    amf_size x = 0;
+    if (channels == 2)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            const __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(pIn + 2 * x)));
+            const __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(pIn + 2 * x + 4)));
+            _mm_storeu_si128((__m128i*)(ppOut[0] + x), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+            _mm_storeu_si128((__m128i*)(ppOut[1] + x), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+    }
+    else if (channels == 4)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(pIn + 4 * x));
+            __m128i b = _mm_loadu_si128((const __m128i*)(pIn + 4 * x + 4));
+            __m128i c = _mm_loadu_si128((const __m128i*)(pIn + 4 * x + 8));
+            __m128i d = _mm_loadu_si128((const __m128i*)(pIn + 4 * x + 12));
+            Transpose4x4_SSE2(a, b, c, d);
+            _mm_storeu_si128((__m128i*)(ppOut[0] + x), a);
+            _mm_storeu_si128((__m128i*)(ppOut[1] + x), b);
+            _mm_storeu_si128((__m128i*)(ppOut[2] + x), c);
+            _mm_storeu_si128((__m128i*)(ppOut[3] + x), d);
+        }
+    }
+    if (x == 0)
+    {
+        Deinterleave32_Scalar(pIn, ppOut, channels, count);
+        return;
+    }
+    amf_int32* tails[4] = { ppOut[0] + x, ppOut[1] + x, channels == 4 ? ppOut[2] + x : nullptr, channels == 4 ? ppOut[3] + x : nullptr };
+    Deinterleave32_Scalar(pIn + channels * x, tails, channels, count - x);
+}
+#endif // AUDIO_SIMD_X86
+
+#if defined(AUDIO_SIMD_NEON)
+//-------------------------------------------------------------------------------------------------
+// NEON: structured loads and stores do the (de)interleaving; vcvtnq rounds to nearest even
+// and saturates like the scalar code for finite input
+//-------------------------------------------------------------------------------------------------
+static void S16ToFloat_NEON(const amf_int16* pIn, amf_float* pOut, amf_size count)
+{
+    const float32x4_t scale = vdupq_n_f32(1.0f / 32768.0f);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const int16x8_t v = vld1q_s16(pIn + x);
+        vst1q_f32(pOut + x, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(pOut + x + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    S16ToFloat_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void S32ToFloat_NEON(const amf_int32* pIn, amf_float* pOut, amf_size count)
+{
+    const float32x4_t scale = vdupq_n_f32(1.0f / 2147483648.0f);
+    amf_size x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        vst1q_f32(pOut + x, vmulq_f32(vcvtq_f32_s32(vld1q_s32(pIn + x)), scale));
+    }
+    S32ToFloat_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void FloatToS16_NEON(const amf_float* pIn, amf_int16* pOut, amf_size count)
+{
+    const float32x4_t scale = vdupq_n_f32(32768.0f);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const int32x4_t a = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(pIn + x), scale));
+        const int32x4_t b = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(pIn + x + 4), scale));
+        vst1q_s16(pOut + x, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    FloatToS16_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void FloatToS32_NEON(const amf_float* pIn, amf_int32* pOut, amf_size count)
+{
+    const float32x4_t scale = vdupq_n_f32(2147483648.0f);
+    amf_size x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        vst1q_s32(pOut + x, vcvtnq_s32_f32(vmulq_f32(vld1q_f32(pIn + x), scale)));
+    }
+    FloatToS32_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void S16ToS32_NEON(const amf_int16* pIn, amf_int32* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const int16x8_t v = vld1q_s16(pIn + x);
+        vst1q_s32(pOut + x, vshll_n_s16(vget_low_s16(v), 16));
+        vst1q_s32(pOut + x + 4, vshll_n_s16(vget_high_s16(v), 16));
+    }
+    S16ToS32_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void S32ToS16_NEON(const amf_int32* pIn, amf_int16* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        vst1q_s16(pOut + x, vcombine_s16(vshrn_n_s32(vld1q_s32(pIn + x), 16), vshrn_n_s32(vld1q_s32(pIn + x + 4), 16)));
+    }
+    S32ToS16_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Interleave16_NEON(const amf_int16* const* ppIn, amf_int16* pOut, amf_int32 channels, amf_size count)
+{
+    if (channels != 2)
+    {
+        Interleave16_Scalar(ppIn, pOut, channels, count);
+        return;
+    }
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        int16x8x2_t v;
+        v.val[0] = vld1q_s16(ppIn[0] + x);
+        v.val[1] = vld1q_s16(ppIn[1] + x);
+        vst2q_s16(pOut + 2 * x, v);
+    }
+    const amf_int16* tails[2] = { ppIn[0] + x, ppIn[1] + x };
+    Interleave16_Scalar(tails, pOut + 2 * x, 2, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Deinterleave16_NEON(const amf_int16* pIn, amf_int16* const* ppOut, amf_int32 channels, amf_size count)
+{
+    if (channels != 2)
+    {
+        Deinterleave16_Scalar(pIn, ppOut, channels, count);
+        return;
+    }
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const int16x8x2_t v = vld2q_s16(pIn + 2 * x);
+        vst1q_s16(ppOut[0] + x, v.val[0]);
+        vst1q_s16(ppOut[1] + x, v.val[1]);
+    }
+    amf_int16* tails[2] = { ppOut[0] + x, ppOut[1] + x };
+    Deinterleave16_Scalar(pIn + 2 * x, tails, 2, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Interleave32_NEON(const amf_int32* const* ppIn, amf_int32* pOut, amf_int32 channels, amf_size count)
+{
+    amf_size x = 0;
+    if (channels == 2)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            int32x4x2_t v;
+            v.val[0] = vld1q_s32(ppIn[0] + x);
+            v.val[1] = vld1q_s32(ppIn[1] + x);
+            vst2q_s32(pOut + 2 * x, v);
+        }
+    }
+    else if (channels == 4)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            int32x4x4_t v;
+            v.val[0] = vld1q_s32(ppIn[0] + x);
+            v.val[1] = vld1q_s32(ppIn[1] + x);
+            v.val[2] = vld1q_s32(ppIn[2] + x);
+            v.val[3] = vld1q_s32(ppIn[3] + x);
+            vst4q_s32(pOut + 4 * x, v);
+        }
+    }
+    if (x == 0)
+    {
+        Interleave32_Scalar(ppIn, pOut, channels, count);
+        return;
+    }
+    const amf_int32* tails[4] = { ppIn[0] + x, ppIn[1] + x, channels == 4 ? ppIn[2] + x : nullptr, channels == 4 ? ppIn[3] + x : nullptr };
+    Interleave32_Scalar(tails, pOut + channels * x, channels, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Deinterleave32_NEON(const amf_int32* pIn, amf_int32* const* ppOut, amf_int32 channels, amf_size count)
+{
+    amf_size x = 0;
+    if (channels == 2)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            const int32x4x2_t v = vld2q_s32(pIn + 2 * x);
+            vst1q_s32(ppOut[0] + x, v.val[0]);
+            vst1q_s32(ppOut[1] + x, v.val[1]);
+        }
+    }
+    else if (channels == 4)
+    {
+        for (; x + 4 <= count; x += 4)
+        {
+            const int32x4x4_t v = vld4q_s32(pIn + 4 * x);
+            vst1q_s32(ppOut[0] + x, v.val[0]);
+            vst1q_s32(ppOut[1] + x, v.val[1]);
+            vst1q_s32(ppOut[2] + x, v.val[2]);
+            vst1q_s32(ppOut[3] + x, v.val[3]);
+        }
+    }
+    if (x == 0)
+    {
+        Deinterleave32_Scalar(pIn, ppOut, channels, count);
+        return;
+    }
+    amf_int32* tails[4] = { ppOut[0] + x, ppOut[1] + x, channels == 4 ? ppOut[2] + x : nullptr, channels == 4 ? ppOut[3] + x : nullptr };
+    Deinterleave32_Scalar(pIn + channels * x, tails, channels, count - x);
+}
+#endif // AUDIO_SIMD_NEON
+
+//-------------------------------------------------------------------------------------------------
+// dispatch
+//-------------------------------------------------------------------------------------------------
+static const AMFAudioKernels s_AudioScalar =
+{
+    "scalar", S16ToFloat_Scalar, S32ToFloat_Scalar, FloatToS16_Scalar, FloatToS32_Scalar, S16ToS32_Scalar, S32ToS16_Scalar,
+    Interleave16_Scalar, Interleave32_Scalar, Deinterleave16_Scalar, Deinterleave32_Scalar
+};
+#if defined(AUDIO_SIMD_X86)
+static const AMFAudioKernels s_AudioSSE2 =
+{
+    "SSE2", S16ToFloat_SSE2, S32ToFloat_SSE2, FloatToS16_SSE2, FloatToS32_SSE2, S16ToS32_SSE2, S32ToS16_SSE2,
+    Interleave16_SSE2, Interleave32_SSE2, Deinterleave16_SSE2, Deinterleave32_SSE2
+};
+#endif
+#if defined(AUDIO_SIMD_NEON)
+static const AMFAudioKernels s_AudioNEON =
+{
+    "NEON", S16ToFloat_NEON, S32ToFloat_NEON, FloatToS16_NEON, FloatToS32_NEON, S16ToS32_NEON, S32ToS16_NEON,
+    Interleave16_NEON, Interleave32_NEON, Deinterleave16_NEON, Deinterleave32_NEON
+};
+#endif
+//-------------------------------------------------------------------------------------------------
+const AMFAudioKernels* AMF_STD_CALL amf::GetAudioKernels(AMF_AUDIO_KERNEL_LEVEL level)
+{
+    switch (level)
+    {
+    case AMF_AUDIO_KERNEL_SCALAR:
+        return &s_AudioScalar;
+#if defined(AUDIO_SIMD_X86)
+    case AMF_AUDIO_KERNEL_SSE2:
+        return &s_AudioSSE2;
+#endif
+#if defined(AUDIO_SIMD_NEON)
+    case AMF_AUDIO_KERNEL_NEON:
+        return &s_AudioNEON;
+#endif
+    default:
+        return nullptr;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+const AMFAudioKernels& AMF_STD_CALL amf::GetAudioKernels()
+{
+#if defined(AUDIO_SIMD_X86)
+    return s_AudioSSE2;
+#elif defined(AUDIO_SIMD_NEON)
+    return s_AudioNEON;
+#else
+    return s_AudioScalar;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+// whole-buffer conversion
+//-------------------------------------------------------------------------------------------------
+enum AMF_AUDIO_SAMPLE_TYPE
+{
+    AMF_AUDIO_SAMPLE_UNSUPPORTED = 0,
+    AMF_AUDIO_SAMPLE_S16,
+    AMF_AUDIO_SAMPLE_S32,
+    AMF_AUDIO_SAMPLE_FLT,
+};
+//-------------------------------------------------------------------------------------------------
+static AMF_AUDIO_SAMPLE_TYPE GetSampleType(AMF_AUDIO_FORMAT format)
+{
+    switch (format)
+    {
+    case AMFAF_S16:
+    case AMFAF_S16P:
+        return AMF_AUDIO_SAMPLE_S16;
+    case AMFAF_S32:
+    case AMFAF_S32P:
+        return AMF_AUDIO_SAMPLE_S32;
+    case AMFAF_FLT:
+    case AMFAF_FLTP:
+        return AMF_AUDIO_SAMPLE_FLT;
+    default:
+        return AMF_AUDIO_SAMPLE_UNSUPPORTED;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static bool IsPlanarFormat(AMF_AUDIO_FORMAT format)
+{
+    return format == AMFAF_S16P || format == AMFAF_S32P || format == AMFAF_FLTP;
+}
+//-------------------------------------------------------------------------------------------------
+static amf_size GetSampleTypeSize(AMF_AUDIO_SAMPLE_TYPE type)
+{
+    return type == AMF_AUDIO_SAMPLE_S16 ? sizeof(amf_int16) : sizeof(amf_int32);
+}
+//-------------------------------------------------------------------------------------------------
+static void ConvertSamples(const AMFAudioKernels& kernels, AMF_AUDIO_SAMPLE_TYPE inType, const void* pIn,
+                           AMF_AUDIO_SAMPLE_TYPE outType, void* pOut, amf_size count)
+{
+    switch (inType * 4 + outType)
+    {
+    case AMF_AUDIO_SAMPLE_S16 * 4 + AMF_AUDIO_SAMPLE_S32:
+        kernels.S16ToS32(static_cast<const amf_int16*>(pIn), static_cast<amf_int32*>(pOut), count);
+        break;
+    case AMF_AUDIO_SAMPLE_S16 * 4 + AMF_AUDIO_SAMPLE_FLT:
+        kernels.S16ToFloat(static_cast<const amf_int16*>(pIn), static_cast<amf_float*>(pOut), count);
+        break;
+    case AMF_AUDIO_SAMPLE_S32 * 4 + AMF_AUDIO_SAMPLE_S16:
+        kernels.S32ToS16(static_cast<const amf_int32*>(pIn), static_cast<amf_int16*>(pOut), count);
+        break;
+    case AMF_AUDIO_SAMPLE_S32 * 4 + AMF_AUDIO_SAMPLE_FLT:
+        kernels.S32ToFloat(static_cast<const amf_int32*>(pIn), static_cast<amf_float*>(pOut), count);
+        break;
+    case AMF_AUDIO_SAMPLE_FLT * 4 + AMF_AUDIO_SAMPLE_S16:
+        kernels.FloatToS16(static_cast<const amf_float*>(pIn), static_cast<amf_int16*>(pOut), count);
+        break;
+    case AMF_AUDIO_SAMPLE_FLT * 4 + AMF_AUDIO_SAMPLE_S32:
+        kernels.FloatToS32(static_cast<const amf_float*>(pIn), static_cast<amf_int32*>(pOut), count);
+        break;
+    default:
+        memcpy(pOut, pIn, count * GetSampleTypeSize(inType));
+        break;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveSamples(const AMFAudioKernels& kernels, amf_size sampleSize, const amf_uint8* const* ppIn,
+                              amf_uint8* pOut, amf_int32 channels, amf_size count)
+{
+    if (sampleSize == sizeof(amf_int16))
+    {
+        const amf_int16* planes[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+        for (amf_int32 ch = 0; ch < channels; ch++)
+        {
+            planes[ch] = reinterpret_cast<const amf_int16*>(ppIn[ch]);
+        }
+        kernels.Interleave16(planes, reinterpret_cast<amf_int16*>(pOut), channels, count);
+    }
+    else
+    {
+        const amf_int32* planes[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+        for (amf_int32 ch = 0; ch < channels; ch++)
+        {
+            planes[ch] = reinterpret_cast<const amf_int32*>(ppIn[ch]);
+        }
+        kernels.Interleave32(planes, reinterpret_cast<amf_int32*>(pOut), channels, count);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void DeinterleaveSamples(const AMFAudioKernels& kernels, amf_size sampleSize, const amf_uint8* pIn,
+                                amf_uint8* const* ppOut, amf_int32 channels, amf_size count)
+{
+    if (sampleSize == sizeof(amf_int16))
+    {
+        amf_int16* planes[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+        for (amf_int32 ch = 0; ch < channels; ch++)
+        {
+            planes[ch] = reinterpret_cast<amf_int16*>(ppOut[ch]);
+        }
+        kernels.Deinterleave16(reinterpret_cast<const amf_int16*>(pIn), planes, channels, count);
+    }
+    else
+    {
+        amf_int32* planes[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+        for (amf_int32 ch = 0; ch < channels; ch++)
+        {
+            planes[ch] = reinterpret_cast<amf_int32*>(ppOut[ch]);
+        }
+        kernels.Deinterleave32(reinterpret_cast<const amf_int32*>(pIn), planes, channels, count);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf::AMFAudioConvertSupported(AMF_AUDIO_FORMAT inFormat, AMF_AUDIO_FORMAT outFormat)
+{
+    return GetSampleType(inFormat) != AMF_AUDIO_SAMPLE_UNSUPPORTED && GetSampleType(outFormat) != AMF_AUDIO_SAMPLE_UNSUPPORTED;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL amf::AMFAudioConvert(AMF_AUDIO_FORMAT inFormat, const void* const* ppIn,
+                                             AMF_AUDIO_FORMAT outFormat, void* const* ppOut,
+                                             amf_int32 channels, amf_size count)
+{
+    if (AMFAudioConvertSupported(inFormat, outFormat) == false)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    if (ppIn == nullptr || ppOut == nullptr || channels <= 0 || channels > AMF_AUDIO_CONVERT_MAX_CHANNELS)
+    {
+        return AMF_INVALID_ARG;
+    }
+
+    const AMFAudioKernels&      kernels   = GetAudioKernels();
+    const AMF_AUDIO_SAMPLE_TYPE inType    = GetSampleType(inFormat);
+    const AMF_AUDIO_SAMPLE_TYPE outType   = GetSampleType(outFormat);
+    const amf_size              inSize    = GetSampleTypeSize(inType);
+    const amf_size              outSize   = GetSampleTypeSize(outType);
+    const bool                  inPlanar  = IsPlanarFormat(inFormat);
+    const bool                  outPlanar = IsPlanarFormat(outFormat);
+
+    // layout unchanged: one pass per plane
+    if (inPlanar == outPlanar)
+    {
+        const amf_int32 planes = inPlanar ? channels : 1;
+        const amf_size  samples = inPlanar ? count : count * channels;
+        for (amf_int32 ch = 0; ch < planes; ch++)
+        {
+            ConvertSamples(kernels, inType, ppIn[ch], outType, ppOut[ch], samples);
+        }
+        return AMF_OK;
+    }
+
+    const amf_uint8* pIn[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+    amf_uint8* pOut[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+
+    // only the layout changes
+    if (inType == outType)
+    {
+        if (inPlanar)
+        {
+            for (amf_int32 ch = 0; ch < channels; ch++)
+            {
+                pIn[ch] = static_cast<const amf_uint8*>(ppIn[ch]);
+            }
+            InterleaveSamples(kernels, inSize, pIn, static_cast<amf_uint8*>(ppOut[0]), channels, count);
+        }
+        else
+        {
+            for (amf_int32 ch = 0; ch < channels; ch++)
+            {
+                pOut[ch] = static_cast<amf_uint8*>(ppOut[ch]);
+            }
+            DeinterleaveSamples(kernels, inSize, static_cast<const amf_uint8*>(ppIn[0]), pOut, channels, count);
+        }
+        return AMF_OK;
+    }
+
+    // both change: convert a chunk that stays in cache keeping the input layout, then relayout it
+    if (channels * outSize > AMF_AUDIO_SCRATCH_SIZE)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    alignas(16) amf_uint8 scratch[AMF_AUDIO_SCRATCH_SIZE];
+    const amf_size chunk = AMF_AUDIO_SCRATCH_SIZE / (channels * outSize);
+
+    for (amf_size x = 0; x < count; x += chunk)
+    {
+        const amf_size samples = (count - x < chunk) ? count - x : chunk;
+        if (inPlanar)
+        {
+            for (amf_int32 ch = 0; ch < channels; ch++)
+            {
+                pIn[ch] = scratch + ch * samples * outSize;
+                ConvertSamples(kernels, inType, static_cast<const amf_uint8*>(ppIn[ch]) + x * inSize, outType, scratch + ch * samples * outSize, samples);
+            }
+            InterleaveSamples(kernels, outSize, pIn, static_cast<amf_uint8*>(ppOut[0]) + x * channels * outSize, channels, samples);
+        }
+        else
+        {
+            ConvertSamples(kernels, inType, static_cast<const amf_uint8*>(ppIn[0]) + x * channels * inSize, outType, scratch, samples * channels);
+            for (amf_int32 ch = 0; ch < channels; ch++)
+            {
+                pOut[ch] = static_cast<amf_uint8*>(ppOut[ch]) + x * outSize;
+            }
+            DeinterleaveSamples(kernels, outSize, scratch, pOut, channels, samples);
+        }
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL amf::AMFAudioConvertBuffer(AMF_AUDIO_FORMAT inFormat, const void* pIn,
+                                                   AMF_AUDIO_FORMAT outFormat, void* pOut,
+                                                   amf_int32 channels, amf_size count)
+{
+    if (AMFAudioConvertSupported(inFormat, outFormat) == false)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    if (pIn == nullptr || pOut == nullptr || channels <= 0 || channels > AMF_AUDIO_CONVERT_MAX_CHANNELS)
+    {
+        return AMF_INVALID_ARG;
+    }
+    const amf_size inStride = IsPlanarFormat(inFormat) ? count * GetSampleTypeSize(GetSampleType(inFormat)) : 0;
+    const amf_size outStride = IsPlanarFormat(outFormat) ? count * GetSampleTypeSize(GetSampleType(outFormat)) : 0;
+
+    const void* ppIn[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+    void* ppOut[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+    for (amf_int32 ch = 0; ch < channels; ch++)
+    {
+        ppIn[ch] = static_cast<const amf_uint8*>(pIn) + ch * inStride;
+        ppOut[ch] = static_cast<amf_uint8*>(pOut) + ch * outStride;
+    }
+    return AMFAudioConvert(inFormat, ppIn, outFormat, ppOut, channels, count);
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,99 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   AudioConvert.h
+///  @brief  sample format conversion and (de)interleaving of host audio
+///-------------------------------------------------------------------------
+#ifndef AMF_AudioConvert_h
+#define AMF_AudioConvert_h
+#pragma once
+
+#include "../include/core/AudioBuffer.h"
+
+#define AMF_AUDIO_CONVERT_MAX_CHANNELS  128
+
+namespace amf
+{
+    //---------------------------------------------------------------------------------------------
+    // Element kernels. Every kernel has a scalar and a SIMD version with identical output.
+    // Integer to float scales by 1/32768 and 1/2^31, float to integer rounds to nearest and
+    // saturates, S32 to S16 keeps the high 16 bits - the conventions swresample uses
+    //---------------------------------------------------------------------------------------------
+    enum AMF_AUDIO_KERNEL_LEVEL
+    {
+        AMF_AUDIO_KERNEL_SCALAR = 0,
+        AMF_AUDIO_KERNEL_SSE2,
+        AMF_AUDIO_KERNEL_NEON,
+        AMF_AUDIO_KERNEL_LEVEL_COUNT
+    };
+
+    struct AMFAudioKernels
+    {
+        const char* pName;
+
+        void (*S16ToFloat)(const amf_int16* pIn, amf_float* pOut, amf_size count);
+        void (*S32ToFloat)(const amf_int32* pIn, amf_float* pOut, amf_size count);
+        void (*FloatToS16)(const amf_float* pIn, amf_int16* pOut, amf_size count);
+        void (*FloatToS32)(const amf_float* pIn, amf_int32* pOut, amf_size count);
+        void (*S16ToS32)(const amf_int16* pIn, amf_int32* pOut, amf_size count);
+        void (*S32ToS16)(const amf_int32* pIn, amf_int16* pOut, amf_size count);
+
+        // planes of count samples into one packed line of count * channels samples and back
+        void (*Interleave16)(const amf_int16* const* ppIn, amf_int16* pOut, amf_int32 channels, amf_size count);
+        void (*Interleave32)(const amf_int32* const* ppIn, amf_int32* pOut, amf_int32 channels, amf_size count);
+        void (*Deinterleave16)(const amf_int16* pIn, amf_int16* const* ppOut, amf_int32 channels, amf_size count);
+        void (*Deinterleave32)(const amf_int32* pIn, amf_int32* const* ppOut, amf_int32 channels, amf_size count);
+    };
+
+    // best kernels for this build, SSE2 and NEON are part of the x64 and ARM64 baselines
+    const AMFAudioKernels& AMF_STD_CALL GetAudioKernels();
+    // kernels for a specific level or nullptr if this build does not support it
+    const AMFAudioKernels* AMF_STD_CALL GetAudioKernels(AMF_AUDIO_KERNEL_LEVEL level);
+
+    //---------------------------------------------------------------------------------------------
+    // Whole-buffer conversion between S16, S32 and FLT in packed or planar layout, same channel
+    // count and sample rate. Format and layout changes are done in one pass over cache-sized chunks
+    //---------------------------------------------------------------------------------------------
+    bool AMF_STD_CALL AMFAudioConvertSupported(AMF_AUDIO_FORMAT inFormat, AMF_AUDIO_FORMAT outFormat);
+
+    // ppIn / ppOut hold one pointer per channel for planar formats and a single pointer for packed ones
+    AMF_RESULT AMF_STD_CALL AMFAudioConvert(AMF_AUDIO_FORMAT inFormat, const void* const* ppIn,
+                                            AMF_AUDIO_FORMAT outFormat, void* const* ppOut,
+                                            amf_int32 channels, amf_size count);
+
+    // contiguous AMFAudioBuffer layout: planes of count samples stored back to back
+    AMF_RESULT AMF_STD_CALL AMFAudioConvertBuffer(AMF_AUDIO_FORMAT inFormat, const void* pIn,
+                                                  AMF_AUDIO_FORMAT outFormat, void* pOut,
+                                                  amf_int32 channels, amf_size count);
+}
+
+#endif //#ifndef AMF_AudioConvert_h
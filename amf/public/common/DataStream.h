@@ -46,7 +46,8 @@ namespace amf
 {
     // currently supports only
     // file://
-    // memory://
+    // mmfile://    - read-only, memory mapped file (see AMFDataStreamView)
+    // memory://    - in-memory stream; memory://chunked keeps the data in blocks that are never copied on growth
 
     // eventually can be extended with:
     // rtsp://
@@ -96,6 +97,8 @@ namespace amf
         virtual bool                AMF_STD_CALL IsSeekable() = 0;
 
         static AMF_RESULT          AMF_STD_CALL OpenDataStream(const wchar_t* pFileUrl, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType, AMFDataStream** str);
+        // read-only open of a plain path or file:// through mmfile://, other protocols open as they are
+        static AMF_RESULT          AMF_STD_CALL OpenMappedDataStream(const wchar_t* pFileUrl, AMF_FILE_SHARE eShareType, AMFDataStream** str);
 
     };
     //----------------------------------------------------------------------------------------------
@@ -103,6 +106,22 @@ namespace amf
     //----------------------------------------------------------------------------------------------
     typedef AMFInterfacePtr_T<AMFDataStream> AMFDataStreamPtr;
     //----------------------------------------------------------------------------------------------
+    // AMFDataStreamView interface - optional zero-copy read access, query it from AMFDataStream
+    //----------------------------------------------------------------------------------------------
+    class AMF_NO_VTABLE AMFDataStreamView : public AMFDataStream
+    {
+    public:
+        AMF_DECLARE_IID(0x5a3c9e21, 0x7d4b, 0x4f0e, 0x9c, 0x1a, 0x62, 0x8e, 0x3b, 0xd0, 0x47, 0xf5)
+
+        // returns a pointer to up to iSize bytes at the current position without copying and
+        // without moving the position; *pAvailable is less than iSize only at the end of the stream.
+        // The pointer stays valid until the next call to the stream (until Close() if IsMapped())
+        virtual AMF_RESULT          AMF_STD_CALL GetView(amf_size iSize, const amf_uint8** ppData, amf_size* pAvailable) = 0;
+        // true when views point directly into the mapped file and stay valid until Close()
+        virtual bool                AMF_STD_CALL IsMapped() = 0;
+    };
+    typedef AMFInterfacePtr_T<AMFDataStreamView> AMFDataStreamViewPtr;
+    //----------------------------------------------------------------------------------------------
     
 } //namespace amf
 
@@ -66,9 +66,14 @@ AMF_RESULT AMF_STD_CALL amf::AMFDataStream::OpenDataStream(const wchar_t* pFileU
         ptr = new AMFDataStreamFileImpl;
         res = AMF_OK;
     }
+    if(protocol == L"mmfile")
+    {
+        ptr = new AMFDataStreamMappedFileImpl;
+        res = AMF_OK;
+    }
     if(protocol == L"memory")
     {
-        ptr = new AMFDataStreamMemoryImpl();
+        ptr = new AMFDataStreamMemoryImpl(path == L"chunked");
         res = AMF_OK;
     }
     if( res == AMF_OK )
@@ -84,3 +89,20 @@ AMF_RESULT AMF_STD_CALL amf::AMFDataStream::OpenDataStream(const wchar_t* pFileU
     return res;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL amf::AMFDataStream::OpenMappedDataStream(const wchar_t* pFileUrl, AMF_FILE_SHARE eShareType, AMFDataStream** str)
+{
+    AMF_RETURN_IF_FALSE(pFileUrl != NULL, AMF_INVALID_ARG);
+
+    std::wstring url(pFileUrl);
+    std::wstring::size_type found_pos = url.find(L"://", 0);
+    if(found_pos == std::wstring::npos)
+    {
+        url = L"mmfile://" + url;
+    }
+    else if(url.compare(0, found_pos, L"file") == 0)
+    {
+        url = L"mmfile" + url.substr(found_pos);
+    }
+    return OpenDataStream(url.c_str(), AMFSO_READ, eShareType, str);
+}
+//-------------------------------------------------------------------------------------------------
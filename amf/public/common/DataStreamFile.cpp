@@ -36,6 +36,9 @@
 #pragma warning(disable: 4996)
 #if defined(_WIN32)
 #include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
 #endif
 
 #include <fcntl.h>
@@ -47,18 +50,24 @@
     #define amf_read _read
     #define amf_write _write
     #define amf_seek64 _lseeki64
+    #define amf_fstat64 _fstat64
+    typedef struct _stat64 amf_stat64;
 #elif defined(__linux)// Linux
     #include <unistd.h>
     #define amf_close        close
     #define amf_read         read
     #define amf_write        write
     #define amf_seek64       lseek64
+    #define amf_fstat64      fstat64
+    typedef struct stat64    amf_stat64;
 #elif defined(__APPLE__)
     #include <unistd.h>
     #define amf_close        close
     #define amf_read         read
     #define amf_write        write
     #define amf_seek64       lseek
+    #define amf_fstat64      fstat
+    typedef struct stat      amf_stat64;
 #endif
 
 using namespace amf;
@@ -67,6 +76,67 @@ using namespace amf;
 
 #define AMF_FILE_PROTOCOL L"file"
 
+//-------------------------------------------------------------------------------------------------
+static int OpenFileDescriptor(const amf_wstring& path, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType)
+{
+#if defined(_WIN32)
+    int access = _O_BINARY;
+#else
+    int access = 0;
+#endif
+
+    switch(eOpenType)
+    {
+    case AMFSO_READ:
+        access |= O_RDONLY;
+        break;
+
+    case AMFSO_WRITE:
+        access |= O_CREAT | O_TRUNC | O_WRONLY;
+        break;
+
+    case AMFSO_READ_WRITE:
+        access |= O_CREAT | O_TRUNC | O_RDWR;
+        break;
+
+    case AMFSO_APPEND:
+        access |= O_CREAT | O_APPEND | O_RDWR;
+        break;
+    }
+
+#ifdef _WIN32
+    int shflag = 0;
+    switch(eShareType)
+    {
+    case AMFFS_EXCLUSIVE:
+        shflag = _SH_DENYRW;
+        break;
+
+    case AMFFS_SHARE_READ:
+        shflag = _SH_DENYWR;
+        break;
+
+    case AMFFS_SHARE_WRITE:
+        shflag = _SH_DENYRD;
+        break;
+
+    case AMFFS_SHARE_READ_WRITE:
+        shflag = _SH_DENYNO;
+        break;
+    }
+#endif
+
+#ifdef O_BINARY
+    access |= O_BINARY;
+#endif
+
+#ifdef _WIN32
+    return _wsopen(path.c_str(), access, shflag, 0666);
+#else
+    amf_string str = amf_from_unicode_to_utf8(path);
+    return open(str.c_str(), access, 0666);
+#endif
+}
 //-------------------------------------------------------------------------------------------------
 AMFDataStreamFileImpl::AMFDataStreamFileImpl()
     : m_iFileDescriptor(-1), m_Path()
@@ -202,70 +272,320 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Open(const wchar_t* pFilePath, AM
     AMF_RETURN_IF_FALSE(pFilePath != NULL, AMF_INVALID_ARG);
 
     m_Path = pFilePath;
+    m_iFileDescriptor = OpenFileDescriptor(m_Path, eOpenType, eShareType);
+
+    if(m_iFileDescriptor == -1)
+    {
+        return AMF_FAIL;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+// AMFDataStreamMappedFileImpl
+//-------------------------------------------------------------------------------------------------
+AMFDataStreamMappedFileImpl::AMFDataStreamMappedFileImpl()
+    : m_iFileDescriptor(-1),
+    m_Path(),
+    m_Position(0),
+    m_pMapped(NULL),
+    m_MappedSize(0),
+#if defined(_WIN32)
+    m_hMapping(NULL),
+#endif
+    m_ReadAhead(),
+    m_ReadAheadPos(0),
+    m_ReadAheadFill(0),
+    m_FilePos(0)
+{}
+//-------------------------------------------------------------------------------------------------
+AMFDataStreamMappedFileImpl::~AMFDataStreamMappedFileImpl()
+{
+    Close();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Open(const wchar_t* pFilePath, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType)
+{
+    if(m_iFileDescriptor != -1)
+    {
+        Close();
+    }
+    AMF_RETURN_IF_FALSE(pFilePath != NULL, AMF_INVALID_ARG);
+    AMF_RETURN_IF_FALSE(eOpenType == AMFSO_READ, AMF_NOT_SUPPORTED, L"Open() - mapped file streams are read-only");
 
+    m_Path = pFilePath;
+    m_iFileDescriptor = OpenFileDescriptor(m_Path, eOpenType, eShareType);
+    if(m_iFileDescriptor == -1)
+    {
+        return AMF_FAIL;
+    }
+    m_Position = 0;
+    m_FilePos = 0;
+    m_ReadAheadPos = 0;
+    m_ReadAheadFill = 0;
 
+    if(!Map())
+    {
+        AMFTraceDebug(AMF_FACILITY, L"Open() - %s can't be mapped, using read-ahead", m_Path.c_str());
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFDataStreamMappedFileImpl::Map()
+{
+    amf_stat64 st = {};
+    if(amf_fstat64(m_iFileDescriptor, &st) != 0 || (st.st_mode & S_IFMT) != S_IFREG || st.st_size <= 0)
+    {
+        return false;
+    }
+    if(amf_uint64(st.st_size) > amf_uint64(amf_size(-1)))
+    {
+        return false; // doesn't fit into the address space of a 32-bit process
+    }
 #if defined(_WIN32)
-    int access = _O_BINARY;
+    HANDLE hFile = (HANDLE)_get_osfhandle(m_iFileDescriptor);
+    HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(hMapping == NULL)
+    {
+        return false;
+    }
+    void* pMapped = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if(pMapped == NULL)
+    {
+        CloseHandle(hMapping);
+        return false;
+    }
+    m_hMapping = hMapping;
 #else
-    int access = 0;
+    void* pMapped = mmap(NULL, amf_size(st.st_size), PROT_READ, MAP_PRIVATE, m_iFileDescriptor, 0);
+    if(pMapped == MAP_FAILED)
+    {
+        return false;
+    }
+    // streams are consumed front to back
+    madvise(pMapped, amf_size(st.st_size), MADV_SEQUENTIAL);
 #endif
-
-    switch(eOpenType)
+    m_pMapped = (amf_uint8*)pMapped;
+    m_MappedSize = st.st_size;
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamMappedFileImpl::Unmap()
+{
+    if(m_pMapped != NULL)
     {
-    case AMFSO_READ:
-        access |= O_RDONLY;
-        break;
+#if defined(_WIN32)
+        UnmapViewOfFile(m_pMapped);
+        CloseHandle((HANDLE)m_hMapping);
+        m_hMapping = NULL;
+#else
+        munmap(m_pMapped, amf_size(m_MappedSize));
+#endif
+        m_pMapped = NULL;
+        m_MappedSize = 0;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Close()
+{
+    Unmap();
+    m_ReadAheadFill = 0;
 
-    case AMFSO_WRITE:
-        access |= O_CREAT | O_TRUNC | O_WRONLY;
-        break;
+    AMF_RESULT err = AMF_OK;
+    if(m_iFileDescriptor != -1)
+    {
+        const int status = amf_close(m_iFileDescriptor);
+        if(status != 0)
+        {
+            err = AMF_FAIL;
+        }
+        m_iFileDescriptor = -1;
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFDataStreamMappedFileImpl::FillReadAhead(amf_size iSize)
+{
+    // make the read-ahead buffer start at m_Position and hold at least iSize bytes, unless EOF is hit first
+    const amf_int64 bufferEnd = m_ReadAheadPos + amf_int64(m_ReadAheadFill);
+    if(m_Position >= m_ReadAheadPos && m_Position + amf_int64(iSize) <= bufferEnd)
+    {
+        return AMF_OK;
+    }
+    // keep the unread tail, it is shorter than iSize
+    const bool bKeepTail = m_Position >= m_ReadAheadPos && m_Position < bufferEnd;
+    m_ReadAheadFill = bKeepTail ? amf_size(bufferEnd - m_Position) : 0;
+    if(bKeepTail && m_Position > m_ReadAheadPos)
+    {
+        memmove(m_ReadAhead.GetData(), m_ReadAhead.GetData() + (m_Position - m_ReadAheadPos), m_ReadAheadFill);
+    }
+    m_ReadAheadPos = m_Position;
+    if(m_ReadAhead.GetSize() < iSize || m_ReadAhead.GetSize() < ReadAheadSize)
+    {
+        m_ReadAhead.SetSize(AMF_MAX(iSize, ReadAheadSize));
+    }
 
-    case AMFSO_READ_WRITE:
-        access |= O_CREAT | O_TRUNC | O_RDWR;
-        break;
+    const amf_int64 fileFrom = m_ReadAheadPos + amf_int64(m_ReadAheadFill);
+    if(m_FilePos != fileFrom)
+    {
+        if(amf_seek64(m_iFileDescriptor, fileFrom, SEEK_SET) == -1L)
+        {
+            return AMF_FAIL;
+        }
+        m_FilePos = fileFrom;
+    }
+    while(m_ReadAheadFill < iSize)
+    {
+        const int ready = amf_read(m_iFileDescriptor, m_ReadAhead.GetData() + m_ReadAheadFill, (amf_uint)(m_ReadAhead.GetSize() - m_ReadAheadFill));
+        if(ready == -1)
+        {
+            return AMF_FAIL;
+        }
+        if(ready == 0)
+        {
+            break; // eof
+        }
+        m_ReadAheadFill += amf_size(ready);
+        m_FilePos += ready;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::GetView(amf_size iSize, const amf_uint8** ppData, amf_size* pAvailable)
+{
+    AMF_RETURN_IF_FALSE(ppData != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(pAvailable != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"GetView() - File not open");
 
-    case AMFSO_APPEND:
-        access |= O_CREAT | O_APPEND | O_RDWR;
-        break;
+    if(m_pMapped != NULL)
+    {
+        const amf_int64 available = m_Position < m_MappedSize ? m_MappedSize - m_Position : 0;
+        *ppData = m_pMapped + (available > 0 ? m_Position : m_MappedSize);
+        *pAvailable = amf_size(AMF_MIN(amf_int64(iSize), available));
+    }
+    else
+    {
+        AMF_RETURN_IF_FAILED(FillReadAhead(iSize));
+        *ppData = m_ReadAhead.GetData() + (m_Position - m_ReadAheadPos);
+        *pAvailable = AMF_MIN(iSize, m_ReadAheadFill - amf_size(m_Position - m_ReadAheadPos));
     }
+    return *pAvailable == 0 && iSize != 0 ? AMF_EOF : AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL AMFDataStreamMappedFileImpl::IsMapped()
+{
+    return m_pMapped != NULL;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Read(void* pData, amf_size iSize, amf_size* pRead)
+{
+    AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"Read() - File not open");
 
-#ifdef _WIN32
-    int shflag = 0;
-    switch(eShareType)
+    amf_size ready = 0;
+    AMF_RESULT err = AMF_OK;
+    if(m_pMapped == NULL && iSize >= ReadAheadSize && m_ReadAheadFill == 0)
     {
-    case AMFFS_EXCLUSIVE:
-        shflag = _SH_DENYRW;
-        break;
+        // large reads bypass the read-ahead buffer
+        if(m_FilePos != m_Position)
+        {
+            AMF_RETURN_IF_FALSE(amf_seek64(m_iFileDescriptor, m_Position, SEEK_SET) != -1L, AMF_FAIL);
+            m_FilePos = m_Position;
+        }
+        const int result = amf_read(m_iFileDescriptor, pData, (amf_uint)iSize);
+        err = result == -1 ? AMF_FAIL : result == 0 ? AMF_EOF : AMF_OK;
+        ready = result > 0 ? amf_size(result) : 0;
+        m_FilePos += ready;
+    }
+    else
+    {
+        const amf_uint8* pView = NULL;
+        err = GetView(iSize, &pView, &ready);
+        if(ready > 0)
+        {
+            memcpy(pData, pView, ready);
+        }
+    }
+    m_Position += ready;
+    if(pRead != NULL)
+    {
+        *pRead = ready;
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Write(const void* /*pData*/, amf_size /*iSize*/, amf_size* pWritten)
+{
+    if(pWritten != NULL)
+    {
+        *pWritten = 0;
+    }
+    return AMF_NOT_SUPPORTED; // read-only
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition)
+{
+    AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"Seek() - File not Open");
 
-    case AMFFS_SHARE_READ:
-        shflag = _SH_DENYWR;
+    amf_int64 new_pos = 0;
+    switch(eOrigin)
+    {
+    case AMF_SEEK_BEGIN:
+        new_pos = iPosition;
         break;
 
-    case AMFFS_SHARE_WRITE:
-        shflag = _SH_DENYRD;
+    case AMF_SEEK_CURRENT:
+        new_pos = m_Position + iPosition;
         break;
 
-    case AMFFS_SHARE_READ_WRITE:
-        shflag = _SH_DENYNO;
+    case AMF_SEEK_END:
+        {
+            amf_int64 size = 0;
+            AMF_RETURN_IF_FAILED(GetSize(&size));
+            new_pos = size + iPosition;
+        }
         break;
     }
-#endif
-
-#ifdef O_BINARY
-    access |= O_BINARY;
-#endif
-
-#ifdef _WIN32
-    m_iFileDescriptor = _wsopen(m_Path.c_str(), access, shflag, 0666);
-#else
-    amf_string str = amf_from_unicode_to_utf8(m_Path);
-    m_iFileDescriptor = open(str.c_str(), access, 0666);
-#endif
-
-    if(m_iFileDescriptor == -1)
+    if(new_pos < 0) // check errors
     {
         return AMF_FAIL;
     }
+    m_Position = new_pos;
+    if(pNewPosition != NULL)
+    {
+        *pNewPosition = new_pos;
+    }
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::GetPosition(amf_int64* pPosition)
+{
+    AMF_RETURN_IF_FALSE(pPosition != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"GetPosition() - File not Open");
+    *pPosition = m_Position;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::GetSize(amf_int64* pSize)
+{
+    AMF_RETURN_IF_FALSE(pSize != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"GetSize() - File not open");
+
+    if(m_pMapped != NULL)
+    {
+        *pSize = m_MappedSize;
+        return AMF_OK;
+    }
+    amf_stat64 st = {};
+    AMF_RETURN_IF_FALSE(amf_fstat64(m_iFileDescriptor, &st) == 0, AMF_FAIL, L"GetSize() - fstat failed");
+    *pSize = st.st_size;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL AMFDataStreamMappedFileImpl::IsSeekable()
+{
+    if(m_pMapped != NULL)
+    {
+        return true;
+    }
+    return m_iFileDescriptor != -1 && amf_seek64(m_iFileDescriptor, 0, SEEK_CUR) != -1L;
+}
+//-------------------------------------------------------------------------------------------------
@@ -38,6 +38,7 @@
 #include "DataStream.h"
 #include "InterfaceImpl.h"
 #include "AMFSTL.h"
+#include "ByteArray.h"
 #include <string>
 
 namespace amf
@@ -63,5 +64,62 @@ namespace amf
         int m_iFileDescriptor;
         amf_wstring m_Path;
     };
+    //----------------------------------------------------------------------------------------------
+    // read-only file stream: maps the whole file and serves Read() and GetView() from the mapping.
+    // When the file can't be mapped (pipes, character devices, address space exhaustion) it falls
+    // back to reading ahead in large blocks, so small Read() calls still don't cost a syscall each.
+    // The size of a mapped file is taken at Open().
+    //----------------------------------------------------------------------------------------------
+    class AMFDataStreamMappedFileImpl : public AMFInterfaceImpl<AMFDataStreamView>
+    {
+    public:
+        AMFDataStreamMappedFileImpl();
+        virtual ~AMFDataStreamMappedFileImpl();
+
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_ENTRY(AMFDataStream)
+            AMF_INTERFACE_CHAIN_ENTRY(AMFInterfaceImpl<AMFDataStreamView>)
+        AMF_END_INTERFACE_MAP
+
+        // interface
+        virtual AMF_RESULT AMF_STD_CALL Close();
+        virtual AMF_RESULT AMF_STD_CALL Read(void* pData, amf_size iSize, amf_size* pRead);
+        virtual AMF_RESULT AMF_STD_CALL Write(const void* pData, amf_size iSize, amf_size* pWritten);
+        virtual AMF_RESULT AMF_STD_CALL Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition);
+        virtual AMF_RESULT AMF_STD_CALL GetPosition(amf_int64* pPosition);
+        virtual AMF_RESULT AMF_STD_CALL GetSize(amf_int64* pSize);
+        virtual bool       AMF_STD_CALL IsSeekable();
+        virtual AMF_RESULT AMF_STD_CALL GetView(amf_size iSize, const amf_uint8** ppData, amf_size* pAvailable);
+        virtual bool       AMF_STD_CALL IsMapped();
+
+        // local
+        virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* pFilePath, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType);
+
+        static constexpr amf_size ReadAheadSize = 1024 * 1024;
+    protected:
+        bool        Map();
+        void        Unmap();
+        AMF_RESULT  FillReadAhead(amf_size iSize);
+
+        int         m_iFileDescriptor;
+        amf_wstring m_Path;
+        amf_int64   m_Position;         // logical stream position
+
+        // mapped mode
+        amf_uint8*  m_pMapped;
+        amf_int64   m_MappedSize;
+#if defined(_WIN32)
+        void*       m_hMapping;
+#endif
+
+        // read-ahead mode: m_ReadAhead holds file bytes [m_ReadAheadPos, m_ReadAheadPos + m_ReadAheadFill)
+        AMFByteArray m_ReadAhead;
+        amf_int64    m_ReadAheadPos;
+        amf_size     m_ReadAheadFill;
+        amf_int64    m_FilePos;         // position of the file descriptor
+    private:
+        AMFDataStreamMappedFileImpl(const AMFDataStreamMappedFileImpl&);
+        AMFDataStreamMappedFileImpl& operator=(const AMFDataStreamMappedFileImpl&);
+    };
 } //namespace amf
 #endif // AMF_DataStreamFile_h
\ No newline at end of file
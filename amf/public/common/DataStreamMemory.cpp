@@ -38,12 +38,95 @@ using namespace amf;
 
 #define AMF_FACILITY    L"AMFDataStreamMemoryImpl"
 
+namespace
+{
+    //-------------------------------------------------------------------------------------------------
+    // Free blocks shared by all memory streams, binned by power-of-two size. Blocks above the
+    // largest bin and blocks that would push the pool over its limit go back to the system.
+    class MemoryBlockPool
+    {
+    public:
+        static constexpr amf_size MinBlockSize = 4 * 1024;
+        static constexpr int      BinCount = 15;            // 4 KB .. 64 MB
+        static constexpr amf_size MaxPooledBytes = 64 * 1024 * 1024;
+
+        static MemoryBlockPool& Get()
+        {
+            // never destroyed: streams may be released from other static destructors
+            static MemoryBlockPool* s_pPool = new MemoryBlockPool();
+            return *s_pPool;
+        }
+
+        // rounds iSize up to the block size Alloc() will return
+        static amf_size BlockSize(amf_size iSize)
+        {
+            amf_size blockSize = MinBlockSize;
+            while(blockSize < iSize)
+            {
+                blockSize *= 2;
+            }
+            return blockSize;
+        }
+
+        amf_uint8* Alloc(amf_size blockSize)
+        {
+            const int bin = GetBin(blockSize);
+            if(bin >= 0)
+            {
+                AMFLock lock(&m_Sect);
+                if(m_Bins[bin].empty() == false)
+                {
+                    amf_uint8* pBlock = m_Bins[bin].back();
+                    m_Bins[bin].pop_back();
+                    m_PooledBytes -= blockSize;
+                    return pBlock;
+                }
+            }
+            return (amf_uint8*)amf_virtual_alloc(blockSize);
+        }
+
+        void Free(amf_uint8* pBlock, amf_size blockSize)
+        {
+            const int bin = GetBin(blockSize);
+            if(bin >= 0)
+            {
+                AMFLock lock(&m_Sect);
+                if(m_PooledBytes + blockSize <= MaxPooledBytes)
+                {
+                    m_Bins[bin].push_back(pBlock);
+                    m_PooledBytes += blockSize;
+                    return;
+                }
+            }
+            amf_virtual_free(pBlock);
+        }
+
+    private:
+        MemoryBlockPool() : m_PooledBytes(0) {}
+
+        static int GetBin(amf_size blockSize)
+        {
+            int bin = 0;
+            for(amf_size size = MinBlockSize; size < blockSize; size *= 2)
+            {
+                bin++;
+            }
+            return bin < BinCount && (MinBlockSize << bin) == blockSize ? bin : -1;
+        }
+
+        AMFCriticalSection          m_Sect;
+        std::vector<amf_uint8*>     m_Bins[BinCount];
+        amf_size                    m_PooledBytes;
+    };
+}
+
 //-------------------------------------------------------------------------------------------------
-AMFDataStreamMemoryImpl::AMFDataStreamMemoryImpl()
+AMFDataStreamMemoryImpl::AMFDataStreamMemoryImpl(bool bChunked)
     : m_pMemory(NULL),
     m_uiMemorySize(0),
     m_uiAllocatedSize(0),
-    m_pos(0)
+    m_pos(0),
+    m_bChunked(bChunked)
 {}
 //-------------------------------------------------------------------------------------------------
 AMFDataStreamMemoryImpl::~AMFDataStreamMemoryImpl()
@@ -55,10 +138,16 @@ AMFDataStreamMemoryImpl::~AMFDataStreamMemoryImpl()
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Close()
 {
+    MemoryBlockPool& pool = MemoryBlockPool::Get();
     if(m_pMemory != NULL)
     {
-        amf_virtual_free(m_pMemory);
+        pool.Free(m_pMemory, m_uiAllocatedSize);
+    }
+    for(amf_uint8* pChunk : m_Chunks)
+    {
+        pool.Free(pChunk, ChunkSize);
     }
+    m_Chunks.clear();
     m_pMemory = NULL,
     m_uiMemorySize = 0,
     m_uiAllocatedSize = 0,
@@ -68,21 +157,39 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Close()
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMFDataStreamMemoryImpl::Realloc(amf_size iSize)
 {
-    if(iSize > m_uiMemorySize)
+    if(iSize > m_uiAllocatedSize)
     {
-        amf_uint8* pNewMemory = (amf_uint8*)amf_virtual_alloc(iSize);
-        if(pNewMemory == NULL)
+        MemoryBlockPool& pool = MemoryBlockPool::Get();
+        if(m_bChunked)
         {
-            return AMF_OUT_OF_MEMORY;
+            while(m_uiAllocatedSize < iSize)
+            {
+                amf_uint8* pChunk = pool.Alloc(ChunkSize);
+                if(pChunk == NULL)
+                {
+                    return AMF_OUT_OF_MEMORY;
+                }
+                m_Chunks.push_back(pChunk);
+                m_uiAllocatedSize += ChunkSize;
+            }
         }
-        m_uiAllocatedSize = iSize;
-        if(m_pMemory != NULL)
+        else
         {
-            memcpy(pNewMemory, m_pMemory, m_uiMemorySize);
-            amf_virtual_free(m_pMemory);
+            // doubling keeps appending a packet at a time linear overall
+            const amf_size allocSize = MemoryBlockPool::BlockSize(AMF_MAX(iSize, m_uiAllocatedSize * 2));
+            amf_uint8* pNewMemory = pool.Alloc(allocSize);
+            if(pNewMemory == NULL)
+            {
+                return AMF_OUT_OF_MEMORY;
+            }
+            if(m_pMemory != NULL)
+            {
+                memcpy(pNewMemory, m_pMemory, m_uiMemorySize);
+                pool.Free(m_pMemory, m_uiAllocatedSize);
+            }
+            m_pMemory = pNewMemory;
+            m_uiAllocatedSize = allocSize;
         }
-
-        m_pMemory = pNewMemory;
     }
     m_uiMemorySize = iSize;
     if(m_pos > m_uiMemorySize)
@@ -95,10 +202,24 @@ AMF_RESULT AMFDataStreamMemoryImpl::Realloc(amf_size iSize)
 AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Read(void* pData, amf_size iSize, amf_size* pRead)
 {
     AMF_RETURN_IF_FALSE(pData != NULL, AMF_INVALID_POINTER, L"Read() - pData==NULL");
-    AMF_RETURN_IF_FALSE(m_pMemory != NULL, AMF_NOT_INITIALIZED, L"Read() - Stream is not allocated");
+    AMF_RETURN_IF_FALSE(m_pMemory != NULL || m_Chunks.empty() == false, AMF_NOT_INITIALIZED, L"Read() - Stream is not allocated");
 
     amf_size toRead = AMF_MIN(iSize, m_uiMemorySize - m_pos);
-    memcpy(pData, m_pMemory + m_pos, toRead);
+    if(m_bChunked)
+    {
+        amf_uint8* pDst = (amf_uint8*)pData;
+        for(amf_size done = 0; done < toRead; )
+        {
+            const amf_size offset = (m_pos + done) % ChunkSize;
+            const amf_size size = AMF_MIN(toRead - done, ChunkSize - offset);
+            memcpy(pDst + done, m_Chunks[(m_pos + done) / ChunkSize] + offset, size);
+            done += size;
+        }
+    }
+    else
+    {
+        memcpy(pData, m_pMemory + m_pos, toRead);
+    }
     m_pos += toRead;
     if(pRead != NULL)
     {
@@ -110,10 +231,24 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Read(void* pData, amf_size iSiz
 AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Write(const void* pData, amf_size iSize, amf_size* pWritten)
 {
     AMF_RETURN_IF_FALSE(pData != NULL, AMF_INVALID_POINTER, L"Write() - pData==NULL");
-    AMF_RETURN_IF_FAILED(Realloc(m_pos + iSize), L"Write() - Stream is not allocated");
+    AMF_RETURN_IF_FAILED(Realloc(AMF_MAX(m_uiMemorySize, m_pos + iSize)), L"Write() - Stream is not allocated");
 
     amf_size toWrite = AMF_MIN(iSize, m_uiMemorySize - m_pos);
-    memcpy(m_pMemory + m_pos, pData, toWrite);
+    if(m_bChunked)
+    {
+        const amf_uint8* pSrc = (const amf_uint8*)pData;
+        for(amf_size done = 0; done < toWrite; )
+        {
+            const amf_size offset = (m_pos + done) % ChunkSize;
+            const amf_size size = AMF_MIN(toWrite - done, ChunkSize - offset);
+            memcpy(m_Chunks[(m_pos + done) / ChunkSize] + offset, pSrc + done, size);
+            done += size;
+        }
+    }
+    else
+    {
+        memcpy(m_pMemory + m_pos, pData, toWrite);
+    }
     m_pos += toWrite;
     if(pWritten != NULL)
     {
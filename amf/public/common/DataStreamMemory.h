@@ -37,13 +37,20 @@
 
 #include "DataStream.h"
 #include "InterfaceImpl.h"
+#include <vector>
 
 namespace amf
 {
+    // Memory blocks of both layouts come from a process-wide pool, so streams that are created
+    // and closed at a high rate (muxing to memory, segmenting) reuse each other's storage.
     class AMFDataStreamMemoryImpl : public AMFInterfaceImpl<AMFDataStream>
     {
     public:
-        AMFDataStreamMemoryImpl();
+        // contiguous streams double their capacity when they grow; chunked streams keep the data
+        // in fixed-size blocks and never copy it when they grow
+        static constexpr amf_size ChunkSize = 256 * 1024;
+
+        AMFDataStreamMemoryImpl(bool bChunked = false);
         virtual ~AMFDataStreamMemoryImpl();
         // interface
         virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* /*pFileUrl*/, AMF_STREAM_OPEN /*eOpenType*/, AMF_FILE_SHARE /*eShareType*/)
@@ -68,6 +75,8 @@ namespace amf
         amf_size m_uiMemorySize;
         amf_size m_uiAllocatedSize;
         amf_size m_pos;
+        bool m_bChunked;
+        std::vector<amf_uint8*> m_Chunks;
     private:
         AMFDataStreamMemoryImpl(const AMFDataStreamMemoryImpl&);
         AMFDataStreamMemoryImpl& operator=(const AMFDataStreamMemoryImpl&);
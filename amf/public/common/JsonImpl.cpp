@@ -35,185 +35,429 @@
 #include "JsonImpl.h"
 #include <stdio.h>
 #include <cstdlib>
-#include <sstream>
+#include <cstring>
 #include <inttypes.h>
 
 #pragma warning(disable: 4996)
 
 static amf::JSONParser::OutputFormatDesc defaultFormat = {};
+static const size_t STRINGIFY_RESERVE = 4096;
+static const char* const NULL_STR = "null";
+static const char* const TRUE_STR = "true";
+static const char* const FALSE_STR = "false";
 
-///////////////////////////// Element ////////////////////////////////////////
-amf::JSONParserImpl::ElementHelper::ElementHelper()
-{
-}
-
-size_t amf::JSONParserImpl::ElementHelper::FindClosure(const std::string& str, char opener, char closer, size_t start)
+///////////////////////////// Reader ////////////////////////////////////////
+// single pass tokenizer: each character of the document is visited once and strings are
+// reported as pointers into the source, nothing is copied until the handler asks for it
+class amf::JSONParserImpl::Reader
 {
-    size_t endPos = start;
-    
-    if (opener != closer)
+public:
+    Reader(const std::string& str, size_t start, size_t end, Handler* pHandler) :
+        m_pBegin(str.c_str()),
+        m_pCur(str.c_str() + start),
+        m_pEnd(str.c_str() + end),
+        m_pHandler(pHandler)
     {
-        int openerCnt = 0;
-        int closerCnt = 0;
-
-        bool inQuote = false;
-        bool backslashEscape = false;
+    }
 
-        for (size_t i = start; i < str.length(); i++)
+    Error ParseValue()
+    {
+        SkipWhitespaces();
+        const size_t start = GetOffset();
+        if (m_pCur == m_pEnd)
         {
-            char sym = str.at(i);
-
-            // skip openers/closers that are inside quotes
-            if (sym == '\\' && backslashEscape == false) {
-                backslashEscape = true;
-                continue;
-            }
-            if (sym == '"' && backslashEscape == false)
-            {
-                inQuote = !inQuote;
-            }
-
-            backslashEscape = false;
-            if (inQuote == true)
+            return Error(start, JSONParser::MISSING_VALUE);
+        }
+        switch (*m_pCur)
+        {
+        case '{':
+            return ParseNode();
+        case '[':
+            return ParseArray();
+        case '\"':
+        {
+            const char* pValue = nullptr;
+            size_t length = 0;
+            if (ReadString(pValue, length) == false)
             {
-                continue;
+                return Error(start, JSONParser::MISSING_QUOTE);
             }
-
-            if (sym == opener)
+            return Error(start, m_pHandler->OnString(pValue, length));
+        }
+        default:
+        {
+            const char* pValue = m_pCur;
+            while (m_pCur != m_pEnd && IsDelimiter(*m_pCur) == false)
             {
-                ++openerCnt;
+                ++m_pCur;
             }
-            else if (sym == closer)
+            if (m_pCur == pValue)
             {
-                ++closerCnt;
-                if (openerCnt == closerCnt)
-                {
-                    endPos = i;
-                    break;
-                }
+                return Error(start, JSONParser::MISSING_VALUE);
             }
+            return Error(start, m_pHandler->OnLiteral(pValue, m_pCur - pValue));
+        }
         }
     }
-    else
+
+private:
+    Error ParseNode()
     {
-        for (size_t i = start+1; i < str.length(); i++)
+        const size_t start = GetOffset();
+        ++m_pCur; // '{'
+        Error err = Error(start, m_pHandler->OnBeginNode());
+        if (err.GetResult() != JSONParser::OK)
+        {
+            return err;
+        }
+        for (;;)
         {
-            if (str.at(i) == closer)
+            SkipWhitespaces();
+            if (m_pCur == m_pEnd)
+            {
+                return Error(start, JSONParser::MISSING_BRACE);
+            }
+            if (*m_pCur == '}') // empty node or trailing comma
             {
-                endPos = i;
                 break;
             }
+            const size_t nameStart = GetOffset();
+            const char* pName = nullptr;
+            size_t nameLength = 0;
+            if (*m_pCur != '\"' || ReadString(pName, nameLength) == false)
+            {
+                return Error(nameStart, JSONParser::MISSING_QUOTE);
+            }
+            SkipWhitespaces();
+            if (m_pCur == m_pEnd || *m_pCur != ':')
+            {
+                return Error(nameStart, JSONParser::MISSING_DELIMITER);
+            }
+            ++m_pCur;
+            err = Error(nameStart, m_pHandler->OnName(pName, nameLength));
+            if (err.GetResult() != JSONParser::OK)
+            {
+                return err;
+            }
+            err = ParseValue();
+            if (err.GetResult() != JSONParser::OK)
+            {
+                return err;
+            }
+            if (ReadSeparator('}', err) == false)
+            {
+                return err;
+            }
+            if (*m_pCur == '}')
+            {
+                break;
+            }
+            ++m_pCur; // ','
         }
+        ++m_pCur; // '}'
+        return Error(start, m_pHandler->OnEndNode());
     }
-    return endPos;
-}
 
-amf::JSONParser::Error amf::JSONParserImpl::ElementHelper::CreateElement(const std::string& str, size_t start, size_t& valueStart, size_t& valueEnd, JSONParser::Element** val)
-{
-    *val = nullptr;
-    static const char* specialCharsStart = "\t\n\r ";
-    static const char* specialCharsEnd = "\t\n\r,:}] ";
-    valueStart = str.find_first_not_of(specialCharsStart, start);
-    bool bParse = true;
-    if (valueStart == str.npos)
+    Error ParseArray()
     {
-        return Error(start, JSONParser::MISSING_VALUE);
-    }
-    else
-    {
-        switch (str.at(valueStart))
+        const size_t start = GetOffset();
+        ++m_pCur; // '['
+        Error err = Error(start, m_pHandler->OnBeginArray());
+        if (err.GetResult() != JSONParser::OK)
         {
-        case '{':
-            valueEnd = FindClosure(str, '{', '}', valueStart);
-            if (valueEnd == str.npos)
+            return err;
+        }
+        for (;;)
+        {
+            SkipWhitespaces();
+            if (m_pCur == m_pEnd)
             {
-                return Error(start, JSONParser::MISSING_BRACE);
+                return Error(start, JSONParser::MISSING_BRACKET);
             }
-            else
+            if (*m_pCur == ']') // empty array or trailing comma
             {
-                ++valueEnd;
+                break;
             }
-            *val = new NodeImpl();
-            break;
-        case '[':
-            valueEnd = FindClosure(str, '[', ']', valueStart);
-            if (valueEnd == str.npos)
+            err = ParseValue();
+            if (err.GetResult() != JSONParser::OK)
             {
-                return Error(start, JSONParser::MISSING_BRACKET);
-
+                return err;
             }
-            else
+            if (ReadSeparator(']', err) == false)
             {
-                ++valueEnd;
+                return err;
             }
-            *val = new ArrayImpl();
-        
-            break;
-            
-        case '\"':
+            if (*m_pCur == ']')
+            {
+                break;
+            }
+            ++m_pCur; // ','
+        }
+        ++m_pCur; // ']'
+        return Error(start, m_pHandler->OnEndArray());
+    }
+
+    // leaves the cursor on ',' or the closer
+    bool ReadSeparator(char closer, Error& err)
+    {
+        SkipWhitespaces();
+        if (m_pCur == m_pEnd)
         {
-            valueEnd = FindClosure(str, '\"', '\"', valueStart);
-            if (valueEnd == str.npos)
+            err = Error(GetOffset(), JSONParser::UNEXPECTED_END);
+            return false;
+        }
+        if (*m_pCur != ',' && *m_pCur != closer)
+        {
+            err = Error(GetOffset(), JSONParser::MISSING_DELIMITER);
+            return false;
+        }
+        return true;
+    }
+
+    // the cursor is on the opening quote; escapes are skipped but kept in the value
+    bool ReadString(const char*& pValue, size_t& length)
+    {
+        pValue = ++m_pCur;
+        while (m_pCur != m_pEnd)
+        {
+            const char* pQuote = static_cast<const char*>(memchr(m_pCur, '\"', m_pEnd - m_pCur));
+            if (pQuote == nullptr)
             {
-                return Error(start, JSONParser::MISSING_QUOTE);
+                break;
             }
-            else
+            m_pCur = pQuote + 1;
+
+            // a quote behind an odd number of backslashes is escaped
+            const char* pEscape = pQuote;
+            while (pEscape != pValue && pEscape[-1] == '\\')
             {
-                ++valueEnd;
+                --pEscape;
             }
-            ValueImpl *valImpl = new ValueImpl();
-            valImpl->SetValue(str.substr(valueStart +1, valueEnd - valueStart - 2) );
-            *val = valImpl;
-            bParse = false;
-            break;
-        }
-        
-        default:
+            if (((pQuote - pEscape) & 1) == 0)
             {
-           
-                if (valueStart == str.npos)
-                {
-                    return Error(start, JSONParser::MISSING_VALUE);
-                }
-                else
-                {
-                    valueEnd = str.find_first_of(specialCharsEnd, valueStart);
-                    if (valueEnd == str.npos)
-                    {
-                        return Error(valueStart, JSONParser::MISSING_DELIMITER);
-                    }
-                }
-                *val = new ValueImpl();
-                break;
+                length = pQuote - pValue;
+                return true;
+            }
+        }
+        m_pCur = m_pEnd;
+        return false;
+    }
+
+    void SkipWhitespaces()
+    {
+        while (m_pCur != m_pEnd && IsWhitespace(*m_pCur))
+        {
+            ++m_pCur;
+        }
+    }
+
+    static bool IsWhitespace(char sym)
+    {
+        return sym == ' ' || sym == '\t' || sym == '\n' || sym == '\r';
+    }
+
+    static bool IsDelimiter(char sym)
+    {
+        return IsWhitespace(sym) || sym == ',' || sym == ':' || sym == '}' || sym == ']';
+    }
+
+    size_t GetOffset() const
+    {
+        return m_pCur - m_pBegin;
+    }
+
+    const char*     m_pBegin;
+    const char*     m_pCur;
+    const char*     m_pEnd;
+    Handler*        m_pHandler;
+};
+
+///////////////////////////// DOMBuilder ////////////////////////////////////////
+// turns Reader events into Node/Array/Value elements under a given root
+class amf::JSONParserImpl::DOMBuilder : public amf::JSONParserImpl::Handler
+{
+public:
+    DOMBuilder(ElementHelper* pRoot) :
+        m_pRoot(pRoot),
+        m_Name(),
+        m_Stack()
+    {
+    }
+
+    virtual JSONParser::Result OnBeginNode() override
+    {
+        if (m_Stack.empty())
+        {
+            return BeginRoot(ElementHelper::ET_Node, JSONParser::MISSING_BRACE);
+        }
+        NodeImpl* pNode = new NodeImpl();
+        JSONParser::Result result = Add(pNode);
+        if (result == JSONParser::OK)
+        {
+            m_Stack.push_back(pNode);
+        }
+        return result;
+    }
+
+    virtual JSONParser::Result OnEndNode() override
+    {
+        m_Stack.pop_back();
+        return JSONParser::OK;
+    }
+
+    virtual JSONParser::Result OnBeginArray() override
+    {
+        if (m_Stack.empty())
+        {
+            return BeginRoot(ElementHelper::ET_Array, JSONParser::MISSING_BRACKET);
+        }
+        ArrayImpl* pArray = new ArrayImpl();
+        JSONParser::Result result = Add(pArray);
+        if (result == JSONParser::OK)
+        {
+            m_Stack.push_back(pArray);
+        }
+        return result;
+    }
+
+    virtual JSONParser::Result OnEndArray() override
+    {
+        m_Stack.pop_back();
+        return JSONParser::OK;
+    }
+
+    virtual JSONParser::Result OnName(const char* name, size_t length) override
+    {
+        m_Name.assign(name, length);
+        return JSONParser::OK;
+    }
+
+    virtual JSONParser::Result OnString(const char* value, size_t length) override
+    {
+        return AddValue(value, length, true);
+    }
+
+    virtual JSONParser::Result OnLiteral(const char* value, size_t length) override
+    {
+        return AddValue(value, length, false);
+    }
+
+private:
+    JSONParser::Result BeginRoot(ElementHelper::ELEMENT_TYPE eType, JSONParser::Result mismatch)
+    {
+        if (m_pRoot == nullptr || m_pRoot->GetElementType() != eType)
+        {
+            return mismatch;
         }
+        m_Stack.push_back(m_pRoot);
+        m_pRoot = nullptr;
+        return JSONParser::OK;
+    }
+
+    JSONParser::Result AddValue(const char* value, size_t length, bool bString)
+    {
+        if (m_Stack.empty())
+        {
+            if (m_pRoot == nullptr || m_pRoot->GetElementType() != ElementHelper::ET_Value)
+            {
+                return JSONParser::INVALID_VALUE;
+            }
+            static_cast<ValueImpl*>(m_pRoot)->SetParsedValue(value, length, bString);
+            m_pRoot = nullptr;
+            return JSONParser::OK;
         }
-    
-        if (*val != nullptr && bParse == true)
+        ValueImpl* pValue = new ValueImpl();
+        pValue->SetParsedValue(value, length, bString);
+        return Add(pValue);
+    }
+
+    JSONParser::Result Add(JSONParser::Element* pElement)
+    {
+        JSONParser::Element::Ptr pHolder(pElement); // released here if the parent rejects it
+        ElementHelper* pParent = m_Stack.back();
+        if (pParent->GetElementType() == ElementHelper::ET_Node)
         {
-            (*val)->Parse(str, valueStart, valueEnd);
+            return static_cast<NodeImpl*>(pParent)->AddElement(m_Name, pElement);
         }
+        static_cast<ArrayImpl*>(pParent)->AddElement(pElement);
+        return JSONParser::OK;
+    }
+
+    ElementHelper*                  m_pRoot;
+    std::string                     m_Name;
+    std::vector<ElementHelper*>     m_Stack;
+};
+
+///////////////////////////// Element ////////////////////////////////////////
+amf::JSONParserImpl::ElementHelper::ElementHelper(ELEMENT_TYPE eType) :
+    m_eElementType(eType)
+{
+}
+
+const amf::JSONParserImpl::ElementHelper* amf::JSONParserImpl::ElementHelper::GetHelper(const JSONParser::Element* element)
+{
+    // cheaper than a dynamic_cast across the two base classes
+    void* pHelper = nullptr;
+    JSONParser::Element* pElement = const_cast<JSONParser::Element*>(element);
+    if (pElement->QueryInterface(ElementHelper::IID(), &pHelper) != AMF_OK)
+    {
+        return nullptr;
+    }
+    pElement->Release(); // the parent keeps the element alive
+    return static_cast<const ElementHelper*>(pHelper);
+}
+
+bool amf::JSONParserImpl::ElementHelper::IsValue(const JSONParser::Element* element)
+{
+    const ElementHelper* pHelper = GetHelper(element);
+    if (pHelper != nullptr)
+    {
+        return pHelper->GetElementType() == ET_Value;
+    }
+    amf::JSONParser::Value::Ptr value(const_cast<JSONParser::Element*>(element));
+    return value != nullptr;
+}
+
+bool amf::JSONParserImpl::ElementHelper::IsNode(const JSONParser::Element* element)
+{
+    const ElementHelper* pHelper = GetHelper(element);
+    if (pHelper != nullptr)
+    {
+        return pHelper->GetElementType() == ET_Node;
+    }
+    amf::JSONParser::Node::Ptr node(const_cast<JSONParser::Element*>(element));
+    return node != nullptr;
+}
+
+void amf::JSONParserImpl::ElementHelper::StringifyElement(std::string& target, const JSONParser::Element* element, const OutputFormatDesc& format, int indent)
+{
+    if (element == nullptr)
+    {
+        target += NULL_STR;
+        return;
+    }
+    const ElementHelper* pHelper = GetHelper(element);
+    if (pHelper != nullptr)
+    {
+        pHelper->StringifyTo(target, format, indent);
+    }
+    else
+    {
+        target += element->StringifyFormatted(format, indent);
     }
-    return Error(valueStart, JSONParser::OK);
 }
 
 void amf::JSONParserImpl::ElementHelper::InsertTabs(std::string& target, int count, const OutputFormatDesc& format) const
 {
-    if (format.bHumanReadable)
+    if (format.bHumanReadable && count > 0)
     {
-        int whitespacesToInsert = count * format.nOffsetSize;
-        for (int i = 0; i < whitespacesToInsert; i++)
-        {
-            target += format.cOffsetWith;
-        }
+        target.append(static_cast<size_t>(count) * format.nOffsetSize, format.cOffsetWith);
     }
 }
 
 ///////////////////////////// Value ////////////////////////////////////////
-static const char* const NULL_STR = "null";
-static const char* const TRUE_STR = "true";
-static const char* const FALSE_STR = "false";
 amf::JSONParserImpl::ValueImpl::ValueImpl() :
-    ElementHelper(),
+    ElementHelper(ET_Value),
     m_eType(VT_Unknown)
 {
 }
@@ -236,33 +480,33 @@ void amf::JSONParserImpl::ValueImpl::SetValue(const std::string& val)
 
 void amf::JSONParserImpl::ValueImpl::SetValueAsInt32(int32_t val)
 {
-    std::stringstream str;
-    str << val;
-    m_Value = str.str();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRId32, val);
+    m_Value = buf;
     m_eType = VT_Numeric;
 }
 
 void amf::JSONParserImpl::ValueImpl::SetValueAsUInt32(uint32_t val)
 {
-    std::stringstream str;
-    str << val;
-    m_Value = str.str();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRIu32, val);
+    m_Value = buf;
     m_eType = VT_Numeric;
 }
 
 void amf::JSONParserImpl::ValueImpl::SetValueAsInt64(int64_t val)
 {
-    std::stringstream str;
-    str << val;
-    m_Value = str.str();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRId64, val);
+    m_Value = buf;
     m_eType = VT_Numeric;
 }
 
 void amf::JSONParserImpl::ValueImpl::SetValueAsUInt64(uint64_t val)
 {
-    std::stringstream str;
-    str << val;
-    m_Value = str.str();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRIu64, val);
+    m_Value = buf;
     m_eType = VT_Numeric;
 }
 
@@ -330,9 +574,9 @@ void amf::JSONParserImpl::ValueImpl::SetValueAsTime(time_t date, bool utc)
         val = static_cast<int64_t>(std::mktime(&local_tm));
 #endif // _MSC_VER
     }
-    std::stringstream str;
-    str << val;
-    m_Value = str.str();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRId64, val);
+    m_Value = buf;
     m_eType = VT_Numeric;
 }
 
@@ -429,53 +673,39 @@ time_t amf::JSONParserImpl::ValueImpl::GetValueAsTime() const
 }
 
 
-amf::JSONParser::Error amf::JSONParserImpl::ValueImpl::Parse(const std::string& str, size_t start, size_t end)
+void amf::JSONParserImpl::ValueImpl::SetParsedValue(const char* value, size_t length, bool bString)
 {
-    static const char* specialCharacters = "\"\'\n\r,[{}]"; // whitespaces excluded
-    if(start == end)
+    m_Value.assign(value, length);
+    // Determine Special Types
+    if (bString == true || length == 0)
     {
-        m_Value = "";
         m_eType = VT_String;
     }
+    else if (m_Value.compare(NULL_STR) == 0)
+    {
+        m_eType = VT_Null;
+    }
+    else if (m_Value.compare(TRUE_STR) == 0 || m_Value.compare(FALSE_STR) == 0)
+    {
+        m_eType = VT_Bool;
+    }
     else
     {
-        size_t startPos = str.find_first_not_of(specialCharacters, start);
-        if (startPos == str.npos)
-        {
-            return Error(start, JSONParser::MISSING_VALUE);
-        }
-        startPos = str.find_first_not_of(" \t", startPos); // trim start whitespaces
-        if (startPos == str.npos)
-        {
-            return Error(start, JSONParser::MISSING_VALUE);
-        }
-        size_t endPos = str.find_first_of(specialCharacters, startPos+1); // exclude spaces from search
-        if (endPos == str.npos)
-        {
-            return Error(start, JSONParser::MISSING_VALUE);
-        }
-        endPos = str.find_last_not_of(" \t", endPos); // trim end whitespaces
-        if (endPos == str.npos)
-        {
-            return Error(start, JSONParser::MISSING_VALUE);
-        }
-        m_Value.assign(str, startPos, endPos - startPos);
-        // Determine Special Types
-        if(m_Value.compare(NULL_STR) == 0)
-        {
-            m_eType = VT_Null;
-        }
-        else if(m_Value.compare(TRUE_STR) == 0 || m_Value.compare(FALSE_STR) == 0)
-        {
-            m_eType = VT_Bool;
-        }
-        else
-        {
-            m_eType = VT_Numeric;
-        }
+        m_eType = VT_Numeric;
+    }
+}
 
+amf::JSONParser::Error amf::JSONParserImpl::ValueImpl::Parse(const std::string& str, size_t start, size_t end)
+{
+    if (start == end)
+    {
+        m_Value = "";
+        m_eType = VT_String;
+        return Error(start, JSONParser::OK);
     }
-    return Error(start, JSONParser::OK);
+    DOMBuilder builder(this);
+    Reader reader(str, start, end < str.length() ? end : str.length(), &builder);
+    return reader.ParseValue();
 }
 
 std::string amf::JSONParserImpl::ValueImpl::Stringify() const
@@ -483,24 +713,30 @@ std::string amf::JSONParserImpl::ValueImpl::Stringify() const
     return StringifyFormatted(defaultFormat, 0);
 }
 
-std::string amf::JSONParserImpl::ValueImpl::StringifyFormatted(const OutputFormatDesc&, int /*indent*/) const
+std::string amf::JSONParserImpl::ValueImpl::StringifyFormatted(const OutputFormatDesc& format, int indent) const
 {
     std::string jsonValue;
-    if ((m_eType == VT_String || m_Value.length() == 0) && IsNull() == false)
+    StringifyTo(jsonValue, format, indent);
+    return jsonValue;
+}
+
+void amf::JSONParserImpl::ValueImpl::StringifyTo(std::string& target, const OutputFormatDesc&, int /*indent*/) const
+{
+    const bool bQuoted = (m_eType == VT_String || m_Value.length() == 0) && IsNull() == false;
+    if (bQuoted)
     {
-        jsonValue += '\"';
+        target += '\"';
     }
-    jsonValue += m_Value;
-    if ((m_eType == VT_String || m_Value.length() == 0) && IsNull() == false)
+    target += m_Value;
+    if (bQuoted)
     {
-        jsonValue += '\"';
+        target += '\"';
     }
-    return jsonValue;
 }
 
 ///////////////////////////// Node ////////////////////////////////////////
 amf::JSONParserImpl::NodeImpl::NodeImpl() :
-    ElementHelper()
+    ElementHelper(ET_Node)
 {
 }
 
@@ -511,80 +747,10 @@ size_t amf::JSONParserImpl::NodeImpl::GetElementCount() const
 
 amf::JSONParser::Error amf::JSONParserImpl::NodeImpl::Parse(const std::string& str, size_t start, size_t end)
 {
-    size_t curHead = start;
-    bool continueParsing = true;
-    
-    do
-    {
-        size_t nameStart = str.find_first_of('\"', curHead);
-        size_t nextClosingBrace = str.find_first_of('}', curHead);
-
-        // Additional check for empty elements:
-        // If empty element isn't last in the file
-        // '"' character check might fail to parse correctly
-        // resulting in adding next elements as children
-        if (nextClosingBrace < nameStart)
-        {
-            return Error(start, JSONParser::OK);
-        }
-
-        if (nameStart == str.npos)
-        {
-            if(start + 1 == end)
-            {
-                return Error(start, JSONParser::OK);
-            }
-            return Error(start, JSONParser::MISSING_QUOTE);
-        }
-
-        size_t nameEnd = str.find_first_of('\"', nameStart + 1);
-        if (nameEnd == str.npos)
-        {
-            return Error(nameStart, JSONParser::MISSING_QUOTE);
-        }
-
-        std::string name;
-        name.assign(str, nameStart + 1, nameEnd - nameStart - 1);
-        size_t delimPos = str.find_first_of(':', nameEnd + 1);
-        if (delimPos == str.npos)
-        {
-            return Error(nameStart, JSONParser::MISSING_DELIMITER);
-        }
-
-        size_t valueStart = delimPos+1; //str.find_first_of("\"[{", delimPos + 1);
-        if (valueStart == str.npos)
-        {
-            return Error(nameStart, JSONParser::MISSING_VALUE);
-        }
-        size_t valueEnd = 0;
-        Element* val;
-        Error createErr = CreateElement(str, valueStart, valueStart, valueEnd, &val);
-        if (createErr.GetResult() != OK)
-        {
-            return createErr;
-        }
-        
-        size_t commaPos = str.find_first_not_of(" \t\n\r", valueEnd);
-        if (commaPos == str.npos)
-        {
-            return Error(nameStart, JSONParser::UNEXPECTED_END);
-        }
-        else if (str.at(commaPos) != ',')
-        {
-            continueParsing = false;
-        }
-        else
-        {
-            curHead = commaPos+1;
-        }
-        JSONParser::Result res = AddElement(name, val);
-        if (res != JSONParser::OK)
-        {
-            return Error(nameStart, res);
-        }
-    } 
-    while (continueParsing == true);
-    return Error(start, JSONParser::OK);
+    // end is the position of the closing brace
+    DOMBuilder builder(this);
+    Reader reader(str, start, end < str.length() ? end + 1 : str.length(), &builder);
+    return reader.ParseValue();
 }
 
 std::string amf::JSONParserImpl::NodeImpl::Stringify() const
@@ -594,16 +760,23 @@ std::string amf::JSONParserImpl::NodeImpl::Stringify() const
 
 std::string amf::JSONParserImpl::NodeImpl::StringifyFormatted(const OutputFormatDesc& format, int indent) const
 {
-    bool first = true;
     std::string jsonValue;
+    jsonValue.reserve(STRINGIFY_RESERVE);
+    StringifyTo(jsonValue, format, indent);
+    return jsonValue;
+}
 
-    InsertTabs(jsonValue, indent, format);
-    jsonValue += '{';
+void amf::JSONParserImpl::NodeImpl::StringifyTo(std::string& target, const OutputFormatDesc& format, int indent) const
+{
+    bool first = true;
+
+    InsertTabs(target, indent, format);
+    target += '{';
     for (ElementMap::const_iterator it = m_Elements.begin(); it != m_Elements.end(); ++it)
     {
         if (first == false)
         {
-            jsonValue += ',';
+            target += ',';
         }
         else
         {
@@ -611,30 +784,28 @@ std::string amf::JSONParserImpl::NodeImpl::StringifyFormatted(const OutputFormat
         }
         if (format.bHumanReadable == true)
         {
-            jsonValue += '\n';
+            target += '\n';
         }
-        InsertTabs(jsonValue, indent + 1, format);
-        
-        jsonValue += '\"';
-        jsonValue += it->first;
-        jsonValue += format.bHumanReadable == true ? "\" : " : "\":";
+        InsertTabs(target, indent + 1, format);
+
+        target += '\"';
+        target += it->first;
+        target += format.bHumanReadable == true ? "\" : " : "\":";
         if (format.bHumanReadable == true)
         {
-            amf::JSONParserImpl::Value::Ptr value(it->second);
-            if (value == nullptr && format.bNewLineBeforeBrace == true)
+            if (IsValue(it->second) == false && format.bNewLineBeforeBrace == true)
             {
-                jsonValue += '\n';
+                target += '\n';
             }
         }
-        jsonValue += it->second == nullptr ? "null" : it->second->StringifyFormatted(format, indent + 1);
+        StringifyElement(target, it->second, format, indent + 1);
     }
     if (format.bHumanReadable == true && format.bNewLineBeforeBrace == true)
     {
-        jsonValue += '\n';
+        target += '\n';
     }
-    InsertTabs(jsonValue, indent, format);
-    jsonValue += '}';
-    return jsonValue;
+    InsertTabs(target, indent, format);
+    target += '}';
 }
 
 amf::JSONParser::Element* amf::JSONParserImpl::NodeImpl::GetElementByName(const std::string& name) const
@@ -679,48 +850,16 @@ amf::JSONParser::Element* amf::JSONParserImpl::NodeImpl::GetElementAt(size_t idx
 
 ///////////////////////////// Array ////////////////////////////////////////
 amf::JSONParserImpl::ArrayImpl::ArrayImpl() :
-    ElementHelper()
+    ElementHelper(ET_Array)
 {
 }
 
 amf::JSONParser::Error amf::JSONParserImpl::ArrayImpl::Parse(const std::string& str, size_t start, size_t end)
 {
-    bool continueParsing = true;
-    size_t valueStart;
-    size_t valueEnd = start+1;
-    do
-    {
-        valueStart = str.find_first_not_of("\t\r\n", valueEnd);
-        if (valueStart == str.npos)
-        {
-            return Error(valueEnd, JSONParser::MISSING_VALUE);
-        }
-        if(valueStart + 1 == end)
-        {
-            break;
-        }
-        Element* val = nullptr;
-        Error createErr = CreateElement(str, valueStart, valueStart, valueEnd, &val);
-        if (createErr.GetResult() != OK)
-        {
-            return createErr;
-        }
-        AddElement(Element::Ptr(val));
-        size_t commaPos = str.find_first_not_of(" \t\n\r", valueEnd);
-        if (commaPos == str.npos)
-        {
-            return Error(valueStart, JSONParser::UNEXPECTED_END);
-        }
-        else if (str.at(commaPos) != ',')
-        {
-            continueParsing = false;
-        }
-        else
-        {
-            valueEnd = commaPos+1;
-        }
-    } while (continueParsing == true);
-    return Error(valueStart, JSONParser::OK);
+    // end is the position of the closing bracket
+    DOMBuilder builder(this);
+    Reader reader(str, start, end < str.length() ? end + 1 : str.length(), &builder);
+    return reader.ParseValue();
 }
 
 void amf::JSONParserImpl::ArrayImpl::AddElement(Element* element)
@@ -735,17 +874,24 @@ std::string amf::JSONParserImpl::ArrayImpl::Stringify() const
 
 std::string amf::JSONParserImpl::ArrayImpl::StringifyFormatted(const OutputFormatDesc& format, int indent) const
 {
-    bool first = true;
     std::string jsonValue;
-    InsertTabs(jsonValue, indent, format);
-    
-    jsonValue += '[';
+    jsonValue.reserve(STRINGIFY_RESERVE);
+    StringifyTo(jsonValue, format, indent);
+    return jsonValue;
+}
+
+void amf::JSONParserImpl::ArrayImpl::StringifyTo(std::string& target, const OutputFormatDesc& format, int indent) const
+{
+    bool first = true;
+    InsertTabs(target, indent, format);
+
+    target += '[';
     bool newLineBeforeClosingBrace = false;
     for (ElementVector::const_iterator it = m_Elements.begin(); it != m_Elements.end(); ++it)
     {
         if (first == false)
         {
-            jsonValue += ',';
+            target += ',';
         }
         else
         {
@@ -753,25 +899,21 @@ std::string amf::JSONParserImpl::ArrayImpl::StringifyFormatted(const OutputForma
         }
         if (format.bHumanReadable == true)
         {
-            amf::JSONParserImpl::Node::Ptr node(*it);
-            if (node != nullptr)
+            if (IsNode(*it) == true)
             {
-                jsonValue += '\n';
+                target += '\n';
                 newLineBeforeClosingBrace = true;
             }
         }
-        jsonValue += *it == nullptr ? "null" : (*it)->StringifyFormatted(format, indent + 1);
+        StringifyElement(target, *it, format, indent + 1);
     }
     if (format.bHumanReadable == true && newLineBeforeClosingBrace == true)
     {
-        jsonValue += '\n';
+        target += '\n';
     }
-    InsertTabs(jsonValue, indent, format);
-    
-    jsonValue += ']';
-
-    return jsonValue;
+    InsertTabs(target, indent, format);
 
+    target += ']';
 }
 
 size_t amf::JSONParserImpl::ArrayImpl::GetElementCount() const
@@ -792,39 +934,41 @@ amf::JSONParserImpl::JSONParserImpl() :
 
 amf::JSONParser::Result amf::JSONParserImpl::Parse(const std::string& str, amf::JSONParser::Node** root)
 {
-    amf::JSONParser::Result result = OK;
     if (root == nullptr)
     {
-        result = INVALID_ARG;
+        return INVALID_ARG;
     }
-    else
+    NodeImpl* pRoot = new NodeImpl();
+    Node::Ptr rootNode(pRoot);
+    DOMBuilder builder(pRoot);
+    Result result = Parse(str, &builder);
+    if (result == OK)
     {
-        amf::JSONParser::Node* rootNode(nullptr);
-        size_t start = str.find_first_of('{'); 
-        size_t end = str.find_last_of('}', str.length());
-        if (start != str.npos && end != str.npos)
-        {
-            rootNode = new NodeImpl();
-            Error parseErr = rootNode->Parse(str, start, end);
-            if (parseErr.GetResult() != OK)
-            {
-                result = parseErr.GetResult();
-                m_LastErrorOfs = parseErr.GetOffset();
-            }
-            else
-            {
-                *root = rootNode;
-                (*root)->Acquire();
-            }
-        }
-        else
-        {
-            result = MISSING_BRACE;
-        }
+        *root = rootNode.Detach();
     }
     return result;
 }
-    
+
+amf::JSONParser::Result amf::JSONParserImpl::Parse(const std::string& str, Handler* handler)
+{
+    if (handler == nullptr)
+    {
+        return INVALID_ARG;
+    }
+    size_t start = str.find_first_of('{');
+    if (start == str.npos)
+    {
+        return MISSING_BRACE;
+    }
+    Reader reader(str, start, str.length(), handler);
+    Error parseErr = reader.ParseValue();
+    if (parseErr.GetResult() != OK)
+    {
+        m_LastErrorOfs = parseErr.GetOffset();
+    }
+    return parseErr.GetResult();
+}
+
 std::string amf::JSONParserImpl::Stringify(const JSONParser::Node* root) const
 {
     return StringifyFormatted(root, defaultFormat, 0);
@@ -835,7 +979,8 @@ std::string amf::JSONParserImpl::StringifyFormatted(const Node* root, const Outp
     std::string jsonStr;
     if (root != nullptr)
     {
-        jsonStr = root->StringifyFormatted(format, indent);
+        jsonStr.reserve(STRINGIFY_RESERVE);
+        ElementHelper::StringifyElement(jsonStr, root, format, indent);
     }
     return jsonStr;
 }
@@ -47,16 +47,54 @@ namespace amf
         public AMFInterfaceImpl<JSONParser>
     {
     public:
+        //-----------------------------------------------------------------------------------------
+        // receives the document from Parse(str, handler) in order, without building a DOM
+        // string values and names are passed as they appear between the quotes, literals are
+        // numbers, true, false and null; returning anything but OK stops parsing with that result
+        class Handler
+        {
+        public:
+            virtual ~Handler() {}
+
+            virtual JSONParser::Result OnBeginNode() = 0;
+            virtual JSONParser::Result OnEndNode() = 0;
+            virtual JSONParser::Result OnBeginArray() = 0;
+            virtual JSONParser::Result OnEndArray() = 0;
+            virtual JSONParser::Result OnName(const char* name, size_t length) = 0;
+            virtual JSONParser::Result OnString(const char* value, size_t length) = 0;
+            virtual JSONParser::Result OnLiteral(const char* value, size_t length) = 0;
+        };
         //-----------------------------------------------------------------------------------------
         class ElementHelper
         {
+        public:
+            // answered by QueryInterface() of the elements below
+            AMF_DECLARE_IID(0x5b0e6a3c, 0x2f7d, 0x4c1e, 0x9a, 0x84, 0x3d, 0x6f, 0x1e, 0x27, 0xc0, 0xb9)
+
+            enum ELEMENT_TYPE
+            {
+                ET_Value,
+                ET_Node,
+                ET_Array,
+            };
+
+            ELEMENT_TYPE GetElementType() const { return m_eElementType; }
+
+            // appends the element to target, StringifyFormatted() without the intermediate strings
+            virtual void StringifyTo(std::string& target, const OutputFormatDesc& format, int indent) const = 0;
+            static void StringifyElement(std::string& target, const JSONParser::Element* element, const OutputFormatDesc& format, int indent);
+
         protected:
-            ElementHelper();
+            ElementHelper(ELEMENT_TYPE eType);
+            virtual ~ElementHelper() {}
 
-            Error CreateElement(const std::string& str, size_t start, size_t& valueStart, size_t& valueEnd, JSONParser::Element** val);
-            size_t FindClosure(const std::string& str, char opener, char closer, size_t start);
+            static const ElementHelper* GetHelper(const JSONParser::Element* element);
+            static bool IsValue(const JSONParser::Element* element);
+            static bool IsNode(const JSONParser::Element* element);
             void InsertTabs(std::string& target, int count, const OutputFormatDesc& format) const;
-        protected:
+
+        private:
+            ELEMENT_TYPE m_eElementType;
         };
         //-----------------------------------------------------------------------------------------
         class ValueImpl : 
@@ -68,6 +106,7 @@ namespace amf
 
             AMF_BEGIN_INTERFACE_MAP
                 AMF_INTERFACE_ENTRY(JSONParser::Element)
+                AMF_INTERFACE_ENTRY(ElementHelper)
                 AMF_INTERFACE_ENTRY(JSONParser::Value)
             AMF_END_INTERFACE_MAP
 
@@ -75,6 +114,10 @@ namespace amf
             virtual JSONParser::Error Parse(const std::string& str, size_t start, size_t end) override;
             virtual std::string Stringify() const override;
             virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const override;
+            virtual void StringifyTo(std::string& target, const OutputFormatDesc& format, int indent) const override;
+
+            // takes a parsed string or literal as is
+            void                        SetParsedValue(const char* value, size_t length, bool bString);
 
             virtual void                SetValue(const std::string& val) override;
             virtual void                SetValueAsInt32(int32_t val) override;
@@ -120,6 +163,7 @@ namespace amf
 
             AMF_BEGIN_INTERFACE_MAP
                 AMF_INTERFACE_ENTRY(JSONParser::Element)
+                AMF_INTERFACE_ENTRY(ElementHelper)
                 AMF_INTERFACE_ENTRY(JSONParser::Node)
             AMF_END_INTERFACE_MAP
 
@@ -128,7 +172,8 @@ namespace amf
             virtual JSONParser::Error Parse(const std::string& str, size_t start, size_t end) override;
             virtual std::string Stringify() const override;
             virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const override;
-            
+            virtual void StringifyTo(std::string& target, const OutputFormatDesc& format, int indent) const override;
+
 
             virtual size_t GetElementCount() const override;
             virtual JSONParser::Element* GetElementByName(const std::string& name) const override;
@@ -150,6 +195,7 @@ namespace amf
 
             AMF_BEGIN_INTERFACE_MAP
                 AMF_INTERFACE_ENTRY(JSONParser::Element)
+                AMF_INTERFACE_ENTRY(ElementHelper)
                 AMF_INTERFACE_ENTRY(JSONParser::Array)
             AMF_END_INTERFACE_MAP
 
@@ -158,6 +204,7 @@ namespace amf
             virtual JSONParser::Error Parse(const std::string& str, size_t start, size_t end) override;
             virtual std::string Stringify() const override;
             virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const override;
+            virtual void StringifyTo(std::string& target, const OutputFormatDesc& format, int indent) const override;
 
             virtual size_t GetElementCount() const override;
             virtual JSONParser::Element* GetElementAt(size_t idx) const override;
@@ -170,6 +217,7 @@ namespace amf
         JSONParserImpl();
 
         virtual JSONParser::Result Parse(const std::string& str, Node** root);
+        JSONParser::Result Parse(const std::string& str, Handler* handler);    //  Parse a JSON string into handler events
         virtual std::string Stringify(const Node* root) const;
         virtual std::string StringifyFormatted(const Node* root, const OutputFormatDesc& format, int indent) const;
 
@@ -180,6 +228,9 @@ namespace amf
         virtual Result CreateArray(Array** array) const;
 
     private:
+        class Reader;
+        class DOMBuilder;
+
         size_t              m_LastErrorOfs;
     };
 }
@@ -183,6 +183,47 @@ bool AMF_STD_CALL amf_leave_critical_section(amf_handle cs)
     return pthread_mutex_unlock(mutex) == 0;
 }
 //----------------------------------------------------------------------------------------
+// Timed waits use absolute deadlines on CLOCK_MONOTONIC so that wall-clock steps (NTP, manual
+// date changes) neither stall nor cut short a wait. macOS condition variables and semaphores only
+// accept CLOCK_REALTIME deadlines, so it keeps the wall clock.
+#if defined(__APPLE__)
+#define AMF_WAIT_CLOCK CLOCK_REALTIME
+#else
+#define AMF_WAIT_CLOCK CLOCK_MONOTONIC
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+#define AMF_HAS_CLOCKWAIT 1 // sem_clockwait / pthread_mutex_clocklock
+#endif
+//----------------------------------------------------------------------------------------
+static void amf_get_deadline_us(clockid_t clock, amf_uint64 timeoutUs, timespec* deadline)
+{
+    // keep the full nanosecond resolution of the clock
+    clock_gettime(clock, deadline);
+    deadline->tv_sec += (time_t)(timeoutUs / 1000000);
+    deadline->tv_nsec += (long)(timeoutUs % 1000000) * 1000L;
+    if(deadline->tv_nsec >= 1000000000L)
+    {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+//----------------------------------------------------------------------------------------
+static void amf_get_deadline(clockid_t clock, amf_ulong timeout, timespec* deadline)
+{
+    // timeout is in milliseconds
+    amf_get_deadline_us(clock, (amf_uint64)timeout * 1000, deadline);
+}
+//----------------------------------------------------------------------------------------
+#if defined(__ANDROID__) || defined(__APPLE__)
+static bool amf_deadline_expired(const timespec* deadline)
+{
+    timespec now;
+    clock_gettime(AMF_WAIT_CLOCK, &now);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+#endif
+//----------------------------------------------------------------------------------------
 struct MyEvent
 {
     bool m_manual_reset;
@@ -206,8 +247,13 @@ amf_handle AMF_STD_CALL amf_create_event(bool initially_owned, bool manual_reset
         exit(1);
     }
     event->m_manual_reset = manual_reset;
-    pthread_cond_t cond_tmp = PTHREAD_COND_INITIALIZER;
-    event->m_cond = cond_tmp;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attr, AMF_WAIT_CLOCK);
+#endif
+    pthread_cond_init(&event->m_cond, &attr);
+    pthread_condattr_destroy(&attr);
     pthread_mutex_t mutex_tmp = PTHREAD_MUTEX_INITIALIZER;
     event->m_mutex = mutex_tmp;
 
@@ -262,80 +308,46 @@ bool AMF_STD_CALL amf_reset_event(amf_handle hevent)
     return err == 0;
 }
 //----------------------------------------------------------------------------------------
-static bool AMF_STD_CALL amf_wait_for_event_int(amf_handle hevent, unsigned long timeout, bool bTimeoutErr)
+#define AMF_INFINITE_US (~amf_uint64(0))
+//----------------------------------------------------------------------------------------
+static bool AMF_STD_CALL amf_wait_for_event_int(amf_handle hevent, amf_uint64 timeoutUs, bool bTimeoutErr)
 {
     if(hevent == NULL)
     {
         return false;
     }
     bool ret = true;
-    int err = 0;
     MyEvent* event = (MyEvent*)hevent;
-    pthread_mutex_lock(&event->m_mutex);
 
-    timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    amf_uint64 start_time = ((amf_uint64)ts.tv_sec) * 1000 + ((amf_uint64)ts.tv_nsec) / 1000000; //to msec
-
-    if(event->m_manual_reset)
+    timespec deadline;
+    if(timeoutUs != AMF_INFINITE_US)
     {
-        while(!event->m_triggered)
-        {
-            if(timeout == AMF_INFINITE)
-            {
-                err = pthread_cond_wait(&event->m_cond, &event->m_mutex);          //MM todo - timeout is not supported
-                ret = err == 0;
-            }
-            else
-            {
-                clock_gettime(CLOCK_REALTIME, &ts);
-                amf_uint64 current_time = ((amf_uint64)ts.tv_sec) * 1000 + ((amf_uint64)ts.tv_nsec) / 1000000; //to msec
-                if(current_time - start_time > (amf_uint64)timeout)
-                {
-                    ret = bTimeoutErr ? false : true;
-                    break;
-                }
-                amf_uint64 to_wait = start_time + timeout;
-
-                timespec abstime;
-                abstime.tv_sec = (time_t)(to_wait / 1000); // timeout is in millisec
-                abstime.tv_nsec = (time_t)((to_wait - ((amf_uint64)abstime.tv_sec) * 1000) * 1000000); // the rest to nanosec
-
-                err = pthread_cond_timedwait(&event->m_cond, &event->m_mutex, &abstime);
-                ret = err == 0;
-            }
-        }
+        amf_get_deadline_us(AMF_WAIT_CLOCK, timeoutUs, &deadline);
     }
-    else
-    {
-        if(event->m_triggered)
-        {
-            ret = true;
-        }
-        else
-        {
-            if (timeout == AMF_INFINITE) {
-                err = pthread_cond_wait(&event->m_cond, &event->m_mutex);
-            } else {
-                start_time += timeout;
-                timespec abstime;
-                abstime.tv_sec = (time_t) (start_time / 1000); // timeout is in millisec
-                abstime.tv_nsec = (time_t) ((start_time - (amf_uint64) (abstime.tv_sec) * 1000) *
-                                            1000000); // the rest to nanosec
-                err = pthread_cond_timedwait(&event->m_cond, &event->m_mutex, &abstime);
-            }
 
-            if (bTimeoutErr) {
-                ret = (err == 0);
-            } else {
-                ret = (err == 0 || err == ETIMEDOUT);
-            }
+    pthread_mutex_lock(&event->m_mutex);
+    // loop on the predicate: the condition variable may wake spuriously, and an auto-reset
+    // event may have been consumed by another waiter before this one reacquired the mutex
+    while(!event->m_triggered)
+    {
+        int err = timeoutUs == AMF_INFINITE_US ?
+            pthread_cond_wait(&event->m_cond, &event->m_mutex) :
+            pthread_cond_timedwait(&event->m_cond, &event->m_mutex, &deadline);
+        if(err == ETIMEDOUT)
+        {
+            ret = bTimeoutErr ? false : true;
+            break;
         }
-        if(ret == true)
+        if(err != 0)
         {
-            event->m_triggered = false;
+            ret = false;
+            break;
         }
     }
+    if(!event->m_manual_reset && ret == true)
+    {
+        event->m_triggered = false;
+    }
     pthread_mutex_unlock(&event->m_mutex);
 
     return ret;
@@ -343,12 +355,17 @@ static bool AMF_STD_CALL amf_wait_for_event_int(amf_handle hevent, unsigned long
 //----------------------------------------------------------------------------------------
 bool AMF_STD_CALL amf_wait_for_event(amf_handle hevent, unsigned long timeout)
 {
-    return amf_wait_for_event_int(hevent, timeout, true);
+    return amf_wait_for_event_int(hevent, timeout == AMF_INFINITE ? AMF_INFINITE_US : (amf_uint64)timeout * 1000, true);
 }
 //----------------------------------------------------------------------------------------
 bool AMF_STD_CALL amf_wait_for_event_timeout(amf_handle hevent, amf_ulong ulTimeout)
 {
-    return amf_wait_for_event_int(hevent, ulTimeout, false);
+    return amf_wait_for_event_int(hevent, ulTimeout == AMF_INFINITE ? AMF_INFINITE_US : (amf_uint64)ulTimeout * 1000, false);
+}
+//----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_wait_for_event_timeout_us(amf_handle hevent, amf_uint64 ulTimeoutUs)
+{
+    return amf_wait_for_event_int(hevent, ulTimeoutUs, false);
 }
 //----------------------------------------------------------------------------------------
 amf_handle AMF_STD_CALL amf_create_mutex(bool initially_owned, const wchar_t* name)
@@ -389,21 +406,19 @@ bool AMF_STD_CALL amf_delete_mutex(amf_handle hmutex)
 //----------------------------------------------------------------------------------------
 
 #if defined(__APPLE__)
+// macOS has no sem_timedwait(); poll until the deadline
 int sem_timedwait1(sem_t* semaphore, const struct timespec* timeout)
 {
-    struct timeval timenow;
     struct timespec sleepytime;
     int retcode;
-    
+
     /// This is just to avoid a completely busy wait
     sleepytime.tv_sec = 0;
-    sleepytime.tv_nsec = 10000000; // 10ms
+    sleepytime.tv_nsec = 100000; // 100us
 
     while((retcode = sem_trywait(semaphore)) != 0)
     {
-        gettimeofday (&timenow, NULL);
-        
-        if((timenow.tv_sec >= timeout->tv_sec) && ((timenow.tv_usec * 1000) >= timeout->tv_nsec))
+        if(amf_deadline_expired(timeout))
         {
             return retcode;
         }
@@ -413,22 +428,20 @@ int sem_timedwait1(sem_t* semaphore, const struct timespec* timeout)
 }
 #endif
 
-#if defined(__ANDROID__) || defined(__APPLE__)
+#if defined(__APPLE__) || (defined(__ANDROID__) && __ANDROID_API__ < 28)
+// no pthread_mutex_timedlock() on macOS, and no monotonic variant before Android P; poll until the deadline
 int pthread_mutex_timedlock1(pthread_mutex_t* mutex, const struct timespec* timeout)
 {
-    struct timeval timenow;
     struct timespec sleepytime;
     int retcode;
 
     /// This is just to avoid a completely busy wait
     sleepytime.tv_sec = 0;
-    sleepytime.tv_nsec = 10000000; // 10ms
+    sleepytime.tv_nsec = 100000; // 100us
 
     while((retcode = pthread_mutex_trylock (mutex)) == EBUSY)
     {
-        gettimeofday (&timenow, NULL);
-
-        if((timenow.tv_sec >= timeout->tv_sec) && ((timenow.tv_usec * 1000) >= timeout->tv_nsec))
+        if(amf_deadline_expired(timeout))
         {
             return ETIMEDOUT;
         }
@@ -451,25 +464,21 @@ bool AMF_STD_CALL amf_wait_for_mutex(amf_handle hmutex, unsigned long timeout)
         return pthread_mutex_lock(mutex) == 0;
     }
 
-    // ulTimeout is in milliseconds
-    long timeout_sec = timeout / 1000;      /* Seconds */;
-    long timeout_nsec = (timeout - (timeout / 1000) * 1000) * 1000000;
-
+#if defined(AMF_HAS_CLOCKWAIT)
     timespec wait_time; //absolute time
-    clock_gettime(CLOCK_REALTIME, &wait_time);
-
-    wait_time.tv_sec += timeout_sec;
-    wait_time.tv_nsec += timeout_nsec;
-
-    if (wait_time.tv_nsec >= 1000000000)
-    {
-        wait_time.tv_sec++;
-        wait_time.tv_nsec -= 1000000000;
-    }
-
-#if defined(__ANDROID__) || defined (__APPLE__)
+    amf_get_deadline(CLOCK_MONOTONIC, timeout, &wait_time);
+    return pthread_mutex_clocklock(mutex, CLOCK_MONOTONIC, &wait_time) == 0;
+#elif defined(__ANDROID__) && __ANDROID_API__ >= 28
+    timespec wait_time; //absolute time
+    amf_get_deadline(CLOCK_MONOTONIC, timeout, &wait_time);
+    return pthread_mutex_timedlock_monotonic_np(mutex, &wait_time) == 0;
+#elif defined(__ANDROID__) || defined (__APPLE__)
+    timespec wait_time; //absolute time
+    amf_get_deadline(AMF_WAIT_CLOCK, timeout, &wait_time);
     return pthread_mutex_timedlock1(mutex, &wait_time) == 0;
 #else
+    timespec wait_time; //absolute time
+    amf_get_deadline(CLOCK_REALTIME, timeout, &wait_time);
     return pthread_mutex_timedlock(mutex, &wait_time) == 0;
 #endif
 }
@@ -554,28 +563,21 @@ bool AMF_STD_CALL amf_wait_for_semaphore(amf_handle hsemaphore, amf_ulong timeou
         return true;
     }
 
-    // ulTimeout is in milliseconds
-    long timeout_sec = timeout / 1000;      /* Seconds */;
-    long timeout_nsec = (timeout - (timeout / 1000) * 1000) * 1000000;
-
-    timespec wait_time; //absolute time
-    clock_gettime(CLOCK_REALTIME, &wait_time);
-
-    wait_time.tv_sec += timeout_sec;
-    wait_time.tv_nsec += timeout_nsec;
-
-    if (wait_time.tv_nsec >= 1000000000)
-    {
-        wait_time.tv_sec++;
-        wait_time.tv_nsec -= 1000000000;
-    }
-
     amf_linux_semaphore* semaphore = (amf_linux_semaphore*)hsemaphore;
     if(timeout != AMF_INFINITE)
     {
-    #if defined(__APPLE__)
-        return sem_timedwait1 (semaphore->s, &wait_time) == 0; // errno=ETIMEDOU
+        timespec wait_time; //absolute time
+    #if defined(AMF_HAS_CLOCKWAIT)
+        amf_get_deadline(CLOCK_MONOTONIC, timeout, &wait_time);
+        return sem_clockwait (semaphore->s, CLOCK_MONOTONIC, &wait_time) == 0; // errno=ETIMEDOUT
+    #elif defined(__ANDROID__) && __ANDROID_API__ >= 28
+        amf_get_deadline(CLOCK_MONOTONIC, timeout, &wait_time);
+        return sem_timedwait_monotonic_np (semaphore->s, &wait_time) == 0; // errno=ETIMEDOUT
+    #elif defined(__APPLE__)
+        amf_get_deadline(CLOCK_REALTIME, timeout, &wait_time);
+        return sem_timedwait1 (semaphore->s, &wait_time) == 0; // errno=ETIMEDOUT
     #else
+        amf_get_deadline(CLOCK_REALTIME, timeout, &wait_time);
         return sem_timedwait (semaphore->s, &wait_time) == 0; // errno=ETIMEDOUT
     #endif
     }
@@ -770,6 +772,13 @@ amf_pts AMF_STD_CALL amf_high_precision_clock()
     return ts.tv_sec * 10000000LL + ts.tv_nsec / 100.; //to nanosec
 }
 //---------------------------------------------------------------------------------------
+amf_pts AMF_STD_CALL amf_monotonic_clock()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 10000000LL + ts.tv_nsec / 100;
+}
+//---------------------------------------------------------------------------------------
 // Returns number of physical cores
 amf_int32 AMF_STD_CALL amf_get_cpu_cores()
 {
@@ -0,0 +1,287 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+///-------------------------------------------------------------------------
+///  @file   PropertyKey.h
+///  @brief  interned property names and the per-storage index built on them
+///-------------------------------------------------------------------------
+#ifndef AMF_PropertyKey_h
+#define AMF_PropertyKey_h
+#pragma once
+
+#include "../include/core/Platform.h"
+#include "AMFSTL.h"
+#include "Thread.h"
+#include <atomic>
+
+namespace amf
+{
+    //---------------------------------------------------------------------------------------------
+    // An interned property name. Each distinct name is stored once for the lifetime of the module,
+    // so keys compare by pointer and carry a precomputed hash. Resolve constant names once with
+    // AMFInternPropertyKey() and pass the key to the key overloads of the storage implementations
+    // to skip hashing and string compares on hot paths.
+    //---------------------------------------------------------------------------------------------
+    struct AMFPropertyKeyEntry
+    {
+        const wchar_t*  name;
+        amf_size        length;
+        amf_uint32      hash;
+    };
+    typedef const AMFPropertyKeyEntry* AMFPropertyKey;
+
+    //---------------------------------------------------------------------------------------------
+    inline amf_uint32 AMFHashPropertyName(const wchar_t* name, amf_size* pLength)
+    {
+        // FNV-1a over the UTF-16/32 code units
+        amf_uint32 hash = 2166136261u;
+        const wchar_t* p = name;
+        for (; *p != 0; p++)
+        {
+            hash = (hash ^ amf_uint32(*p)) * 16777619u;
+        }
+        *pLength = amf_size(p - name);
+        return hash;
+    }
+    //---------------------------------------------------------------------------------------------
+    // Fixed open-addressing table that never rehashes or removes, so lookups run lock-free while
+    // new names are published with release stores under the lock. Names beyond the capacity are
+    // not interned and callers fall back to their string keyed path.
+    //---------------------------------------------------------------------------------------------
+    class AMFPropertyKeyRegistry
+    {
+    public:
+        static AMFPropertyKeyRegistry& Instance()
+        {
+            static AMFPropertyKeyRegistry s_Registry;
+            return s_Registry;
+        }
+        //-----------------------------------------------------------------------------------------
+        // never allocates; NULL when the name was not interned yet
+        AMFPropertyKey Find(const wchar_t* name) const
+        {
+            amf_size length = 0;
+            const amf_uint32 hash = AMFHashPropertyName(name, &length);
+            return Find(name, length, hash);
+        }
+        //-----------------------------------------------------------------------------------------
+        // allocates only the first time a name is seen
+        AMFPropertyKey Intern(const wchar_t* name)
+        {
+            amf_size length = 0;
+            const amf_uint32 hash = AMFHashPropertyName(name, &length);
+            AMFPropertyKey key = Find(name, length, hash);
+            if (key != NULL)
+            {
+                return key;
+            }
+
+            AMFLock lock(&m_Sync);
+            if (m_iCount >= MAX_KEYS)
+            {
+                return NULL;
+            }
+            for (amf_size slot = hash & (CAPACITY - 1); ; slot = (slot + 1) & (CAPACITY - 1))
+            {
+                key = m_Slots[slot].load(std::memory_order_acquire);
+                if (key == NULL)
+                {
+                    wchar_t* pName = new wchar_t[length + 1];
+                    memcpy(pName, name, (length + 1) * sizeof(wchar_t));
+                    AMFPropertyKeyEntry* pEntry = new AMFPropertyKeyEntry;
+                    pEntry->name = pName;
+                    pEntry->length = length;
+                    pEntry->hash = hash;
+                    m_Slots[slot].store(pEntry, std::memory_order_release);
+                    m_iCount++;
+                    return pEntry;
+                }
+                if (Equals(key, name, length, hash))
+                {
+                    return key; // interned by another thread meanwhile
+                }
+            }
+        }
+        //-----------------------------------------------------------------------------------------
+    private:
+        static const amf_size CAPACITY = 16384;         // power of two
+        static const amf_size MAX_KEYS = CAPACITY / 2;  // keeps probe sequences short
+
+        AMFPropertyKeyRegistry() : m_iCount(0)
+        {
+            for (amf_size i = 0; i < CAPACITY; i++)
+            {
+                m_Slots[i].store(NULL, std::memory_order_relaxed);
+            }
+        }
+        // entries are intentionally leaked - keys stay valid until the module unloads
+
+        static bool Equals(AMFPropertyKey key, const wchar_t* name, amf_size length, amf_uint32 hash)
+        {
+            return key->hash == hash && key->length == length && memcmp(key->name, name, length * sizeof(wchar_t)) == 0;
+        }
+
+        AMFPropertyKey Find(const wchar_t* name, amf_size length, amf_uint32 hash) const
+        {
+            for (amf_size slot = hash & (CAPACITY - 1); ; slot = (slot + 1) & (CAPACITY - 1))
+            {
+                AMFPropertyKey key = m_Slots[slot].load(std::memory_order_acquire);
+                if (key == NULL)
+                {
+                    return NULL;
+                }
+                if (Equals(key, name, length, hash))
+                {
+                    return key;
+                }
+            }
+        }
+
+        std::atomic<AMFPropertyKey> m_Slots[CAPACITY];
+        amf_size                    m_iCount;
+        AMFCriticalSection          m_Sync;
+
+        AMFPropertyKeyRegistry(const AMFPropertyKeyRegistry&);
+        AMFPropertyKeyRegistry& operator=(const AMFPropertyKeyRegistry&);
+    };
+    //---------------------------------------------------------------------------------------------
+    inline AMFPropertyKey AMFInternPropertyKey(const wchar_t* name)
+    {
+        return name != NULL ? AMFPropertyKeyRegistry::Instance().Intern(name) : NULL;
+    }
+    //---------------------------------------------------------------------------------------------
+    inline AMFPropertyKey AMFFindPropertyKey(const wchar_t* name)
+    {
+        return name != NULL ? AMFPropertyKeyRegistry::Instance().Find(name) : NULL;
+    }
+    //---------------------------------------------------------------------------------------------
+    // Per-storage open-addressing index from interned keys to values owned elsewhere (the
+    // storage maps, whose nodes never move). Not thread-safe - the owner serializes writes.
+    //---------------------------------------------------------------------------------------------
+    template<typename _T>
+    class AMFPropertyKeyIndex
+    {
+    public:
+        AMFPropertyKeyIndex() : m_Slots(), m_iCount(0)
+        {
+        }
+        //-----------------------------------------------------------------------------------------
+        _T* Find(AMFPropertyKey key) const
+        {
+            if (key == NULL || m_Slots.empty())
+            {
+                return NULL;
+            }
+            const amf_size mask = m_Slots.size() - 1;
+            for (amf_size slot = key->hash & mask; ; slot = (slot + 1) & mask)
+            {
+                const Slot& s = m_Slots[slot];
+                if (s.key == key)
+                {
+                    return s.pValue;
+                }
+                if (s.key == NULL)
+                {
+                    return NULL;
+                }
+            }
+        }
+        //-----------------------------------------------------------------------------------------
+        void Insert(AMFPropertyKey key, _T* pValue)
+        {
+            if (key == NULL)
+            {
+                return;
+            }
+            if ((m_iCount + 1) * 2 > m_Slots.size())
+            {
+                Grow();
+            }
+            Place(key, pValue);
+        }
+        //-----------------------------------------------------------------------------------------
+        void Clear()
+        {
+            m_Slots.clear();
+            m_iCount = 0;
+        }
+        //-----------------------------------------------------------------------------------------
+    private:
+        struct Slot
+        {
+            AMFPropertyKey  key;
+            _T*             pValue;
+        };
+
+        void Place(AMFPropertyKey key, _T* pValue)
+        {
+            const amf_size mask = m_Slots.size() - 1;
+            for (amf_size slot = key->hash & mask; ; slot = (slot + 1) & mask)
+            {
+                Slot& s = m_Slots[slot];
+                if (s.key == key)
+                {
+                    s.pValue = pValue;
+                    return;
+                }
+                if (s.key == NULL)
+                {
+                    s.key = key;
+                    s.pValue = pValue;
+                    m_iCount++;
+                    return;
+                }
+            }
+        }
+
+        void Grow()
+        {
+            amf_vector<Slot> slots;
+            slots.swap(m_Slots);
+            const Slot empty = { NULL, NULL };
+            m_Slots.resize(slots.empty() ? 16 : slots.size() * 2, empty);
+            m_iCount = 0;
+            for (amf_size i = 0; i < slots.size(); i++)
+            {
+                if (slots[i].key != NULL)
+                {
+                    Place(slots[i].key, slots[i].pValue);
+                }
+            }
+        }
+
+        amf_vector<Slot>    m_Slots;
+        amf_size            m_iCount;
+    };
+    //---------------------------------------------------------------------------------------------
+} // namespace amf
+
+#endif // AMF_PropertyKey_h
@@ -43,6 +43,7 @@
 #include "InterfaceImpl.h"
 #include "ObservableImpl.h"
 #include "TraceAdapter.h"
+#include "PropertyKey.h"
 #include <limits.h>
 #include <float.h>
 #include <memory>
@@ -96,6 +97,9 @@ namespace amf
     protected:
         PropertyInfoMap         m_PropertiesInfo;
         AMFCriticalSection      m_Sync; //thread-safety lock.
+        // interned name -> m_PropertiesInfo node, filled by RegisterPropertyInfo();
+        // entries must not be erased from m_PropertiesInfo
+        AMFPropertyKeyIndex<std::shared_ptr<AMFPropertyInfoImpl> > m_PropertiesIndex;
 
     public:
         AMFPropertyStorageExImpl()
@@ -258,10 +262,10 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(name);
             AMF_RETURN_IF_INVALID_POINTER(ppParamInfo);
 
-            PropertyInfoMap::const_iterator it = m_PropertiesInfo.find(name);
-            if (it != m_PropertiesInfo.end())
+            AMFPropertyInfoImpl* pInfo = FindPropertyInfo(name);
+            if (pInfo != NULL)
             {
-                *ppParamInfo = it->second.get();
+                *ppParamInfo = pInfo;
                 return AMF_OK;
             }
 
@@ -390,15 +394,15 @@ namespace amf
         {
             AMF_RETURN_IF_INVALID_POINTER(name);
 
-            PropertyInfoMap::iterator found = m_PropertiesInfo.find(name);
-            AMF_RETURN_IF_FALSE(found != m_PropertiesInfo.end(), AMF_NOT_FOUND);
+            AMFPropertyInfoImpl* pInfo = FindPropertyInfo(name);
+            AMF_RETURN_IF_FALSE(pInfo != NULL, AMF_NOT_FOUND);
 
-            if (found->second->accessType == accessType)
+            if (pInfo->accessType == accessType)
             {
                 return AMF_OK;
             }
 
-            found->second->accessType = accessType;
+            pInfo->accessType = accessType;
             OnPropertyChanged(name);
             NotifyObservers<const wchar_t*>(&AMFPropertyStorageObserver::OnPropertyChanged, name);
             return AMF_OK;
@@ -415,21 +419,21 @@ namespace amf
                 return validateResult;
             }
 
-            PropertyInfoMap::iterator found = m_PropertiesInfo.find(name);
-            if (found == m_PropertiesInfo.end())
+            AMFPropertyInfoImpl* pInfo = FindPropertyInfo(name);
+            if (pInfo == NULL)
             {
                 return AMF_NOT_FOUND;
             }
             {
                 AMFLock lock(&m_Sync);
 
-                if (found->second->value == validatedValue)
+                if (pInfo->value == validatedValue)
                 {
                     return AMF_OK;
                 }
-                found->second->value = validatedValue;
+                pInfo->value = validatedValue;
             }
-            found->second->OnPropertyChanged();
+            pInfo->OnPropertyChanged();
             OnPropertyChanged(name);
             NotifyObservers<const wchar_t*>(&AMFPropertyStorageObserver::OnPropertyChanged, name);
             return AMF_OK;
@@ -441,11 +445,11 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(pValue);
 
 
-            PropertyInfoMap::const_iterator found = m_PropertiesInfo.find(name);
-            if (found != m_PropertiesInfo.end())
+            const AMFPropertyInfoImpl* pInfo = FindPropertyInfo(name);
+            if (pInfo != NULL)
             {
                 AMFLock lock(const_cast<AMFCriticalSection*>(&m_Sync));
-                AMFVariantCopy(pValue, &found->second->value);
+                AMFVariantCopy(pValue, &pInfo->value);
                 return AMF_OK;
             }
 
@@ -483,13 +487,46 @@ namespace amf
         //-------------------------------------------------------------------------------------------------
         bool HasPrivateProperty(const wchar_t* name) const
         {
-            return m_PropertiesInfo.find(name) != m_PropertiesInfo.end();
+            return FindPropertyInfo(name) != NULL;
         }
         //-------------------------------------------------------------------------------------------------
         bool  IsRuntimeChange(const wchar_t* name) const
         {
+            const AMFPropertyInfoImpl* pInfo = FindPropertyInfo(name);
+            return (pInfo != NULL) ? pInfo->AllowedChangeInRuntime() : false;
+        }
+        //-------------------------------------------------------------------------------------------------
+        // adds or replaces a property description, used by AMFPrimitivePropertyInfoMapEnd
+        void  RegisterPropertyInfo(AMFPropertyInfoImpl* pPropInfo)
+        {
+            std::shared_ptr<AMFPropertyInfoImpl>& info = m_PropertiesInfo[pPropInfo->name];
+            info.reset(pPropInfo);
+            m_PropertiesIndex.Insert(AMFInternPropertyKey(pPropInfo->name), &info);
+        }
+        //-------------------------------------------------------------------------------------------------
+        AMFPropertyInfoImpl* FindPropertyInfo(AMFPropertyKey key) const
+        {
+            std::shared_ptr<AMFPropertyInfoImpl>* pInfo = m_PropertiesIndex.Find(key);
+            if (pInfo != NULL)
+            {
+                return pInfo->get();
+            }
+            // not registered through RegisterPropertyInfo()
+            PropertyInfoMap::const_iterator it = m_PropertiesInfo.find(key->name);
+            return (it != m_PropertiesInfo.end()) ? it->second.get() : NULL;
+        }
+        //-------------------------------------------------------------------------------------------------
+        AMFPropertyInfoImpl* FindPropertyInfo(const wchar_t* name) const
+        {
+            // allocation free for every registered name; the map walk is left for
+            // names the registry had no room for or that were inserted directly
+            AMFPropertyKey key = AMFFindPropertyKey(name);
+            if (key != NULL)
+            {
+                return FindPropertyInfo(key);
+            }
             PropertyInfoMap::const_iterator it = m_PropertiesInfo.find(name);
-            return (it != m_PropertiesInfo.end()) ? it->second->AllowedChangeInRuntime() : false;
+            return (it != m_PropertiesInfo.end()) ? it->second.get() : NULL;
         }
         //-------------------------------------------------------------------------------------------------
         void  ResetDefaultValues()
@@ -523,8 +560,7 @@ namespace amf
             }; \
             for (amf_size i = 0; i < sizeof(s_PropertiesInfo) / sizeof(s_PropertiesInfo[0]); ++i) \
             { \
-                amf::AMFPropertyInfoImpl* pPropInfo = s_PropertiesInfo[i]; \
-                m_PropertiesInfo[pPropInfo->name].reset(pPropInfo); \
+                RegisterPropertyInfo(s_PropertiesInfo[i]); \
             } \
     }
 
@@ -42,6 +42,7 @@
 #include "InterfaceImpl.h"
 #include "ObservableImpl.h"
 #include "TraceAdapter.h"
+#include "PropertyKey.h"
 
 namespace amf
 {
@@ -52,7 +53,7 @@ namespace amf
     {
     public:
         //-------------------------------------------------------------------------------------------------
-        AMFPropertyStorageImpl() : m_PropertyValues()
+        AMFPropertyStorageImpl() : m_PropertyValues(), m_PropertyIndex()
         {
         }
         //-------------------------------------------------------------------------------------------------
@@ -69,10 +70,7 @@ namespace amf
         {
             AMF_RETURN_IF_INVALID_POINTER(pName);
 
-            m_PropertyValues[pName] = value;
-            OnPropertyChanged(pName);
-            NotifyObservers<const wchar_t*>(&AMFPropertyStorageObserver::OnPropertyChanged, pName);
-            return AMF_OK;
+            return SetProperty(AMFInternPropertyKey(pName), pName, value);
         }
         //-------------------------------------------------------------------------------------------------
         virtual AMF_RESULT  AMF_STD_CALL GetProperty(const wchar_t* pName, AMFVariantStruct* pValue) const override
@@ -80,11 +78,10 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(pName);
             AMF_RETURN_IF_INVALID_POINTER(pValue);
 
-            amf_wstring name(pName);
-            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.find(name);
-            if(found != m_PropertyValues.end())
+            const AMFVariant* pFound = FindValue(AMFFindPropertyKey(pName), pName);
+            if(pFound != NULL)
             {
-                AMFVariantCopy(pValue, &found->second);
+                AMFVariantCopy(pValue, pFound);
                 return AMF_OK;
             }
             return AMF_NOT_FOUND;
@@ -93,7 +90,51 @@ namespace amf
         virtual bool        AMF_STD_CALL HasProperty(const wchar_t* pName) const override
         {
             AMF_ASSERT(pName != NULL);
-            return m_PropertyValues.find(pName) != m_PropertyValues.end();
+            return FindValue(AMFFindPropertyKey(pName), pName) != NULL;
+        }
+        //-------------------------------------------------------------------------------------------------
+        // pre-resolved key overloads - no hashing, string compares or allocations once the property exists
+        //-------------------------------------------------------------------------------------------------
+        using _TBase::SetProperty;
+        using _TBase::GetProperty;
+        //-------------------------------------------------------------------------------------------------
+        AMF_RESULT          SetProperty(AMFPropertyKey key, AMFVariantStruct value)
+        {
+            AMF_RETURN_IF_INVALID_POINTER(key);
+
+            return SetProperty(key, key->name, value);
+        }
+        //-------------------------------------------------------------------------------------------------
+        AMF_RESULT          GetProperty(AMFPropertyKey key, AMFVariantStruct* pValue) const
+        {
+            AMF_RETURN_IF_INVALID_POINTER(key);
+            AMF_RETURN_IF_INVALID_POINTER(pValue);
+
+            const AMFVariant* pFound = FindValue(key, key->name);
+            if(pFound != NULL)
+            {
+                AMFVariantCopy(pValue, pFound);
+                return AMF_OK;
+            }
+            return AMF_NOT_FOUND;
+        }
+        //-------------------------------------------------------------------------------------------------
+        template<typename _T>
+        AMF_RESULT          SetProperty(AMFPropertyKey key, const _T& value)
+        {
+            return SetProperty(key, static_cast<const AMFVariantStruct&>(AMFVariant(value)));
+        }
+        //-------------------------------------------------------------------------------------------------
+        template<typename _T>
+        AMF_RESULT          GetProperty(AMFPropertyKey key, _T* pValue) const
+        {
+            AMFVariant var;
+            AMF_RESULT err = GetProperty(key, static_cast<AMFVariantStruct*>(&var));
+            if(err == AMF_OK)
+            {
+                *pValue = static_cast<_T>(var);
+            }
+            return err;
         }
         //-------------------------------------------------------------------------------------------------
         virtual amf_size    AMF_STD_CALL GetPropertyCount() const override
@@ -128,6 +169,7 @@ namespace amf
         //-------------------------------------------------------------------------------------------------
         virtual AMF_RESULT  AMF_STD_CALL Clear() override
         {
+            m_PropertyIndex.Clear();
             m_PropertyValues.clear();
             return AMF_OK;
         }
@@ -186,7 +228,34 @@ namespace amf
         //-------------------------------------------------------------------------------------------------
     protected:
         //-------------------------------------------------------------------------------------------------
-        amf_map<amf_wstring, AMFVariant> m_PropertyValues;
+        const AMFVariant* FindValue(AMFPropertyKey key, const wchar_t* pName) const
+        {
+            // every property set with an interned name is indexed, the map walk is
+            // only needed for names the registry had no room for
+            if(key != NULL)
+            {
+                return m_PropertyIndex.Find(key);
+            }
+            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.find(pName);
+            return found != m_PropertyValues.end() ? &found->second : NULL;
+        }
+        //-------------------------------------------------------------------------------------------------
+        AMF_RESULT SetProperty(AMFPropertyKey key, const wchar_t* pName, const AMFVariantStruct& value)
+        {
+            AMFVariant* pFound = m_PropertyIndex.Find(key);
+            if(pFound == NULL)
+            {
+                pFound = &m_PropertyValues[pName];
+                m_PropertyIndex.Insert(key, pFound);
+            }
+            *pFound = value;
+            OnPropertyChanged(pName);
+            NotifyObservers<const wchar_t*>(&AMFPropertyStorageObserver::OnPropertyChanged, pName);
+            return AMF_OK;
+        }
+        //-------------------------------------------------------------------------------------------------
+        amf_map<amf_wstring, AMFVariant>        m_PropertyValues;
+        AMFPropertyKeyIndex<AMFVariant>         m_PropertyIndex;  // interned name -> m_PropertyValues node
     };
     //---------------------------------------------------------------------------------------------
     //---------------------------------------------------------------------------------------------
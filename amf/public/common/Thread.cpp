@@ -67,6 +67,11 @@ namespace amf
         return amf_wait_for_event_timeout(m_hSyncObject, ulTimeout);
     }
     //----------------------------------------------------------------------------
+    bool AMFEvent::LockTimeoutUs(amf_uint64 ulTimeoutUs)
+    {
+        return amf_wait_for_event_timeout_us(m_hSyncObject, ulTimeoutUs);
+    }
+    //----------------------------------------------------------------------------
     bool AMFEvent::Unlock()
     {
         return true;
@@ -35,6 +35,7 @@
 #pragma once
 
 #include <cassert>
+#include <atomic>
 #include <list>
 #include <vector>
 
@@ -66,6 +67,8 @@ extern "C"
     bool        AMF_CDECL_CALL amf_reset_event(amf_handle hevent);
     bool        AMF_CDECL_CALL amf_wait_for_event(amf_handle hevent, amf_ulong ulTimeout);
     bool        AMF_CDECL_CALL amf_wait_for_event_timeout(amf_handle hevent, amf_ulong ulTimeout);
+    // same in microseconds; Windows waits are rounded up to whole milliseconds
+    bool        AMF_CDECL_CALL amf_wait_for_event_timeout_us(amf_handle hevent, amf_uint64 ulTimeoutUs);
 
     // threads: mutex
     amf_handle  AMF_CDECL_CALL amf_create_mutex(bool bInitiallyOwned, const wchar_t* pName);
@@ -85,6 +88,7 @@ extern "C"
     // threads: delay
     void        AMF_CDECL_CALL amf_sleep(amf_ulong delay);
     amf_pts     AMF_CDECL_CALL amf_high_precision_clock();    // in 100 of nanosec
+    amf_pts     AMF_CDECL_CALL amf_monotonic_clock();         // in 100 of nanosec, not affected by wall clock steps
 
     void        AMF_CDECL_CALL amf_increase_timer_precision();
     void        AMF_CDECL_CALL amf_restore_timer_precision();
@@ -141,6 +145,7 @@ namespace amf
 
         virtual bool Lock(amf_ulong ulTimeout = AMF_INFINITE);
         virtual bool LockTimeout(amf_ulong ulTimeout = AMF_INFINITE);
+        bool LockTimeoutUs(amf_uint64 ulTimeoutUs);
         virtual bool Unlock();
         bool SetEvent();
         bool ResetEvent();
@@ -463,6 +468,256 @@ namespace amf
         }
     };
     //----------------------------------------------------------------
+    // Bounded ring buffer with the AMFQueue interface for FIFO (zero priority) traffic.
+    // Add/Get are lock-free and allocation-free (Vyukov sequence cells); the events are only
+    // touched when a caller has to wait for room or data. With bSingleProducerConsumer the
+    // positions are advanced without CAS - valid only if each side is used by one thread at a time.
+    // A queue size of 0 (unbounded) falls back to the AMFQueue list implementation.
+    //----------------------------------------------------------------
+    template<typename T, bool bSingleProducerConsumer = false>
+    class AMFRingQueue : public AMFQueue<T>
+    {
+    protected:
+        struct Cell
+        {
+            std::atomic<amf_size>   sequence;
+            T                       data;
+            amf_ulong               ulID;
+        };
+
+        Cell*                   m_pCells;
+        amf_size                m_Capacity;     // cells, at least 2: with one cell "full" and "empty next lap" share a sequence
+        amf_size                m_Limit;        // requested queue size, may be exceeded by one under concurrent producers
+        std::atomic<amf_size>   m_EnqueuePos;
+        std::atomic<amf_size>   m_DequeuePos;
+        std::atomic<amf_long>   m_iWaitingProducers;
+        std::atomic<amf_long>   m_iWaitingConsumers;
+        AMFEvent                m_NotFullEvent;
+        AMFEvent                m_NotEmptyEvent;
+
+        bool TryAdd(amf_ulong ulID, const T& item)
+        {
+            if(m_Capacity == 0)
+            {
+                return false;
+            }
+            Cell* pCell = NULL;
+            amf_size pos = m_EnqueuePos.load(std::memory_order_relaxed);
+            for(;;)
+            {
+                pCell = &m_pCells[pos % m_Capacity];
+                const amf_size seq = pCell->sequence.load(std::memory_order_acquire);
+                const amf_int64 diff = (amf_int64)seq - (amf_int64)pos;
+                if(diff == 0)
+                {
+                    if(m_Limit < m_Capacity && pos - m_DequeuePos.load(std::memory_order_acquire) >= m_Limit)
+                    {
+                        return false; // full at the requested size
+                    }
+                    if(bSingleProducerConsumer)
+                    {
+                        m_EnqueuePos.store(pos + 1, std::memory_order_relaxed);
+                        break;
+                    }
+                    if(m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(diff < 0)
+                {
+                    return false; // full
+                }
+                else
+                {
+                    pos = m_EnqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            pCell->data = item;
+            pCell->ulID = ulID;
+            pCell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+        bool TryGet(amf_ulong& ulID, T& item)
+        {
+            if(m_Capacity == 0)
+            {
+                return false;
+            }
+            Cell* pCell = NULL;
+            amf_size pos = m_DequeuePos.load(std::memory_order_relaxed);
+            for(;;)
+            {
+                pCell = &m_pCells[pos % m_Capacity];
+                const amf_size seq = pCell->sequence.load(std::memory_order_acquire);
+                const amf_int64 diff = (amf_int64)seq - (amf_int64)(pos + 1);
+                if(diff == 0)
+                {
+                    if(bSingleProducerConsumer)
+                    {
+                        m_DequeuePos.store(pos + 1, std::memory_order_relaxed);
+                        break;
+                    }
+                    if(m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if(diff < 0)
+                {
+                    return false; // empty
+                }
+                else
+                {
+                    pos = m_DequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            ulID = pCell->ulID;
+            item = pCell->data;
+            pCell->data = T(); // release the reference held by the cell
+            pCell->sequence.store(pos + m_Capacity, std::memory_order_release);
+            return true;
+        }
+        static void Signal(std::atomic<amf_long>& waiters, AMFEvent& event)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in Wait()
+            if(waiters.load(std::memory_order_relaxed) > 0)
+            {
+                event.SetEvent();
+            }
+        }
+        template<typename _Try>
+        static bool Wait(std::atomic<amf_long>& waiters, AMFEvent& event, amf_ulong ulTimeout, _Try tryOp)
+        {
+            const amf_pts start = amf_high_precision_clock();
+            waiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool bDone = false;
+            while(!(bDone = tryOp()))
+            {
+                amf_ulong wait = ulTimeout;
+                if(ulTimeout != AMF_INFINITE)
+                {
+                    const amf_pts elapsed = (amf_high_precision_clock() - start) / (AMF_SECOND / 1000);
+                    if(elapsed >= (amf_pts)ulTimeout)
+                    {
+                        break;
+                    }
+                    wait = ulTimeout - (amf_ulong)elapsed;
+                }
+                event.Lock(wait);
+            }
+            waiters.fetch_sub(1);
+            return bDone;
+        }
+        void Allocate(amf_size capacity)
+        {
+            delete [] m_pCells;
+            m_pCells = NULL;
+            m_Limit = capacity;
+            m_Capacity = capacity == 1 ? 2 : capacity;
+            if(m_Capacity > 0)
+            {
+                m_pCells = new Cell[m_Capacity];
+                for(amf_size i = 0; i < m_Capacity; i++)
+                {
+                    m_pCells[i].sequence.store(i, std::memory_order_relaxed);
+                    m_pCells[i].ulID = 0;
+                }
+            }
+            m_EnqueuePos.store(0);
+            m_DequeuePos.store(0);
+        }
+    public:
+        AMFRingQueue(amf_int32 iQueueSize = 0)
+            : AMFQueue<T>(iQueueSize),
+            m_pCells(NULL),
+            m_Capacity(0),
+            m_Limit(0),
+            m_EnqueuePos(0),
+            m_DequeuePos(0),
+            m_iWaitingProducers(0),
+            m_iWaitingConsumers(0),
+            m_NotFullEvent(false, false),
+            m_NotEmptyEvent(false, false)
+        {
+            Allocate(iQueueSize > 0 ? (amf_size)iQueueSize : 0);
+        }
+        virtual ~AMFRingQueue()
+        {
+            delete [] m_pCells;
+        }
+        // must not be called while other threads use the queue
+        virtual bool SetQueueSize(amf_int32 iQueueSize)
+        {
+            if(!AMFQueue<T>::SetQueueSize(iQueueSize))
+            {
+                return false;
+            }
+            Allocate(iQueueSize > 0 ? (amf_size)iQueueSize : 0);
+            return true;
+        }
+        virtual bool Add(amf_ulong ulID, const T& item, amf_long ulPriority = 0, amf_ulong ulTimeout = AMF_INFINITE)
+        {
+            if(m_Capacity == 0)
+            {
+                return AMFQueue<T>::Add(ulID, item, ulPriority, ulTimeout);
+            }
+            assert(ulPriority == 0); // ring is FIFO only
+            bool bAdded = TryAdd(ulID, item);
+            if(!bAdded && ulTimeout != 0)
+            {
+                bAdded = Wait(m_iWaitingProducers, m_NotFullEvent, ulTimeout, [&]() { return TryAdd(ulID, item); });
+            }
+            if(bAdded)
+            {
+                Signal(m_iWaitingConsumers, m_NotEmptyEvent);
+            }
+            return bAdded;
+        }
+        virtual bool Get(amf_ulong& ulID, T& item, amf_ulong ulTimeout)
+        {
+            if(m_Capacity == 0)
+            {
+                return AMFQueue<T>::Get(ulID, item, ulTimeout);
+            }
+            bool bGot = TryGet(ulID, item);
+            if(!bGot && ulTimeout != 0)
+            {
+                bGot = Wait(m_iWaitingConsumers, m_NotEmptyEvent, ulTimeout, [&]() { return TryGet(ulID, item); });
+            }
+            if(bGot)
+            {
+                Signal(m_iWaitingProducers, m_NotFullEvent);
+            }
+            return bGot;
+        }
+        virtual void Clear()
+        {
+            if(m_Capacity == 0)
+            {
+                AMFQueue<T>::Clear();
+                return;
+            }
+            amf_ulong ulID;
+            T item;
+            while(TryGet(ulID, item))
+            {
+            }
+            Signal(m_iWaitingProducers, m_NotFullEvent);
+        }
+        virtual amf_size GetSize() const
+        {
+            if(m_Capacity == 0)
+            {
+                return AMFQueue<T>::GetSize();
+            }
+            const amf_size dequeuePos = m_DequeuePos.load(std::memory_order_acquire);
+            const amf_size enqueuePos = m_EnqueuePos.load(std::memory_order_acquire);
+            return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+        }
+    };
+    //----------------------------------------------------------------
     template<class inT, class outT>
     class AMFQueueThread : public AMFThread
     {
@@ -655,6 +910,7 @@ namespace amf
         {}
         virtual ~AMFPreciseWaiter()
         {}
+        // sleeps the remaining time in one wait on a monotonic deadline; Cancel() wakes it
         amf_pts Wait(amf_pts waittime)
         {
             if (waittime < 0)
@@ -662,17 +918,16 @@ namespace amf
                 return 0;
             }
             m_bCancel = false;
-            amf_pts start = amf_high_precision_clock();
+            m_WaitEvent.ResetEvent();
+            amf_pts start = amf_monotonic_clock();
             amf_pts waited = 0;
-            int count = 0;
             while(!m_bCancel)
             {
-                count++;
-                if(!m_WaitEvent.LockTimeout(1))
+                if(!m_WaitEvent.LockTimeoutUs((amf_uint64)(waittime - waited + 9) / 10))
                 {
                     break;
                 }
-                waited = amf_high_precision_clock() - start;
+                waited = amf_monotonic_clock() - start;
                 if(waited >= waittime)
                 {
                     break;
@@ -683,7 +938,8 @@ namespace amf
         amf_pts WaitEx(amf_pts waittime)
         {
             m_bCancel = false;
-            amf_pts start = amf_high_precision_clock();
+            m_WaitEvent.ResetEvent();
+            amf_pts start = amf_monotonic_clock();
             amf_pts waited = 0;
             int count = 0;
             while (!m_bCancel && waited < waittime)
@@ -699,18 +955,19 @@ namespace amf
                     }
 
                 }
-                else if (!m_WaitEvent.LockTimeout(1))
+                else if (!m_WaitEvent.LockTimeoutUs((amf_uint64)(waittime - waited - 2 * AMF_SECOND / 1000) / 10))
                 {
                     	break;
                 }
 
-                waited = amf_high_precision_clock() - start;
+                waited = amf_monotonic_clock() - start;
             }
             return waited;
         }
         void Cancel()
         {
             m_bCancel = true;
+            m_WaitEvent.SetEvent();
         }
     protected:
         AMFEvent m_WaitEvent;
@@ -33,6 +33,9 @@
 #include "../include/core/Factory.h"
 #include "Thread.h"
 #include "TraceAdapter.h"
+#include <atomic>
+#include <string.h>
+#include <wchar.h>
 
 #pragma warning(disable: 4251)
 #pragma warning(disable: 4996)
@@ -95,6 +98,341 @@ static AMFDebug *GetDebug()
     return s_pDebug;
 }
 //------------------------------------------------------------------------------------------------
+// buffered sink: every thread writes formatted messages into its own single producer / single
+// consumer ring, the flusher thread is the only consumer and passes them on to AMFTrace
+//------------------------------------------------------------------------------------------------
+namespace
+{
+    const amf_size  TRACE_RING_SIZE         = 256 * 1024;   // bytes per thread, power of 2
+    const amf_size  TRACE_RECORD_ALIGN      = 8;
+    const amf_size  TRACE_MESSAGE_CHARS     = 512;          // longer messages are formatted on the heap
+    const amf_ulong TRACE_FLUSH_INTERVAL    = 10;           // ms
+    const amf_int32 TRACE_RECORD_PAD        = -1;           // level of the filler at the end of the ring
+
+    struct AMFTraceRecordHeader
+    {
+        amf_uint32  size;           // of the whole record, first two fields are all a filler has
+        amf_int32   level;
+        amf_int32   line;
+        amf_uint32  pathLength;
+        amf_uint32  scopeLength;
+        amf_uint32  messageLength;
+        // followed by path, scope and message, each zero terminated
+    };
+    //------------------------------------------------------------------------------------------------
+    class AMFTraceRing
+    {
+    public:
+        AMFTraceRing() :
+            m_Data(TRACE_RING_SIZE),
+            m_Head(0),
+            m_Tail(0)
+        {
+        }
+        //------------------------------------------------------------------------------------------------
+        // producer side, never blocks: returns false when the ring has no room,
+        // bHalfFull is set when this record filled the ring past the half
+        bool Push(const wchar_t* src_path, amf_int32 line, amf_int32 level, const wchar_t* scope, const wchar_t* message, amf_size messageLength, bool& bHalfFull)
+        {
+            bHalfFull = false;
+            const amf_size pathLength = src_path != NULL ? wcslen(src_path) : 0;
+            const amf_size scopeLength = scope != NULL ? wcslen(scope) : 0;
+            amf_size size = sizeof(AMFTraceRecordHeader) + (pathLength + scopeLength + messageLength + 3) * sizeof(wchar_t);
+            size = (size + TRACE_RECORD_ALIGN - 1) & ~(TRACE_RECORD_ALIGN - 1);
+            if (size > TRACE_RING_SIZE / 4)
+            {
+                return false;
+            }
+
+            amf_size head = m_Head.load(std::memory_order_relaxed);
+            const amf_size tail = m_Tail.load(std::memory_order_acquire);
+            amf_size offset = head & (TRACE_RING_SIZE - 1);
+            const amf_size pad = (offset + size > TRACE_RING_SIZE) ? TRACE_RING_SIZE - offset : 0; // records are never split
+            if (head + pad + size - tail > TRACE_RING_SIZE)
+            {
+                return false;
+            }
+            if (pad != 0)
+            {
+                AMFTraceRecordHeader* pFiller = reinterpret_cast<AMFTraceRecordHeader*>(&m_Data[offset]);
+                pFiller->size = amf_uint32(pad);
+                pFiller->level = TRACE_RECORD_PAD;
+                head += pad;
+                offset = 0;
+            }
+
+            AMFTraceRecordHeader* pHeader = reinterpret_cast<AMFTraceRecordHeader*>(&m_Data[offset]);
+            pHeader->size = amf_uint32(size);
+            pHeader->level = level;
+            pHeader->line = line;
+            pHeader->pathLength = amf_uint32(pathLength);
+            pHeader->scopeLength = amf_uint32(scopeLength);
+            pHeader->messageLength = amf_uint32(messageLength);
+            wchar_t* pText = reinterpret_cast<wchar_t*>(pHeader + 1);
+            pText = CopyText(pText, src_path, pathLength);
+            pText = CopyText(pText, scope, scopeLength);
+            CopyText(pText, message, messageLength);
+
+            m_Head.store(head + size, std::memory_order_release);
+            bHalfFull = head + size - tail > TRACE_RING_SIZE / 2 && head - tail <= TRACE_RING_SIZE / 2;
+            return true;
+        }
+        //------------------------------------------------------------------------------------------------
+        // consumer side, serialized by the caller
+        void Drain(AMFTrace* pTrace)
+        {
+            amf_size tail = m_Tail.load(std::memory_order_relaxed);
+            const amf_size head = m_Head.load(std::memory_order_acquire);
+            while (tail != head)
+            {
+                const AMFTraceRecordHeader* pHeader = reinterpret_cast<const AMFTraceRecordHeader*>(&m_Data[tail & (TRACE_RING_SIZE - 1)]);
+                if (pHeader->level != TRACE_RECORD_PAD)
+                {
+                    const wchar_t* src_path = reinterpret_cast<const wchar_t*>(pHeader + 1);
+                    const wchar_t* scope = src_path + pHeader->pathLength + 1;
+                    const wchar_t* message = scope + pHeader->scopeLength + 1;
+                    pTrace->Trace(src_path, pHeader->line, pHeader->level, scope, message, NULL);
+                }
+                tail += pHeader->size;
+                m_Tail.store(tail, std::memory_order_release);
+            }
+        }
+        //------------------------------------------------------------------------------------------------
+        bool IsEmpty() const
+        {
+            return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+        }
+        //------------------------------------------------------------------------------------------------
+    private:
+        static wchar_t* CopyText(wchar_t* pDst, const wchar_t* pSrc, amf_size length)
+        {
+            if (length != 0)
+            {
+                memcpy(pDst, pSrc, length * sizeof(wchar_t));
+            }
+            pDst[length] = L'\0';
+            return pDst + length + 1;
+        }
+
+        amf_vector<amf_uint8>   m_Data;
+        std::atomic<amf_size>   m_Head;     // bytes ever written, advanced by the producer
+        std::atomic<amf_size>   m_Tail;     // bytes ever read, advanced by the consumer
+    };
+    //------------------------------------------------------------------------------------------------
+    // counters are written by the owning thread only and read by AMFTraceGetStatistics
+    struct AMFTraceThreadState
+    {
+        AMFTraceThreadState() :
+            calls(0),
+            filtered(0),
+            dropped(0),
+            time(0),
+            pRing(NULL),
+            bExited(false)
+        {
+        }
+
+        static void Add(std::atomic<amf_int64>& counter, amf_int64 value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        std::atomic<amf_int64>  calls;
+        std::atomic<amf_int64>  filtered;
+        std::atomic<amf_int64>  dropped;
+        std::atomic<amf_int64>  time;
+        AMFTraceRing*           pRing;      // allocated on the first buffered message
+        bool                    bExited;    // set under the sink lock, the sink frees the state once drained
+    };
+    //------------------------------------------------------------------------------------------------
+    class AMFTraceSink : public AMFThread
+    {
+    public:
+        // never destroyed: threads may still exit and trace while static objects are torn down
+        static AMFTraceSink& Instance()
+        {
+            static AMFTraceSink* s_pSink = new AMFTraceSink();
+            return *s_pSink;
+        }
+        //------------------------------------------------------------------------------------------------
+        AMFTraceThreadState* RegisterThread()
+        {
+            AMFTraceThreadState* pState = new AMFTraceThreadState();
+            AMFLock lock(&m_Sync);
+            m_States.push_back(pState);
+            return pState;
+        }
+        //------------------------------------------------------------------------------------------------
+        void UnregisterThread(AMFTraceThreadState* pState)
+        {
+            AMFLock lock(&m_Sync);
+            pState->bExited = true;
+            if (pState->pRing == NULL || pState->pRing->IsEmpty())
+            {
+                Retire(pState);
+            }
+        }
+        //------------------------------------------------------------------------------------------------
+        bool IsEnabled() const
+        {
+            return m_bEnabled.load(std::memory_order_acquire);
+        }
+        //------------------------------------------------------------------------------------------------
+        bool Push(AMFTraceThreadState* pState, const wchar_t* src_path, amf_int32 line, amf_int32 level, const wchar_t* scope, const wchar_t* message, amf_size messageLength)
+        {
+            if (pState->pRing == NULL)
+            {
+                AMFTraceRing* pRing = new AMFTraceRing();
+                AMFLock lock(&m_Sync);
+                pState->pRing = pRing;
+            }
+            bool bHalfFull = false;
+            const bool pushed = pState->pRing->Push(src_path, line, level, scope, message, messageLength, bHalfFull);
+            if (bHalfFull)
+            {
+                m_Wake.SetEvent(); // don't wait for the interval under a burst
+            }
+            return pushed;
+        }
+        //------------------------------------------------------------------------------------------------
+        AMF_RESULT Enable(bool enable)
+        {
+            AMFLock lock(&m_EnableSync);
+            if (enable)
+            {
+                if (m_iEnableCount == 0)
+                {
+                    m_bEnabled.store(true, std::memory_order_release);
+                    const bool bStarted = Start();
+                    if (!bStarted)
+                    {
+                        m_bEnabled.store(false, std::memory_order_release);
+                        Drain(); // whatever was pushed before the start failed
+                    }
+                    AMF_RETURN_IF_FALSE(bStarted, AMF_FAIL, L"Enable() - failed to start the trace flusher");
+                }
+                m_iEnableCount++;
+                return AMF_OK;
+            }
+            AMF_RETURN_IF_FALSE(m_iEnableCount > 0, AMF_WRONG_STATE, L"Enable() - the buffered sink is not enabled");
+            if (--m_iEnableCount == 0)
+            {
+                m_bEnabled.store(false, std::memory_order_release);
+                RequestStop();
+                m_Wake.SetEvent();
+                WaitForStop();
+                Drain(); // whatever was pushed while the flusher stopped
+            }
+            return AMF_OK;
+        }
+        //------------------------------------------------------------------------------------------------
+        void Drain()
+        {
+            AMFLock drainLock(&m_DrainSync);
+            AMFLock lock(&m_Sync);
+            AMFTrace* pTrace = GetTrace();
+            for (amf_list<AMFTraceThreadState*>::iterator it = m_States.begin(); it != m_States.end();)
+            {
+                AMFTraceThreadState* pState = *it++;
+                if (pState->pRing != NULL)
+                {
+                    pState->pRing->Drain(pTrace);
+                }
+                if (pState->bExited)
+                {
+                    Retire(pState);
+                }
+            }
+        }
+        //------------------------------------------------------------------------------------------------
+        void GetStatistics(AMFTraceStatistics* pStatistics)
+        {
+            AMFLock lock(&m_Sync);
+            *pStatistics = m_Retired;
+            for (amf_list<AMFTraceThreadState*>::const_iterator it = m_States.begin(); it != m_States.end(); ++it)
+            {
+                pStatistics->calls += (*it)->calls.load(std::memory_order_relaxed);
+                pStatistics->filtered += (*it)->filtered.load(std::memory_order_relaxed);
+                pStatistics->dropped += (*it)->dropped.load(std::memory_order_relaxed);
+                pStatistics->time += (*it)->time.load(std::memory_order_relaxed);
+            }
+        }
+        //------------------------------------------------------------------------------------------------
+        virtual void Run() override
+        {
+            while (StopRequested() == false)
+            {
+                m_Wake.Lock(TRACE_FLUSH_INTERVAL);
+                Drain();
+            }
+        }
+        //------------------------------------------------------------------------------------------------
+    private:
+        AMFTraceSink() :
+            m_Retired(),
+            m_iEnableCount(0),
+            m_bEnabled(false),
+            m_Wake(false, false)
+        {
+        }
+        //------------------------------------------------------------------------------------------------
+        // m_Sync is held
+        void Retire(AMFTraceThreadState* pState)
+        {
+            m_Retired.calls += pState->calls.load(std::memory_order_relaxed);
+            m_Retired.filtered += pState->filtered.load(std::memory_order_relaxed);
+            m_Retired.dropped += pState->dropped.load(std::memory_order_relaxed);
+            m_Retired.time += pState->time.load(std::memory_order_relaxed);
+            m_States.remove(pState);
+            delete pState->pRing;
+            delete pState;
+        }
+
+        AMFCriticalSection                  m_Sync;         // m_States, m_Retired, ring allocation
+        AMFCriticalSection                  m_DrainSync;    // keeps a single consumer per ring
+        AMFCriticalSection                  m_EnableSync;
+        amf_list<AMFTraceThreadState*>      m_States;
+        AMFTraceStatistics                  m_Retired;      // counters of exited threads
+        amf_int32                           m_iEnableCount;
+        std::atomic<bool>                   m_bEnabled;
+        AMFEvent                            m_Wake;
+    };
+    //------------------------------------------------------------------------------------------------
+    class AMFTraceThreadHolder
+    {
+    public:
+        AMFTraceThreadHolder() :
+            m_pState(NULL)
+        {
+        }
+        ~AMFTraceThreadHolder()
+        {
+            if (m_pState != NULL)
+            {
+                AMFTraceSink::Instance().UnregisterThread(m_pState);
+                m_pState = NULL;
+            }
+        }
+        // NULL until the thread traces its first message
+        AMFTraceThreadState* Peek() const
+        {
+            return m_pState;
+        }
+        AMFTraceThreadState* Get()
+        {
+            if (m_pState == NULL)
+            {
+                m_pState = AMFTraceSink::Instance().RegisterThread();
+            }
+            return m_pState;
+        }
+    private:
+        AMFTraceThreadState* m_pState;
+    };
+
+    thread_local AMFTraceThreadHolder s_ThreadHolder;
+}
+//------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_CDECL_CALL amf::AMFSetCustomDebugger(AMFDebug *pDebugger)
 {
     s_pDebug = pDebugger;
@@ -114,13 +452,79 @@ AMF_RESULT AMF_CDECL_CALL amf::AMFTraceEnableAsync(bool enable)
 //------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_CDECL_CALL amf::AMFTraceFlush()
 {
+    AMFTraceSink::Instance().Drain();
     return GetTrace()->TraceFlush();
 }
 //------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_CDECL_CALL amf::AMFTraceEnableBufferedSink(bool enable)
+{
+    return AMFTraceSink::Instance().Enable(enable);
+}
+//------------------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf::AMFTraceLevelEnabled(amf_int32 level)
+{
+    return level <= GetTrace()->GetGlobalLevel();
+}
+//------------------------------------------------------------------------------------------------
+void AMF_CDECL_CALL amf::AMFTraceGetStatistics(AMFTraceStatistics* pStatistics)
+{
+    if (pStatistics != NULL)
+    {
+        AMFTraceSink::Instance().GetStatistics(pStatistics);
+    }
+}
+//------------------------------------------------------------------------------------------------
 void AMF_CDECL_CALL amf::AMFTraceW(const wchar_t* src_path, amf_int32 line, amf_int32 level, const wchar_t* scope,
             amf_int32 countArgs, const wchar_t* format, ...) // if countArgs <= 0 -> no args, formatting could be optimized then
 {
-    if(countArgs <= 0)
+    if(AMFTraceLevelEnabled(level) == false)
+    {
+        // no clock reads and no thread registration for messages below the level
+        AMFTraceThreadState* pFiltered = s_ThreadHolder.Peek();
+        if(pFiltered != NULL)
+        {
+            AMFTraceThreadState::Add(pFiltered->calls, 1);
+            AMFTraceThreadState::Add(pFiltered->filtered, 1);
+        }
+        return;
+    }
+
+    const amf_pts start = amf_high_precision_clock();
+    AMFTraceThreadState* pState = s_ThreadHolder.Get();
+    AMFTraceThreadState::Add(pState->calls, 1);
+
+    if(AMFTraceSink::Instance().IsEnabled())
+    {
+        bool pushed = false;
+        if(countArgs <= 0)
+        {
+            pushed = AMFTraceSink::Instance().Push(pState, src_path, line, level, scope, format, wcslen(format));
+        }
+        else
+        {
+            wchar_t message[TRACE_MESSAGE_CHARS];
+            va_list vl;
+            va_start(vl, format);
+            amf_int length = amf_string_formatVA(message, amf_countof(message), format, vl);
+            va_end(vl);
+            if(length >= 0)
+            {
+                pushed = AMFTraceSink::Instance().Push(pState, src_path, line, level, scope, message, amf_size(length));
+            }
+            else
+            {
+                va_start(vl, format);
+                amf_wstring longMessage = amf_string_formatVA(format, vl);
+                va_end(vl);
+                pushed = AMFTraceSink::Instance().Push(pState, src_path, line, level, scope, longMessage.c_str(), longMessage.length());
+            }
+        }
+        if(pushed == false)
+        {
+            AMFTraceThreadState::Add(pState->dropped, 1);
+        }
+    }
+    else if(countArgs <= 0)
     {
         GetTrace()->Trace(src_path, line, level, scope, format, NULL);
     }
@@ -133,6 +537,7 @@ void AMF_CDECL_CALL amf::AMFTraceW(const wchar_t* src_path, amf_int32 line, amf_
 
         va_end(vl);
     }
+    AMFTraceThreadState::Add(pState->time, amf_high_precision_clock() - start);
 }
 //------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_CDECL_CALL amf::AMFTraceSetPath(const wchar_t* path)
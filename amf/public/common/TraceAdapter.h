@@ -133,6 +133,54 @@ AMF_RESULT AMF_CDECL_CALL AMFSetCustomTracer(AMFTrace *pTrace);
 */
 AMF_RESULT AMF_CDECL_CALL AMFTraceFlush();
 
+/**
+*******************************************************************************
+*   AMFTraceEnableBufferedSink
+*
+*   @brief
+*       Enable or disable the buffered trace sink of this module
+*
+*  With the sink enabled AMFTraceW formats a message into a lock-free ring owned by the calling
+*  thread and returns; a flusher thread passes the messages to AMFTrace in the order each thread
+*  wrote them. A full ring drops the message rather than blocking, see AMFTraceGetStatistics.
+*  Source, line, level and scope are preserved; thread id and indentation are those of the flusher.
+*
+*  Calls are counted the same way as AMFTraceEnableAsync and the same rule applies: the sink
+*  must be disabled before the application quits.
+*******************************************************************************
+*/
+AMF_RESULT AMF_CDECL_CALL AMFTraceEnableBufferedSink(bool enable);
+
+/**
+*******************************************************************************
+*   AMFTraceLevelEnabled
+*
+*   @brief
+*       Returns true if a message of the given level passes the global trace level
+*
+*  Used to skip formatting of messages nobody will see
+*******************************************************************************
+*/
+bool AMF_CDECL_CALL AMFTraceLevelEnabled(amf_int32 level);
+
+/**
+*******************************************************************************
+*   AMFTraceGetStatistics
+*
+*   @brief
+*       Returns counters of AMFTraceW calls made in this module
+*******************************************************************************
+*/
+struct AMFTraceStatistics
+{
+    amf_int64   calls;      // AMFTraceW calls, filtered ones counted as below
+    amf_int64   filtered;   // skipped by level before formatting, counted on threads that traced before
+    amf_int64   dropped;    // lost on a full ring of the buffered sink
+    amf_pts     time;       // total time callers spent inside AMFTraceW on messages that passed the level
+};
+
+void AMF_CDECL_CALL AMFTraceGetStatistics(AMFTraceStatistics* pStatistics);
+
 /**
 *******************************************************************************
 *   EXPAND
@@ -351,8 +399,11 @@ inline amf_wstring __FormatMessage(int argsCount, const wchar_t* /*expression*/,
         exp_type exp_res = (exp_type)(exp); \
         if(!check_func(exp_res)) \
         { \
-            amf_wstring message = format_prefix(exp_res) + amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
-            EXPAND(amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, level, scope, 0, message.c_str()) ); \
+            if(amf::AMFTraceLevelEnabled(level)) \
+            { \
+                amf_wstring message = format_prefix(exp_res) + amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
+                EXPAND(amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, level, scope, 0, message.c_str()) ); \
+            } \
             AMFDebugBreak; \
             return return_result; \
         } \
@@ -371,8 +422,11 @@ inline amf_wstring __FormatMessage(int argsCount, const wchar_t* /*expression*/,
         exp_type exp_res = (exp_type)(exp); \
         if(!check_func(exp_res)) \
         { \
-            amf_wstring message = format_prefix(exp_res) + amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
-            EXPAND(amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, level, scope, 0, message.c_str()) ); \
+            if(amf::AMFTraceLevelEnabled(level)) \
+            { \
+                amf_wstring message = format_prefix(exp_res) + amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
+                EXPAND(amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, level, scope, 0, message.c_str()) ); \
+            } \
             AMFDebugBreak; \
         } \
     }
@@ -390,15 +444,26 @@ inline amf_wstring __FormatMessage(int argsCount, const wchar_t* /*expression*/,
 */
 #define AMF_BASE_CALL(exp, exp_type, check_func, format_prefix, level, scope, return_result/*(could be exp_res)*/, /*optional message, optional message args*/ ...) \
     { \
-        amf_wstring function_name = amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
-        amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, AMF_TRACE_DEBUG, scope, 0, function_name.c_str()); \
+        amf_wstring function_name; \
+        if(amf::AMFTraceLevelEnabled(AMF_TRACE_DEBUG)) \
+        { \
+            function_name = amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
+            amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, AMF_TRACE_DEBUG, scope, 0, function_name.c_str()); \
+        } \
         amf::AMFTraceEnterScope(); \
         exp_type exp_res = (exp_type)(exp); \
         amf::AMFTraceExitScope(); \
         if(!check_func(exp_res)) \
         { \
-            amf_wstring message = format_prefix(exp_res) + function_name; \
-            EXPAND(amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, level, scope, 0, message.c_str()) ); \
+            if(amf::AMFTraceLevelEnabled(level)) \
+            { \
+                if(function_name.empty()) \
+                { \
+                    function_name = amf::__FormatMessage(COUNT_ARGS(__VA_ARGS__) - 2, __VA_ARGS__); \
+                } \
+                amf_wstring message = format_prefix(exp_res) + function_name; \
+                EXPAND(amf::AMFTraceW(AMF_UNICODE(__FILE__), __LINE__, level, scope, 0, message.c_str()) ); \
+            } \
             AMFDebugBreak; \
             return return_result; \
         } \
@@ -189,6 +189,13 @@ bool AMF_CDECL_CALL amf_wait_for_event_timeout(amf_handle hevent, amf_ulong ulTi
     return ret == WAIT_OBJECT_0 || ret == WAIT_TIMEOUT;
 }
 //----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_wait_for_event_timeout_us(amf_handle hevent, amf_uint64 ulTimeoutUs)
+{
+    // WaitForSingleObject() has millisecond resolution - never return early
+    const amf_uint64 timeout = (ulTimeoutUs + 999) / 1000;
+    return amf_wait_for_event_timeout(hevent, timeout < AMF_INFINITE ? (amf_ulong)timeout : AMF_INFINITE - 1);
+}
+//----------------------------------------------------------------------------------------
 amf_handle AMF_CDECL_CALL amf_create_mutex(bool bInitiallyOwned, const wchar_t* pName)
 {
 #if defined(METRO_APP)
@@ -345,6 +352,12 @@ amf_pts AMF_CDECL_CALL amf_high_precision_clock()
 #endif
 }
 //-------------------------------------------------------------------------------------------------
+amf_pts AMF_CDECL_CALL amf_monotonic_clock()
+{
+    // QueryPerformanceCounter() is not affected by system time changes
+    return amf_high_precision_clock();
+}
+//-------------------------------------------------------------------------------------------------
 #pragma comment (lib, "Winmm.lib")
 static amf_uint32 timerPrecision = 1;
 
@@ -62,6 +62,7 @@
 #define AUDIO_DECODER_OUT_AUDIO_SAMPLE_FORMAT       L"Out_SampleFormat"             // amf_int64 (default = AMFAF_UNKNOWN)  (AMF_AUDIO_FORMAT)
 #define AUDIO_DECODER_OUT_AUDIO_CHANNEL_LAYOUT      L"Out_ChannelLayout"            // amf_int64 (default = 0)
 #define AUDIO_DECODER_OUT_AUDIO_BLOCK_ALIGN         L"Out_BlockAlign"               // amf_int64 (default = 0)
+#define AUDIO_DECODER_OUT_AUDIO_REQUESTED_FORMAT    L"Out_RequestedSampleFormat"    // amf_int64 (default = AMFAF_UNKNOWN)  (AMF_AUDIO_FORMAT) - S16, S32, FLT or planar; decoded samples are converted while copied out
 
 
 
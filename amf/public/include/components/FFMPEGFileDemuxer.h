@@ -51,6 +51,11 @@
 //#define FFMPEG_DEMUXER_SYNC_AV                  L"SyncAV"                   // bool (default = false)
 #define FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE   L"StreamMode"               // bool (default = true)
 #define FFMPEG_DEMUXER_LISTEN                   L"Listen"                   // bool (default = false)
+#define FFMPEG_DEMUXER_READ_AHEAD               L"ReadAhead"                // bool (default = false) - read packets on a background thread, applied on Init
+#define FFMPEG_DEMUXER_READ_AHEAD_BYTES         L"ReadAheadBytes"           // amf_int64 (default = 8MB) - per stream cache limit in bytes, ignored while another output waits on an empty cache
+#define FFMPEG_DEMUXER_READ_AHEAD_DURATION      L"ReadAheadDuration"        // amf_pts (default = 2s) - per stream cache duration considered enough
+#define FFMPEG_DEMUXER_INDEX_PATH               L"IndexPath"                // string (default = "") - keyframe index sidecar file, loaded on open and updated on close
+#define FFMPEG_DEMUXER_VIDEO_ANNEXB             L"VideoAnnexB"              // bool (default = false) - H.264 / HEVC video from MP4-like containers as Annex B, rewritten in place, applied on Init
 
 // for common, video and audio properties see Component.h
 
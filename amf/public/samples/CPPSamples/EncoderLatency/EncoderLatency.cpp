@@ -57,6 +57,7 @@
 #include "public/samples/CPPSamples/common/EncoderParamsAV1.h"
 #include "public/samples/CPPSamples/common/SurfaceGenerator.h"
 #include "public/samples/CPPSamples/common/PollingThread.h"
+#include "public/samples/CPPSamples/common/AsyncStreamWriter.h"
 #include "../common/ParametersStorage.h"
 #include "../common/CmdLineParser.h"
 #include "../common/CmdLogger.h"
@@ -76,6 +77,7 @@ static bool bMaximumSpeed = true;
 static bool bRTModeFrameBase = true; // real time encode is frame based (true) or stream based (false)
 static float fFrameRate = 30.f;
 static bool bRealTime = false;
+static bool bDirectIO = false;
 
 
 #ifdef _WIN32
@@ -105,6 +107,7 @@ static const wchar_t*  PARAM_NAME_WORKALGORITHM = L"ALGORITHM";
 static const wchar_t*  PARAM_NAME_PRERENDER     = L"PRERENDER";
 static const wchar_t*  PARAM_NAME_VCN_INSTANCE  = L"VCNINSTANCE";
 static const wchar_t*  PARAM_NAME_REALTIME      = L"REALTIME";
+static const wchar_t*  PARAM_NAME_DIRECTIO      = L"DIRECTIO";
 #if defined(_WIN32)
 static const wchar_t*  PARAM_NAME_PRIORITY      = L"PRIORITY";
 struct PriorityParam
@@ -176,6 +179,7 @@ AMF_RESULT RegisterParams(ParametersStorage* pParams)
     pParams->SetParamDescription(PARAM_NAME_INPUT_WIDTH, ParamCommon, L"Input file width", ParamConverterInt64);
     pParams->SetParamDescription(PARAM_NAME_INPUT_HEIGHT, ParamCommon, L"Input file height", ParamConverterInt64);
     pParams->SetParamDescription(PARAM_NAME_REALTIME, ParamCommon, L"Bool, Keep real-time framerate, default false", ParamConverterBoolean);
+    pParams->SetParamDescription(PARAM_NAME_DIRECTIO, ParamCommon, L"Bool, Write output with O_DIRECT where supported, default false", ParamConverterBoolean);
 #if defined(_WIN32)
     pParams->SetParamDescription(PARAM_NAME_PRIORITY, ParamCommon, L"Sets process priority class: (Idle, Below_Normal, Normal, Above_Normal, High, Realtime)", PriorityParam::Converter);
 #endif
@@ -285,6 +289,7 @@ AMF_RESULT ReadParams(ParametersStorage* params, int argc, char* argv[])
     params->GetParamWString(PARAM_NAME_OUTPUT, fileNameOut);
 
     params->GetParam(PARAM_NAME_REALTIME, bRealTime);
+    params->GetParam(PARAM_NAME_DIRECTIO, bDirectIO);
 
     if (codec == amf_wstring(AMFVideoEncoder_HEVC))
     {
@@ -538,10 +543,11 @@ protected:
     amf_pts m_FirstSliceLatency;
     amf_bool m_IsFirstSlice;
     amf_wstring m_Codec;
+    AsyncStreamWriter m_Writer; // keeps file I/O off the polling thread
 };
 
 EncPollingThread::EncPollingThread(amf::AMFContext* pContext, amf::AMFComponent* pEncoder, const wchar_t* pFileName, const amf_wstring& enc_codec)
-    : PollingThread(pContext, pEncoder, pFileName, bWriteToFile),
+    : PollingThread(pContext, pEncoder, pFileName, false),
     m_StartTime(0),
     m_FirstFrameLatency(0),
     m_FrameTime(0),
@@ -550,7 +556,13 @@ EncPollingThread::EncPollingThread(amf::AMFContext* pContext, amf::AMFComponent*
     m_IsFirstSlice(true),
     m_FirstSliceLatency(0),
     m_Codec(enc_codec)
-{}
+{
+    if (bWriteToFile == true)
+    {
+        AMF_RESULT res = m_Writer.Open(pFileName, bDirectIO);
+        AMF_ASSERT_OK(res, L"Failed to open file %s", pFileName);
+    }
+}
 
 bool EncPollingThread::Init()
 {
@@ -630,9 +642,9 @@ void EncPollingThread::ProcessData(amf::AMFData* pData)
     }
 
     amf::AMFBufferPtr pBuffer(pData); // query for buffer interface
-    if ((bWriteToFile == true) && (m_pFile != NULL))
+    if (m_Writer.IsOpen() == true)
     {
-        m_pFile->Write(pBuffer->GetNative(), pBuffer->GetSize(), NULL);
+        m_Writer.Write(pBuffer); // waits only while the write queue is full
         m_WriteDuration += amf_high_precision_clock() - poll_time;
     }
 }
@@ -641,6 +653,11 @@ void EncPollingThread::PrintResults()
 {
     amf_pts end_time = amf_high_precision_clock();
     printTime(end_time - m_StartTime, m_LatencyTime, m_FirstFrameLatency, m_MinLatency, m_MaxLatency, m_FirstSliceLatency);
+    if (m_Writer.IsOpen() == true)
+    {
+        m_Writer.Close();
+        fprintf(stderr, "%ls\n", m_Writer.GetDisplayResult().c_str());
+    }
 }
 
 void CheckAndRestartReader(RawStreamReader *pRawStreamReader)
@@ -0,0 +1,223 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// audio sample format conversion and (de)interleaving shared by the FFmpeg audio components and the
+// Ambisonic renderer: SIMD kernels are checked bit-exact against the scalar ones and timed on
+// multichannel 96 kHz buffers, the whole-buffer path is compared with a per-sample loop
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include "public/common/AudioConvert.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <random>
+
+using namespace amf;
+
+static const amf_size SampleRate = 96000;
+static const amf_int32 Channels[] = { 2, 4, 6 };
+
+//-------------------------------------------------------------------------------------------------
+// runs every kernel over odd counts with full-range and out-of-range input and compares the
+// output and the bytes around it with the scalar kernels
+static bool CheckBitExact(const AMFAudioKernels& kernels, const AMFAudioKernels& reference)
+{
+    std::mt19937 random(5678);
+    std::uniform_real_distribution<float> level(-1.5f, 1.5f);
+    const amf_size maxCount = 300;
+    std::vector<amf_int32> ints(maxCount * 6);
+    std::vector<amf_float> floats(maxCount * 6);
+    for (amf_size i = 0; i < ints.size(); i++)
+    {
+        ints[i] = amf_int32(random());
+        floats[i] = (i % 17 == 0) ? 1.0f : level(random);
+    }
+    std::vector<amf_uint8> out(maxCount * 6 * sizeof(amf_int32) + 64);
+    std::vector<amf_uint8> expected(out.size());
+
+    bool bMatch = true;
+    for (amf_size count = 0; count <= maxCount; count += (count < 40 ? 1 : 37))
+    {
+        auto compare = [&](const char* pKernel, amf_int32 channels, auto run)
+        {
+            memset(out.data(), 0xCD, out.size());
+            memset(expected.data(), 0xCD, expected.size());
+            run(reference, expected.data());
+            run(kernels, out.data());
+            if (memcmp(out.data(), expected.data(), out.size()) != 0)
+            {
+                printf("%s %s: mismatch, %zu samples, %d channels\n", kernels.pName, pKernel, count, channels);
+                bMatch = false;
+            }
+        };
+        const amf_int16* pInts16 = reinterpret_cast<const amf_int16*>(ints.data());
+
+        compare("S16ToFloat", 1, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.S16ToFloat(pInts16, (amf_float*)pOut, count); });
+        compare("S32ToFloat", 1, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.S32ToFloat(ints.data(), (amf_float*)pOut, count); });
+        compare("FloatToS16", 1, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.FloatToS16(floats.data(), (amf_int16*)pOut, count); });
+        compare("FloatToS32", 1, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.FloatToS32(floats.data(), (amf_int32*)pOut, count); });
+        compare("S16ToS32", 1, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.S16ToS32(pInts16, (amf_int32*)pOut, count); });
+        compare("S32ToS16", 1, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.S32ToS16(ints.data(), (amf_int16*)pOut, count); });
+
+        for (amf_int32 channels = 1; channels <= 6; channels++)
+        {
+            const amf_int16* planes16[6];
+            const amf_int32* planes32[6];
+            for (amf_int32 ch = 0; ch < channels; ch++)
+            {
+                planes16[ch] = pInts16 + ch * maxCount;
+                planes32[ch] = ints.data() + ch * maxCount;
+            }
+            compare("Interleave16", channels, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.Interleave16(planes16, (amf_int16*)pOut, channels, count); });
+            compare("Interleave32", channels, [&](const AMFAudioKernels& k, amf_uint8* pOut) { k.Interleave32(planes32, (amf_int32*)pOut, channels, count); });
+            compare("Deinterleave16", channels, [&](const AMFAudioKernels& k, amf_uint8* pOut)
+            {
+                amf_int16* outPlanes[6];
+                for (amf_int32 ch = 0; ch < channels; ch++)
+                {
+                    outPlanes[ch] = (amf_int16*)pOut + ch * count;
+                }
+                k.Deinterleave16(pInts16, outPlanes, channels, count);
+            });
+            compare("Deinterleave32", channels, [&](const AMFAudioKernels& k, amf_uint8* pOut)
+            {
+                amf_int32* outPlanes[6];
+                for (amf_int32 ch = 0; ch < channels; ch++)
+                {
+                    outPlanes[ch] = (amf_int32*)pOut + ch * count;
+                }
+                k.Deinterleave32(ints.data(), outPlanes, channels, count);
+            });
+        }
+    }
+    return bMatch;
+}
+//-------------------------------------------------------------------------------------------------
+template<typename TRun>
+static void TimeConversion(const char* pLevel, const char* pConversion, amf_int32 channels, amf_uint64 bytes, amf_uint32 seconds, TRun run)
+{
+    char name[128];
+    snprintf(name, sizeof(name), "%-6s %-22s %dch", pLevel, pConversion, channels);
+    const amf_pts start = amf_high_precision_clock();
+    for (amf_uint32 second = 0; second < seconds; second++)
+    {
+        run();
+    }
+    PrintThroughput(name, bytes * seconds, amf_high_precision_clock() - start);
+}
+//-------------------------------------------------------------------------------------------------
+int RunAudioConvertBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 seconds = iterations != 0 ? iterations : 20;
+
+    int result = 0;
+    const AMFAudioKernels& reference = *GetAudioKernels(AMF_AUDIO_KERNEL_SCALAR);
+    printf("dispatch selects %s\n", GetAudioKernels().pName);
+    for (int level = AMF_AUDIO_KERNEL_SCALAR + 1; level < AMF_AUDIO_KERNEL_LEVEL_COUNT; level++)
+    {
+        const AMFAudioKernels* pKernels = GetAudioKernels(AMF_AUDIO_KERNEL_LEVEL(level));
+        if (pKernels != nullptr && !CheckBitExact(*pKernels, reference))
+        {
+            result = 1;
+        }
+    }
+
+    // one second of audio per iteration
+    std::mt19937 random(1234);
+    std::vector<amf_int32> src(SampleRate * 6);
+    for (amf_int32& sample : src)
+    {
+        sample = amf_int32(random());
+    }
+    std::vector<amf_float> dst(SampleRate * 6);
+
+    for (amf_int32 channels : Channels)
+    {
+        const amf_uint64 samples = SampleRate * channels;
+
+        // the per-sample loops the components used before
+        TimeConversion("loop", "S16 to FLTP", channels, samples * sizeof(amf_float), seconds, [&]()
+        {
+            const amf_int16* pIn = reinterpret_cast<const amf_int16*>(src.data());
+            for (amf_size i = 0; i < SampleRate; i++)
+            {
+                for (amf_int32 ch = 0; ch < channels; ch++)
+                {
+                    dst[ch * SampleRate + i] = amf_float(*pIn++) / amf_float(0x7FFF);
+                }
+            }
+        });
+        TimeConversion("loop", "FLTP to S16", channels, samples * sizeof(amf_float), seconds, [&]()
+        {
+            const amf_float* pIn = reinterpret_cast<const amf_float*>(dst.data());
+            amf_int16* pOut = reinterpret_cast<amf_int16*>(src.data());
+            for (amf_size i = 0; i < SampleRate; i++)
+            {
+                for (amf_int32 ch = 0; ch < channels; ch++)
+                {
+                    const amf_float v = pIn[ch * SampleRate + i] * 32768.0f;
+                    *pOut++ = amf_int16(v >= 32767.0f ? 32767 : v <= -32768.0f ? -32768 : amf_int32(v));
+                }
+            }
+        });
+
+        const struct
+        {
+            const char*         pName;
+            AMF_AUDIO_FORMAT    inFormat;
+            AMF_AUDIO_FORMAT    outFormat;
+        } conversions[] =
+        {
+            { "S16 to FLTP",  AMFAF_S16,  AMFAF_FLTP },
+            { "S32 to FLTP",  AMFAF_S32,  AMFAF_FLTP },
+            { "FLT to FLTP",  AMFAF_FLT,  AMFAF_FLTP },
+            { "FLTP to S16",  AMFAF_FLTP, AMFAF_S16 },
+            { "FLTP to FLT",  AMFAF_FLTP, AMFAF_FLT },
+            { "S16P to S16",  AMFAF_S16P, AMFAF_S16 },
+        };
+        for (const auto& conversion : conversions)
+        {
+            TimeConversion(GetAudioKernels().pName, conversion.pName, channels, samples * sizeof(amf_float), seconds, [&]()
+            {
+                if (AMFAudioConvertBuffer(conversion.inFormat, src.data(), conversion.outFormat, dst.data(), channels, SampleRate) != AMF_OK)
+                {
+                    result = 1;
+                }
+            });
+        }
+    }
+    if (result != 0)
+    {
+        printf("SIMD audio conversion output differs from the scalar kernels\n");
+    }
+    return result;
+}
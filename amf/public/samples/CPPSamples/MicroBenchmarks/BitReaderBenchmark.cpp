@@ -0,0 +1,317 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Parser::BitReader against the bit-at-a-time reader it replaced, on a corpus of H.264-style
+// SPS, PPS and slice headers
+#include "MicroBenchmarks.h"
+#include "../common/BitStreamParser.h"
+#include <stdio.h>
+#include <vector>
+#include <random>
+
+namespace
+{
+    enum OpType
+    {
+        OpBits,
+        OpUe,
+        OpSe,
+    };
+
+    struct Op
+    {
+        OpType      type;
+        amf_uint32  bits;   // u(n) width
+        amf_uint32  value;  // expected value (se(v) stored as amf_int32)
+    };
+
+    struct Header
+    {
+        std::vector<amf_uint8>  data;
+        std::vector<Op>         ops;
+    };
+
+    class BitWriter
+    {
+    public:
+        BitWriter(Header& header) : m_Header(header), m_Bits(0) {}
+
+        void PutBits(amf_uint32 value, amf_uint32 count, bool bRecord = true)
+        {
+            for(amf_uint32 i = count; i > 0; i--)
+            {
+                if(m_Bits % 8 == 0)
+                {
+                    m_Header.data.push_back(0);
+                }
+                if((value >> (i - 1)) & 1)
+                {
+                    m_Header.data.back() |= amf_uint8(0x80 >> (m_Bits % 8));
+                }
+                m_Bits++;
+            }
+            if(bRecord)
+            {
+                m_Header.ops.push_back({ OpBits, count, value });
+            }
+        }
+        void PutUe(amf_uint32 value, bool bRecord = true)
+        {
+            const amf_uint64 code = amf_uint64(value) + 1;
+            amf_uint32 length = 0;
+            while((code >> length) > 1)
+            {
+                length++;
+            }
+            PutBits(0, length, false);
+            PutBits(amf_uint32(code >> 32), length >= 32 ? 1 : 0, false);
+            PutBits(amf_uint32(code), AMF_MIN(length + 1, amf_uint32(32)), false);
+            if(bRecord)
+            {
+                m_Header.ops.push_back({ OpUe, 0, value });
+            }
+        }
+        void PutSe(amf_int32 value)
+        {
+            PutUe(value > 0 ? amf_uint32(value) * 2 - 1 : amf_uint32(-value) * 2, false);
+            m_Header.ops.push_back({ OpSe, 0, amf_uint32(value) });
+        }
+        void Finish()
+        {
+            PutBits(1, 1, false); // rbsp_stop_one_bit
+            while(m_Bits % 8 != 0)
+            {
+                PutBits(0, 1, false);
+            }
+        }
+    private:
+        Header&     m_Header;
+        size_t      m_Bits;
+    };
+
+    //-------------------------------------------------------------------------------------------------
+    // the reader the parsers used before: one shift and mask per bit
+    amf_uint32 ReadBitsByBit(const amf_uint8* data, size_t& bitIdx, size_t count)
+    {
+        amf_uint32 result = 0;
+        for(size_t i = 0; i < count; i++)
+        {
+            result = (result << 1) | ((data[bitIdx / 8] >> (7 - bitIdx % 8)) & 1);
+            bitIdx++;
+        }
+        return result;
+    }
+    amf_uint32 ReadUeByBit(const amf_uint8* data, size_t& bitIdx)
+    {
+        size_t zeroBitsCount = 0;
+        while(ReadBitsByBit(data, bitIdx, 1) == 0)
+        {
+            zeroBitsCount++;
+        }
+        if(zeroBitsCount > 30)
+        {
+            return 0;
+        }
+        return ((1u << zeroBitsCount) - 1) + ReadBitsByBit(data, bitIdx, zeroBitsCount);
+    }
+    amf_int32 ReadSeByBit(const amf_uint8* data, size_t& bitIdx)
+    {
+        const amf_uint32 ue = ReadUeByBit(data, bitIdx);
+        const amf_int32 r = amf_int32(ue / 2 + ue % 2);
+        return ue % 2 != 0 ? r : -r;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+    void GenerateCorpus(std::vector<Header>& corpus, size_t count)
+    {
+        std::mt19937 random(42);
+        auto range = [&](amf_uint32 from, amf_uint32 to) { return from + amf_uint32(random() % (to - from + 1)); };
+
+        corpus.resize(count);
+        for(size_t i = 0; i < count; i++)
+        {
+            Header& header = corpus[i];
+            BitWriter writer(header);
+            switch(i % 8)
+            {
+            case 0: // seq_parameter_set_rbsp
+                writer.PutBits(range(66, 110), 8);
+                writer.PutBits(range(0, 255), 8);
+                writer.PutBits(range(30, 52), 8);
+                writer.PutUe(range(0, 31));
+                writer.PutUe(range(0, 3));
+                writer.PutUe(range(0, 2));
+                writer.PutUe(range(0, 2));
+                writer.PutBits(0, 1);
+                writer.PutBits(0, 1);
+                writer.PutUe(range(0, 12));
+                writer.PutUe(range(0, 2));
+                writer.PutUe(range(0, 12));
+                writer.PutUe(range(1, 16));
+                writer.PutBits(0, 1);
+                writer.PutUe(range(39, 239));
+                writer.PutUe(range(29, 134));
+                writer.PutBits(1, 1);
+                writer.PutBits(1, 1);
+                writer.PutBits(1, 1);
+                for(int crop = 0; crop < 4; crop++)
+                {
+                    writer.PutUe(range(0, 8));
+                }
+                writer.PutBits(1, 1);
+                writer.PutBits(range(0, 1), 1);
+                writer.PutBits(range(0, 1), 1);
+                writer.PutBits(1, 1);
+                writer.PutBits(range(1000, 1001), 32);
+                writer.PutBits(range(48000, 120000), 32);
+                writer.PutBits(1, 1);
+                break;
+            case 1: // pic_parameter_set_rbsp
+                writer.PutUe(range(0, 255));
+                writer.PutUe(range(0, 31));
+                writer.PutBits(range(0, 1), 1);
+                writer.PutBits(range(0, 1), 1);
+                writer.PutUe(0);
+                writer.PutUe(range(0, 4));
+                writer.PutUe(range(0, 4));
+                writer.PutBits(range(0, 1), 1);
+                writer.PutBits(range(0, 2), 2);
+                writer.PutSe(amf_int32(range(0, 50)) - 26);
+                writer.PutSe(amf_int32(range(0, 50)) - 26);
+                writer.PutSe(amf_int32(range(0, 24)) - 12);
+                writer.PutBits(range(0, 1), 1);
+                writer.PutBits(range(0, 1), 1);
+                writer.PutBits(range(0, 1), 1);
+                break;
+            default: // slice_header
+                writer.PutUe(range(0, 8160));
+                writer.PutUe(range(0, 9));
+                writer.PutUe(range(0, 3));
+                for(int field = 0; field < 2; field++) // frame_num, pic_order_cnt_lsb
+                {
+                    const amf_uint32 width = range(4, 16);
+                    writer.PutBits(range(0, (1u << width) - 1), width);
+                }
+                writer.PutSe(amf_int32(range(0, 6)) - 3);
+                writer.PutBits(range(0, 1), 1);
+                writer.PutUe(range(0, 4));
+                writer.PutSe(amf_int32(range(0, 30)) - 15);
+                writer.PutUe(range(0, 2));
+                writer.PutSe(amf_int32(range(0, 12)) - 6);
+                writer.PutSe(amf_int32(range(0, 12)) - 6);
+                writer.PutUe(range(0, 0x3fffffff)); // long codewords take the slow path
+                break;
+            }
+            writer.Finish();
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+int RunBitReaderBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 passes = iterations != 0 ? iterations : 200;
+
+    std::vector<Header> corpus;
+    GenerateCorpus(corpus, 4096);
+    amf_uint64 bytes = 0;
+    size_t fields = 0;
+    for(const Header& header : corpus)
+    {
+        bytes += header.data.size();
+        fields += header.ops.size();
+    }
+    printf("corpus: %zu headers, %zu fields, %llu bytes\n", corpus.size(), fields, (unsigned long long)bytes);
+
+    int result = 0;
+    amf_uint32 checksumByBit = 0;
+    amf_pts start = amf_high_precision_clock();
+    for(amf_uint32 pass = 0; pass < passes; pass++)
+    {
+        for(const Header& header : corpus)
+        {
+            size_t bitIdx = 0;
+            for(const Op& op : header.ops)
+            {
+                amf_uint32 value = 0;
+                switch(op.type)
+                {
+                case OpBits:    value = ReadBitsByBit(header.data.data(), bitIdx, op.bits); break;
+                case OpUe:      value = ReadUeByBit(header.data.data(), bitIdx); break;
+                case OpSe:      value = amf_uint32(ReadSeByBit(header.data.data(), bitIdx)); break;
+                }
+                if(pass == 0 && value != op.value)
+                {
+                    result = 1;
+                }
+                checksumByBit += value;
+            }
+        }
+    }
+    PrintThroughput("bit-at-a-time reader", bytes * passes, amf_high_precision_clock() - start);
+
+    amf_uint32 checksum = 0;
+    start = amf_high_precision_clock();
+    for(amf_uint32 pass = 0; pass < passes; pass++)
+    {
+        for(const Header& header : corpus)
+        {
+            Parser::BitReader bits(header.data.data(), header.data.size());
+            for(const Op& op : header.ops)
+            {
+                amf_uint32 value = 0;
+                switch(op.type)
+                {
+                case OpBits:    value = bits.ReadBits(op.bits); break;
+                case OpUe:      value = bits.ReadUe(); break;
+                case OpSe:      value = amf_uint32(bits.ReadSe()); break;
+                }
+                if(pass == 0 && value != op.value)
+                {
+                    result = 1;
+                }
+                checksum += value;
+            }
+            if(bits.IsOverrun())
+            {
+                result = 1;
+            }
+        }
+    }
+    PrintThroughput("Parser::BitReader", bytes * passes, amf_high_precision_clock() - start);
+
+    if(result != 0 || checksum != checksumByBit)
+    {
+        printf("decoded values differ from the corpus\n");
+        result = 1;
+    }
+    return result;
+}
@@ -0,0 +1,232 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// binaural convolution engines of the Ambisonic renderer: direct time-domain convolution against
+// the uniformly partitioned overlap-save FFT engine, per processed block of 8 ear / channel pairs
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include "public/src/components/AmbisonicRenderer/convolution.h"
+#include "public/src/components/AmbisonicRenderer/HRTFtable.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <random>
+
+static const int        ChannelCount = 8;       // W, X, Y, Z for each ear, as Ambi2Stereo::process
+static const amf_size   BlockLength = 128;      // Ambi2Stereo uses responseLength / 4
+
+//-------------------------------------------------------------------------------------------------
+struct ConvolutionCase
+{
+    const char*         pName;
+    float               sampleRate;             // 0 - synthetic responses
+    amf_size            responseLength;
+};
+//-------------------------------------------------------------------------------------------------
+// measured HRTFs as Ambi2Stereo::loadTabulatedHRTFs loads them, or exponentially decaying noise
+// when the case has no table behind it
+static bool LoadResponses(const ConvolutionCase& test, std::vector<std::vector<float> >& responses)
+{
+    responses.assign(IRTABLEN * 2, std::vector<float>(test.responseLength, 0.0f));
+    if(test.sampleRate != 0.0f)
+    {
+        for(int n = 0; n < IRTABLEN; n++)
+        {
+            float elevation = 0, azimuth = 0;
+            if(!getIR(test.sampleRate, n, &elevation, &azimuth, (int)test.responseLength, responses[n * 2].data(), responses[n * 2 + 1].data()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    for(std::vector<float>& response : responses)
+    {
+        for(amf_size i = 0; i < test.responseLength; i++)
+        {
+            response[i] = noise(random) * expf(-4.0f * float(i) / float(test.responseLength));
+        }
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+// per-channel response for a block: a blend of two table entries, re-weighted every block while
+// the head moves, the way Ambi2Stereo::getResponses mixes the virtual speakers
+static void BlendResponses(const std::vector<std::vector<float> >& table, float weight, std::vector<std::vector<float> >& responses,
+                           amf_uint32* pNonZero)
+{
+    for(int k = 0; k < ChannelCount; k++)
+    {
+        const std::vector<float>& a = table[k];
+        const std::vector<float>& b = table[k + ChannelCount];
+        std::vector<float>& response = responses[k];
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            response[i] = a[i] * weight + b[i] * (1.0f - weight);
+        }
+
+        amf_uint32 first = 0;
+        amf_uint32 last = 0;
+        for(size_t i = 0; i < response.size(); i++)
+        {
+            if(response[i] != 0.0f)
+            {
+                first = amf_uint32(i);
+                break;
+            }
+        }
+        for(size_t i = response.size(); i > 0; i--)
+        {
+            if(response[i - 1] != 0.0f)
+            {
+                last = amf_uint32(i - 1);
+                break;
+            }
+        }
+        pNonZero[k * 2] = first;
+        pNonZero[k * 2 + 1] = last;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static int RunCase(const ConvolutionCase& test, bool bMoving, amf_uint32 blocks)
+{
+    std::vector<std::vector<float> > table;
+    if(!LoadResponses(test, table))
+    {
+        printf("%s: failed to load responses\n", test.pName);
+        return 1;
+    }
+
+    // timeDomainCPU keeps convlength samples of history including the current block, so the
+    // reference gets datalength more of it to reach the tail of long synthetic responses
+    const amf_size historyLength = test.responseLength + BlockLength;
+    convolution timeDomain(ChannelCount, (int)historyLength);
+    convolution partitioned(ChannelCount, (int)test.responseLength);
+    if(!timeDomain.init() || !partitioned.init() || !partitioned.initPartitioned(BlockLength))
+    {
+        printf("%s: failed to initialize the convolution engines\n", test.pName);
+        return 1;
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> input(BlockLength * ChannelCount);
+    std::vector<float> outTime(BlockLength * ChannelCount);
+    std::vector<float> outFFT(BlockLength * ChannelCount);
+    std::vector<std::vector<float> > responses(ChannelCount, std::vector<float>(historyLength, 0.0f));
+    amf_uint32 nonZero[ChannelCount * 2];
+
+    char timeName[128];
+    char fftName[128];
+    snprintf(timeName, sizeof(timeName), "%s%s, time domain", test.pName, bMoving ? " moving" : "");
+    snprintf(fftName, sizeof(fftName), "%s%s, partitioned FFT", test.pName, bMoving ? " moving" : "");
+    BenchmarkStats statsTime(timeName);
+    BenchmarkStats statsFFT(fftName);
+    statsTime.Reserve(blocks);
+    statsFFT.Reserve(blocks);
+
+    double maxError = 0.0;
+    double maxOutput = 0.0;
+    BlendResponses(table, 0.5f, responses, nonZero);
+    for(amf_uint32 block = 0; block < blocks; block++)
+    {
+        if(bMoving)
+        {
+            BlendResponses(table, 0.5f + 0.5f * sinf(float(block) * 0.05f), responses, nonZero);
+        }
+        for(float& sample : input)
+        {
+            sample = noise(random);
+        }
+
+        amf_pts start = amf_high_precision_clock();
+        for(int k = 0; k < ChannelCount; k++)
+        {
+            // timeDomainCPU treats lastNonZero as exclusive
+            timeDomain.timeDomainCPU(responses[k].data(), nonZero[k * 2], nonZero[k * 2 + 1] + 1, &input[k * BlockLength],
+                &outTime[k * BlockLength], k, BlockLength, historyLength);
+        }
+        statsTime.Add(amf_high_precision_clock() - start);
+
+        start = amf_high_precision_clock();
+        for(int k = 0; k < ChannelCount; k++)
+        {
+            partitioned.frequencyDomainCPU(responses[k].data(), nonZero[k * 2], nonZero[k * 2 + 1], &input[k * BlockLength],
+                &outFFT[k * BlockLength], k, BlockLength, test.responseLength);
+        }
+        statsFFT.Add(amf_high_precision_clock() - start);
+
+        for(size_t i = 0; i < outTime.size(); i++)
+        {
+            maxError = AMF_MAX(maxError, fabs(double(outTime[i]) - double(outFFT[i])));
+            maxOutput = AMF_MAX(maxOutput, fabs(double(outTime[i])));
+        }
+    }
+
+    statsTime.Print();
+    statsFFT.Print();
+
+    const double relativeError = maxOutput > 0.0 ? maxError / maxOutput : maxError;
+    printf("%s: %zu taps, block %zu, max error %.2e relative to peak\n", test.pName, test.responseLength, BlockLength, relativeError);
+    if(relativeError > 1e-4)
+    {
+        printf("%s: partitioned FFT output does not match the time domain path\n", test.pName);
+        return 1;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+int RunConvolutionBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 blocks = iterations != 0 ? iterations : 400;
+
+    static const ConvolutionCase cases[] =
+    {
+        { "HRTF 44.1 kHz",      44100.0f,   512 },
+        { "HRTF 48 kHz",        48000.0f,   512 },
+        { "synthetic 1024",     0.0f,       1024 },
+        { "synthetic 4096",     0.0f,       4096 },
+    };
+
+    int result = 0;
+    for(const ConvolutionCase& test : cases)
+    {
+        for(bool bMoving : { false, true })
+        {
+            result |= RunCase(test, bMoving, blocks);
+        }
+    }
+    return result;
+}
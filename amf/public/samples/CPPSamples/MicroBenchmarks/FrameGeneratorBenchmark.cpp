@@ -0,0 +1,313 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// synthetic host frames for encoder benchmarks: the SIMD kernels and the banded multi-threaded fill
+// are checked bit-exact against the scalar single-threaded generator and the VideoRenderHost setup
+// against the per-pixel loops it replaced, then frame rates are compared with those loops on a
+// freshly allocated frame
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include "../common/FrameGenerator.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace amf;
+
+static volatile amf_uint32 s_Sink; // keeps the compiler from dropping the loop frames
+
+static const amf::AMF_SURFACE_FORMAT Formats[] =
+{
+    amf::AMF_SURFACE_NV12, amf::AMF_SURFACE_P010, amf::AMF_SURFACE_BGRA, amf::AMF_SURFACE_RGBA, amf::AMF_SURFACE_RGBA_F16
+};
+
+//-------------------------------------------------------------------------------------------------
+// host frame with some padding after every line, so stray writes past the width show up
+struct HostFrame
+{
+    HostFrame(amf::AMF_SURFACE_FORMAT format, amf_int32 width, amf_int32 height)
+    {
+        const bool bYUV420 = format == amf::AMF_SURFACE_NV12 || format == amf::AMF_SURFACE_P010;
+        const amf_int32 pixelSize = format == amf::AMF_SURFACE_NV12 ? 1 : format == amf::AMF_SURFACE_P010 ? 2 :
+                                    format == amf::AMF_SURFACE_RGBA_F16 ? 8 : 4;
+        pitch = width * pixelSize + 32;
+        data.resize(amf_size(pitch) * (bYUV420 ? height + (height + 1) / 2 : height));
+        pUV = bYUV420 ? data.data() + amf_size(pitch) * height : NULL;
+    }
+    std::vector<amf_uint8>  data;
+    amf_uint8*              pUV;
+    amf_int32               pitch;
+};
+//-------------------------------------------------------------------------------------------------
+static bool CheckBitExact(FRAME_GENERATOR_KERNEL_LEVEL level)
+{
+    const amf_int32 sizes[][2] = { { 1, 1 }, { 2, 2 }, { 35, 17 }, { 66, 130 }, { 641, 481 } };
+
+    bool bMatch = true;
+    for (amf::AMF_SURFACE_FORMAT format : Formats)
+    {
+        for (const amf_int32* size : sizes)
+        {
+            FrameGeneratorPtr pReference = new FrameGenerator();
+            FrameGeneratorPtr pGenerator = new FrameGenerator();
+            pReference->Init(NULL, format, size[0], size[1], 1);
+            pReference->SetKernelLevel(FRAME_GENERATOR_KERNEL_SCALAR);
+            pGenerator->Init(NULL, format, size[0], size[1], 8);
+            pGenerator->SetKernelLevel(level);
+
+            for (amf_uint32 patterns = 0; patterns <= (FRAME_PATTERN_GRADIENT | FRAME_PATTERN_BOXES | FRAME_PATTERN_NOISE); patterns++)
+            {
+                for (amf_int32 complexity : { 0, 37, 100 })
+                {
+                    FrameGeneratorParams params;
+                    params.patterns = patterns;
+                    params.complexity = complexity;
+                    params.motion = 3;
+                    const amf_uint8 background[3] = { 200, 10, 99 };
+                    const amf_uint8 foreground[3] = { 5, 250, 128 };
+                    memcpy(params.background, background, sizeof(background));
+                    memcpy(params.foreground, foreground, sizeof(foreground));
+                    pReference->SetParams(params);
+                    pGenerator->SetParams(params);
+
+                    for (amf_int64 frame : { 0, 57, 100000 })
+                    {
+                        HostFrame expected(format, size[0], size[1]);
+                        HostFrame out(format, size[0], size[1]);
+                        memset(expected.data.data(), 0xCD, expected.data.size());
+                        memset(out.data.data(), 0xCD, out.data.size());
+                        pReference->FillHost(expected.data.data(), expected.pitch, expected.pUV, expected.pitch, frame);
+                        pGenerator->FillHost(out.data.data(), out.pitch, out.pUV, out.pitch, frame);
+                        if (expected.data != out.data)
+                        {
+                            printf("%s %d threads: mismatch, format %d, %dx%d, patterns %u, complexity %d, frame %lld\n",
+                                pGenerator->GetKernelName(), pGenerator->GetThreadCount(), int(format), size[0], size[1],
+                                patterns, complexity, (long long)frame);
+                            bMatch = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return bMatch;
+}
+//-------------------------------------------------------------------------------------------------
+// what VideoRenderHost::Render did for every frame: a new frame, per-pixel background and square
+// pFrame - receives the frame when not NULL
+static amf_uint8 FillLoop(amf_int32 width, amf_int32 height, amf_int32 animation, std::vector<amf_uint8>* pFrame = NULL)
+{
+    const amf_int32 squareSize = 50;
+    std::vector<amf_uint8> frame(amf_size(width) * height * 3 / 2);
+    amf_uint8* pY = frame.data();
+    amf_uint8* pUV = pY + amf_size(width) * height;
+    for (amf_int32 y = 0; y < height; y++)
+    {
+        amf_uint8* pLine = pY + amf_size(y) * width;
+        for (amf_int32 x = 0; x < width; x++)
+        {
+            *pLine++ = 16;
+        }
+    }
+    for (amf_int32 y = 0; y < height / 2; y++)
+    {
+        amf_uint8* pLine = pUV + amf_size(y) * width;
+        for (amf_int32 x = 0; x < width / 2; x++)
+        {
+            *pLine++ = 128;
+            *pLine++ = 128;
+        }
+    }
+    for (amf_int32 y = animation; y < height && y < animation + squareSize; y++)
+    {
+        amf_uint8* pLine = pY + amf_size(y) * width + animation;
+        for (amf_int32 x = 0; x + animation < width && x < squareSize; x++)
+        {
+            *pLine++ = 81;
+        }
+    }
+    for (amf_int32 y = animation / 2; y < height / 2 && y < animation / 2 + squareSize / 2; y++)
+    {
+        amf_uint8* pLine = pUV + amf_size(y) * width + animation / 2 * 2;
+        for (amf_int32 x = 0; x + animation / 2 < width / 2 && x < squareSize / 2; x++)
+        {
+            *pLine++ = 90;
+            *pLine++ = 240;
+        }
+    }
+    const amf_uint8 value = pY[amf_size(animation) * width + animation];
+    if (pFrame != NULL)
+    {
+        pFrame->swap(frame);
+    }
+    return value;
+}
+//-------------------------------------------------------------------------------------------------
+// the generator set up as VideoRenderHost does must reproduce the old square, wrap included
+static bool CheckVideoRenderHost()
+{
+    const amf_int32 sizes[][2] = { { 640, 480 }, { 320, 640 } };
+
+    bool bMatch = true;
+    for (const amf_int32* size : sizes)
+    {
+        const amf_int32 width = size[0];
+        const amf_int32 height = size[1];
+        FrameGeneratorPtr pGenerator = new FrameGenerator();
+        pGenerator->Init(NULL, amf::AMF_SURFACE_NV12, width, height, 1);
+        FrameGeneratorParams params;
+        params.patterns = FRAME_PATTERN_BOXES;
+        params.boxSize = 50;
+        params.motion = 1;
+        const amf_uint8 black[3] = { 16, 128, 128 };
+        const amf_uint8 red[3] = { 81, 90, 240 };
+        memcpy(params.background, black, sizeof(black));
+        memcpy(params.foreground, red, sizeof(red));
+        pGenerator->SetParams(params);
+
+        for (amf_int32 frame : { 0, 1, 77, height - 51, height - 50, height + 3 })
+        {
+            std::vector<amf_uint8> expected;
+            FillLoop(width, height, frame % (height - 50), &expected);
+            std::vector<amf_uint8> out(expected.size());
+            pGenerator->FillHost(out.data(), width, out.data() + amf_size(width) * height, width, frame);
+            if (expected != out)
+            {
+                printf("VideoRenderHost square: mismatch, %dx%d, frame %d\n", width, height, frame);
+                bMatch = false;
+            }
+        }
+    }
+    return bMatch;
+}
+//-------------------------------------------------------------------------------------------------
+static void PrintFrameRate(const char* pName, amf_uint64 bytes, amf_uint32 frames, amf_pts duration)
+{
+    char name[128];
+    snprintf(name, sizeof(name), "%-44s %7.1f fps", pName, double(frames) * AMF_SECOND / double(duration > 0 ? duration : 1));
+    PrintThroughput(name, bytes * frames, duration);
+}
+//-------------------------------------------------------------------------------------------------
+int RunFrameGeneratorBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 frames = iterations != 0 ? iterations : 100;
+
+    int result = 0;
+    for (int level = FRAME_GENERATOR_KERNEL_SSE2; level <= FRAME_GENERATOR_KERNEL_NEON; level++)
+    {
+        FrameGeneratorPtr pGenerator = new FrameGenerator();
+        if (pGenerator->SetKernelLevel(FRAME_GENERATOR_KERNEL_LEVEL(level)) == AMF_OK && !CheckBitExact(FRAME_GENERATOR_KERNEL_LEVEL(level)))
+        {
+            result = 1;
+        }
+    }
+    if (!CheckVideoRenderHost())
+    {
+        result = 1;
+    }
+
+    const amf_int32 sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+    for (const amf_int32* size : sizes)
+    {
+        const amf_int32 width = size[0];
+        const amf_int32 height = size[1];
+        char name[96];
+
+        amf_uint32 checksum = 0;
+        const amf_pts start = amf_high_precision_clock();
+        for (amf_uint32 frame = 0; frame < frames; frame++)
+        {
+            checksum += FillLoop(width, height, amf_int32(frame % amf_uint32(height - 50)));
+        }
+        s_Sink = checksum;
+        snprintf(name, sizeof(name), "%dx%d NV12 loop, new frame", width, height);
+        PrintFrameRate(name, amf_uint64(width) * height * 3 / 2, frames, amf_high_precision_clock() - start);
+
+        const struct
+        {
+            const char* pName;
+            amf_uint32  patterns;
+        } patterns[] =
+        {
+            { "box",            FRAME_PATTERN_BOXES },
+            { "gradient+boxes", FRAME_PATTERN_GRADIENT | FRAME_PATTERN_BOXES },
+            { "noise",          FRAME_PATTERN_NOISE },
+            { "all",            FRAME_PATTERN_GRADIENT | FRAME_PATTERN_BOXES | FRAME_PATTERN_NOISE },
+        };
+        const struct
+        {
+            const char*             pName;
+            amf::AMF_SURFACE_FORMAT format;
+            amf_uint32              bytesPerPixel2;     // bytes per two pixels
+        } formats[] =
+        {
+            { "NV12", amf::AMF_SURFACE_NV12, 3 },
+            { "P010", amf::AMF_SURFACE_P010, 6 },
+            { "BGRA", amf::AMF_SURFACE_BGRA, 8 },
+        };
+        for (const auto& format : formats)
+        {
+            HostFrame out(format.format, width, height);
+            for (const auto& pattern : patterns)
+            {
+                for (amf_int32 threads : { 1, 0 })
+                {
+                    for (int level = FRAME_GENERATOR_KERNEL_SCALAR; level <= FRAME_GENERATOR_KERNEL_NEON; level++)
+                    {
+                        FrameGeneratorPtr pGenerator = new FrameGenerator();
+                        if (pGenerator->SetKernelLevel(FRAME_GENERATOR_KERNEL_LEVEL(level)) != AMF_OK ||
+                            (threads != 1 && (level == FRAME_GENERATOR_KERNEL_SCALAR || amf_get_cpu_cores() == 1)))
+                        {
+                            continue;
+                        }
+                        pGenerator->Init(NULL, format.format, width, height, threads);
+                        FrameGeneratorParams params;
+                        params.patterns = pattern.patterns;
+                        params.complexity = 50;
+                        pGenerator->SetParams(params);
+
+                        const amf_pts begin = amf_high_precision_clock();
+                        for (amf_uint32 frame = 0; frame < frames; frame++)
+                        {
+                            pGenerator->FillHost(out.data.data(), out.pitch, out.pUV, out.pitch, frame);
+                        }
+                        const amf_pts duration = amf_high_precision_clock() - begin;
+                        snprintf(name, sizeof(name), "%dx%d %s %-14s %-6s %2d threads", width, height, format.pName,
+                            pattern.pName, pGenerator->GetKernelName(), pGenerator->GetThreadCount());
+                        PrintFrameRate(name, amf_uint64(width) * height * format.bytesPerPixel2 / 2, frames, duration);
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,144 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// this sample runs CPU-only microbenchmarks of common AMF helpers; it doesn't need the AMF runtime
+// usage: MicroBenchmarks [benchmark|all] [iterations]
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+//-------------------------------------------------------------------------------------------------
+struct BenchmarkEntry
+{
+    const char* pName;
+    const char* pDescription;
+    int         (*pRun)(amf_uint32 iterations);
+};
+
+static const BenchmarkEntry s_Benchmarks[] =
+{
+    { "threadwait",     "event/semaphore wake latency and timed-wait accuracy",     RunThreadWaitBenchmark },
+    { "startcode",      "Annex-B start code and emulation prevention scanning",     RunStartCodeBenchmark },
+    { "bitreader",      "Exp-Golomb and fixed-width header field decoding",         RunBitReaderBenchmark },
+    { "convolution",    "Ambisonic binaural convolution, time domain vs partitioned FFT", RunConvolutionBenchmark },
+    { "repack",         "FFmpeg decoder host-side pixel repacking, scalar vs SIMD", RunRepackBenchmark },
+    { "audioconvert",   "audio sample format conversion and interleaving, loops vs SIMD", RunAudioConvertBenchmark },
+    { "pipeline",       "sample Pipeline throughput and latency over threading modes and queue sizes", RunPipelineBenchmark },
+    { "framegen",       "synthetic host frame generation, per-pixel loops vs pooled SIMD generator", RunFrameGeneratorBenchmark },
+    { "ringqueue",      "AMFRingQueue size limit check and hand-off throughput vs AMFQueue", RunRingQueueBenchmark },
+};
+//-------------------------------------------------------------------------------------------------
+BenchmarkStats::BenchmarkStats(const char* pName) :
+    m_pName(pName)
+{
+}
+//-------------------------------------------------------------------------------------------------
+void BenchmarkStats::Reserve(size_t count)
+{
+    m_Samples.reserve(count);
+}
+//-------------------------------------------------------------------------------------------------
+void BenchmarkStats::Add(amf_pts sample)
+{
+    m_Samples.push_back(sample);
+}
+//-------------------------------------------------------------------------------------------------
+void BenchmarkStats::Print(const char* pUnit)
+{
+    if (m_Samples.empty())
+    {
+        printf("%-40s no samples\n", m_pName);
+        return;
+    }
+    std::sort(m_Samples.begin(), m_Samples.end());
+
+    const double scale = strcmp(pUnit, "ms") == 0 ? double(AMF_MILLISECOND) :
+                         strcmp(pUnit, "ns") == 0 ? 0.01 : double(AMF_MICROSECOND);
+    auto percentile = [&](double p) -> double
+    {
+        size_t index = std::min(m_Samples.size() - 1, size_t(p * double(m_Samples.size())));
+        return double(m_Samples[index]) / scale;
+    };
+    printf("%-40s min=%9.1f p50=%9.1f p99=%9.1f max=%9.1f %s (n=%zu)\n",
+        m_pName, percentile(0.), percentile(0.5), percentile(0.99),
+        double(m_Samples.back()) / scale, pUnit, m_Samples.size());
+}
+//-------------------------------------------------------------------------------------------------
+void PrintThroughput(const char* pName, amf_uint64 bytes, amf_pts duration)
+{
+    const double seconds = double(std::max<amf_pts>(duration, 1)) / double(AMF_SECOND);
+    const double mbps = double(bytes) / seconds / (1024. * 1024.);
+    if (mbps >= 1024.)
+    {
+        printf("%-40s %9.2f GB/s\n", pName, mbps / 1024.);
+    }
+    else
+    {
+        printf("%-40s %9.1f MB/s\n", pName, mbps);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void PrintUsage()
+{
+    printf("usage: MicroBenchmarks [benchmark|all] [iterations]\n");
+    for (const BenchmarkEntry& entry : s_Benchmarks)
+    {
+        printf("  %-16s %s\n", entry.pName, entry.pDescription);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    const char* pSelected = argc > 1 ? argv[1] : "all";
+    const amf_uint32 iterations = argc > 2 ? amf_uint32(strtoul(argv[2], NULL, 10)) : 0;
+
+    int result = 0;
+    bool bFound = false;
+    for (const BenchmarkEntry& entry : s_Benchmarks)
+    {
+        if (strcmp(pSelected, "all") == 0 || strcmp(pSelected, entry.pName) == 0)
+        {
+            bFound = true;
+            printf("=== %s ===\n", entry.pName);
+            result |= entry.pRun(iterations);
+        }
+    }
+    if (!bFound)
+    {
+        PrintUsage();
+        return 1;
+    }
+    return result;
+}
@@ -0,0 +1,69 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// common helpers for the MicroBenchmarks sample: each benchmark registers one entry point
+// in MicroBenchmarks.cpp and reports its timings through BenchmarkStats
+#pragma once
+
+#include "public/include/core/Platform.h"
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------
+// collects per-iteration timings in amf_pts (100 ns) units and prints min/percentiles/max
+class BenchmarkStats
+{
+public:
+    BenchmarkStats(const char* pName);
+
+    void Reserve(size_t count);
+    void Add(amf_pts sample);
+    void Print(const char* pUnit = "us");
+
+protected:
+    const char*             m_pName;
+    std::vector<amf_pts>    m_Samples;
+};
+//-------------------------------------------------------------------------------------------------
+// throughput helper: prints MB/s or GB/s for the given amount of processed data
+void PrintThroughput(const char* pName, amf_uint64 bytes, amf_pts duration);
+
+//-------------------------------------------------------------------------------------------------
+// benchmark entry points; iterations == 0 selects the benchmark's default
+int RunThreadWaitBenchmark(amf_uint32 iterations);
+int RunStartCodeBenchmark(amf_uint32 iterations);
+int RunBitReaderBenchmark(amf_uint32 iterations);
+int RunConvolutionBenchmark(amf_uint32 iterations);
+int RunRepackBenchmark(amf_uint32 iterations);
+int RunAudioConvertBenchmark(amf_uint32 iterations);
+int RunPipelineBenchmark(amf_uint32 iterations);
+int RunFrameGeneratorBenchmark(amf_uint32 iterations);
+int RunRingQueueBenchmark(amf_uint32 iterations);
@@ -0,0 +1,372 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// throughput and end-to-end latency of the sample Pipeline framework on synthetic host-memory
+// elements, swept over graph shapes, connection threading, slot wait modes and queue sizes
+#include "MicroBenchmarks.h"
+#include "public/samples/CPPSamples/common/Pipeline.h"
+#include "public/common/PropertyStorageImpl.h"
+#include "public/common/Thread.h"
+#include <stdio.h>
+#include <deque>
+#include <memory>
+#include <algorithm>
+
+//-------------------------------------------------------------------------------------------------
+// host-memory NV12 frame sharing one generated plane; only the wrapper is allocated per frame
+class SyntheticFrame : public amf::AMFPropertyStorageImpl<amf::AMFBuffer>
+{
+public:
+    SyntheticFrame(std::shared_ptr<const std::vector<amf_uint8> > pPlane) : m_pPlane(pPlane), m_pts(0), m_duration(0) {}
+
+    // AMFData
+    amf::AMF_MEMORY_TYPE AMF_STD_CALL GetMemoryType() override { return amf::AMF_MEMORY_HOST; }
+    AMF_RESULT AMF_STD_CALL Duplicate(amf::AMF_MEMORY_TYPE, amf::AMFData**) override { return AMF_NOT_IMPLEMENTED; }
+    AMF_RESULT AMF_STD_CALL Convert(amf::AMF_MEMORY_TYPE type) override { return type == amf::AMF_MEMORY_HOST ? AMF_OK : AMF_NOT_SUPPORTED; }
+    AMF_RESULT AMF_STD_CALL Interop(amf::AMF_MEMORY_TYPE type) override { return Convert(type); }
+    amf::AMF_DATA_TYPE AMF_STD_CALL GetDataType() override { return amf::AMF_DATA_BUFFER; }
+    amf_bool AMF_STD_CALL IsReusable() override { return false; }
+    void AMF_STD_CALL SetPts(amf_pts pts) override { m_pts = pts; }
+    amf_pts AMF_STD_CALL GetPts() override { return m_pts; }
+    void AMF_STD_CALL SetDuration(amf_pts duration) override { m_duration = duration; }
+    amf_pts AMF_STD_CALL GetDuration() override { return m_duration; }
+
+    // AMFBuffer
+    AMF_RESULT AMF_STD_CALL SetSize(amf_size) override { return AMF_NOT_SUPPORTED; }
+    amf_size AMF_STD_CALL GetSize() override { return m_pPlane->size(); }
+    void* AMF_STD_CALL GetNative() override { return const_cast<amf_uint8*>(m_pPlane->data()); }
+    void AMF_STD_CALL AddObserver(amf::AMFBufferObserver*) override {}
+    void AMF_STD_CALL RemoveObserver(amf::AMFBufferObserver*) override {}
+    using amf::AMFPropertyStorageImpl<amf::AMFBuffer>::AddObserver;
+    using amf::AMFPropertyStorageImpl<amf::AMFBuffer>::RemoveObserver;
+
+protected:
+    std::shared_ptr<const std::vector<amf_uint8> > m_pPlane;
+    amf_pts     m_pts;
+    amf_pts     m_duration;
+};
+//-------------------------------------------------------------------------------------------------
+// stands in for RawStreamReader: emits one generated NV12 picture over and over, stamping the
+// emission time into the pts so that the sinks can measure end-to-end latency
+class SyntheticSource : public PipelineElement
+{
+public:
+    SyntheticSource(amf_int32 width, amf_int32 height, amf_int64 frameCount) :
+        m_framesCount(frameCount),
+        m_framesCountRead(0)
+    {
+        std::shared_ptr<std::vector<amf_uint8> > pPlane = std::make_shared<std::vector<amf_uint8> >(width * height * 3 / 2);
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            for (amf_int32 x = 0; x < width; x++)
+            {
+                (*pPlane)[y * width + x] = amf_uint8(x + y); // luma gradient
+            }
+        }
+        std::fill(pPlane->begin() + width * height, pPlane->end(), amf_uint8(128)); // neutral chroma
+        m_pPlane = pPlane;
+    }
+
+    amf_int32 GetInputSlotCount() const override { return 0; }
+    amf_int32 GetOutputSlotCount() const override { return 1; }
+
+    AMF_RESULT QueryOutput(amf::AMFData** ppData) override
+    {
+        amf::AMFLock lock(&m_cs);
+        if (m_bFrozen)
+        {
+            return AMF_OK;
+        }
+        if (m_framesCountRead >= m_framesCount)
+        {
+            return AMF_EOF;
+        }
+        m_framesCountRead++;
+
+        // AMFInterfaceImpl only answers the AMFBuffer IID, so hand the object over as AMFData* directly
+        amf::AMFData* pFrame = new amf::AMFInterfaceImpl<SyntheticFrame, std::shared_ptr<const std::vector<amf_uint8> > >(m_pPlane);
+        amf::AMFDataPtr pData(pFrame);
+        pData->SetPts(amf_high_precision_clock());
+        *ppData = pData.Detach();
+        return AMF_OK;
+    }
+
+protected:
+    std::shared_ptr<const std::vector<amf_uint8> > m_pPlane;
+    amf_int64   m_framesCount;
+    amf_int64   m_framesCountRead;
+};
+//-------------------------------------------------------------------------------------------------
+// configurable-cost transform: cpuCost is burned reading the frame on the submitting thread,
+// asyncLatency delays the output like a hardware engine would; up to depth frames in flight
+class SyntheticTransform : public PipelineElement
+{
+public:
+    SyntheticTransform(amf_pts cpuCost, amf_pts asyncLatency, amf_size depth) :
+        m_cpuCost(cpuCost),
+        m_asyncLatency(asyncLatency),
+        m_depth(depth),
+        m_bEof(false),
+        m_checksum(0)
+    {
+    }
+
+    amf_int32 GetInputSlotCount() const override { return 1; }
+    amf_int32 GetOutputSlotCount() const override { return 1; }
+
+    AMF_RESULT SubmitInput(amf::AMFData* pData) override
+    {
+        {
+            amf::AMFLock lock(&m_cs);
+            if (m_bFrozen || m_Queue.size() >= m_depth)
+            {
+                return AMF_INPUT_FULL;
+            }
+        }
+        Burn(pData);
+
+        amf::AMFLock lock(&m_cs);
+        m_Queue.push_back(std::make_pair(amf::AMFDataPtr(pData), amf_high_precision_clock() + m_asyncLatency));
+        return AMF_OK;
+    }
+    AMF_RESULT QueryOutput(amf::AMFData** ppData) override
+    {
+        amf::AMFLock lock(&m_cs);
+        if (m_bFrozen)
+        {
+            return AMF_OK;
+        }
+        if (m_Queue.empty())
+        {
+            return m_bEof ? AMF_EOF : AMF_REPEAT;
+        }
+        if (m_asyncLatency > 0 && amf_high_precision_clock() < m_Queue.front().second)
+        {
+            return AMF_REPEAT;
+        }
+        *ppData = m_Queue.front().first.Detach();
+        m_Queue.pop_front();
+        return AMF_OK;
+    }
+    AMF_RESULT Drain(amf_int32 /*inputSlot*/) override
+    {
+        amf::AMFLock lock(&m_cs);
+        m_bEof = true;
+        return m_Queue.empty() ? AMF_OK : AMF_INPUT_FULL; // keeps CT_Direct polling until the delayed output is out
+    }
+    AMF_RESULT Flush() override
+    {
+        amf::AMFLock lock(&m_cs);
+        m_Queue.clear();
+        m_bEof = false;
+        return AMF_OK;
+    }
+
+protected:
+    void Burn(amf::AMFData* pData)
+    {
+        if (m_cpuCost <= 0)
+        {
+            return;
+        }
+        amf::AMFBufferPtr pBuffer(pData);
+        const amf_uint8* pBits = static_cast<const amf_uint8*>(pBuffer->GetNative());
+        const amf_size size = pBuffer->GetSize();
+
+        const amf_pts deadline = amf_high_precision_clock() + m_cpuCost;
+        amf_uint32 checksum = 0;
+        amf_size pos = 0;
+        do
+        {
+            const amf_size end = std::min(pos + 4096, size);
+            for (; pos < end; pos++)
+            {
+                checksum = checksum * 31 + pBits[pos];
+            }
+            if (pos == size)
+            {
+                pos = 0;
+            }
+        } while (amf_high_precision_clock() < deadline);
+        m_checksum = m_checksum + checksum; // keeps the loop from being optimized away
+    }
+
+    amf_pts     m_cpuCost;
+    amf_pts     m_asyncLatency;
+    amf_size    m_depth;
+    bool        m_bEof;
+    std::deque<std::pair<amf::AMFDataPtr, amf_pts> > m_Queue;
+    volatile amf_uint32 m_checksum;
+};
+//-------------------------------------------------------------------------------------------------
+// DummyWriter that records source-to-sink latency of every frame it swallows
+class LatencyWriter : public DummyWriter
+{
+public:
+    LatencyWriter(BenchmarkStats& latency, amf::AMFCriticalSection& cs) : m_Latency(latency), m_StatsCs(cs) {}
+
+    AMF_RESULT SubmitInput(amf::AMFData* pData) override
+    {
+        if (pData != NULL)
+        {
+            const amf_pts latency = amf_high_precision_clock() - pData->GetPts();
+            amf::AMFLock lock(&m_StatsCs);
+            m_Latency.Add(latency);
+        }
+        return DummyWriter::SubmitInput(pData);
+    }
+
+protected:
+    BenchmarkStats&             m_Latency;
+    amf::AMFCriticalSection&    m_StatsCs;
+};
+//-------------------------------------------------------------------------------------------------
+enum BenchmarkShape
+{
+    BS_Linear,  // source -> cpu transform -> async transform -> sink
+    BS_FanOut,  // source -> splitter -> 2 x (cpu transform -> sink)
+};
+
+static const amf_int32 FRAME_WIDTH          = 640;
+static const amf_int32 FRAME_HEIGHT         = 360;
+static const amf_pts   TRANSFORM_CPU_COST   = 100 * AMF_MICROSECOND;
+static const amf_pts   TRANSFORM_LATENCY    = 300 * AMF_MICROSECOND;
+static const amf_size  TRANSFORM_DEPTH      = 4;
+static const amf_pts   RUN_TIMEOUT          = 60 * AMF_SECOND;
+
+static const char* ShapeName(BenchmarkShape eShape)
+{
+    return eShape == BS_Linear ? "linear" : "fanout";
+}
+static const char* ThreadingName(ConnectionThreading eThreading)
+{
+    switch (eThreading)
+    {
+    case CT_ThreadQueue:    return "queue";
+    case CT_ThreadPoll:     return "poll";
+    case CT_Direct:         return "direct";
+    case CT_ThreadPool:     return "pool";
+    }
+    return "?";
+}
+//-------------------------------------------------------------------------------------------------
+static int RunConfiguration(BenchmarkShape eShape, ConnectionThreading eThreading, SlotWaitMode eWaitMode, amf_int32 queueSize, amf_uint32 frames)
+{
+    char config[64];
+    snprintf(config, sizeof(config), "%s %s %s q=%d", ShapeName(eShape), ThreadingName(eThreading),
+        eWaitMode == SWM_Poll ? "poll" : "wake", queueSize);
+    char name[96] = {};
+
+    BenchmarkStats latency(name); // named once the throughput is known
+    amf::AMFCriticalSection statsCs;
+    amf_int32 sinkCount = 0;
+
+    Pipeline pipeline;
+    pipeline.SetSlotWaitMode(eWaitMode);
+
+    PipelineElementPtr pSource(new SyntheticSource(FRAME_WIDTH, FRAME_HEIGHT, frames));
+    pipeline.Connect(pSource, queueSize, eThreading);
+    if (eShape == BS_Linear)
+    {
+        pipeline.Connect(PipelineElementPtr(new SyntheticTransform(TRANSFORM_CPU_COST, 0, TRANSFORM_DEPTH)), queueSize, eThreading);
+        pipeline.Connect(PipelineElementPtr(new SyntheticTransform(0, TRANSFORM_LATENCY, TRANSFORM_DEPTH)), queueSize, eThreading);
+        pipeline.Connect(PipelineElementPtr(new LatencyWriter(latency, statsCs)), queueSize, eThreading);
+        sinkCount = 1;
+    }
+    else
+    {
+        const amf_int32 branches = 2;
+        SplitterPtr pSplitter(new Splitter(false, branches, queueSize));
+        pipeline.Connect(pSplitter, queueSize, eThreading);
+        for (amf_int32 branch = 0; branch < branches; branch++)
+        {
+            PipelineElementPtr pTransform(new SyntheticTransform(TRANSFORM_CPU_COST, 0, TRANSFORM_DEPTH));
+            pipeline.Connect(pTransform, 0, pSplitter, branch, queueSize, eThreading);
+            pipeline.Connect(PipelineElementPtr(new LatencyWriter(latency, statsCs)), 0, pTransform, 0, queueSize, eThreading);
+        }
+        sinkCount = branches;
+    }
+    latency.Reserve(amf_size(frames) * sinkCount);
+
+    pipeline.Start();
+    const amf_pts start = amf_high_precision_clock();
+    bool bTimeout = false;
+    while (pipeline.GetState() == PipelineStateRunning)
+    {
+        if (amf_high_precision_clock() - start > RUN_TIMEOUT)
+        {
+            bTimeout = true;
+            break;
+        }
+        amf_sleep(1);
+    }
+    const double processingTime = pipeline.GetProcessingTime(); // ms, source start to EOF
+    pipeline.Stop();
+
+    if (bTimeout)
+    {
+        printf("%-40s timed out\n", config);
+        return 1;
+    }
+    snprintf(name, sizeof(name), "%-24s %6u fps", config, processingTime > 0. ? amf_uint32(double(frames) * 1000. / processingTime) : 0u);
+    latency.Print("ms");
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+int RunPipelineBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 frames = iterations != 0 ? iterations : 200;
+
+    static const BenchmarkShape shapes[] = { BS_Linear, BS_FanOut };
+    static const ConnectionThreading threadings[] = { CT_ThreadQueue, CT_ThreadPoll, CT_Direct, CT_ThreadPool };
+    static const SlotWaitMode waitModes[] = { SWM_Poll, SWM_WakeOnData };
+    static const amf_int32 queueSizes[] = { 1, 4, 16 };
+
+    printf("%dx%d NV12, %u frames, transform %.0fus cpu / %.0fus async\n", FRAME_WIDTH, FRAME_HEIGHT, frames,
+        double(TRANSFORM_CPU_COST) / AMF_MICROSECOND, double(TRANSFORM_LATENCY) / AMF_MICROSECOND);
+
+    int result = 0;
+    for (BenchmarkShape eShape : shapes)
+    {
+        for (ConnectionThreading eThreading : threadings)
+        {
+            for (SlotWaitMode eWaitMode : waitModes)
+            {
+                for (amf_int32 queueSize : queueSizes)
+                {
+                    result |= RunConfiguration(eShape, eThreading, eWaitMode, queueSize, frames);
+                }
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,178 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// host-side pixel repacking of the FFmpeg video decoder: every SIMD level supported by the
+// CPU is checked bit-exact against the scalar kernels and timed on 4K frames
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include "public/src/components/ComponentsFFMPEG/PixelRepack.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <random>
+
+using namespace amf;
+
+static const amf_size FrameWidth = 3840;
+static const amf_size FrameHeight = 2160;
+
+//-------------------------------------------------------------------------------------------------
+// runs every kernel of the given set over odd widths, unaligned starts and every shift and
+// compares the output and the bytes around it with the scalar kernels
+static bool CheckBitExact(const AMFRepackKernels& kernels, const AMFRepackKernels& reference)
+{
+    std::mt19937 random(5678);
+    std::vector<amf_uint8> in(1024 * 8 + 64);
+    for (amf_uint8& byte : in)
+    {
+        byte = amf_uint8(random());
+    }
+    std::vector<amf_uint8> out(1024 * 8 + 64);
+    std::vector<amf_uint8> expected(out.size());
+
+    bool bMatch = true;
+    for (amf_size count = 0; count <= 200; count++)
+    {
+        const amf_size offset = count % 5;    // bytes: keeps 16-bit data 16-bit aligned only every other size
+        const amf_size offset16 = (count % 3) * 2;
+        const amf_uint8* pIn = in.data() + offset;
+        const amf_uint16* pIn16 = (const amf_uint16*)(in.data() + offset16);
+        const amf_uint16* pIn16b = (const amf_uint16*)(in.data() + 4096 + offset16);
+
+        auto compare = [&](const char* pKernel, amf_int32 shift, auto run)
+        {
+            memset(out.data(), 0xCD, out.size());
+            memset(expected.data(), 0xCD, expected.size());
+            run(reference, expected.data() + offset16);
+            run(kernels, out.data() + offset16);
+            if (memcmp(out.data(), expected.data(), out.size()) != 0)
+            {
+                printf("%s %s: mismatch, %zu elements, shift %d\n", kernels.pName, pKernel, count, shift);
+                bMatch = false;
+            }
+        };
+
+        compare("InterleaveUV8", 0, [&](const AMFRepackKernels& k, amf_uint8* pOut)
+            { k.InterleaveUV8(pIn, pIn + 4096, pOut, count); });
+        for (amf_int32 shift = 0; shift <= 8; shift++)
+        {
+            compare("InterleaveUV16", shift, [&](const AMFRepackKernels& k, amf_uint8* pOut)
+                { k.InterleaveUV16(pIn16, pIn16b, (amf_uint16*)pOut, count, shift); });
+            compare("ShiftLeft16", shift, [&](const AMFRepackKernels& k, amf_uint8* pOut)
+                { k.ShiftLeft16(pIn16, (amf_uint16*)pOut, count, shift); });
+        }
+        for (bool bBigEndian : { false, true })
+        {
+            compare(bBigEndian ? "RGB48BEToRGBA8" : "RGB48LEToRGBA8", 0, [&](const AMFRepackKernels& k, amf_uint8* pOut)
+                { k.RGB48ToRGBA8(pIn, pOut, count, bBigEndian); });
+            compare(bBigEndian ? "RGB48BEToRGBA16" : "RGB48LEToRGBA16", 0, [&](const AMFRepackKernels& k, amf_uint8* pOut)
+                { k.RGB48ToRGBA16(pIn16, (amf_uint16*)pOut, count, bBigEndian); });
+        }
+        compare("RGBA64ToRGBA8", 0, [&](const AMFRepackKernels& k, amf_uint8* pOut)
+            { k.RGBA64ToRGBA8(pIn, pOut, count); });
+    }
+    return bMatch;
+}
+//-------------------------------------------------------------------------------------------------
+template<typename TRun>
+static void TimeKernel(const AMFRepackKernels& kernels, const char* pKernel, amf_uint64 frameBytes, amf_uint32 frames, TRun run)
+{
+    char name[128];
+    snprintf(name, sizeof(name), "%-6s %s", kernels.pName, pKernel);
+    const amf_pts start = amf_high_precision_clock();
+    for (amf_uint32 frame = 0; frame < frames; frame++)
+    {
+        for (amf_size y = 0; y < FrameHeight; y++)
+        {
+            run(y);
+        }
+    }
+    PrintThroughput(name, frameBytes * frames, amf_high_precision_clock() - start);
+}
+//-------------------------------------------------------------------------------------------------
+int RunRepackBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 frames = iterations != 0 ? iterations : 10;
+
+    const AMFRepackKernels& reference = *GetRepackKernels(AMF_REPACK_SCALAR);
+    printf("dispatch selects %s\n", GetRepackKernels().pName);
+
+    // one 4K frame worth of source lines: P010 planes and RGB48 / RGBA64 pictures
+    std::mt19937 random(1234);
+    std::vector<amf_uint16> src(FrameWidth * 4 * FrameHeight);
+    for (amf_uint16& sample : src)
+    {
+        sample = amf_uint16(random());
+    }
+    std::vector<amf_uint16> dst(FrameWidth * 4 * FrameHeight);
+
+    const amf_size lumaPitch = FrameWidth;           // in samples
+    const amf_size chromaWidth = FrameWidth / 2;
+    const amf_uint8* pSrc8 = (const amf_uint8*)src.data();
+    amf_uint8* pDst8 = (amf_uint8*)dst.data();
+
+    int result = 0;
+    for (int level = AMF_REPACK_SCALAR; level < AMF_REPACK_LEVEL_COUNT; level++)
+    {
+        const AMFRepackKernels* pKernels = GetRepackKernels(AMF_REPACK_LEVEL(level));
+        if (pKernels == nullptr)
+        {
+            continue;
+        }
+        const AMFRepackKernels& kernels = *pKernels;
+        if (level != AMF_REPACK_SCALAR && !CheckBitExact(kernels, reference))
+        {
+            result = 1;
+        }
+
+        // chroma lines are only half as many; time them over half the frame height
+        TimeKernel(kernels, "P010 Y shift", FrameWidth * FrameHeight * 2, frames, [&](amf_size y)
+            { kernels.ShiftLeft16(src.data() + y * lumaPitch, dst.data() + y * lumaPitch, FrameWidth, 6); });
+        TimeKernel(kernels, "P010 UV interleave", FrameWidth * FrameHeight * 2, frames / 2 + 1, [&](amf_size y)
+            { kernels.InterleaveUV16(src.data() + y * lumaPitch, src.data() + y * lumaPitch + chromaWidth, dst.data() + y * lumaPitch, chromaWidth, 6); });
+        TimeKernel(kernels, "NV12 UV interleave", FrameWidth * FrameHeight, frames / 2 + 1, [&](amf_size y)
+            { kernels.InterleaveUV8(pSrc8 + y * FrameWidth, pSrc8 + y * FrameWidth + chromaWidth, pDst8 + y * FrameWidth, chromaWidth); });
+        TimeKernel(kernels, "RGB48LE to RGBA", FrameWidth * FrameHeight * 4, frames, [&](amf_size y)
+            { kernels.RGB48ToRGBA8(pSrc8 + y * FrameWidth * 6, pDst8 + y * FrameWidth * 4, FrameWidth, false); });
+        TimeKernel(kernels, "RGB48BE to RGBA", FrameWidth * FrameHeight * 4, frames, [&](amf_size y)
+            { kernels.RGB48ToRGBA8(pSrc8 + y * FrameWidth * 6, pDst8 + y * FrameWidth * 4, FrameWidth, true); });
+        TimeKernel(kernels, "RGBA64 to RGBA", FrameWidth * FrameHeight * 4, frames, [&](amf_size y)
+            { kernels.RGBA64ToRGBA8(pSrc8 + y * FrameWidth * 8, pDst8 + y * FrameWidth * 4, FrameWidth); });
+        TimeKernel(kernels, "RGB48BE to RGBA_F16", FrameWidth * FrameHeight * 8, frames, [&](amf_size y)
+            { kernels.RGB48ToRGBA16(src.data() + y * FrameWidth * 3, dst.data() + y * FrameWidth * 4, FrameWidth, true); });
+    }
+    if (result != 0)
+    {
+        printf("SIMD repack output differs from the scalar kernels\n");
+    }
+    return result;
+}
@@ -0,0 +1,185 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// AMFRingQueue against the locked AMFQueue: FIFO order and the requested size limit - including a
+// queue size of 1 as used by the stitch and capture pipelines - then two-thread hand-off throughput
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include <stdio.h>
+#include <algorithm>
+
+//-------------------------------------------------------------------------------------------------
+// fills and drains the queue for a few laps so the ring positions wrap around the cells
+template<typename TQueue>
+static bool CheckLimit(const char* pName, amf_int32 queueSize)
+{
+    TQueue queue;
+    queue.SetQueueSize(queueSize);
+
+    amf_ulong next = 0;
+    for (int lap = 0; lap < 4; lap++)
+    {
+        for (amf_int32 i = 0; i < queueSize; i++)
+        {
+            if (!queue.Add(0, next + amf_ulong(i), 0, 0))
+            {
+                printf("%-40s FAILED: queue size %d refused item %d on lap %d\n", pName, queueSize, i, lap);
+                return false;
+            }
+        }
+        if (queue.Add(0, amf_ulong(-1), 0, 0) || queue.GetSize() != amf_size(queueSize))
+        {
+            printf("%-40s FAILED: queue size %d holds more than %d items\n", pName, queueSize, queueSize);
+            return false;
+        }
+        for (amf_int32 i = 0; i < queueSize; i++)
+        {
+            amf_ulong id = 0;
+            amf_ulong item = 0;
+            if (!queue.Get(id, item, 0) || item != next)
+            {
+                printf("%-40s FAILED: queue size %d returned %lu, expected %lu\n", pName, queueSize, item, next);
+                return false;
+            }
+            next++;
+        }
+        amf_ulong id = 0;
+        amf_ulong item = 0;
+        if (queue.Get(id, item, 0))
+        {
+            printf("%-40s FAILED: queue size %d returned an item when empty\n", pName, queueSize);
+            return false;
+        }
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+template<typename TQueue>
+class ProducerThread : public amf::AMFThread
+{
+public:
+    ProducerThread(TQueue& queue, amf_ulong count) : m_Queue(queue), m_Count(count) {}
+
+protected:
+    void Run() override
+    {
+        for (amf_ulong i = 0; i < m_Count; i++)
+        {
+            while (!m_Queue.Add(0, i, 0, 50))
+            {
+                if (StopRequested())
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    TQueue&     m_Queue;
+    amf_ulong   m_Count;
+};
+//-------------------------------------------------------------------------------------------------
+// one producer thread, the calling thread consumes and checks order and the size limit
+template<typename TQueue>
+static bool RunHandOff(const char* pQueueName, amf_int32 queueSize, amf_ulong count)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s size %d", pQueueName, queueSize);
+
+    TQueue queue;
+    queue.SetQueueSize(queueSize);
+    ProducerThread<TQueue> producer(queue, count);
+
+    bool bOk = true;
+    const amf_pts start = amf_high_precision_clock();
+    producer.Start();
+    for (amf_ulong i = 0; i < count; i++)
+    {
+        const amf_size size = queue.GetSize();
+        amf_ulong id = 0;
+        amf_ulong item = 0;
+        if (!queue.Get(id, item, 1000))
+        {
+            printf("%-40s FAILED: item %lu did not arrive\n", name, i);
+            bOk = false;
+            break;
+        }
+        if (item != i || size > amf_size(queueSize))
+        {
+            printf("%-40s FAILED: got %lu expected %lu, %zu items queued\n", name, item, i, size);
+            bOk = false;
+            break;
+        }
+    }
+    const amf_pts duration = amf_high_precision_clock() - start;
+    producer.RequestStop();
+    queue.Clear();
+    producer.WaitForStop();
+
+    if (bOk)
+    {
+        printf("%-40s %9.2f Mitems/s\n", name, double(count) / (double(std::max<amf_pts>(duration, 1)) / AMF_SECOND) / 1e6);
+    }
+    return bOk;
+}
+//-------------------------------------------------------------------------------------------------
+// a queue that breaks its size limit can lose items, so its hand-off is not timed
+template<typename TQueue>
+static bool RunQueue(const char* pName, amf_ulong count)
+{
+    const amf_int32 sizes[] = { 1, 2, 4, 16 };
+
+    for (amf_int32 size : sizes)
+    {
+        if (!CheckLimit<TQueue>(pName, size))
+        {
+            return false;
+        }
+    }
+    bool bOk = true;
+    for (amf_int32 size : sizes)
+    {
+        bOk &= RunHandOff<TQueue>(pName, size, count);
+    }
+    return bOk;
+}
+//-------------------------------------------------------------------------------------------------
+int RunRingQueueBenchmark(amf_uint32 iterations)
+{
+    const amf_ulong count = iterations != 0 ? iterations : 200000;
+
+    bool bOk = true;
+    bOk &= RunQueue<amf::AMFQueue<amf_ulong> >("AMFQueue", count);
+    bOk &= RunQueue<amf::AMFRingQueue<amf_ulong> >("AMFRingQueue", count);
+    bOk &= RunQueue<amf::AMFRingQueue<amf_ulong, true> >("AMFRingQueue SPSC", count);
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Annex-B start code and emulation prevention scanning used by the H.264/H.265 elementary stream
+// parsers, compared against the byte-at-a-time loops they used before
+#include "MicroBenchmarks.h"
+#include "../common/BitStreamParser.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <random>
+
+//-------------------------------------------------------------------------------------------------
+// synthetic elementary stream: random NAL payloads with emulation prevention applied, separated
+// by 3- and 4-byte start codes
+static void GenerateStream(std::vector<amf_uint8>& stream, std::vector<size_t>& startCodes, size_t size, size_t averageNaluSize)
+{
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<size_t> naluSize(averageNaluSize / 2, averageNaluSize * 3 / 2);
+
+    stream.clear();
+    startCodes.clear();
+    stream.reserve(size + averageNaluSize * 2);
+    while(stream.size() < size)
+    {
+        if(random() % 2 == 0)
+        {
+            stream.push_back(0);
+        }
+        startCodes.push_back(stream.size());
+        stream.push_back(0);
+        stream.push_back(0);
+        stream.push_back(1);
+
+        const size_t count = naluSize(random);
+        size_t zeros = 0;
+        for(size_t i = 0; i < count; i++)
+        {
+            // skew towards zero bytes so that emulation prevention is exercised
+            amf_uint8 byte = random() % 8 == 0 ? 0 : amf_uint8(random());
+            if(zeros >= 2 && byte <= 3)
+            {
+                stream.push_back(3);
+                zeros = 0;
+            }
+            stream.push_back(byte);
+            zeros = byte == 0 ? zeros + 1 : 0;
+        }
+        if(zeros > 0)
+        {
+            stream.push_back(0x80); // rbsp_stop_one_bit
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// the scan the parsers used before: count zeros, report a start code on 0x01 after two of them
+static size_t FindStartCodeByteLoop(const amf_uint8* data, size_t size)
+{
+    size_t zerosCount = 0;
+    for(size_t i = 0; i < size; i++)
+    {
+        if(data[i] == 0)
+        {
+            zerosCount++;
+        }
+        else
+        {
+            if(data[i] == 1 && zerosCount >= 2)
+            {
+                return i - 2;
+            }
+            zerosCount = 0;
+        }
+    }
+    return size;
+}
+//-------------------------------------------------------------------------------------------------
+// the in-place removal the parsers used before: one memmove per emulation prevention byte
+static size_t EBSPtoRBSPByteLoop(amf_uint8* data, size_t size)
+{
+    int count = 0;
+    amf_uint8* pos = data;
+    amf_uint8* end = data + size;
+    while(pos != end)
+    {
+        amf_uint8 tmp = *pos;
+        if(count == 2 && tmp == 0x03)
+        {
+            if(pos + 1 == end)
+            {
+                end--;
+                break;
+            }
+            memmove(pos, pos + 1, end - pos - 1);
+            end--;
+            count = 0;
+            tmp = *pos;
+        }
+        count = tmp == 0 ? count + 1 : 0;
+        pos++;
+    }
+    return end - data;
+}
+//-------------------------------------------------------------------------------------------------
+template<typename TFind>
+static bool ScanAll(const std::vector<amf_uint8>& stream, const std::vector<size_t>& startCodes, TFind find, amf_uint32 passes, const char* pName)
+{
+    bool bMatch = true;
+    const amf_pts start = amf_high_precision_clock();
+    for(amf_uint32 pass = 0; pass < passes; pass++)
+    {
+        size_t pos = 0;
+        size_t index = 0;
+        while(pos < stream.size())
+        {
+            const size_t found = pos + find(stream.data() + pos, stream.size() - pos);
+            if(found >= stream.size())
+            {
+                break;
+            }
+            // 4-byte start codes are reported at their last three bytes
+            const size_t expected = index < startCodes.size() ? startCodes[index] : size_t(-1);
+            if(found != expected && found != expected + 1)
+            {
+                bMatch = false;
+            }
+            index++;
+            pos = found + 3;
+        }
+        bMatch = bMatch && index == startCodes.size();
+    }
+    PrintThroughput(pName, amf_uint64(stream.size()) * passes, amf_high_precision_clock() - start);
+    return bMatch;
+}
+//-------------------------------------------------------------------------------------------------
+int RunStartCodeBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 passes = iterations != 0 ? iterations : 8;
+
+    std::vector<amf_uint8> stream;
+    std::vector<size_t> startCodes;
+    int result = 0;
+    for(size_t naluSize : { size_t(512), size_t(256 * 1024) })
+    {
+        GenerateStream(stream, startCodes, 64 * 1024 * 1024, naluSize);
+        printf("stream %zu MB, %zu NAL units, ~%zu bytes each\n", stream.size() / (1024 * 1024), startCodes.size(), naluSize);
+
+        const bool bByteLoop = ScanAll(stream, startCodes, FindStartCodeByteLoop, passes, "start codes, byte loop");
+        const bool bSimd = ScanAll(stream, startCodes, Parser::FindStartCode, passes, "start codes, Parser::FindStartCode");
+        if(!bByteLoop || !bSimd)
+        {
+            printf("start code mismatch\n");
+            result = 1;
+        }
+
+        // emulation prevention removal on a copy of each NAL unit, as the parsers do for headers
+        std::vector<amf_uint8> nalu;
+        amf_pts timeByteLoop = 0;
+        amf_pts timeSimd = 0;
+        amf_uint64 bytes = 0;
+        const size_t naluCount = AMF_MIN(startCodes.size(), size_t(2000));
+        for(size_t i = 0; i + 1 < naluCount; i++)
+        {
+            const size_t begin = startCodes[i] + 3;
+            const size_t end = startCodes[i + 1];
+            std::vector<amf_uint8> reference(stream.begin() + begin, stream.begin() + end);
+
+            amf_pts start = amf_high_precision_clock();
+            const size_t referenceSize = EBSPtoRBSPByteLoop(reference.data(), reference.size());
+            timeByteLoop += amf_high_precision_clock() - start;
+
+            nalu.assign(stream.begin() + begin, stream.begin() + end);
+            start = amf_high_precision_clock();
+            const size_t size = Parser::EBSPtoRBSP(nalu.data(), nalu.size());
+            timeSimd += amf_high_precision_clock() - start;
+
+            if(size != referenceSize || memcmp(nalu.data(), reference.data(), size) != 0)
+            {
+                printf("EBSPtoRBSP mismatch in NAL unit %zu\n", i);
+                result = 1;
+                break;
+            }
+            bytes += end - begin;
+        }
+        PrintThroughput("EBSP to RBSP, byte loop", bytes, timeByteLoop);
+        PrintThroughput("EBSP to RBSP, Parser::EBSPtoRBSP", bytes, timeSimd);
+    }
+    return result;
+}
@@ -0,0 +1,170 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// wake latency of AMFEvent/AMFSemaphore ping-pong between two threads and the accuracy of
+// short timed waits, which bound how tightly pipeline slots and AMFPreciseWaiter can sleep
+#include "MicroBenchmarks.h"
+#include "public/common/Thread.h"
+#include <stdio.h>
+
+//-------------------------------------------------------------------------------------------------
+static void Signal(amf::AMFEvent& event)
+{
+    event.SetEvent();
+}
+static void Signal(amf::AMFSemaphore& semaphore)
+{
+    semaphore.Unlock();
+}
+//-------------------------------------------------------------------------------------------------
+// answers each ping with a pong and records the moment it woke up
+template<typename TSync>
+class PongThread : public amf::AMFThread
+{
+public:
+    PongThread(TSync& ping, TSync& pong) : m_Ping(ping), m_Pong(pong), m_WakeTime(0) {}
+
+    amf_pts GetWakeTime() const { return m_WakeTime; }
+
+protected:
+    void Run() override
+    {
+        while (true)
+        {
+            m_Ping.Lock();
+            if (StopRequested())
+            {
+                break;
+            }
+            m_WakeTime = amf_high_precision_clock();
+            Signal(m_Pong);
+        }
+    }
+
+    TSync&          m_Ping;
+    TSync&          m_Pong;
+    volatile amf_pts m_WakeTime; // published to the main thread through m_Pong
+};
+//-------------------------------------------------------------------------------------------------
+template<typename TSync>
+static void RunPingPong(const char* pName, TSync& ping, TSync& pong, amf_uint32 iterations)
+{
+    BenchmarkStats wake(pName);
+    wake.Reserve(iterations);
+
+    PongThread<TSync> thread(ping, pong);
+    thread.Start();
+    for (amf_uint32 i = 0; i < iterations; i++)
+    {
+        const amf_pts start = amf_high_precision_clock();
+        Signal(ping);
+        pong.Lock();
+        wake.Add(thread.GetWakeTime() - start);
+    }
+    thread.RequestStop();
+    Signal(ping);
+    thread.WaitForStop();
+
+    wake.Print();
+}
+//-------------------------------------------------------------------------------------------------
+static void RunTimedWait(amf_ulong timeout, amf_uint32 iterations)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "AMFEvent timeout %lums overshoot", (unsigned long)timeout);
+    BenchmarkStats overshoot(name);
+    overshoot.Reserve(iterations);
+
+    amf::AMFEvent event;
+    for (amf_uint32 i = 0; i < iterations; i++)
+    {
+        const amf_pts start = amf_high_precision_clock();
+        event.Lock(timeout);
+        overshoot.Add(amf_high_precision_clock() - start - amf_pts(timeout) * AMF_MILLISECOND);
+    }
+    overshoot.Print();
+}
+//-------------------------------------------------------------------------------------------------
+static void RunTimedWaitUs(amf_uint64 timeoutUs, amf_uint32 iterations)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "AMFEvent timeout %lluus overshoot", (unsigned long long)timeoutUs);
+    BenchmarkStats overshoot(name);
+    overshoot.Reserve(iterations);
+
+    amf::AMFEvent event;
+    for (amf_uint32 i = 0; i < iterations; i++)
+    {
+        const amf_pts start = amf_high_precision_clock();
+        event.LockTimeoutUs(timeoutUs);
+        overshoot.Add(amf_high_precision_clock() - start - amf_pts(timeoutUs) * AMF_MILLISECOND / 1000);
+    }
+    overshoot.Print();
+}
+//-------------------------------------------------------------------------------------------------
+static void RunPreciseWaiter(amf_pts waitTime, amf_uint32 iterations)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "AMFPreciseWaiter %.1fms error", double(waitTime) / AMF_MILLISECOND);
+    BenchmarkStats error(name);
+    error.Reserve(iterations);
+
+    amf::AMFPreciseWaiter waiter;
+    for (amf_uint32 i = 0; i < iterations; i++)
+    {
+        error.Add(waiter.Wait(waitTime) - waitTime);
+    }
+    error.Print();
+}
+//-------------------------------------------------------------------------------------------------
+int RunThreadWaitBenchmark(amf_uint32 iterations)
+{
+    const amf_uint32 pingPongCount = iterations != 0 ? iterations : 10000;
+    const amf_uint32 timedCount = iterations != 0 ? iterations : 200;
+
+    {
+        amf::AMFEvent ping;
+        amf::AMFEvent pong;
+        RunPingPong("AMFEvent wake latency", ping, pong, pingPongCount);
+    }
+    {
+        amf::AMFSemaphore ping(0, 1);
+        amf::AMFSemaphore pong(0, 1);
+        RunPingPong("AMFSemaphore wake latency", ping, pong, pingPongCount);
+    }
+    RunTimedWait(1, timedCount);
+    RunTimedWait(5, timedCount / 4 + 1);
+    RunTimedWaitUs(500, timedCount);
+    RunPreciseWaiter(AMF_MILLISECOND / 2, timedCount);
+    RunPreciseWaiter(2 * AMF_MILLISECOND, timedCount);
+    return 0;
+}
@@ -155,7 +155,7 @@ AMF_RESULT SVCSplitter::Init(amf_int32 layerCount, const wchar_t *fileIn,const w
     CHECK_AMF_ERROR_RETURN(res , L"AMFCreateContext failed");
 
     amf::AMFDataStreamPtr stream;
-    amf::AMFDataStream::OpenDataStream(m_FileNameIn.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &stream);
+    amf::AMFDataStream::OpenMappedDataStream(m_FileNameIn.c_str(), amf::AMFFS_SHARE_READ, &stream);
 
     if(stream == NULL)
     {
@@ -119,7 +119,7 @@ int main(int argc, char* argv[])
     BitStreamParserPtr      parser;
 
     // initialize AMF
-    res = amf::AMFDataStream::OpenDataStream(fileNameIn, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &datastream);
+    res = amf::AMFDataStream::OpenMappedDataStream(fileNameIn, amf::AMFFS_SHARE_READ, &datastream);
 
     if(datastream == NULL)
     {
@@ -169,7 +169,7 @@ int main(int argc, char* argv[])
     BitStreamParserPtr      parser;
 
     // initialize AMF
-    res = amf::AMFDataStream::OpenDataStream(fileNameIn.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &datastream);
+    res = amf::AMFDataStream::OpenMappedDataStream(fileNameIn.c_str(), amf::AMFFS_SHARE_READ, &datastream);
 
     if(datastream == NULL)
     {
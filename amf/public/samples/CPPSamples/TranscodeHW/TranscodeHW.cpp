@@ -50,6 +50,7 @@
 #include <vector>
 
 #include "public/common/AMFFactory.h"
+#include "public/common/AMFSTL.h"
 #include "../common/ParametersStorage.h"
 #include "../common/TranscodePipeline.h"
 #include "../common/CmdLineParser.h"
@@ -252,6 +253,7 @@ private:
 
 static const wchar_t* PARAM_NAME_PREVIEW_MODE = L"PREVIEWMODE";
 static const wchar_t* PARAM_NAME_REPEAT       = L"REPEAT";
+static const wchar_t* PARAM_NAME_ALLOC_POOLS  = L"ALLOC_POOLS";
 
 
 static AMF_RESULT RegisterCodecParams(ParametersStorage* pParams)
@@ -270,6 +272,8 @@ AMF_RESULT RegisterParams(ParametersStorage* pParams)
     pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_SCALE_HEIGHT, ParamCommon, L"Frame height (integer, default = 0)", ParamConverterInt64);
     pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_FRAMES,       ParamCommon, L"Number of frames to render (in frames, default = 0 - means all )", ParamConverterInt64);
     pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_SCALE_TYPE,   ParamCommon, L"Frame height (integer, default = 0)", ParamConverterScaleType);
+    pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_STATS_INTERVAL, ParamCommon, L"Per-element pipeline stats dump period (in ms, default = 0 - off, 1000 if STATSFILE is set)", ParamConverterInt64);
+    pParams->SetParamDescription(TranscodePipeline::PARAM_NAME_STATS_FILE,     ParamCommon, L"Append pipeline stats to this file instead of the log (.json - one JSON object per line)", NULL);
 
     pParams->SetParamDescription(PARAM_NAME_ADAPTERID, ParamCommon, L"Index of GPU adapter (number, default = 0)", NULL);
     pParams->SetParamDescription(PARAM_NAME_ENGINE,    ParamCommon, L"Specifiy engine type (DX9, DX11, Vulkan)", NULL);
@@ -294,6 +298,7 @@ AMF_RESULT RegisterParams(ParametersStorage* pParams)
 
     // allow Transcode to run multiple times with the same paramters
     pParams->SetParamDescription(PARAM_NAME_REPEAT, ParamCommon, L"How many times the command should be executed with the same parameters (integer, default = 1)", ParamConverterInt64);
+    pParams->SetParamDescription(PARAM_NAME_ALLOC_POOLS, ParamCommon, L"Serve small sample-side allocations from slab pools and print allocation counters (bool, default = false)", ParamConverterBoolean);
     
     // allow Transcode to run decode with ffmpeg deocder.
     pParams->SetParamDescription(PARAM_NAME_SWDECODE, ParamCommon, L"Enable FFMPEG decoder.(true, false default = false)", ParamConverterBoolean);
@@ -385,6 +390,15 @@ int main(int argc, char* argv[])
 #endif
 
 
+    // pools only serve this module: the runtime and component libraries keep their own allocators
+    amf_bool allocPools = false;
+    params.GetParam(PARAM_NAME_ALLOC_POOLS, allocPools);
+    if (allocPools && !amf_alloc_enable_pools(0))
+    {
+        LOG_ERROR(L"Failed to enable allocation pools");
+        allocPools = false;
+    }
+
     // figure out the codec
     std::wstring codec = AMFVideoEncoderVCE_AVC;
     params.GetParamWString(PARAM_NAME_CODEC, codec);
@@ -530,6 +544,14 @@ int main(int argc, char* argv[])
         LOG_SUCCESS(messageStream.str());
     }
 
+    if (allocPools)
+    {
+        AMFAllocStatistics stats = {};
+        amf_alloc_get_statistics(&stats);
+        LOG_INFO(L"Allocations: heap " << stats.heapAllocations << L" pool " << stats.poolAllocations <<
+            L" slabs " << stats.slabs << L" depot transfers " << stats.depotTransfers);
+    }
+
     g_AMFFactory.Terminate();
     return 0;
 }
@@ -628,7 +628,7 @@ AMF_RESULT RenderEncodePipeline::Init(ParametersStorage* pParams, int threadID)
     amf::AMFDataStream::OpenDataStream(outputPath.c_str(), amf::AMFSO_WRITE, amf::AMFFS_SHARE_READ, &m_pStreamOut);
     CHECK_RETURN(m_pStreamOut != NULL, AMF_FILE_NOT_OPEN, "Open File" << outputPath);
 
-    m_pStreamWriter = PipelineElementPtr(new StreamWriter(m_pStreamOut));
+    m_pStreamWriter = PipelineElementPtr(new StreamWriter(m_pStreamOut, true));
 
 #define ASYNC_CONNECT 0 // fully asynchronous
 //#define ASYNC_CONNECT 1 // fully synchronous
@@ -667,7 +667,7 @@ AMF_RESULT RenderEncodePipeline::Init(ParametersStorage* pParams, int threadID)
     m_pStreamOut2 = AMFDataStream::Create(outputPath2.c_str(), AMF_FileWrite);
     CHECK_RETURN(m_pStreamOut2 != NULL, AMF_FILE_NOT_OPEN, "Open File" << outputPath2);
 
-    m_pStreamWriter2 = PipelineElementPtr(new StreamWriter(m_pStreamOut2));
+    m_pStreamWriter2 = PipelineElementPtr(new StreamWriter(m_pStreamOut2, true));
 
     m_pSplitter = SplitterPtr(new Splitter(false, 2, 10));
 
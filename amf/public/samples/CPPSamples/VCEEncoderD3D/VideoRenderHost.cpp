@@ -35,8 +35,7 @@
 #include "../common/CmdLogger.h"
 
 VideoRenderHost::VideoRenderHost(amf_int width, amf_int height, bool bInterlaced, amf_int frames, amf::AMFContext* pContext)
-    :VideoRender(width, height, bInterlaced, frames, pContext),
-    m_iAnimation(0)
+    :VideoRender(width, height, bInterlaced, frames, pContext)
 {
 }
 
@@ -45,121 +44,58 @@ VideoRenderHost::~VideoRenderHost()
     Terminate();
 }
 
+#define SQUARE_SIZE 50
+
 AMF_RESULT      VideoRenderHost::Init(amf_handle /* hWnd */, amf_handle /* hDisplay */, bool /* bFullScreen */)
 {
+    // frames come from a pool of host surfaces filled in parallel by SIMD line kernels,
+    // so the renderer does not allocate or loop over pixels on the encoder's input path
+    m_pGenerator = new FrameGenerator();
+    AMF_RESULT res = m_pGenerator->Init(m_pContext, GetFormat(), m_width, m_height);
+    CHECK_AMF_ERROR_RETURN(res, L"FrameGenerator::Init() failed");
+
+    // a red square moving down the diagonal and restarting at the top left corner: over black for
+    // NV12, black over red with zero alpha for BGRA
+    FrameGeneratorParams params;
+    params.patterns = FRAME_PATTERN_BOXES;
+    params.boxSize = SQUARE_SIZE;
+    params.motion = 1;
+    params.alpha = 0;
+    if(GetFormat() == amf::AMF_SURFACE_NV12)
+    {
+        const amf_uint8 black[3] = { 16, 128, 128 };
+        const amf_uint8 red[3] = { 81, 90, 240 };
+        memcpy(params.background, black, sizeof(black));
+        memcpy(params.foreground, red, sizeof(red));
+    }
+    else
+    {
+        const amf_uint8 red[3] = { 255, 0, 0 };
+        const amf_uint8 black[3] = { 0, 0, 0 };
+        memcpy(params.background, red, sizeof(red));
+        memcpy(params.foreground, black, sizeof(black));
+    }
+    m_pGenerator->SetParams(params);
     return AMF_OK;
 }
 AMF_RESULT VideoRenderHost::Terminate()
 {
+    if(m_pGenerator != NULL)
+    {
+        m_pGenerator->Terminate();
+        m_pGenerator = NULL;
+    }
     return AMF_OK;
 }
 
-#define SQUARE_SIZE 50
-
 AMF_RESULT VideoRenderHost::Render(amf::AMFData** ppData)
 {
-    AMF_RESULT res = AMF_OK;
-    amf::AMFSurfacePtr pSurface;
-    res = m_pContext->AllocSurface(amf::AMF_MEMORY_HOST, GetFormat(), m_width, m_height, &pSurface);
-    CHECK_AMF_ERROR_RETURN(res, L"AMFSurfrace::AllocSurface() failed");
-
-    if(GetFormat() == amf::AMF_SURFACE_NV12)
-    {
-
-        // black
-        amf_uint8 BlackY = 16;
-        amf_uint8 BlackU = 128;
-        amf_uint8 BlackV= 128;
-
-        amf::AMFPlanePtr plane = pSurface->GetPlane(amf::AMF_PLANE_Y);
-        amf_uint8 *data = (amf_uint8*)plane->GetNative();
-        for(amf_int32 y = 0; y < m_height; y++)
-        {
-            amf_uint8 *dataLine = data + y * plane->GetHPitch();
-            for(amf_int32 x = 0; x < m_width; x++)
-            {
-                *dataLine++ = BlackY;
-            }
-        }
-        plane = pSurface->GetPlane(amf::AMF_PLANE_UV);
-        data = (amf_uint8*)plane->GetNative();
-        for(amf_int32 y = 0; y < m_height/2; y++)
-        {
-            amf_uint8 *dataLine = data + y * plane->GetHPitch();
-            for(amf_int32 x = 0; x < m_width/2; x++)
-            {
-                *dataLine++ = BlackU;
-                *dataLine++ = BlackV;
-            }
-        }
-
-        // red
-        amf_uint8 RedY = 81;
-        amf_uint8 RedU = 90;
-        amf_uint8 RedV= 240;
+    CHECK_RETURN(m_pGenerator != NULL, AMF_NOT_INITIALIZED, L"VideoRenderHost::Render() - not initialized");
 
-        plane = pSurface->GetPlane(amf::AMF_PLANE_Y);
-        data = (amf_uint8*)plane->GetNative();
-
-
-        for(amf_int32 y = m_iAnimation; y < m_height && y < m_iAnimation + SQUARE_SIZE; y++)
-        {
-            amf_uint8 *dataLine = data + y * plane->GetHPitch() + m_iAnimation*1;
-            for(amf_int32 x = 0; x+ m_iAnimation < m_width && x < SQUARE_SIZE; x++)
-            {
-                *dataLine++ = RedY;
-            }
-        }
-        plane = pSurface->GetPlane(amf::AMF_PLANE_UV);
-        data = (amf_uint8*)plane->GetNative();
-
-        for(amf_int32 y = m_iAnimation /2; y < m_height/2 && y < m_iAnimation/2 + SQUARE_SIZE/2; y++)
-        {
-            amf_uint8 *dataLine = data + y * plane->GetHPitch() + m_iAnimation/2*2;
-            for(amf_int32 x = 0; x+ m_iAnimation/2 < m_width/2 && x < SQUARE_SIZE/2; x++)
-            {
-                *dataLine++ = RedU;
-                *dataLine++ = RedV;
-            }
-        }
-    }
-    else
-    {
-        amf::AMFPlanePtr plane = pSurface->GetPlane(amf::AMF_PLANE_PACKED);
+    amf::AMFSurfacePtr pSurface;
+    AMF_RESULT res = m_pGenerator->Generate(&pSurface);
+    CHECK_AMF_ERROR_RETURN(res, L"FrameGenerator::Generate() failed");
 
-        amf_uint8 *data = (amf_uint8*)plane->GetNative();
-        for(amf_int32 y = 0; y < m_height; y++)
-        {
-            amf_uint8 *dataLine = data + y * plane->GetHPitch();
-            for(amf_int32 x = 0; x < m_width; x++)
-            {
-                *dataLine++ = 0; // B
-                *dataLine++ = 0; // G
-                *dataLine++ = 0xFF; // R
-                *dataLine++ = 0; // A
-            }
-        }
-        // make black rectangle
-        for(amf_int32 y = m_iAnimation; y < m_height && y < m_iAnimation + SQUARE_SIZE; y++)
-        {
-            amf_uint8 *dataLine = data + y * plane->GetHPitch() + m_iAnimation*4;
-            for(amf_int32 x = 0; x+ m_iAnimation < m_width && x < SQUARE_SIZE; x++)
-            {
-                *dataLine++ = 0; // B
-                *dataLine++ = 0; // G
-                *dataLine++ = 0; // R
-                *dataLine++ = 0; // A
-            }
-        }
-    }
-    m_iAnimation++;
-    if(m_iAnimation + SQUARE_SIZE >= m_height)
-    {
-        m_iAnimation = 0;
-    }
-    if(pSurface)
-    {
-        *ppData = pSurface.Detach();
-    }
+    *ppData = pSurface.Detach();
     return res;
 }
@@ -34,6 +34,7 @@
 #pragma once
 
 #include "VideoRender.h"
+#include "../common/FrameGenerator.h"
 
 
 class VideoRenderHost : public VideoRender
@@ -49,6 +50,6 @@ public:
     virtual amf::AMF_SURFACE_FORMAT GetFormat() { return amf::AMF_SURFACE_NV12; }
 
 protected:
-    amf_int32   m_iAnimation;
+    FrameGeneratorPtr   m_pGenerator;
 };
 
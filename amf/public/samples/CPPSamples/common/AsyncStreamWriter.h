@@ -0,0 +1,561 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef AMF_AsyncStreamWriter_h
+#define AMF_AsyncStreamWriter_h
+
+#pragma once
+
+#include "public/include/core/Buffer.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/DataStream.h"
+#include "public/common/Thread.h"
+#include "public/common/TraceAdapter.h"
+#include <string.h>
+#include <sstream>
+#include <vector>
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#pragma push_macro("AMF_FACILITY")
+#undef AMF_FACILITY
+#define AMF_FACILITY L"AsyncStreamWriter"
+
+//-------------------------------------------------------------------------------------------------
+// AsyncStreamWriter - takes bitstream writes off the thread that drains the encoder.
+// Write() queues the buffer by reference and returns; a dedicated I/O thread swaps the queue
+// out and writes it as one batch while the producer keeps filling the other half. The number
+// of buffers and bytes held (queued plus in flight) is bounded: when the bound is reached
+// Write() waits up to the given timeout and then returns AMF_INPUT_FULL.
+// When opened by path on POSIX the batch goes out with writev(); with direct I/O it is packed
+// into an aligned staging buffer and written through O_DIRECT in sector multiples.
+// Opened on an AMFDataStream the batch is written with sequential AMFDataStream::Write().
+//-------------------------------------------------------------------------------------------------
+struct AsyncStreamWriterStats
+{
+    amf_int64   buffersQueued;
+    amf_int64   buffersWritten;
+    amf_int64   bytesWritten;
+    amf_int64   batches;
+    amf_int64   maxBatchBuffers;
+    amf_int64   queueDepthSum;      // buffers held, sampled on every Write()
+    amf_int64   maxQueueDepth;      // buffers
+    amf_int64   maxQueueBytes;
+    amf_int64   fullCount;          // Write() calls that found the queue full
+    amf_pts     blockedTime;        // time producers waited for space
+    amf_pts     writeTime;          // time the I/O thread spent writing
+    AMF_RESULT  lastError;
+};
+//-------------------------------------------------------------------------------------------------
+class AsyncStreamWriter : protected amf::AMFThread
+{
+public:
+    static constexpr amf_size DEFAULT_QUEUE_BUFFERS = 256;
+    static constexpr amf_size DEFAULT_QUEUE_BYTES = 32 * 1024 * 1024;
+    static constexpr amf_size DIRECT_IO_ALIGNMENT = 4096;
+    static constexpr amf_size DIRECT_IO_STAGING_SIZE = 4 * 1024 * 1024;
+
+    AsyncStreamWriter(amf_size maxQueueBuffers = DEFAULT_QUEUE_BUFFERS, amf_size maxQueueBytes = DEFAULT_QUEUE_BYTES)
+        : m_maxQueueBuffers(maxQueueBuffers > 0 ? maxQueueBuffers : 1),
+        m_maxQueueBytes(maxQueueBytes),
+        m_bOpen(false),
+        m_bWriting(false),
+        m_eError(AMF_OK),
+        m_pendingBytes(0),
+        m_inFlightBuffers(0),
+        m_inFlightBytes(0),
+        m_DataEvent(false, false),
+        m_SpaceEvent(false, false),
+        m_file(-1),
+        m_bDirectIO(false),
+        m_pStaging(NULL),
+        m_stagingUsed(0)
+    {
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    virtual ~AsyncStreamWriter()
+    {
+        Close();
+    }
+
+    // writes through the stream; the stream is not closed by Close()
+    AMF_RESULT Open(amf::AMFDataStream* pStream)
+    {
+        AMF_RETURN_IF_FALSE(pStream != NULL, AMF_INVALID_ARG, L"Open() - pStream == NULL");
+        AMF_RETURN_IF_FALSE(!m_bOpen, AMF_ALREADY_INITIALIZED, L"Open() - already open");
+        m_pStream = pStream;
+        return StartThread();
+    }
+
+    // bDirectIO is a hint: it falls back to buffered I/O where O_DIRECT is not available
+    AMF_RESULT Open(const wchar_t* pFilePath, bool bDirectIO = false)
+    {
+        AMF_RETURN_IF_FALSE(pFilePath != NULL, AMF_INVALID_ARG, L"Open() - pFilePath == NULL");
+        AMF_RETURN_IF_FALSE(!m_bOpen, AMF_ALREADY_INITIALIZED, L"Open() - already open");
+#if defined(_WIN32)
+        (void)bDirectIO;
+        AMF_RETURN_IF_FAILED(amf::AMFDataStream::OpenDataStream(pFilePath, amf::AMFSO_WRITE, amf::AMFFS_SHARE_READ, &m_pStream),
+            L"Failed to open %s", pFilePath);
+#else
+        const amf_string path = amf::amf_from_unicode_to_multibyte(pFilePath);
+        const int flags = O_CREAT | O_TRUNC | O_WRONLY;
+#if defined(O_DIRECT)
+        if(bDirectIO)
+        {
+            m_file = open(path.c_str(), flags | O_DIRECT, 0666);
+            m_bDirectIO = m_file >= 0; // EINVAL on file systems without direct I/O support
+        }
+#endif
+        if(m_file < 0)
+        {
+            m_file = open(path.c_str(), flags, 0666);
+        }
+        AMF_RETURN_IF_FALSE(m_file >= 0, AMF_FILE_NOT_OPEN, L"Failed to open %s", pFilePath);
+        if(m_bDirectIO)
+        {
+            m_pStaging = (amf_uint8*)amf_aligned_alloc(DIRECT_IO_STAGING_SIZE, DIRECT_IO_ALIGNMENT);
+            m_stagingUsed = 0;
+            if(m_pStaging == NULL)
+            {
+                CloseFile();
+                return AMF_OUT_OF_MEMORY;
+            }
+        }
+#endif
+        return StartThread();
+    }
+
+    bool IsOpen() const { return m_bOpen; }
+    bool IsDirectIO() const { return m_bDirectIO; }
+
+    // ulTimeout (ms) bounds the wait for space: 0 returns AMF_INPUT_FULL right away
+    AMF_RESULT Write(amf::AMFBuffer* pBuffer, amf_ulong ulTimeout = AMF_INFINITE)
+    {
+        AMF_RETURN_IF_FALSE(pBuffer != NULL, AMF_INVALID_ARG, L"Write() - pBuffer == NULL");
+        const amf_size size = pBuffer->GetSize();
+        const amf_pts start = amf_high_precision_clock();
+        bool bCountedFull = false;
+
+        amf::AMFLock lock(&m_cs);
+        AMF_RETURN_IF_FALSE(m_bOpen, AMF_NOT_INITIALIZED, L"Write() - not open");
+        while(m_eError == AMF_OK && !HasSpace(size))
+        {
+            if(!bCountedFull)
+            {
+                m_stats.fullCount++;
+                bCountedFull = true;
+            }
+            amf_ulong wait = WAIT_SLICE;
+            if(ulTimeout != AMF_INFINITE)
+            {
+                const amf_pts elapsed = (amf_high_precision_clock() - start) / AMF_MILLISECOND;
+                if(elapsed >= (amf_pts)ulTimeout)
+                {
+                    m_stats.blockedTime += amf_high_precision_clock() - start;
+                    return AMF_INPUT_FULL;
+                }
+                wait = AMF_MIN(wait, ulTimeout - (amf_ulong)elapsed);
+            }
+            lock.Unlock();
+            m_SpaceEvent.Lock(wait);
+            lock.Lock();
+        }
+        if(bCountedFull)
+        {
+            m_stats.blockedTime += amf_high_precision_clock() - start;
+        }
+        if(m_eError != AMF_OK)
+        {
+            return m_eError;
+        }
+
+        m_pending.push_back(amf::AMFBufferPtr(pBuffer));
+        m_pendingBytes += size;
+
+        const amf_int64 depth = (amf_int64)(m_pending.size() + m_inFlightBuffers);
+        const amf_int64 bytes = (amf_int64)(m_pendingBytes + m_inFlightBytes);
+        m_stats.buffersQueued++;
+        m_stats.queueDepthSum += depth;
+        m_stats.maxQueueDepth = AMF_MAX(m_stats.maxQueueDepth, depth);
+        m_stats.maxQueueBytes = AMF_MAX(m_stats.maxQueueBytes, bytes);
+        lock.Unlock();
+
+        m_DataEvent.SetEvent();
+        return AMF_OK;
+    }
+
+    // waits until every queued buffer reached the file; returns the first I/O error if any
+    AMF_RESULT Flush()
+    {
+        amf::AMFLock lock(&m_cs);
+        while(m_bOpen && m_eError == AMF_OK && (!m_pending.empty() || m_bWriting))
+        {
+            lock.Unlock();
+            m_DataEvent.SetEvent();
+            m_SpaceEvent.Lock(WAIT_SLICE);
+            lock.Lock();
+        }
+        return m_eError;
+    }
+
+    AMF_RESULT Close()
+    {
+        {
+            amf::AMFLock lock(&m_cs);
+            if(!m_bOpen)
+            {
+                return m_eError;
+            }
+        }
+        Flush();
+        RequestStop();
+        m_DataEvent.SetEvent();
+        WaitForStop();
+
+        amf::AMFLock lock(&m_cs);
+        m_bOpen = false;
+        AMF_RESULT res = WriteStagingTail();
+        if(m_eError == AMF_OK)
+        {
+            m_eError = res;
+        }
+        m_pending.clear();
+        m_pendingBytes = 0;
+        m_pStream = NULL;
+        CloseFile();
+        return m_eError;
+    }
+
+    amf_size GetQueueDepth() const
+    {
+        amf::AMFLock lock(&m_cs);
+        return m_pending.size() + m_inFlightBuffers;
+    }
+
+    amf_size GetQueueBytes() const
+    {
+        amf::AMFLock lock(&m_cs);
+        return m_pendingBytes + m_inFlightBytes;
+    }
+
+    void GetStatistics(AsyncStreamWriterStats* pStats) const
+    {
+        amf::AMFLock lock(&m_cs);
+        *pStats = m_stats;
+        pStats->lastError = m_eError;
+    }
+
+    std::wstring GetDisplayResult() const
+    {
+        AsyncStreamWriterStats stats;
+        GetStatistics(&stats);
+        std::wstringstream messageStream;
+        messageStream << L" Async writer: " << stats.buffersWritten << L" buffers in " << stats.batches << L" batches (max " << stats.maxBatchBuffers << L")";
+        if(stats.buffersQueued > 0)
+        {
+            messageStream << L", queue depth avg " << stats.queueDepthSum / stats.buffersQueued << L" max " << stats.maxQueueDepth
+                << L" (" << stats.maxQueueBytes / 1024 << L" KB)";
+        }
+        messageStream << L", full " << stats.fullCount << L" times, blocked " << stats.blockedTime / AMF_MILLISECOND << L" ms"
+            << L", write " << stats.writeTime / AMF_MILLISECOND << L" ms";
+        return messageStream.str();
+    }
+
+protected:
+    static constexpr amf_ulong WAIT_SLICE = 10; // ms - auto-reset events may wake only one of several waiters
+
+    AMF_RESULT StartThread()
+    {
+        {
+            amf::AMFLock lock(&m_cs);
+            m_bOpen = true;
+            m_eError = AMF_OK;
+            memset(&m_stats, 0, sizeof(m_stats));
+        }
+        if(!Start())
+        {
+            amf::AMFLock lock(&m_cs);
+            m_bOpen = false;
+            m_pStream = NULL;
+            CloseFile();
+            return AMF_FAIL;
+        }
+        return AMF_OK;
+    }
+
+    virtual void Run() override
+    {
+        std::vector<amf::AMFBufferPtr> batch;
+        while(true)
+        {
+            {
+                amf::AMFLock lock(&m_cs);
+                if(m_eError != AMF_OK)
+                {
+                    m_pending.clear(); // the file is broken - drop instead of writing past the failure
+                    m_pendingBytes = 0;
+                }
+                if(m_pending.empty())
+                {
+                    if(StopRequested())
+                    {
+                        break;
+                    }
+                    lock.Unlock();
+                    m_DataEvent.Lock(WAIT_SLICE * 5);
+                    continue;
+                }
+                // double buffering: the producer refills m_pending while this batch is written
+                batch.swap(m_pending);
+                m_inFlightBuffers = batch.size();
+                m_inFlightBytes = m_pendingBytes;
+                m_pendingBytes = 0;
+                m_bWriting = true;
+            }
+
+            const amf_pts start = amf_high_precision_clock();
+            AMF_RESULT res = WriteBatch(batch);
+            const amf_pts duration = amf_high_precision_clock() - start;
+
+            amf::AMFLock lock(&m_cs);
+            if(res == AMF_OK)
+            {
+                m_stats.buffersWritten += (amf_int64)batch.size();
+                m_stats.bytesWritten += (amf_int64)m_inFlightBytes;
+            }
+            else if(m_eError == AMF_OK)
+            {
+                m_eError = res;
+            }
+            m_stats.batches++;
+            m_stats.maxBatchBuffers = AMF_MAX(m_stats.maxBatchBuffers, (amf_int64)batch.size());
+            m_stats.writeTime += duration;
+            batch.clear(); // releases the buffers, capacity is kept for the next swap
+            m_inFlightBuffers = 0;
+            m_inFlightBytes = 0;
+            m_bWriting = false;
+            lock.Unlock();
+            m_SpaceEvent.SetEvent();
+        }
+    }
+
+    bool HasSpace(amf_size size) const
+    {
+        const amf_size buffers = m_pending.size() + m_inFlightBuffers;
+        const amf_size bytes = m_pendingBytes + m_inFlightBytes;
+        if(buffers == 0)
+        {
+            return true; // a single buffer larger than the byte bound still goes through
+        }
+        return buffers < m_maxQueueBuffers && (m_maxQueueBytes == 0 || bytes + size <= m_maxQueueBytes);
+    }
+
+    AMF_RESULT WriteBatch(const std::vector<amf::AMFBufferPtr>& batch)
+    {
+        if(m_pStream != NULL)
+        {
+            for(std::vector<amf::AMFBufferPtr>::const_iterator it = batch.begin(); it != batch.end(); ++it)
+            {
+                const amf_size towrite = (*it)->GetSize();
+                amf_size written = 0;
+                AMF_RETURN_IF_FAILED(m_pStream->Write((*it)->GetNative(), towrite, &written));
+                AMF_RETURN_IF_FALSE(written == towrite, AMF_FAIL, L"Failed to write %d bytes", (int)towrite);
+            }
+            return AMF_OK;
+        }
+#if !defined(_WIN32)
+        if(m_bDirectIO)
+        {
+            return WriteStaged(batch);
+        }
+        return WriteVectored(batch);
+#else
+        return AMF_FILE_NOT_OPEN;
+#endif
+    }
+
+#if !defined(_WIN32)
+    static AMF_RESULT WriteAll(int file, const void* pData, amf_size size)
+    {
+        const amf_uint8* pBytes = (const amf_uint8*)pData;
+        while(size > 0)
+        {
+            const ssize_t written = write(file, pBytes, size);
+            if(written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            AMF_RETURN_IF_FALSE(written > 0, AMF_FAIL, L"write() failed, errno=%d", errno);
+            pBytes += written;
+            size -= (amf_size)written;
+        }
+        return AMF_OK;
+    }
+
+    AMF_RESULT WriteVectored(const std::vector<amf::AMFBufferPtr>& batch)
+    {
+#if defined(IOV_MAX)
+        const amf_size maxVectors = IOV_MAX;
+#else
+        const amf_size maxVectors = 1024;
+#endif
+        m_vectors.resize(batch.size());
+        for(amf_size i = 0; i < batch.size(); i++)
+        {
+            m_vectors[i].iov_base = batch[i]->GetNative();
+            m_vectors[i].iov_len = batch[i]->GetSize();
+        }
+        amf_size first = 0;
+        while(first < m_vectors.size())
+        {
+            const amf_size count = AMF_MIN(maxVectors, m_vectors.size() - first);
+            const ssize_t written = writev(m_file, &m_vectors[first], (int)count);
+            if(written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            AMF_RETURN_IF_FALSE(written >= 0, AMF_FAIL, L"writev() failed, errno=%d", errno);
+            // skip what went out; a short write resumes inside the partially written vector
+            amf_size left = (amf_size)written;
+            while(first < m_vectors.size() && left >= m_vectors[first].iov_len)
+            {
+                left -= m_vectors[first].iov_len;
+                first++;
+            }
+            if(left > 0)
+            {
+                m_vectors[first].iov_base = (amf_uint8*)m_vectors[first].iov_base + left;
+                m_vectors[first].iov_len -= left;
+            }
+        }
+        return AMF_OK;
+    }
+
+    // O_DIRECT needs aligned memory, offsets and sizes: only whole sectors leave the staging buffer,
+    // the remainder is carried into the next batch and written without O_DIRECT on Close()
+    AMF_RESULT WriteStaged(const std::vector<amf::AMFBufferPtr>& batch)
+    {
+        for(std::vector<amf::AMFBufferPtr>::const_iterator it = batch.begin(); it != batch.end(); ++it)
+        {
+            const amf_uint8* pData = (const amf_uint8*)(*it)->GetNative();
+            amf_size size = (*it)->GetSize();
+            while(size > 0)
+            {
+                const amf_size chunk = AMF_MIN(size, DIRECT_IO_STAGING_SIZE - m_stagingUsed);
+                memcpy(m_pStaging + m_stagingUsed, pData, chunk);
+                m_stagingUsed += chunk;
+                pData += chunk;
+                size -= chunk;
+                if(m_stagingUsed == DIRECT_IO_STAGING_SIZE)
+                {
+                    AMF_RETURN_IF_FAILED(WriteAll(m_file, m_pStaging, m_stagingUsed));
+                    m_stagingUsed = 0;
+                }
+            }
+        }
+        const amf_size aligned = m_stagingUsed / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+        if(aligned > 0)
+        {
+            AMF_RETURN_IF_FAILED(WriteAll(m_file, m_pStaging, aligned));
+            memmove(m_pStaging, m_pStaging + aligned, m_stagingUsed - aligned);
+            m_stagingUsed -= aligned;
+        }
+        return AMF_OK;
+    }
+#endif
+
+    AMF_RESULT WriteStagingTail()
+    {
+#if !defined(_WIN32) && defined(O_DIRECT)
+        if(m_bDirectIO && m_file >= 0 && m_stagingUsed > 0 && m_eError == AMF_OK)
+        {
+            fcntl(m_file, F_SETFL, fcntl(m_file, F_GETFL) & ~O_DIRECT);
+            const AMF_RESULT res = WriteAll(m_file, m_pStaging, m_stagingUsed);
+            m_stagingUsed = 0;
+            return res;
+        }
+#endif
+        return AMF_OK;
+    }
+
+    void CloseFile()
+    {
+#if !defined(_WIN32)
+        if(m_file >= 0)
+        {
+            close(m_file);
+            m_file = -1;
+        }
+#endif
+        if(m_pStaging != NULL)
+        {
+            amf_aligned_free(m_pStaging);
+            m_pStaging = NULL;
+        }
+        m_stagingUsed = 0;
+        m_bDirectIO = false;
+    }
+
+    const amf_size                  m_maxQueueBuffers;
+    const amf_size                  m_maxQueueBytes;
+
+    mutable amf::AMFCriticalSection m_cs;
+    bool                            m_bOpen;
+    bool                            m_bWriting;
+    AMF_RESULT                      m_eError;
+    std::vector<amf::AMFBufferPtr>  m_pending;
+    amf_size                        m_pendingBytes;
+    amf_size                        m_inFlightBuffers;
+    amf_size                        m_inFlightBytes;
+    AsyncStreamWriterStats          m_stats;
+    amf::AMFEvent                   m_DataEvent;
+    amf::AMFEvent                   m_SpaceEvent;
+
+    // I/O thread only
+    amf::AMFDataStreamPtr           m_pStream;
+    int                             m_file;
+    bool                            m_bDirectIO;
+    amf_uint8*                      m_pStaging;
+    amf_size                        m_stagingUsed;
+#if !defined(_WIN32)
+    std::vector<struct iovec>       m_vectors;
+#endif
+};
+//-------------------------------------------------------------------------------------------------
+#pragma pop_macro("AMF_FACILITY")
+
+#endif // AMF_AsyncStreamWriter_h
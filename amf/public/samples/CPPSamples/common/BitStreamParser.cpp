@@ -41,6 +41,20 @@
 #include "BitStreamParserH265.h"
 #include "BitStreamParserIVF.h"
 
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || (defined(__i386__) && defined(__SSE2__))
+    #define PARSER_SIMD_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define PARSER_TARGET_AVX2
+    #else
+        #define PARSER_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define PARSER_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
 BitStreamParser::~BitStreamParser()
 {
 }
@@ -124,3 +138,336 @@ BitStreamParserPtr BitStreamParser::Create(amf::AMFDataStream* pStream, BitStrea
     }
     return pParser;
 }
+//-------------------------------------------------------------------------------------------------
+// Annex-B scanning
+//-------------------------------------------------------------------------------------------------
+namespace
+{
+    typedef size_t (*FindPrefixFunc)(const amf_uint8 *data, size_t size, amf_uint8 last);
+
+    // finds 00 00 <last>; a byte that is neither 0 nor <last> can't be part of a match starting
+    // at any of the three positions before it, so the scan advances by three in that case
+    size_t FindPrefixScalar(const amf_uint8 *data, size_t size, size_t pos, amf_uint8 last)
+    {
+        while(pos + 2 < size)
+        {
+            const amf_uint8 ch = data[pos + 2];
+            if(ch == last)
+            {
+                if(data[pos + 1] == 0 && data[pos] == 0)
+                {
+                    return pos;
+                }
+                pos += 3;
+            }
+            else if(ch != 0)
+            {
+                pos += 3;
+            }
+            else
+            {
+                pos++;
+            }
+        }
+        return size;
+    }
+
+    size_t FindPrefixScalar(const amf_uint8 *data, size_t size, amf_uint8 last)
+    {
+        return FindPrefixScalar(data, size, 0, last);
+    }
+
+#if defined(PARSER_SIMD_X86)
+    inline amf_uint32 LowestSetBit(amf_uint32 mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return (amf_uint32)__builtin_ctz(mask);
+#endif
+    }
+
+    // compares 16 positions per step: byte[i] == 0 && byte[i + 1] == 0 && byte[i + 2] == last
+    size_t FindPrefixSSE2(const amf_uint8 *data, size_t size, amf_uint8 last)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i third = _mm_set1_epi8((char)last);
+        size_t pos = 0;
+        for(; pos + 18 <= size; pos += 16)
+        {
+            const __m128i v0 = _mm_loadu_si128((const __m128i*)(data + pos));
+            const __m128i v1 = _mm_loadu_si128((const __m128i*)(data + pos + 1));
+            const __m128i v2 = _mm_loadu_si128((const __m128i*)(data + pos + 2));
+            const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(v0, zero), _mm_cmpeq_epi8(v1, zero)), _mm_cmpeq_epi8(v2, third));
+            const amf_uint32 mask = (amf_uint32)_mm_movemask_epi8(match);
+            if(mask != 0)
+            {
+                return pos + LowestSetBit(mask);
+            }
+        }
+        return FindPrefixScalar(data, size, pos, last);
+    }
+
+    PARSER_TARGET_AVX2 size_t FindPrefixAVX2(const amf_uint8 *data, size_t size, amf_uint8 last)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i third = _mm256_set1_epi8((char)last);
+        size_t pos = 0;
+        for(; pos + 34 <= size; pos += 32)
+        {
+            const __m256i v0 = _mm256_loadu_si256((const __m256i*)(data + pos));
+            const __m256i v1 = _mm256_loadu_si256((const __m256i*)(data + pos + 1));
+            const __m256i v2 = _mm256_loadu_si256((const __m256i*)(data + pos + 2));
+            const __m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(v0, zero), _mm256_cmpeq_epi8(v1, zero)), _mm256_cmpeq_epi8(v2, third));
+            const amf_uint32 mask = (amf_uint32)_mm256_movemask_epi8(match);
+            if(mask != 0)
+            {
+                return pos + LowestSetBit(mask);
+            }
+        }
+        return FindPrefixScalar(data, size, pos, last);
+    }
+
+    bool CpuSupportsAVX2()
+    {
+#if defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0);
+        if(regs[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(regs, 1);
+        const bool bOsSavesYmm = (regs[2] & (1 << 27)) != 0 && (regs[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+        if(!bOsSavesYmm)
+        {
+            return false;
+        }
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif // PARSER_SIMD_X86
+
+#if defined(PARSER_SIMD_NEON)
+    size_t FindPrefixNEON(const amf_uint8 *data, size_t size, amf_uint8 last)
+    {
+        const uint8x16_t zero = vdupq_n_u8(0);
+        const uint8x16_t third = vdupq_n_u8(last);
+        size_t pos = 0;
+        for(; pos + 18 <= size; pos += 16)
+        {
+            const uint8x16_t v0 = vld1q_u8(data + pos);
+            const uint8x16_t v1 = vld1q_u8(data + pos + 1);
+            const uint8x16_t v2 = vld1q_u8(data + pos + 2);
+            const uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(v0, zero), vceqq_u8(v1, zero)), vceqq_u8(v2, third));
+            const uint8x8_t folded = vorr_u8(vget_low_u8(match), vget_high_u8(match));
+            if(vget_lane_u64(vreinterpret_u64_u8(folded), 0) != 0)
+            {
+                return FindPrefixScalar(data, pos + 18, pos, last);
+            }
+        }
+        return FindPrefixScalar(data, size, pos, last);
+    }
+#endif // PARSER_SIMD_NEON
+
+    FindPrefixFunc SelectFindPrefix()
+    {
+#if defined(PARSER_SIMD_X86)
+        return CpuSupportsAVX2() ? FindPrefixAVX2 : FindPrefixSSE2;
+#elif defined(PARSER_SIMD_NEON)
+        return FindPrefixNEON;
+#else
+        return FindPrefixScalar;
+#endif
+    }
+
+    size_t FindPrefix(const amf_uint8 *data, size_t size, amf_uint8 last)
+    {
+        static const FindPrefixFunc s_FindPrefix = SelectFindPrefix();
+        return s_FindPrefix(data, size, last);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+size_t Parser::FindStartCode(const amf_uint8 *data, size_t size)
+{
+    return FindPrefix(data, size, 0x01);
+}
+//-------------------------------------------------------------------------------------------------
+size_t Parser::FindEmulationPrevention(const amf_uint8 *data, size_t size)
+{
+    return FindPrefix(data, size, 0x03);
+}
+//-------------------------------------------------------------------------------------------------
+size_t Parser::EBSPtoRBSP(amf_uint8 *data, size_t size)
+{
+    size_t read = 0;
+    size_t write = 0;
+    while(read < size)
+    {
+        const size_t found = read + FindEmulationPrevention(data + read, size - read);
+        if(found >= size)
+        {
+            memmove(data + write, data + read, size - read);
+            write += size - read;
+            break;
+        }
+        // keep 00 00, drop 03
+        const size_t run = found + 2 - read;
+        memmove(data + write, data + read, run);
+        write += run;
+        read = found + 3;
+
+        // in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any byte-aligned position,
+        // so the byte after 0x000003 is at most 0x03; a final 0x03 after cabac_zero_words is discarded.
+        // Malformed data is cut off here so that a bounded reader stops at the damage
+        if(read < size && data[read] > 0x03)
+        {
+            break;
+        }
+    }
+    return write;
+}
+//-------------------------------------------------------------------------------------------------
+Parser::StreamWindow::StreamWindow(amf::AMFDataStream *pStream, size_t capacity) :
+    m_pStream(pStream),
+    m_pData(NULL),
+    m_Begin(0),
+    m_End(0),
+    m_Capacity(capacity),
+    m_bMapped(false),
+    m_bStarted(false),
+    m_bEof(false)
+{
+}
+//-------------------------------------------------------------------------------------------------
+void Parser::StreamWindow::Reset()
+{
+    m_pData = m_Buffer.GetData();
+    m_Begin = 0;
+    m_End = 0;
+    m_bMapped = false;
+    m_bStarted = false;
+    m_bEof = false;
+}
+//-------------------------------------------------------------------------------------------------
+size_t Parser::StreamWindow::Fill(size_t readSize)
+{
+    if(m_bEof)
+    {
+        return 0;
+    }
+    if(!m_bStarted)
+    {
+        m_bStarted = true;
+
+        // a mapped stream is exposed in one piece from the current position to the end
+        amf::AMFDataStreamViewPtr pView(m_pStream);
+        amf_int64 position = 0;
+        amf_int64 size = 0;
+        if(pView != NULL && pView->IsMapped() &&
+            pView->GetPosition(&position) == AMF_OK && pView->GetSize(&size) == AMF_OK && size > position)
+        {
+            const amf_uint8 *pData = NULL;
+            amf_size available = 0;
+            if(pView->GetView(amf_size(size - position), &pData, &available) == AMF_OK)
+            {
+                m_bMapped = true;
+                m_pData = pData;
+                m_Begin = 0;
+                m_End = available;
+                return available;
+            }
+        }
+    }
+    if(m_bMapped)
+    {
+        m_bEof = true;
+        return 0;
+    }
+
+    if(m_End + readSize > m_Buffer.GetSize())
+    {
+        // move the unconsumed tail to the front; this happens about once per window capacity
+        if(m_Begin > 0)
+        {
+            memmove(m_Buffer.GetData(), m_Buffer.GetData() + m_Begin, m_End - m_Begin);
+            m_End -= m_Begin;
+            m_Begin = 0;
+        }
+        // the window grows only when a single packet does not fit
+        if(m_End + readSize > m_Buffer.GetSize())
+        {
+            m_Buffer.SetSize(AMF_MAX(AMF_MAX(m_Capacity, m_Buffer.GetSize() * 2), m_End + readSize));
+        }
+        m_pData = m_Buffer.GetData();
+    }
+
+    amf_size ready = 0;
+    m_pStream->Read(m_Buffer.GetData() + m_End, readSize, &ready);
+    m_End += ready;
+    m_bEof = ready == 0;
+    return ready;
+}
+//-------------------------------------------------------------------------------------------------
+void Parser::StreamWindow::Consume(size_t size)
+{
+    size = AMF_MIN(size, GetSize());
+    m_Begin += size;
+    if(m_bMapped)
+    {
+        // keep the stream position in step with what the parser has taken
+        m_pStream->Seek(amf::AMF_SEEK_CURRENT, amf_int64(size), NULL);
+    }
+    else if(m_Begin == m_End)
+    {
+        m_Begin = 0;
+        m_End = 0;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+bool Parser::ReadNextNaluUnit(StreamWindow &window, size_t readSize, size_t *offset, size_t *nalu)
+{
+    const size_t startOffset = *offset;
+    size_t searchFrom = startOffset;
+    for(;;)
+    {
+        const size_t dataSize = window.GetSize();
+        if(searchFrom < dataSize)
+        {
+            const amf_uint8 *data = window.GetData();
+            const size_t found = searchFrom + FindStartCode(data + searchFrom, dataSize - searchFrom);
+            if(found < dataSize)
+            {
+                // leading zero bytes (zero_byte, trailing_zero_8bits) belong to the start code
+                size_t prefix = found;
+                while(prefix > startOffset && data[prefix - 1] == 0)
+                {
+                    prefix--;
+                }
+                if(prefix > startOffset)
+                {
+                    *offset = prefix;
+                    return true; // new NAL
+                }
+                *nalu = found + 3;
+                searchFrom = found + 3;
+                continue;
+            }
+            // a start code may straddle the end of the data read so far
+            searchFrom = AMF_MAX(searchFrom, dataSize - AMF_MIN(dataSize, size_t(2)));
+        }
+
+        // read next portion
+        if(window.Fill(readSize) == 0)
+        {
+            *offset = dataSize;
+            return startOffset != dataSize;
+        }
+    }
+}
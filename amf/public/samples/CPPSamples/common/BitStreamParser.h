@@ -33,8 +33,14 @@
 #pragma once
 
 #include "public/include/core/Context.h"
+#include "public/common/ByteArray.h"
 #include "PipelineElement.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <string.h>
+
 enum BitStreamType
 {
     BitStreamH264AnnexB,
@@ -96,73 +102,217 @@ namespace Parser
         return (data & 0xFF);
     }
 
-    inline bool getBit(const amf_uint8 *data, size_t &bitIdx)
-    {
-        bool ret = (data[bitIdx / 8] >> (7 - bitIdx % 8) & 1);
-        bitIdx++;
-        return ret;
-    }
-    inline amf_uint32 getBitToUint32(const amf_uint8 *data, size_t &bitIdx)
+    // Annex-B scanning shared by the H.264 and H.265 parsers; vectorized with SSE2/AVX2/NEON
+    // where the CPU allows it, scalar otherwise
+
+    // returns the offset of the first 00 00 01 start code prefix in data, or size if there is none
+    size_t FindStartCode(const amf_uint8 *data, size_t size);
+    // returns the offset of the first 00 00 03 emulation prevention sequence in data, or size if there is none
+    size_t FindEmulationPrevention(const amf_uint8 *data, size_t size);
+    // removes emulation prevention bytes in place; returns the RBSP size, truncated at the first
+    // malformed emulation prevention sequence
+    size_t EBSPtoRBSP(amf_uint8 *data, size_t size);
+
+    // Sliding read window over an elementary stream. The unconsumed bytes are always contiguous
+    // at GetData(); Consume() drops bytes from the front without moving the rest, and the buffer
+    // is compacted only when a read no longer fits behind the data. Memory mapped streams
+    // (AMFDataStreamView::IsMapped()) are not copied at all - the window points into the mapping.
+    class StreamWindow
     {
-        amf_uint32 ret = (data[bitIdx / 8] >> (7 - bitIdx % 8) & 1);
-        bitIdx++;
-        return ret;
-    }
+    public:
+        static const size_t DefaultCapacity = 4 * 1024 * 1024;
+
+        explicit StreamWindow(amf::AMFDataStream *pStream, size_t capacity = DefaultCapacity);
 
-    inline amf_uint32 readBits(const amf_uint8 *data, size_t &startBitIdx, size_t bitsToRead)
+        const amf_uint8    *GetData() const { return m_pData + m_Begin; }
+        size_t              GetSize() const { return m_End - m_Begin; }
+        bool                IsEof() const { return m_bEof; }
+
+        // appends up to readSize more bytes from the stream; returns the number of bytes added,
+        // 0 at the end of the stream. Pointers returned by GetData() before the call are invalidated
+        size_t              Fill(size_t readSize);
+        // drops size bytes from the front of the window
+        void                Consume(size_t size);
+        // forgets the window contents; call after the stream was repositioned
+        void                Reset();
+
+    private:
+        amf::AMFDataStreamPtr   m_pStream;
+        AMFByteArray            m_Buffer;
+        const amf_uint8        *m_pData;
+        size_t                  m_Begin;
+        size_t                  m_End;
+        size_t                  m_Capacity;
+        bool                    m_bMapped;
+        bool                    m_bStarted;
+        bool                    m_bEof;
+    };
+
+    // finds the NAL unit that follows *offset in the window, reading more in readSize portions
+    // as needed. On success *nalu is the first byte after the start code and *offset is the start
+    // of the next start code (or the end of the data at EOF); both are relative to GetData()
+    bool ReadNextNaluUnit(StreamWindow &window, size_t readSize, size_t *offset, size_t *nalu);
+
+    // MSB-first reader for RBSP payloads (parameter sets, slice headers). Keeps up to 64 bits
+    // cached so that u(n) is a shift and ue(v)/se(v) decode from a single count-leading-zeros.
+    // Reading past the end of the payload yields zero bits and sets the overrun flag
+    class BitReader
     {
-        if (bitsToRead > 32)
+    public:
+        BitReader(const amf_uint8 *data, size_t size, size_t startBitIdx = 0) :
+            m_pData(data),
+            m_Size(size),
+            m_BytePos(0),
+            m_Cache(0),
+            m_CacheBits(0),
+            m_bOverrun(false)
         {
-            return 0; // assert(0);
+            if (startBitIdx / 8 < size)
+            {
+                m_BytePos = startBitIdx / 8;
+                Refill();
+                Consume(startBitIdx % 8);
+            }
+            else
+            {
+                m_BytePos = size;
+                m_bOverrun = startBitIdx > size * 8;
+            }
         }
-        amf_uint32 result = 0;
-        for (size_t i = 0; i < bitsToRead; i++)
+
+        // u(1)
+        inline bool ReadBit()
         {
-            result = result << 1;
-            result |= getBitToUint32(data, startBitIdx); // startBitIdx incremented inside
+            return ReadBits(1) != 0;
         }
-        return result;
-    }
 
-    inline size_t countContiniusZeroBits(const amf_uint8 *data, size_t &startBitIdx)
-    {
-        size_t startBitIdxOrg = startBitIdx;
-        while (getBit(data, startBitIdx) == false) // startBitIdx incremented inside
+        // u(n), n <= 32
+        inline amf_uint32 ReadBits(size_t count)
         {
+            if (count == 0 || count > 32)
+            {
+                return 0; // assert(0);
+            }
+            if (m_CacheBits < count)
+            {
+                Refill();
+            }
+            const amf_uint32 result = static_cast<amf_uint32>(m_Cache >> (64 - count));
+            Consume(count);
+            return result;
         }
-        startBitIdx--; // remove non zero
-        return startBitIdx - startBitIdxOrg;
-    }
 
-    namespace ExpGolomb
-    {
-        inline amf_uint32 readUe(const amf_uint8 *data, size_t &startBitIdx)
+        inline void SkipBits(size_t count)
+        {
+            while (count > 32)
+            {
+                ReadBits(32);
+                count -= 32;
+            }
+            ReadBits(count);
+        }
+
+        // ue(v)
+        inline amf_uint32 ReadUe()
         {
-            size_t zeroBitsCount = countContiniusZeroBits(data, startBitIdx); // startBitIdx incremented inside
+            if (m_CacheBits < 32)
+            {
+                Refill();
+            }
+            const size_t zeroBitsCount = CountLeadingZeros(m_Cache);
+            if (zeroBitsCount < 16)
+            {
+                // the whole codeword is in the cache: 0..0 1 x..x read as one number is value + 1
+                return ReadBits(2 * zeroBitsCount + 1) - 1;
+            }
             if (zeroBitsCount > 30)
             {
+                SkipBits(zeroBitsCount);
                 return 0; // assert(0)
             }
+            Consume(zeroBitsCount + 1);
+            return ((1u << zeroBitsCount) - 1) + ReadBits(zeroBitsCount);
+        }
 
-            amf_uint32 leftPart = (0x1 << zeroBitsCount) - 1;
-            startBitIdx++;
-            amf_uint32 rightPart = readBits(data, startBitIdx, zeroBitsCount);
-            return leftPart + rightPart;
+        // se(v)
+        inline amf_int32 ReadSe()
+        {
+            const amf_uint32 ue = ReadUe();
+            const amf_int32 r = static_cast<amf_int32>(ue / 2 + ue % 2);
+            return (ue % 2) != 0 ? r : -r;
         }
 
-        inline amf_int32 readSe(const amf_uint8 *data, size_t &startBitIdx)
+        // bits consumed so far, counted from the start of the payload
+        inline size_t GetPosition() const
         {
-            amf_uint32 ue = readUe(data, startBitIdx);
-            // se From Ue 
-            amf_uint32 mod2 = ue % 2;
-            amf_uint32 r = ue / 2 + mod2;
+            return m_BytePos * 8 - m_CacheBits;
+        }
 
-            if (mod2 == 0)
+        inline bool IsOverrun() const
+        {
+            return m_bOverrun;
+        }
+
+    private:
+        static inline size_t CountLeadingZeros(amf_uint64 value)
+        {
+            if (value == 0)
             {
-                return r * -1;
+                return 64;
             }
-            return r;
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanReverse64(&index, value);
+            return 63 - index;
+#else
+            return static_cast<size_t>(__builtin_clzll(value));
+#endif
         }
-    }
+
+        inline void Consume(size_t count)
+        {
+            if (count > m_CacheBits)
+            {
+                // zero bits past the end of the payload
+                m_bOverrun = true;
+                m_BytePos += (count - m_CacheBits + 7) / 8;
+                m_CacheBits += (count - m_CacheBits + 7) / 8 * 8;
+            }
+            m_Cache = count < 64 ? m_Cache << count : 0;
+            m_CacheBits -= count;
+        }
+
+        // tops the cache up to at least 56 bits while payload bytes remain
+        inline void Refill()
+        {
+            if (m_BytePos + 8 <= m_Size)
+            {
+                amf_uint64 word;
+                memcpy(&word, m_pData + m_BytePos, sizeof(word));
+#if defined(_MSC_VER)
+                word = _byteswap_uint64(word);
+#else
+                word = __builtin_bswap64(word);
+#endif
+                // bits beyond the byte boundary are the same bits the next refill loads again
+                m_Cache |= word >> m_CacheBits;
+                m_BytePos += (63 - m_CacheBits) / 8;
+                m_CacheBits |= 56;
+                return;
+            }
+            while (m_CacheBits <= 56 && m_BytePos < m_Size)
+            {
+                m_Cache |= static_cast<amf_uint64>(m_pData[m_BytePos++]) << (56 - m_CacheBits);
+                m_CacheBits += 8;
+            }
+        }
+
+        const amf_uint8 *m_pData;
+        size_t           m_Size;
+        size_t           m_BytePos;     // next byte to load into the cache
+        amf_uint64       m_Cache;       // next bits to read, MSB first
+        size_t           m_CacheBits;   // valid bits in m_Cache
+        bool             m_bOverrun;
+    };
 }
 
@@ -47,8 +47,8 @@ class ExtraDataAvccBuilder
 public:
     ExtraDataAvccBuilder() : m_SPSCount(0), m_PPSCount(0){}
 
-    void AddSPS(amf_uint8 *sps, size_t size);
-    void AddPPS(amf_uint8 *pps, size_t size);
+    void AddSPS(const amf_uint8 *sps, size_t size);
+    void AddPPS(const amf_uint8 *pps, size_t size);
     void SetAnnexB(amf_uint8 *data, size_t size);
     bool GetExtradata(AMFByteArray   &extradata);
 
@@ -242,7 +242,8 @@ protected:
     static const amf_uint8 NalUnitTypeMask = 0x1F; // b00011111
     static const amf_uint8 NalRefIdcMask = 0x60;   // b01100000
 
-    static const size_t m_ReadSize = 1024*4;
+    static const size_t m_ReadSize = 1024*64;
+    static const size_t MaxSliceHeaderSize = 256; // covers the fields AccessUnitSigns reads
 
 
     NalUnitType   ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size);
@@ -251,10 +252,9 @@ protected:
     {
         return (NalUnitType)(data  & NalUnitTypeMask);
     }
-    size_t EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos);
 
 
-    AMFByteArray   m_ReadData;
+    Parser::StreamWindow m_Window;
     AMFByteArray   m_Extradata;
 
     AMFByteArray   m_EBSPtoRBSPData;
@@ -266,7 +266,6 @@ protected:
     std::map<amf_uint32,PpsData> m_PpsMap;
     amf_size       m_PacketCount;
     AccessUnitSigns m_currentAccessUnitsSigns;
-    bool            m_bEof;
     double          m_fps;
     amf_size        m_maxFramesNumber;
     amf::AMFContext* m_pContext;
@@ -284,11 +283,11 @@ BitStreamParser* CreateAvcCParser(amf::AMFDataStream* /* stream */, amf::AMFCont
 }
 //-------------------------------------------------------------------------------------------------
 AvcParser::AvcParser(amf::AMFDataStream* stream, amf::AMFContext* pContext) :
+    m_Window(stream),
     m_bUseStartCodes(false),
     m_currentFrameTimestamp(0),
     m_pStream(stream),
     m_PacketCount(0),
-    m_bEof(false),
     m_fps(0),
     m_maxFramesNumber(0),
     m_pContext(pContext)
@@ -464,7 +463,7 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
         return AMF_OK;
     }
 
-    if((m_bEof && m_ReadData.GetSize() == 0) || (m_maxFramesNumber && m_PacketCount >= m_maxFramesNumber))
+    if((m_Window.IsEof() && m_Window.GetSize() == 0) || (m_maxFramesNumber && m_PacketCount >= m_maxFramesNumber))
     {
         return AMF_EOF;
     }
@@ -486,8 +485,8 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
         if (naluType == NalUnitTypeSequenceParameterSet)
         {
             m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, naluSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), naluSize);
 
             SpsData sps;
             sps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
@@ -496,8 +495,8 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
         else if (naluType == NalUnitTypePictureParameterSet)
         {
             m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, naluSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), naluSize);
 
             PpsData pps;
             pps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
@@ -529,9 +528,11 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
             bSliceFound = true;
             AccessUnitSigns naluAccessUnitsSigns;
 
-            m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            // only the slice header is parsed - don't copy the slice data
+            const size_t headerSize = AMF_MIN(naluSize, MaxSliceHeaderSize);
+            m_EBSPtoRBSPData.SetSize(headerSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, headerSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), headerSize);
 
             naluAccessUnitsSigns.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize, m_SpsMap, m_PpsMap);
 
@@ -581,7 +582,7 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
     amf_uint8 *data = (amf_uint8*)pictureBuffer->GetNative();
     if(m_bUseStartCodes)
     {
-        memcpy(data, m_ReadData.GetData(), packetSize);
+        memcpy(data, m_Window.GetData(), packetSize);
     }
     else
     {
@@ -594,7 +595,7 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
             *data++ = ((naluSize >> 8) & 0x000000FF);
             *data++ = ((naluSize & 0x000000FF));
 
-            memcpy(data, m_ReadData.GetData() + naluStarts[i], naluSize);
+            memcpy(data, m_Window.GetData() + naluStarts[i], naluSize);
             data += naluSize;
         }
     }
@@ -604,13 +605,7 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
     pictureBuffer->SetDuration(frameDuration);
     m_currentFrameTimestamp += frameDuration;
 
-//    if (newPictureDetected)
-    {
-    // shift remaining data in m_ReadData
-        size_t remainingData = m_ReadData.GetSize() - readSize;
-        memmove(m_ReadData.GetData(), m_ReadData.GetData()+readSize, remainingData);
-        m_ReadData.SetSize(remainingData);
-    }
+    m_Window.Consume(readSize);
     *ppData = pictureBuffer.Detach();
     m_PacketCount++;
     return AMF_OK;
@@ -619,71 +614,13 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
 AvcParser::NalUnitType   AvcParser::ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size)
 {
     *size = 0;
-    size_t startOffset = *offset;
-
-    bool newNalFound = false;
-    size_t zerosCount = 0;
-
-    while(!newNalFound)
-    {
-        // read next portion if needed
-        size_t ready = m_ReadData.GetSize() - *offset;
-        if(ready == 0)
-        {
-            m_ReadData.SetSize(m_ReadData.GetSize()+m_ReadSize);
-            ready = 0;
-            m_pStream->Read(m_ReadData.GetData() + *offset, m_ReadSize, &ready);
-            if(ready == 0 )
-            {
-                m_bEof = true;
-                newNalFound = startOffset != *offset;
-                *offset = m_ReadData.GetSize();
-                break; // EOF
-            }
-        }
-
-        amf_uint8* data = m_ReadData.GetData();
-        if (data == nullptr) // check data before adding the offset
-        {
-            return NalUnitTypeUnspecified; // no data read
-        }
-        data += *offset; // don't forget the offset!
-
-        for(size_t i = 0; i < ready; i++)
-        {
-            amf_uint8 ch = *data++;
-            if (0 == ch)
-            {
-                zerosCount++;
-            }
-            else
-            {
-                if (1 == ch && zerosCount > 1) // We found a start code in Annex B stream
-                {
-                    if(*offset + (i - zerosCount) > startOffset)
-                    {
-                        ready = i - zerosCount;
-                        newNalFound = true; // new NAL
-                        break;
-                    }
-                    else
-                    {
-                        *nalu = *offset + zerosCount + 1;
-                    }
-                }
-                zerosCount = 0;
-            }
-        }
-        // if zeros found but not a new NAL - continue with zerosCount on the next iteration
-        *offset += ready;
-    }
-    if(!newNalFound)
+    if(!Parser::ReadNextNaluUnit(m_Window, m_ReadSize, offset, nalu))
     {
         return NalUnitTypeUnspecified; // EOF
     }
     *size = *offset - *nalu;
     // get NAL type
-    return GetNaluUnitType(*(m_ReadData.GetData() + *nalu));
+    return GetNaluUnitType(*(m_Window.GetData() + *nalu));
 }
 //-------------------------------------------------------------------------------------------------
 void    AvcParser::FindSPSandPPS()
@@ -708,25 +645,25 @@ void    AvcParser::FindSPSandPPS()
         if (naluType == NalUnitTypeSequenceParameterSet)
         {
             m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, naluSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), naluSize);
 
             SpsData sps;
             sps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
             m_SpsMap[sps.Id] = sps;
-            extraDataBuilder.AddSPS(m_ReadData.GetData()+naluOffset, naluSize);
+            extraDataBuilder.AddSPS(m_Window.GetData()+naluOffset, naluSize);
             bSPSFound = true;
         }
         else if (naluType == NalUnitTypePictureParameterSet)
         {
             m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, naluSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), naluSize);
 
             PpsData pps;
             pps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
             m_PpsMap[pps.Id] = pps;
-            extraDataBuilder.AddPPS(m_ReadData.GetData()+naluOffset, naluSize);
+            extraDataBuilder.AddPPS(m_Window.GetData()+naluOffset, naluSize);
             bPPSFound = true;
         }
         else if (   /*naluType == static_cast<amf_uint8>(NalUnitTypeSliceDataPartitionA) ||
@@ -743,7 +680,7 @@ void    AvcParser::FindSPSandPPS()
     } while (true);
 
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
-    m_ReadData.SetSize(0);
+    m_Window.Reset();
     // It will fail if SPS or PPS are absent
     extraDataBuilder.GetExtradata(m_Extradata);
 }
@@ -751,14 +688,14 @@ void    AvcParser::FindSPSandPPS()
 //-------------------------------------------------------------------------------------------------
 #pragma warning (push)
 #pragma warning (disable : 4189) // local variable is initialized but not referenced
-bool AvcParser::SpsData::Parse(amf_uint8 *nalu, size_t /* size */)
+bool AvcParser::SpsData::Parse(amf_uint8 *nalu, size_t size)
 {
     ProfileIdc = nalu[1];
     LevelIdc = nalu[3];
 
-    size_t offset = 32; // 4 bytes
+    Parser::BitReader bits(nalu, size, 32); // 4 bytes
 
-    Id = Parser::ExpGolomb::readUe(nalu, offset);
+    Id = bits.ReadUe();
 
     // See ITU-T Rec. H.264 (04/2013) Advanced video coding for generic audiovisual services, page 64
     if( ProfileIdc == 100 ||
@@ -772,24 +709,24 @@ bool AvcParser::SpsData::Parse(amf_uint8 *nalu, size_t /* size */)
         ProfileIdc == 128 ||
         ProfileIdc == 138 )
     {
-        ChromaFormatIdc = Parser::ExpGolomb::readUe(nalu, offset);
+        ChromaFormatIdc = bits.ReadUe();
 
         if (3 == ChromaFormatIdc)
         {
-            SeparateColourPlane = Parser::getBit(nalu, offset);
+            SeparateColourPlane = bits.ReadBit();
         }
 
-        amf_uint32 bitDepthLumaMinus8 = Parser::ExpGolomb::readUe(nalu, offset);
-        amf_uint32 bitDepthChromaMinus8 = Parser::ExpGolomb::readUe(nalu, offset);
-        bool qpPrimeYZeroTransformBypass = Parser::getBit(nalu, offset);
-        bool seqScalingMatrixPresent = Parser::getBit(nalu, offset);
+        amf_uint32 bitDepthLumaMinus8 = bits.ReadUe();
+        amf_uint32 bitDepthChromaMinus8 = bits.ReadUe();
+        bool qpPrimeYZeroTransformBypass = bits.ReadBit();
+        bool seqScalingMatrixPresent = bits.ReadBit();
 
         if (seqScalingMatrixPresent)
         {
             size_t iterationsCount = 3 == ChromaFormatIdc ? 12 : 8;
             for (size_t i = 0; i < iterationsCount; i++)
             {
-                bool seqScalingListPresent = Parser::getBit(nalu, offset);
+                bool seqScalingListPresent = bits.ReadBit();
                 if (seqScalingListPresent)
                 {
                     amf_uint32 lastScale = 8;
@@ -800,9 +737,9 @@ bool AvcParser::SpsData::Parse(amf_uint8 *nalu, size_t /* size */)
                     {
                         if(nextScale)
                         {
-                            nextScale = (lastScale + Parser::ExpGolomb::readSe(nalu, offset)) & 0xFF;
+                            nextScale = (lastScale + bits.ReadSe()) & 0xFF;
                         }
-//                        amf_int32 deltaScale = Parser::ExpGolomb::readSe(nalu, offset);
+//                        amf_int32 deltaScale = bits.ReadSe();
 //                        if (nextScale != 0)
 //                        {
 //                            nextScale = (lastScale + deltaScale + 256 ) % 256;
@@ -815,89 +752,89 @@ bool AvcParser::SpsData::Parse(amf_uint8 *nalu, size_t /* size */)
         }
     }
 
-    Log2MaxFrameNumMinus4 = Parser::ExpGolomb::readUe(nalu, offset);
-    PicOrderCntType = Parser::ExpGolomb::readUe(nalu, offset);
+    Log2MaxFrameNumMinus4 = bits.ReadUe();
+    PicOrderCntType = bits.ReadUe();
     if (0 == PicOrderCntType)
     {
-        Log2MaxPicOrderCntLsbMinus4 = Parser::ExpGolomb::readUe(nalu, offset);
+        Log2MaxPicOrderCntLsbMinus4 = bits.ReadUe();
     }
     else if (1 == PicOrderCntType)
     {
-        DeltaPicOrderAlwaysZero = Parser::getBit(nalu, offset);
-        amf_int32 offsetForNonRefPic = Parser::ExpGolomb::readSe(nalu, offset);
-        amf_int32 offsetForTopToBottomField = Parser::ExpGolomb::readSe(nalu, offset);
-        amf_uint32 numRefFramesInPicOrderCntCycle = Parser::ExpGolomb::readUe(nalu, offset);
+        DeltaPicOrderAlwaysZero = bits.ReadBit();
+        amf_int32 offsetForNonRefPic = bits.ReadSe();
+        amf_int32 offsetForTopToBottomField = bits.ReadSe();
+        amf_uint32 numRefFramesInPicOrderCntCycle = bits.ReadUe();
 
         for(size_t i = 0; i < numRefFramesInPicOrderCntCycle; i++)
         {
-            amf_int32 offsetForRefFrame = Parser::ExpGolomb::readSe(nalu, offset);
+            amf_int32 offsetForRefFrame = bits.ReadSe();
         }
     }
 
-    MaxNumRefFrames = Parser::ExpGolomb::readUe(nalu, offset);
-    bool gapsInFrameNumValueAllowedFlag = Parser::getBit(nalu, offset);
-    PicWidthInMbsMinus1 = Parser::ExpGolomb::readUe(nalu, offset);
-    PicHeightInMapUnitsMinus1 = Parser::ExpGolomb::readUe(nalu, offset);
-    FrameMbsOnlyFlag = Parser::getBit(nalu, offset);
+    MaxNumRefFrames = bits.ReadUe();
+    bool gapsInFrameNumValueAllowedFlag = bits.ReadBit();
+    PicWidthInMbsMinus1 = bits.ReadUe();
+    PicHeightInMapUnitsMinus1 = bits.ReadUe();
+    FrameMbsOnlyFlag = bits.ReadBit();
 
     if (!FrameMbsOnlyFlag)
     {
-        bool mb_adaptive_frame_field_flag = Parser::getBit(nalu, offset);
+        bool mb_adaptive_frame_field_flag = bits.ReadBit();
     }
-    bool direct_8x8_inference_flag = Parser::getBit(nalu, offset);
-    FrameCroppingFlag = Parser::getBit(nalu, offset);
+    bool direct_8x8_inference_flag = bits.ReadBit();
+    FrameCroppingFlag = bits.ReadBit();
     if (FrameCroppingFlag)
     {
 
-        FrameCroppingRectLeftOffset = Parser::ExpGolomb::readUe(nalu, offset);
-        FrameCroppingRectRightOffset = Parser::ExpGolomb::readUe(nalu, offset);
-        FrameCroppingRectTopOffset = Parser::ExpGolomb::readUe(nalu, offset);
-        FrameCroppingRectBottomOffset = Parser::ExpGolomb::readUe(nalu, offset);
+        FrameCroppingRectLeftOffset = bits.ReadUe();
+        FrameCroppingRectRightOffset = bits.ReadUe();
+        FrameCroppingRectTopOffset = bits.ReadUe();
+        FrameCroppingRectBottomOffset = bits.ReadUe();
     }
-    bool vui_parameters_present_flag = Parser::getBit(nalu, offset);
+    bool vui_parameters_present_flag = bits.ReadBit();
     // partial read of VUI - need frame rate
     if(vui_parameters_present_flag)
     {
-        bool aspect_ratio_info_present_flag = Parser::getBit(nalu, offset);
+        bool aspect_ratio_info_present_flag = bits.ReadBit();
         if (aspect_ratio_info_present_flag)
         {
-            amf_uint8 aspect_ratio_idc             = static_cast<amf_uint8>(Parser::readBits(nalu, offset, 8));
+            amf_uint8 aspect_ratio_idc             = static_cast<amf_uint8>(bits.ReadBits(8));
             if (255==aspect_ratio_idc)
             {
-                amf_uint16 sar_width                  = static_cast<amf_uint16>(Parser::readBits(nalu, offset, 16));
-                amf_uint16 sar_height                 = static_cast<amf_uint16>(Parser::readBits(nalu, offset, 16));
+                amf_uint16 sar_width                  = static_cast<amf_uint16>(bits.ReadBits(16));
+                amf_uint16 sar_height                 = static_cast<amf_uint16>(bits.ReadBits(16));
             }
         }
-        bool overscan_info_present_flag     = Parser::getBit(nalu, offset);
+        bool overscan_info_present_flag     = bits.ReadBit();
         if (overscan_info_present_flag)
         {
-            bool overscan_appropriate_flag    = Parser::getBit(nalu, offset);
+            bool overscan_appropriate_flag    = bits.ReadBit();
         }
-        bool video_signal_type_present_flag = Parser::getBit(nalu, offset);
+        bool video_signal_type_present_flag = bits.ReadBit();
         if (video_signal_type_present_flag)
         {
-            amf_uint8 video_format              = static_cast<amf_uint8>(Parser::readBits(nalu, offset, 3));
-            bool video_full_range_flag           = Parser::getBit(nalu, offset);
-            bool colour_description_present_flag = Parser::getBit(nalu, offset);
+            amf_uint8 video_format              = static_cast<amf_uint8>(bits.ReadBits(3));
+            bool video_full_range_flag           = bits.ReadBit();
+            bool colour_description_present_flag = bits.ReadBit();
             if(colour_description_present_flag)
             {
-                amf_uint8 colour_primaries              = static_cast<amf_uint8>(Parser::readBits(nalu, offset, 8));
-                amf_uint8 transfer_characteristics      = static_cast<amf_uint8>(Parser::readBits(nalu, offset, 8));
-                amf_uint8 matrix_coefficients           = static_cast<amf_uint8>(Parser::readBits(nalu, offset, 8));
+                amf_uint8 colour_primaries              = static_cast<amf_uint8>(bits.ReadBits(8));
+                amf_uint8 transfer_characteristics      = static_cast<amf_uint8>(bits.ReadBits(8));
+                amf_uint8 matrix_coefficients           = static_cast<amf_uint8>(bits.ReadBits(8));
             }
         }
-        bool chroma_location_info_present_flag = Parser::getBit(nalu, offset);;
+        bool chroma_location_info_present_flag = bits.ReadBit();;
         if(chroma_location_info_present_flag)
         {
-            amf_uint32 chroma_sample_loc_type_top_field     = Parser::ExpGolomb::readUe(nalu, offset);
-            amf_uint32 chroma_sample_loc_type_bottom_field  = Parser::ExpGolomb::readUe(nalu, offset);
+            amf_uint32 chroma_sample_loc_type_top_field     = bits.ReadUe();
+            amf_uint32 chroma_sample_loc_type_bottom_field  = bits.ReadUe();
         }
-        timing_info_present_flag          = Parser::getBit(nalu, offset);
+        timing_info_present_flag          = bits.ReadBit();
         if (timing_info_present_flag)
         {
-            num_units_in_tick               = Parser::readBits(nalu, offset, 32);
-            time_scale                      = Parser::readBits(nalu, offset, 32);
-            bool fixed_frame_rate_flag      = Parser::getBit(nalu, offset);
+            num_units_in_tick               = bits.ReadBits(32);
+            time_scale                      = bits.ReadBits(32);
+            bool fixed_frame_rate_flag      = bits.ReadBit();
         }
         // the rest can be parsed if needed
     }
@@ -905,27 +842,27 @@ bool AvcParser::SpsData::Parse(amf_uint8 *nalu, size_t /* size */)
 }
 #pragma warning(pop)
 //-------------------------------------------------------------------------------------------------
-bool AvcParser::PpsData::Parse(amf_uint8 *nalu, size_t /* size */)
+bool AvcParser::PpsData::Parse(amf_uint8 *nalu, size_t size)
 {
-    size_t offset = 8; // 1 byte
+    Parser::BitReader bits(nalu, size, 8); // 1 byte
 
-    Id = Parser::ExpGolomb::readUe(nalu, offset);
-    SpsId = Parser::ExpGolomb::readUe(nalu, offset);
-    EntropyCodingMode = Parser::getBit(nalu, offset);
-    BottomFieldPicOrderInFramePresent = Parser::getBit(nalu, offset);
+    Id = bits.ReadUe();
+    SpsId = bits.ReadUe();
+    EntropyCodingMode = bits.ReadBit();
+    BottomFieldPicOrderInFramePresent = bits.ReadBit();
     return true;
 }
 
 //-------------------------------------------------------------------------------------------------
 #pragma warning (push)
 #pragma warning (disable : 4189) // local variable is initialized but not referenced
-bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::map<amf_uint32, SpsData>& spsMap, std::map<amf_uint32, PpsData>& ppsMap)
+bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t size, std::map<amf_uint32, SpsData>& spsMap, std::map<amf_uint32, PpsData>& ppsMap)
 {
-    size_t offset = 8;
+    Parser::BitReader bits(nalu, size, 8);
 
-    amf_uint32 firstMbInSlice = Parser::ExpGolomb::readUe(nalu, offset);
-    amf_uint32 sliceType = Parser::ExpGolomb::readUe(nalu, offset);
-    PicParameterSetId = Parser::ExpGolomb::readUe(nalu, offset);
+    amf_uint32 firstMbInSlice = bits.ReadUe();
+    amf_uint32 sliceType = bits.ReadUe();
+    PicParameterSetId = bits.ReadUe();
 
     std::map<amf_uint32,PpsData>::iterator ppsIt = ppsMap.find(PicParameterSetId);
     if (ppsIt == ppsMap.end())
@@ -941,23 +878,23 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
 
     if (spsIt->second.SeparateColourPlane)
     {
-       amf_uint32 colourPlaneId = Parser::readBits(nalu, offset, 2);
+       amf_uint32 colourPlaneId = bits.ReadBits(2);
     }
 
     amf_uint32 frameNumBitsCount = spsIt->second.Log2MaxFrameNumMinus4 + 4;
 
-    FrameNum = Parser::readBits(nalu, offset, frameNumBitsCount);
+    FrameNum = bits.ReadBits(frameNumBitsCount);
 
     FieldPicFlag = false;
     BottomFieldFlag = false;
 
     if (!spsIt->second.FrameMbsOnlyFlag)
     {
-        FieldPicFlag = Parser::getBit(nalu, offset);
+        FieldPicFlag = bits.ReadBit();
 
         if (FieldPicFlag)
         {
-            BottomFieldFlag = Parser::getBit(nalu, offset);
+            BottomFieldFlag = bits.ReadBit();
         }
     }
 
@@ -965,7 +902,7 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
     IdrPicId = 0;
     if (IdrPicFlag)
     {
-        IdrPicId = Parser::ExpGolomb::readUe(nalu, offset);
+        IdrPicId = bits.ReadUe();
     }
 
     PicOrderCntLsb = 0;
@@ -973,11 +910,11 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
     if (0 == spsIt->second.PicOrderCntType)
     {
         amf_uint32 picOrderCntLsbBitsCount = spsIt->second.Log2MaxPicOrderCntLsbMinus4 + 4;
-        PicOrderCntLsb = Parser::readBits(nalu, offset, picOrderCntLsbBitsCount);
+        PicOrderCntLsb = bits.ReadBits(picOrderCntLsbBitsCount);
 
         if (ppsIt->second.BottomFieldPicOrderInFramePresent && !FieldPicFlag)
         {
-            DeltaPicOrderCntBottom = Parser::ExpGolomb::readSe(nalu, offset);
+            DeltaPicOrderCntBottom = bits.ReadSe();
         }
     }
 
@@ -985,11 +922,11 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
     DeltaPicOrderCnt1 = 0;
     if (1 == spsIt->second.PicOrderCntType && !spsIt->second.DeltaPicOrderAlwaysZero)
     {
-        DeltaPicOrderCnt0 = Parser::ExpGolomb::readSe(nalu, offset);
+        DeltaPicOrderCnt0 = bits.ReadSe();
 
         if (ppsIt->second.BottomFieldPicOrderInFramePresent && !FieldPicFlag)
         {
-            DeltaPicOrderCnt1 = Parser::ExpGolomb::readSe(nalu, offset);
+            DeltaPicOrderCnt1 = bits.ReadSe();
         }
     }
 
@@ -1057,7 +994,7 @@ bool AvcParser::AccessUnitSigns::IsNewPicture(const AccessUnitSigns &newSigns)
         return false;
 }
 //-------------------------------------------------------------------------------------------------
-void ExtraDataAvccBuilder::AddSPS(amf_uint8 *sps, size_t size)
+void ExtraDataAvccBuilder::AddSPS(const amf_uint8 *sps, size_t size)
 {
     m_SPSCount++;
     size_t pos = m_SPSs.GetSize();
@@ -1069,7 +1006,7 @@ void ExtraDataAvccBuilder::AddSPS(amf_uint8 *sps, size_t size)
     memcpy(data , sps, (size_t)spsSize);
 }
 //-------------------------------------------------------------------------------------------------
-void ExtraDataAvccBuilder::AddPPS(amf_uint8 *pps, size_t size)
+void ExtraDataAvccBuilder::AddPPS(const amf_uint8 *pps, size_t size)
 {
     m_PPSCount++;
     size_t pos = m_PPSs.GetSize();
@@ -1181,68 +1118,14 @@ void ExtraDataAvccBuilder::SetAnnexB(amf_uint8 *data, size_t size)
     }
 }
 //-------------------------------------------------------------------------------------------------
-#define ZEROBYTES_SHORTSTARTCODE 2 //indicates the number of zero bytes in the short start-code prefix
-//-------------------------------------------------------------------------------------------------
-size_t AvcParser::EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos)
-{
-    int count = 0;
-    if(end_bytepos < begin_bytepos)
-    {
-        return end_bytepos;
-    }
-    amf_uint8 *streamBuffer_i=streamBuffer+begin_bytepos;
-    amf_uint8 *streamBuffer_end=streamBuffer+end_bytepos;
-    int iReduceCount=0;
-    for(; streamBuffer_i!=streamBuffer_end; )
-    {
-        //starting from begin_bytepos to avoid header information
-        //in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
-        amf_uint8 tmp=*streamBuffer_i;
-        if(count == ZEROBYTES_SHORTSTARTCODE)
-        {
-            if(tmp == 0x03)
-            {
-                //check the 4th amf_uint8 after 0x000003, except when cabac_zero_word is used, in which case the last three bytes of this NAL unit must be 0x000003
-                if((streamBuffer_i+1 != streamBuffer_end) && (streamBuffer_i[1] > 0x03))
-                {
-                    return static_cast<size_t>(-1);
-                }
-                //if cabac_zero_word is used, the final amf_uint8 of this NAL unit(0x03) is discarded, and the last two bytes of RBSP must be 0x0000
-                if(streamBuffer_i+1 == streamBuffer_end)
-                {
-                    break;
-                }
-                memmove(streamBuffer_i,streamBuffer_i+1,streamBuffer_end-streamBuffer_i-1);
-                streamBuffer_end--;
-                iReduceCount++;
-                count = 0;
-                tmp = *streamBuffer_i;
-            }
-            else if(tmp < 0x03)
-            {
-            }
-        }
-        if(tmp == 0x00)
-        {
-            count++;
-        }
-        else
-        {
-            count = 0;
-        }
-        streamBuffer_i++;
-    }
-    return end_bytepos - begin_bytepos + iReduceCount;
-}
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT              AvcParser::ReInit()
 {
     m_currentFrameTimestamp = 0;
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
     m_PacketCount = 0;
-    m_bEof = false;
     m_currentAccessUnitsSigns = AccessUnitSigns();
-    m_ReadData.SetSize(0);
+    m_Window.Reset();
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
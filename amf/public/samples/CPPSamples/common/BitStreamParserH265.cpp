@@ -402,12 +402,12 @@ protected:
             memset(this, 0, sizeof(*this));
         }
         bool Parse(amf_uint8 *data, size_t size);
-        void ParsePTL(AMFH265_profile_tier_level_t *ptl, amf_bool profilePresentFlag, amf_uint32 maxNumSubLayersMinus1, amf_uint8 *nalu, size_t size, size_t &offset);
-        void ParseSubLayerHrdParameters(AMFH265_sub_layer_hrd_parameters *sub_hrd, amf_uint32 CpbCnt, amf_bool sub_pic_hrd_params_present_flag, amf_uint8 *nalu, size_t size, size_t &offset);
-        void ParseHrdParameters(AMFH265_hrd_parameters_t *hrd, amf_bool commonInfPresentFlag, amf_uint32 maxNumSubLayersMinus1, amf_uint8 *nalu, size_t size, size_t &offset);
-        static void ParseScalingList(AMFH265_scaling_list_data_t * s_data, amf_uint8 *data, size_t size,size_t &offset);
-        void ParseVUI(AMFH265_vui_parameters_t *vui, amf_uint32 maxNumSubLayersMinus1, amf_uint8 *data, size_t size,size_t &offset);
-        void ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps, amf_int32 stRpsIdx, amf_uint32 num_short_term_ref_pic_sets, AMFH265_short_term_RPS_t rps_ref[], amf_uint8 *data, size_t size,size_t &offset);
+        void ParsePTL(AMFH265_profile_tier_level_t *ptl, amf_bool profilePresentFlag, amf_uint32 maxNumSubLayersMinus1, Parser::BitReader &bits);
+        void ParseSubLayerHrdParameters(AMFH265_sub_layer_hrd_parameters *sub_hrd, amf_uint32 CpbCnt, amf_bool sub_pic_hrd_params_present_flag, Parser::BitReader &bits);
+        void ParseHrdParameters(AMFH265_hrd_parameters_t *hrd, amf_bool commonInfPresentFlag, amf_uint32 maxNumSubLayersMinus1, Parser::BitReader &bits);
+        static void ParseScalingList(AMFH265_scaling_list_data_t * s_data, Parser::BitReader &bits);
+        void ParseVUI(AMFH265_vui_parameters_t *vui, amf_uint32 maxNumSubLayersMinus1, Parser::BitReader &bits);
+        void ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps, amf_int32 stRpsIdx, amf_uint32 num_short_term_ref_pic_sets, AMFH265_short_term_RPS_t rps_ref[], Parser::BitReader &bits);
     };
     struct PpsData
     {
@@ -486,7 +486,7 @@ protected:
         AccessUnitSigns() :
             bNewPicture(false)
         {}
-        bool Parse(amf_uint8 *data, size_t size, std::map<amf_uint32,SpsData> &spsMap, std::map<amf_uint32,PpsData> &ppsMap);
+        bool Parse(const amf_uint8 *data, size_t size, std::map<amf_uint32,SpsData> &spsMap, std::map<amf_uint32,PpsData> &ppsMap);
         bool IsNewPicture();
     };
     class ExtraDataBuilder
@@ -494,8 +494,8 @@ protected:
     public:
         ExtraDataBuilder() : m_SPSCount(0), m_PPSCount(0){}
 
-        void AddSPS(amf_uint8 *sps, size_t size);
-        void AddPPS(amf_uint8 *pps, size_t size);
+        void AddSPS(const amf_uint8 *sps, size_t size);
+        void AddPPS(const amf_uint8 *pps, size_t size);
         bool GetExtradata(AMFByteArray   &extradata, bool bAnnexB);
 
     private:
@@ -514,7 +514,7 @@ protected:
     static const amf_uint8 NalRefIdcMask = 0x60;   // b01100000
     static const amf_uint8 NalUnitLengthSize = 4U;
 
-    static const size_t m_ReadSize = 1024*4;
+    static const size_t m_ReadSize = 1024*64;
 
     static const amf_uint16 maxSpsSize = 0xFFFF;
     static const amf_uint16 minSpsSize = 5;
@@ -522,7 +522,7 @@ protected:
 
     NalUnitHeader ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size);
     void          FindSPSandPPS();
-    static inline NalUnitHeader GetNaluUnitType(amf_uint8 *nalUnit)
+    static inline NalUnitHeader GetNaluUnitType(const amf_uint8 *nalUnit)
     {
         NalUnitHeader nalu_header;
         nalu_header.num_emu_byte_removed = 0;
@@ -534,11 +534,10 @@ protected:
 
         return nalu_header;
     }
-    size_t EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos);
     AMFRect GetCropRect() const;
 
 
-    AMFByteArray   m_ReadData;
+    Parser::StreamWindow m_Window;
     AMFByteArray   m_Extradata;
 
     AMFByteArray   m_EBSPtoRBSPData;
@@ -549,7 +548,6 @@ protected:
     std::map<amf_uint32,SpsData> m_SpsMap;
     std::map<amf_uint32,PpsData> m_PpsMap;
     amf_size       m_PacketCount;
-    bool            m_bEof;
     double          m_fps;
     amf_size        m_maxFramesNumber;
     amf::AMFContext* m_pContext;
@@ -561,11 +559,11 @@ BitStreamParser* CreateHEVCParser(amf::AMFDataStream* stream, amf::AMFContext* p
 }
 //-------------------------------------------------------------------------------------------------
 HevcParser::HevcParser(amf::AMFDataStream* stream, amf::AMFContext* pContext) :
+    m_Window(stream),
     m_bUseStartCodes(false),
     m_currentFrameTimestamp(0),
     m_pStream(stream),
     m_PacketCount(0),
-    m_bEof(false),
     m_fps(0),
     m_maxFramesNumber(0),
     m_pContext(pContext)
@@ -719,7 +717,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     {
         return AMF_OK;
     }
-    if((m_bEof && m_ReadData.GetSize() == 0) || ((m_maxFramesNumber > 0) && (m_PacketCount >= m_maxFramesNumber)))
+    if((m_Window.IsEof() && m_Window.GetSize() == 0) || ((m_maxFramesNumber > 0) && (m_PacketCount >= m_maxFramesNumber)))
     {
         return AMF_EOF;
     }
@@ -791,7 +789,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
 				else
 				{
 					AccessUnitSigns naluAccessUnitsSigns;
-					naluAccessUnitsSigns.Parse(m_ReadData.GetData() + naluOffset, naluSize, m_SpsMap, m_PpsMap);
+					naluAccessUnitsSigns.Parse(m_Window.GetData() + naluOffset, naluSize, m_SpsMap, m_PpsMap);
 					newPictureDetected = naluAccessUnitsSigns.IsNewPicture() && bSliceFound;
 				}
 				bSliceFound = true;
@@ -800,7 +798,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
 			else
 			{
 				AccessUnitSigns naluAccessUnitsSigns;
-				naluAccessUnitsSigns.Parse(m_ReadData.GetData() + naluOffset, naluSize, m_SpsMap, m_PpsMap);
+				naluAccessUnitsSigns.Parse(m_Window.GetData() + naluOffset, naluSize, m_SpsMap, m_PpsMap);
 
 				newPictureDetected = naluAccessUnitsSigns.IsNewPicture() && bSliceFound;
 				bSliceFound = true;
@@ -846,7 +844,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     amf_uint8 *data = (amf_uint8*)pictureBuffer->GetNative();
     if(m_bUseStartCodes)
     {
-        memcpy(data, m_ReadData.GetData(), packetSize);
+        memcpy(data, m_Window.GetData(), packetSize);
     }
     else
     {
@@ -859,7 +857,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
             *data++ = ((naluSize & 0x0000FF00) >> 8);
             *data++ = ((naluSize & 0x000000FF));
 
-            memcpy(data, m_ReadData.GetData() + naluStarts[i], naluSize);
+            memcpy(data, m_Window.GetData() + naluStarts[i], naluSize);
             data += naluSize;
         }
     }
@@ -869,13 +867,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     pictureBuffer->SetDuration(frameDuration);
     m_currentFrameTimestamp += frameDuration;
 
-//    if (newPictureDetected)
-    {
-    // shift remaining data in m_ReadData
-        size_t remainingData = m_ReadData.GetSize() - readSize;
-        memmove(m_ReadData.GetData(), m_ReadData.GetData()+readSize, remainingData);
-        m_ReadData.SetSize(remainingData);
-    }
+    m_Window.Consume(readSize);
     *ppData = pictureBuffer.Detach();
     m_PacketCount++;
     return AMF_OK;
@@ -884,84 +876,7 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
 HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size)
 {
     *size = 0;
-    size_t startOffset = *offset;
-
-    bool newNalFound = false;
-    size_t zerosCount = 0;
-
-    while(!newNalFound)
-    {
-        // read next portion if needed
-        size_t ready = m_ReadData.GetSize() - *offset;
-		//printf("ReadNextNaluUnit: remaining data size for read: %d\n", ready);
-		if (ready == 0)
-		{
-			if (m_bEof == false)
-			{
-				m_ReadData.SetSize(m_ReadData.GetSize() + m_ReadSize);
-                ready = 0;
-                m_pStream->Read(m_ReadData.GetData() + *offset, m_ReadSize, &ready);
-			}
-
-
-			if (ready != m_ReadSize && ready != 0)
-			{
-				m_ReadData.SetSize(m_ReadData.GetSize() - (m_ReadSize - ready));
-			}
-
-
-
-
-            if(ready == 0 )
-            {
-				if (m_bEof == false)
-				m_ReadData.SetSize(m_ReadData.GetSize() - m_ReadSize);
-
-                m_bEof = true;
-                newNalFound = startOffset != *offset;
-                *offset = m_ReadData.GetSize();
-                break; // EOF
-            }
-        }
-
-        amf_uint8* data = m_ReadData.GetData();
-        if (data == nullptr) // check data before adding the offset
-        {
-            NalUnitHeader header_nalu;
-            header_nalu.nal_unit_type = NAL_UNIT_INVALID;
-            return header_nalu; // no data read
-        }
-        data += *offset; // don't forget the offset!
-
-        for(size_t i = 0; i < ready; i++)
-        {
-            amf_uint8 ch = *data++;
-            if (0 == ch)
-            {
-                zerosCount++;
-            }
-            else
-            {
-                if (1 == ch && zerosCount >=2) // We found a start code in Annex B stream
-                {
-                    if(*offset + (i - zerosCount) > startOffset)
-                    {
-                        ready = i - zerosCount;
-                        newNalFound = true; // new NAL
-                        break;
-                    }
-                    else
-                    {
-                        *nalu = *offset + zerosCount + 1;
-                    }
-                }
-                zerosCount = 0;
-            }
-        }
-        // if zeros found but not a new NAL - continue with zerosCount on the next iteration
-        *offset += ready;
-    }
-    if(!newNalFound)
+    if(!Parser::ReadNextNaluUnit(m_Window, m_ReadSize, offset, nalu))
     {
         NalUnitHeader header_nalu;
         header_nalu.nal_unit_type = NAL_UNIT_INVALID;
@@ -969,7 +884,7 @@ HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t
     }
     *size = *offset - *nalu;
     // get NAL type
-    return GetNaluUnitType(m_ReadData.GetData() + *nalu);
+    return GetNaluUnitType(m_Window.GetData() + *nalu);
 }
 //-------------------------------------------------------------------------------------------------
 void    HevcParser::FindSPSandPPS()
@@ -992,24 +907,24 @@ void    HevcParser::FindSPSandPPS()
         if (naluHeader.nal_unit_type == NAL_UNIT_SPS)
         {
             m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, naluSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), naluSize);
 
             SpsData sps;
             sps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
             m_SpsMap[sps.sps_video_parameter_set_id] = sps;
-            extraDataBuilder.AddSPS(m_ReadData.GetData()+naluOffset, naluSize);
+            extraDataBuilder.AddSPS(m_Window.GetData()+naluOffset, naluSize);
         }
         else if (naluHeader.nal_unit_type == NAL_UNIT_PPS)
         {
             m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+            memcpy(m_EBSPtoRBSPData.GetData(), m_Window.GetData() + naluOffset, naluSize);
+            size_t newNaluSize = Parser::EBSPtoRBSP(m_EBSPtoRBSPData.GetData(), naluSize);
 
             PpsData pps;
             pps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
             m_PpsMap[pps.pps_pic_parameter_set_id] = pps;
-            extraDataBuilder.AddPPS(m_ReadData.GetData()+naluOffset, naluSize);
+            extraDataBuilder.AddPPS(m_Window.GetData()+naluOffset, naluSize);
         }
         else if (
         NAL_UNIT_CODED_SLICE_TRAIL_R == naluHeader.nal_unit_type
@@ -1035,359 +950,358 @@ void    HevcParser::FindSPSandPPS()
     } while (true);
 
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
-    m_ReadData.SetSize(0);
+    m_Window.Reset();
     // It will fail if SPS or PPS are absent
     extraDataBuilder.GetExtradata(m_Extradata, m_bUseStartCodes);
 }
 //-------------------------------------------------------------------------------------------------
 bool HevcParser::SpsData::Parse(amf_uint8 *nalu, size_t size)
 {
-    size_t offset = 16; // 2 bytes NALU header +
-    amf_uint32 activeVPS = Parser::readBits(nalu, offset,4);
-    amf_uint32 max_sub_layer_minus1 = Parser::readBits(nalu, offset,3);
-    sps_temporal_id_nesting_flag = Parser::getBit(nalu, offset);
+    Parser::BitReader bits(nalu, size, 16); // 2 bytes NALU header +
+    amf_uint32 activeVPS = bits.ReadBits(4);
+    amf_uint32 max_sub_layer_minus1 = bits.ReadBits(3);
+    sps_temporal_id_nesting_flag = bits.ReadBit();
     AMFH265_profile_tier_level_t ptl;
     memset (&ptl,0,sizeof(ptl));
-    ParsePTL(&ptl, true, max_sub_layer_minus1, nalu, size, offset);
-    amf_uint32 SPS_ID = Parser::ExpGolomb::readUe(nalu, offset);
+    ParsePTL(&ptl, true, max_sub_layer_minus1, bits);
+    amf_uint32 SPS_ID = bits.ReadUe();
 
     sps_video_parameter_set_id = activeVPS;
     sps_max_sub_layers_minus1 = max_sub_layer_minus1;
     memcpy (&profile_tier_level,&ptl,sizeof(ptl));
     sps_seq_parameter_set_id = SPS_ID;
 
-    chroma_format_idc = Parser::ExpGolomb::readUe(nalu, offset);
+    chroma_format_idc = bits.ReadUe();
     if (chroma_format_idc == 3)
     {
-        separate_colour_plane_flag = Parser::getBit(nalu, offset);
+        separate_colour_plane_flag = bits.ReadBit();
     }
-    pic_width_in_luma_samples = Parser::ExpGolomb::readUe(nalu, offset);
-    pic_height_in_luma_samples = Parser::ExpGolomb::readUe(nalu, offset);
-    conformance_window_flag = Parser::getBit(nalu, offset);
+    pic_width_in_luma_samples = bits.ReadUe();
+    pic_height_in_luma_samples = bits.ReadUe();
+    conformance_window_flag = bits.ReadBit();
     if (conformance_window_flag)
     {
-        conf_win_left_offset = Parser::ExpGolomb::readUe(nalu, offset);
-        conf_win_right_offset = Parser::ExpGolomb::readUe(nalu, offset);
-        conf_win_top_offset = Parser::ExpGolomb::readUe(nalu, offset);
-        conf_win_bottom_offset = Parser::ExpGolomb::readUe(nalu, offset);
+        conf_win_left_offset = bits.ReadUe();
+        conf_win_right_offset = bits.ReadUe();
+        conf_win_top_offset = bits.ReadUe();
+        conf_win_bottom_offset = bits.ReadUe();
     }
-    bit_depth_luma_minus8 = Parser::ExpGolomb::readUe(nalu, offset);
-    bit_depth_chroma_minus8 = Parser::ExpGolomb::readUe(nalu, offset);
-    log2_max_pic_order_cnt_lsb_minus4 = Parser::ExpGolomb::readUe(nalu, offset);
-    sps_sub_layer_ordering_info_present_flag = Parser::getBit(nalu, offset);
+    bit_depth_luma_minus8 = bits.ReadUe();
+    bit_depth_chroma_minus8 = bits.ReadUe();
+    log2_max_pic_order_cnt_lsb_minus4 = bits.ReadUe();
+    sps_sub_layer_ordering_info_present_flag = bits.ReadBit();
     for (amf_uint32 i=(sps_sub_layer_ordering_info_present_flag?0:sps_max_sub_layers_minus1); i<=sps_max_sub_layers_minus1; i++)
     {
-        sps_max_dec_pic_buffering_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
-        sps_max_num_reorder_pics[i] = Parser::ExpGolomb::readUe(nalu, offset);
-        sps_max_latency_increase_plus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+        sps_max_dec_pic_buffering_minus1[i] = bits.ReadUe();
+        sps_max_num_reorder_pics[i] = bits.ReadUe();
+        sps_max_latency_increase_plus1[i] = bits.ReadUe();
     }
-    log2_min_luma_coding_block_size_minus3 = Parser::ExpGolomb::readUe(nalu, offset);
+    log2_min_luma_coding_block_size_minus3 = bits.ReadUe();
 
     int log2MinCUSize = log2_min_luma_coding_block_size_minus3 +3;
 
-    log2_diff_max_min_luma_coding_block_size = Parser::ExpGolomb::readUe(nalu, offset);
+    log2_diff_max_min_luma_coding_block_size = bits.ReadUe();
 
     int maxCUDepthDelta = log2_diff_max_min_luma_coding_block_size;
     max_cu_width = ( 1<<(log2MinCUSize + maxCUDepthDelta) );
     max_cu_height = ( 1<<(log2MinCUSize + maxCUDepthDelta) );
 
-    log2_min_transform_block_size_minus2 = Parser::ExpGolomb::readUe(nalu, offset);
+    log2_min_transform_block_size_minus2 = bits.ReadUe();
 
     amf_uint32 QuadtreeTULog2MinSize = log2_min_transform_block_size_minus2 + 2;
     int addCuDepth = AMF_MAX (0, log2MinCUSize - (int)QuadtreeTULog2MinSize );
     max_cu_depth = (maxCUDepthDelta + addCuDepth);
 
-    log2_diff_max_min_transform_block_size = Parser::ExpGolomb::readUe(nalu, offset);
-    max_transform_hierarchy_depth_inter = Parser::ExpGolomb::readUe(nalu, offset);
-    max_transform_hierarchy_depth_intra = Parser::ExpGolomb::readUe(nalu, offset);
-    scaling_list_enabled_flag = Parser::getBit(nalu, offset);
+    log2_diff_max_min_transform_block_size = bits.ReadUe();
+    max_transform_hierarchy_depth_inter = bits.ReadUe();
+    max_transform_hierarchy_depth_intra = bits.ReadUe();
+    scaling_list_enabled_flag = bits.ReadBit();
     if (scaling_list_enabled_flag)
     {
-        sps_scaling_list_data_present_flag = Parser::getBit(nalu, offset);
+        sps_scaling_list_data_present_flag = bits.ReadBit();
         if (sps_scaling_list_data_present_flag)
         {
-            ParseScalingList(&scaling_list_data, nalu, size, offset);
+            ParseScalingList(&scaling_list_data, bits);
         }
     }
-    amp_enabled_flag = Parser::getBit(nalu, offset);
-    sample_adaptive_offset_enabled_flag = Parser::getBit(nalu, offset);
-    pcm_enabled_flag = Parser::getBit(nalu, offset);
+    amp_enabled_flag = bits.ReadBit();
+    sample_adaptive_offset_enabled_flag = bits.ReadBit();
+    pcm_enabled_flag = bits.ReadBit();
     if (pcm_enabled_flag)
     {
-        pcm_sample_bit_depth_luma_minus1 = Parser::readBits(nalu, offset,4);
-        pcm_sample_bit_depth_chroma_minus1 = Parser::readBits(nalu, offset,4);
-        log2_min_pcm_luma_coding_block_size_minus3 = Parser::ExpGolomb::readUe(nalu, offset);
-        log2_diff_max_min_pcm_luma_coding_block_size = Parser::ExpGolomb::readUe(nalu, offset);
-        pcm_loop_filter_disabled_flag = Parser::getBit(nalu, offset);
+        pcm_sample_bit_depth_luma_minus1 = bits.ReadBits(4);
+        pcm_sample_bit_depth_chroma_minus1 = bits.ReadBits(4);
+        log2_min_pcm_luma_coding_block_size_minus3 = bits.ReadUe();
+        log2_diff_max_min_pcm_luma_coding_block_size = bits.ReadUe();
+        pcm_loop_filter_disabled_flag = bits.ReadBit();
     }
-    num_short_term_ref_pic_sets = Parser::ExpGolomb::readUe(nalu, offset);
+    num_short_term_ref_pic_sets = bits.ReadUe();
     for (amf_uint32 i=0; i<num_short_term_ref_pic_sets; i++)
     {
         //short_term_ref_pic_set( i )
-        ParseShortTermRefPicSet(&stRPS[i], i, num_short_term_ref_pic_sets, stRPS, nalu, size, offset);
+        ParseShortTermRefPicSet(&stRPS[i], i, num_short_term_ref_pic_sets, stRPS, bits);
     }
-    long_term_ref_pics_present_flag = Parser::getBit(nalu, offset);
+    long_term_ref_pics_present_flag = bits.ReadBit();
     if (long_term_ref_pics_present_flag)
     {
-        num_long_term_ref_pics_sps = Parser::ExpGolomb::readUe(nalu, offset);
+        num_long_term_ref_pics_sps = bits.ReadUe();
         ltRPS.num_of_pics = num_long_term_ref_pics_sps;
         for (amf_uint32 i=0; i<num_long_term_ref_pics_sps; i++)
         {
             //The number of bits used to represent lt_ref_pic_poc_lsb_sps[ i ] is equal to log2_max_pic_order_cnt_lsb_minus4 + 4.
-            lt_ref_pic_poc_lsb_sps[i] = Parser::readBits(nalu, offset,(log2_max_pic_order_cnt_lsb_minus4 + 4));
-            used_by_curr_pic_lt_sps_flag[i] = Parser::getBit(nalu, offset);
+            lt_ref_pic_poc_lsb_sps[i] = bits.ReadBits((log2_max_pic_order_cnt_lsb_minus4 + 4));
+            used_by_curr_pic_lt_sps_flag[i] = bits.ReadBit();
             ltRPS.POCs[i]=lt_ref_pic_poc_lsb_sps[i];
             ltRPS.used_by_curr_pic[i] = used_by_curr_pic_lt_sps_flag[i];
         }
     }
-    sps_temporal_mvp_enabled_flag = Parser::getBit(nalu, offset);
-    strong_intra_smoothing_enabled_flag = Parser::getBit(nalu, offset);
-    vui_parameters_present_flag = Parser::getBit(nalu, offset);
+    sps_temporal_mvp_enabled_flag = bits.ReadBit();
+    strong_intra_smoothing_enabled_flag = bits.ReadBit();
+    vui_parameters_present_flag = bits.ReadBit();
     if (vui_parameters_present_flag)
     {
         //vui_parameters()
-        ParseVUI(&vui_parameters, sps_max_sub_layers_minus1, nalu, size, offset);
+        ParseVUI(&vui_parameters, sps_max_sub_layers_minus1, bits);
     }
-    sps_extension_present_flag = Parser::getBit(nalu, offset);
+    sps_extension_present_flag = bits.ReadBit();
     if (sps_extension_present_flag)
     {
-        sps_range_extension_flag = Parser::getBit(nalu, offset);
-        sps_multilayer_extension_flag = Parser::getBit(nalu, offset);
-        sps_3d_extension_flag = Parser::getBit(nalu, offset);
-        sps_scc_extension_flag = Parser::getBit(nalu, offset);
-        sps_extension_4bits = Parser::readBits(nalu, offset, 4);
+        sps_range_extension_flag = bits.ReadBit();
+        sps_multilayer_extension_flag = bits.ReadBit();
+        sps_3d_extension_flag = bits.ReadBit();
+        sps_scc_extension_flag = bits.ReadBit();
+        sps_extension_4bits = bits.ReadBits(4);
     }
     if (sps_range_extension_flag)
     {
-        transform_skip_rotation_enabled_flag = Parser::getBit(nalu, offset);
-        transform_skip_context_enabled_flag = Parser::getBit(nalu, offset);
-        implicit_rdpcm_enabled_flag = Parser::getBit(nalu, offset);
-        explicit_rdpcm_enabled_flag = Parser::getBit(nalu, offset);
-        extended_precision_processing_flag = Parser::getBit(nalu, offset);
-        intra_smoothing_disabled_flag = Parser::getBit(nalu, offset);
-        high_precision_offsets_enabled_flag = Parser::getBit(nalu, offset);
-        persistent_rice_adaptation_enabled_flag = Parser::getBit(nalu, offset);
-        cabac_bypass_alignment_enabled_flag = Parser::getBit(nalu, offset);
+        transform_skip_rotation_enabled_flag = bits.ReadBit();
+        transform_skip_context_enabled_flag = bits.ReadBit();
+        implicit_rdpcm_enabled_flag = bits.ReadBit();
+        explicit_rdpcm_enabled_flag = bits.ReadBit();
+        extended_precision_processing_flag = bits.ReadBit();
+        intra_smoothing_disabled_flag = bits.ReadBit();
+        high_precision_offsets_enabled_flag = bits.ReadBit();
+        persistent_rice_adaptation_enabled_flag = bits.ReadBit();
+        cabac_bypass_alignment_enabled_flag = bits.ReadBit();
     }
     //while( more_rbsp_data() )
-        //sps_extension_data_flag = Parser::getBit(nalu, offset);
+        //sps_extension_data_flag = bits.ReadBit();
     return true;
 }
 //-------------------------------------------------------------------------------------------------
 bool HevcParser::PpsData::Parse(amf_uint8 *nalu, size_t size)
 {
-    size_t offset = 16; // 2 bytes NALU header
+    Parser::BitReader bits(nalu, size, 16); // 2 bytes NALU header
 
-    amf_uint32 PPS_ID = Parser::ExpGolomb::readUe(nalu, offset);
+    amf_uint32 PPS_ID = bits.ReadUe();
 
     pps_pic_parameter_set_id = PPS_ID;
-    amf_uint32 activeSPS = Parser::ExpGolomb::readUe(nalu, offset);
+    amf_uint32 activeSPS = bits.ReadUe();
 
     pps_seq_parameter_set_id = activeSPS;
-    dependent_slice_segments_enabled_flag = Parser::getBit(nalu, offset);
-    output_flag_present_flag = Parser::getBit(nalu, offset);
-    num_extra_slice_header_bits = Parser::readBits(nalu, offset,3);
-    sign_data_hiding_enabled_flag = Parser::getBit(nalu, offset);
-    cabac_init_present_flag = Parser::getBit(nalu, offset);
-    num_ref_idx_l0_default_active_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
-    num_ref_idx_l1_default_active_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
-    init_qp_minus26 = Parser::ExpGolomb::readSe(nalu, offset);
-    constrained_intra_pred_flag = Parser::getBit(nalu, offset);
-    transform_skip_enabled_flag = Parser::getBit(nalu, offset);
-    cu_qp_delta_enabled_flag = Parser::getBit(nalu, offset);
+    dependent_slice_segments_enabled_flag = bits.ReadBit();
+    output_flag_present_flag = bits.ReadBit();
+    num_extra_slice_header_bits = bits.ReadBits(3);
+    sign_data_hiding_enabled_flag = bits.ReadBit();
+    cabac_init_present_flag = bits.ReadBit();
+    num_ref_idx_l0_default_active_minus1 = bits.ReadUe();
+    num_ref_idx_l1_default_active_minus1 = bits.ReadUe();
+    init_qp_minus26 = bits.ReadSe();
+    constrained_intra_pred_flag = bits.ReadBit();
+    transform_skip_enabled_flag = bits.ReadBit();
+    cu_qp_delta_enabled_flag = bits.ReadBit();
     if (cu_qp_delta_enabled_flag)
     {
-        diff_cu_qp_delta_depth = Parser::ExpGolomb::readUe(nalu, offset);
+        diff_cu_qp_delta_depth = bits.ReadUe();
     }
-    pps_cb_qp_offset = Parser::ExpGolomb::readSe(nalu, offset);
-    pps_cr_qp_offset = Parser::ExpGolomb::readSe(nalu, offset);
-    pps_slice_chroma_qp_offsets_present_flag = Parser::getBit(nalu, offset);
-    weighted_pred_flag = Parser::getBit(nalu, offset);
-    weighted_bipred_flag = Parser::getBit(nalu, offset);
-    transquant_bypass_enabled_flag = Parser::getBit(nalu, offset);
-    tiles_enabled_flag = Parser::getBit(nalu, offset);
-    entropy_coding_sync_enabled_flag = Parser::getBit(nalu, offset);
+    pps_cb_qp_offset = bits.ReadSe();
+    pps_cr_qp_offset = bits.ReadSe();
+    pps_slice_chroma_qp_offsets_present_flag = bits.ReadBit();
+    weighted_pred_flag = bits.ReadBit();
+    weighted_bipred_flag = bits.ReadBit();
+    transquant_bypass_enabled_flag = bits.ReadBit();
+    tiles_enabled_flag = bits.ReadBit();
+    entropy_coding_sync_enabled_flag = bits.ReadBit();
     if (tiles_enabled_flag)
     {
-        num_tile_columns_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
-        num_tile_rows_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
-        uniform_spacing_flag = Parser::getBit(nalu, offset);
+        num_tile_columns_minus1 = bits.ReadUe();
+        num_tile_rows_minus1 = bits.ReadUe();
+        uniform_spacing_flag = bits.ReadBit();
         if (!uniform_spacing_flag)
         {
             for (amf_uint32 i=0; i<num_tile_columns_minus1; i++)
             {
-                column_width_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+                column_width_minus1[i] = bits.ReadUe();
             }
             for (amf_uint32 i=0; i<num_tile_rows_minus1; i++)
             {
-                row_height_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+                row_height_minus1[i] = bits.ReadUe();
             }
         }
-        loop_filter_across_tiles_enabled_flag = Parser::getBit(nalu, offset);
+        loop_filter_across_tiles_enabled_flag = bits.ReadBit();
     }
     else
          loop_filter_across_tiles_enabled_flag = 1;
-    pps_loop_filter_across_slices_enabled_flag = Parser::getBit(nalu, offset);
-    deblocking_filter_control_present_flag = Parser::getBit(nalu, offset);
+    pps_loop_filter_across_slices_enabled_flag = bits.ReadBit();
+    deblocking_filter_control_present_flag = bits.ReadBit();
     if (deblocking_filter_control_present_flag)
     {
-        deblocking_filter_override_enabled_flag = Parser::getBit(nalu, offset);
-        pps_deblocking_filter_disabled_flag = Parser::getBit(nalu, offset);
+        deblocking_filter_override_enabled_flag = bits.ReadBit();
+        pps_deblocking_filter_disabled_flag = bits.ReadBit();
         if (!pps_deblocking_filter_disabled_flag)
         {
-            pps_beta_offset_div2 = Parser::ExpGolomb::readSe(nalu, offset);
-            pps_tc_offset_div2 = Parser::ExpGolomb::readSe(nalu, offset);
+            pps_beta_offset_div2 = bits.ReadSe();
+            pps_tc_offset_div2 = bits.ReadSe();
         }
     }
-    pps_scaling_list_data_present_flag = Parser::getBit(nalu, offset);
+    pps_scaling_list_data_present_flag = bits.ReadBit();
     if (pps_scaling_list_data_present_flag)
     {
-        SpsData::ParseScalingList(&scaling_list_data, nalu, size, offset);
+        SpsData::ParseScalingList(&scaling_list_data, bits);
     }
-    lists_modification_present_flag = Parser::getBit(nalu, offset);
-    log2_parallel_merge_level_minus2 = Parser::ExpGolomb::readUe(nalu, offset);
-    slice_segment_header_extension_present_flag = Parser::getBit(nalu, offset);
-    pps_extension_present_flag = Parser::getBit(nalu, offset);
+    lists_modification_present_flag = bits.ReadBit();
+    log2_parallel_merge_level_minus2 = bits.ReadUe();
+    slice_segment_header_extension_present_flag = bits.ReadBit();
+    pps_extension_present_flag = bits.ReadBit();
     if (pps_extension_present_flag)
     {
-        pps_range_extension_flag = Parser::getBit(nalu, offset);
-        pps_multilayer_extension_flag = Parser::getBit(nalu, offset);
-        pps_3d_extension_flag = Parser::getBit(nalu, offset);
-        pps_scc_extension_flag = Parser::getBit(nalu, offset);
-        pps_extension_4bits = Parser::readBits(nalu, offset, 4);
+        pps_range_extension_flag = bits.ReadBit();
+        pps_multilayer_extension_flag = bits.ReadBit();
+        pps_3d_extension_flag = bits.ReadBit();
+        pps_scc_extension_flag = bits.ReadBit();
+        pps_extension_4bits = bits.ReadBits(4);
     }
     if (pps_range_extension_flag)
     {
         if (transform_skip_enabled_flag)
         {
-            log2_max_transform_skip_block_size_minus2 = Parser::ExpGolomb::readUe(nalu, offset);
+            log2_max_transform_skip_block_size_minus2 = bits.ReadUe();
         }
-        cross_component_prediction_enabled_flag = Parser::getBit(nalu, offset);
-        chroma_qp_offset_list_enabled_flag = Parser::getBit(nalu, offset);
+        cross_component_prediction_enabled_flag = bits.ReadBit();
+        chroma_qp_offset_list_enabled_flag = bits.ReadBit();
         if (chroma_qp_offset_list_enabled_flag)
         {
-            diff_cu_chroma_qp_offset_depth = Parser::ExpGolomb::readUe(nalu, offset);
-            chroma_qp_offset_list_len_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
+            diff_cu_chroma_qp_offset_depth = bits.ReadUe();
+            chroma_qp_offset_list_len_minus1 = bits.ReadUe();
             for (amf_uint i = 0; i <= chroma_qp_offset_list_len_minus1; i++)
             {
-                cb_qp_offset_list[i] = Parser::ExpGolomb::readSe(nalu, offset);
-                cr_qp_offset_list[i] = Parser::ExpGolomb::readSe(nalu, offset);
+                cb_qp_offset_list[i] = bits.ReadSe();
+                cr_qp_offset_list[i] = bits.ReadSe();
             }
         }
-        log2_sao_offset_scale_luma = Parser::ExpGolomb::readUe(nalu, offset);
-        log2_sao_offset_scale_chroma = Parser::ExpGolomb::readUe(nalu, offset);
+        log2_sao_offset_scale_luma = bits.ReadUe();
+        log2_sao_offset_scale_chroma = bits.ReadUe();
     }
     //    while( more_rbsp_data( ) )
-    //        pps_extension_data_flag = Parser::getBit(nalu, offset);
+    //        pps_extension_data_flag = bits.ReadBit();
     //    rbsp_trailing_bits( )
     return true;
 }
 //-------------------------------------------------------------------------------------------------
-void HevcParser::SpsData::ParsePTL(AMFH265_profile_tier_level_t *ptl, amf_bool profilePresentFlag, amf_uint32 maxNumSubLayersMinus1, amf_uint8 *nalu, size_t /*size*/, size_t& offset)
+void HevcParser::SpsData::ParsePTL(AMFH265_profile_tier_level_t *ptl, amf_bool profilePresentFlag, amf_uint32 maxNumSubLayersMinus1, Parser::BitReader &bits)
 {
     if(profilePresentFlag)
     {
-        ptl->general_profile_space = Parser::readBits(nalu, offset,2);
-        ptl->general_tier_flag = Parser::getBit(nalu, offset);
-        ptl->general_profile_idc = Parser::readBits(nalu, offset,5);
+        ptl->general_profile_space = bits.ReadBits(2);
+        ptl->general_tier_flag = bits.ReadBit();
+        ptl->general_profile_idc = bits.ReadBits(5);
         for (int i=0; i < 32; i++)
         {
-            ptl->general_profile_compatibility_flag[i] = Parser::getBit(nalu, offset);
+            ptl->general_profile_compatibility_flag[i] = bits.ReadBit();
         }
-        ptl->general_progressive_source_flag = Parser::getBit(nalu, offset);
-        ptl->general_interlaced_source_flag = Parser::getBit(nalu, offset);
-        ptl->general_non_packed_constraint_flag = Parser::getBit(nalu, offset);
-        ptl->general_frame_only_constraint_flag = Parser::getBit(nalu, offset);
-        //readBits is limited to 32
-//        ptl->general_reserved_zero_44bits = Parser::readBits(nalu, offset,44);
-        offset+=44;
+        ptl->general_progressive_source_flag = bits.ReadBit();
+        ptl->general_interlaced_source_flag = bits.ReadBit();
+        ptl->general_non_packed_constraint_flag = bits.ReadBit();
+        ptl->general_frame_only_constraint_flag = bits.ReadBit();
+//        ptl->general_reserved_zero_44bits = bits.ReadBits(44);
+        bits.SkipBits(44);
     }
 
-    ptl->general_level_idc = Parser::readBits(nalu, offset,8);
+    ptl->general_level_idc = bits.ReadBits(8);
     for(amf_uint32 i=0; i < maxNumSubLayersMinus1; i++)
     {
-        ptl->sub_layer_profile_present_flag[i] = Parser::getBit(nalu, offset);
-        ptl->sub_layer_level_present_flag[i] = Parser::getBit(nalu, offset);
+        ptl->sub_layer_profile_present_flag[i] = bits.ReadBit();
+        ptl->sub_layer_level_present_flag[i] = bits.ReadBit();
     }
     if (maxNumSubLayersMinus1 > 0)
     {
         for(amf_uint32 i=maxNumSubLayersMinus1; i<8; i++)
         {
-            ptl->reserved_zero_2bits[i] = Parser::readBits(nalu, offset,2);
+            ptl->reserved_zero_2bits[i] = bits.ReadBits(2);
         }
     }
     for(amf_uint32 i=0; i<maxNumSubLayersMinus1; i++)
     {
         if(ptl->sub_layer_profile_present_flag[i])
         {
-            ptl->sub_layer_profile_space[i] = Parser::readBits(nalu, offset,2);
-            ptl->sub_layer_tier_flag[i] = Parser::getBit(nalu, offset);
-            ptl->sub_layer_profile_idc[i] = Parser::readBits(nalu, offset,5);
+            ptl->sub_layer_profile_space[i] = bits.ReadBits(2);
+            ptl->sub_layer_tier_flag[i] = bits.ReadBit();
+            ptl->sub_layer_profile_idc[i] = bits.ReadBits(5);
             for(int j = 0; j<32; j++)
             {
-                ptl->sub_layer_profile_compatibility_flag[i][j] = Parser::getBit(nalu, offset);
+                ptl->sub_layer_profile_compatibility_flag[i][j] = bits.ReadBit();
             }
-            ptl->sub_layer_progressive_source_flag[i] = Parser::getBit(nalu, offset);
-            ptl->sub_layer_interlaced_source_flag[i] = Parser::getBit(nalu, offset);
-            ptl->sub_layer_non_packed_constraint_flag[i] = Parser::getBit(nalu, offset);
-            ptl->sub_layer_frame_only_constraint_flag[i] = Parser::getBit(nalu, offset);
-            ptl->sub_layer_reserved_zero_44bits[i] = Parser::readBits(nalu, offset,44);
+            ptl->sub_layer_progressive_source_flag[i] = bits.ReadBit();
+            ptl->sub_layer_interlaced_source_flag[i] = bits.ReadBit();
+            ptl->sub_layer_non_packed_constraint_flag[i] = bits.ReadBit();
+            ptl->sub_layer_frame_only_constraint_flag[i] = bits.ReadBit();
+            ptl->sub_layer_reserved_zero_44bits[i] = bits.ReadBits(44);
         }
         if(ptl->sub_layer_level_present_flag[i])
         {
-            ptl->sub_layer_level_idc[i] = Parser::readBits(nalu, offset,8);
+            ptl->sub_layer_level_idc[i] = bits.ReadBits(8);
         }
     }
 }
 //-------------------------------------------------------------------------------------------------
-void HevcParser::SpsData::ParseSubLayerHrdParameters(AMFH265_sub_layer_hrd_parameters *sub_hrd, amf_uint32 CpbCnt, amf_bool sub_pic_hrd_params_present_flag, amf_uint8 *nalu, size_t /*size*/, size_t& offset)
+void HevcParser::SpsData::ParseSubLayerHrdParameters(AMFH265_sub_layer_hrd_parameters *sub_hrd, amf_uint32 CpbCnt, amf_bool sub_pic_hrd_params_present_flag, Parser::BitReader &bits)
 {
     for (amf_uint32 i=0; i<=CpbCnt; i++)
     {
-        sub_hrd->bit_rate_value_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
-        sub_hrd->cpb_size_value_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+        sub_hrd->bit_rate_value_minus1[i] = bits.ReadUe();
+        sub_hrd->cpb_size_value_minus1[i] = bits.ReadUe();
         if(sub_pic_hrd_params_present_flag)
         {
-            sub_hrd->cpb_size_du_value_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
-            sub_hrd->bit_rate_du_value_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+            sub_hrd->cpb_size_du_value_minus1[i] = bits.ReadUe();
+            sub_hrd->bit_rate_du_value_minus1[i] = bits.ReadUe();
         }
-        sub_hrd->cbr_flag[i] = Parser::getBit(nalu, offset);
+        sub_hrd->cbr_flag[i] = bits.ReadBit();
     }
 }
 //-------------------------------------------------------------------------------------------------
-void HevcParser::SpsData::ParseHrdParameters(AMFH265_hrd_parameters_t *hrd, amf_bool commonInfPresentFlag, amf_uint32 maxNumSubLayersMinus1, amf_uint8 *nalu, size_t size,size_t &offset)
+void HevcParser::SpsData::ParseHrdParameters(AMFH265_hrd_parameters_t *hrd, amf_bool commonInfPresentFlag, amf_uint32 maxNumSubLayersMinus1, Parser::BitReader &bits)
 {
     if (commonInfPresentFlag)
     {
-        hrd->nal_hrd_parameters_present_flag = Parser::getBit(nalu, offset);
-        hrd->vcl_hrd_parameters_present_flag = Parser::getBit(nalu, offset);
+        hrd->nal_hrd_parameters_present_flag = bits.ReadBit();
+        hrd->vcl_hrd_parameters_present_flag = bits.ReadBit();
         if (hrd->nal_hrd_parameters_present_flag || hrd->vcl_hrd_parameters_present_flag)
         {
-            hrd->sub_pic_hrd_params_present_flag = Parser::getBit(nalu, offset);
+            hrd->sub_pic_hrd_params_present_flag = bits.ReadBit();
             if (hrd->sub_pic_hrd_params_present_flag)
             {
-                hrd->tick_divisor_minus2 = Parser::readBits(nalu, offset,8);
-                hrd->du_cpb_removal_delay_increment_length_minus1 = Parser::readBits(nalu, offset,5);
-                hrd->sub_pic_cpb_params_in_pic_timing_sei_flag = Parser::getBit(nalu, offset);
-                hrd->dpb_output_delay_du_length_minus1 = Parser::readBits(nalu, offset,5);
+                hrd->tick_divisor_minus2 = bits.ReadBits(8);
+                hrd->du_cpb_removal_delay_increment_length_minus1 = bits.ReadBits(5);
+                hrd->sub_pic_cpb_params_in_pic_timing_sei_flag = bits.ReadBit();
+                hrd->dpb_output_delay_du_length_minus1 = bits.ReadBits(5);
             }
-            hrd->bit_rate_scale = Parser::readBits(nalu, offset,4);
-            hrd->cpb_size_scale = Parser::readBits(nalu, offset,4);
+            hrd->bit_rate_scale = bits.ReadBits(4);
+            hrd->cpb_size_scale = bits.ReadBits(4);
             if (hrd->sub_pic_hrd_params_present_flag)
             {
-                hrd->cpb_size_du_scale = Parser::readBits(nalu, offset,4);
+                hrd->cpb_size_du_scale = bits.ReadBits(4);
             }
-            hrd->initial_cpb_removal_delay_length_minus1 = Parser::readBits(nalu, offset,5);
-            hrd->au_cpb_removal_delay_length_minus1 = Parser::readBits(nalu, offset,5);
-            hrd->dpb_output_delay_length_minus1 = Parser::readBits(nalu, offset,5);
+            hrd->initial_cpb_removal_delay_length_minus1 = bits.ReadBits(5);
+            hrd->au_cpb_removal_delay_length_minus1 = bits.ReadBits(5);
+            hrd->dpb_output_delay_length_minus1 = bits.ReadBits(5);
         }
     }
     for (amf_uint32 i=0; i<= maxNumSubLayersMinus1; i++)
     {
-        hrd->fixed_pic_rate_general_flag[i] = Parser::getBit(nalu, offset);
+        hrd->fixed_pic_rate_general_flag[i] = bits.ReadBit();
         if (!hrd->fixed_pic_rate_general_flag[i])
         {
-            hrd->fixed_pic_rate_within_cvs_flag[i] = Parser::getBit(nalu, offset);
+            hrd->fixed_pic_rate_within_cvs_flag[i] = bits.ReadBit();
         }
         else
         {
@@ -1396,39 +1310,39 @@ void HevcParser::SpsData::ParseHrdParameters(AMFH265_hrd_parameters_t *hrd, amf_
 
         if (hrd->fixed_pic_rate_within_cvs_flag[i])
         {
-            hrd->elemental_duration_in_tc_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+            hrd->elemental_duration_in_tc_minus1[i] = bits.ReadUe();
         }
         else
         {
-            hrd->low_delay_hrd_flag[i] = Parser::getBit(nalu, offset);
+            hrd->low_delay_hrd_flag[i] = bits.ReadBit();
         }
         if (!hrd->low_delay_hrd_flag[i])
         {
-            hrd->cpb_cnt_minus1[i] = Parser::ExpGolomb::readUe(nalu, offset);
+            hrd->cpb_cnt_minus1[i] = bits.ReadUe();
         }
         if (hrd->nal_hrd_parameters_present_flag)
         {
             //sub_layer_hrd_parameters( i )
-            ParseSubLayerHrdParameters(&hrd->sub_layer_hrd_parameters_0[i], hrd->cpb_cnt_minus1[i], hrd->sub_pic_hrd_params_present_flag, nalu, size, offset);
+            ParseSubLayerHrdParameters(&hrd->sub_layer_hrd_parameters_0[i], hrd->cpb_cnt_minus1[i], hrd->sub_pic_hrd_params_present_flag, bits);
         }
         if (hrd->vcl_hrd_parameters_present_flag)
         {
             //sub_layer_hrd_parameters( i )
-            ParseSubLayerHrdParameters(&hrd->sub_layer_hrd_parameters_1[i], hrd->cpb_cnt_minus1[i], hrd->sub_pic_hrd_params_present_flag, nalu, size, offset);
+            ParseSubLayerHrdParameters(&hrd->sub_layer_hrd_parameters_1[i], hrd->cpb_cnt_minus1[i], hrd->sub_pic_hrd_params_present_flag, bits);
         }
     }
 }
 //-------------------------------------------------------------------------------------------------
-void HevcParser::SpsData::ParseScalingList(AMFH265_scaling_list_data_t * s_data, amf_uint8 *nalu, size_t /*size*/, size_t& offset)
+void HevcParser::SpsData::ParseScalingList(AMFH265_scaling_list_data_t * s_data, Parser::BitReader &bits)
 {
     for (int sizeId=0; sizeId < 4; sizeId++)
     {
         for (int matrixId=0; matrixId < ((sizeId == 3)? 2:6); matrixId++)
         {
-            s_data->scaling_list_pred_mode_flag[sizeId][matrixId] = Parser::getBit(nalu, offset);
+            s_data->scaling_list_pred_mode_flag[sizeId][matrixId] = bits.ReadBit();
             if(!s_data->scaling_list_pred_mode_flag[sizeId][matrixId])
             {
-                s_data->scaling_list_pred_matrix_id_delta[sizeId][matrixId] = Parser::ExpGolomb::readUe(nalu, offset);
+                s_data->scaling_list_pred_matrix_id_delta[sizeId][matrixId] = bits.ReadUe();
 
                 int refMatrixId = matrixId - s_data->scaling_list_pred_matrix_id_delta[sizeId][matrixId];
                 int coefNum = std::min(64, (1<< (4 + (sizeId<<1))));
@@ -1478,12 +1392,12 @@ void HevcParser::SpsData::ParseScalingList(AMFH265_scaling_list_data_t * s_data,
                 int coefNum = std::min(64, (1<< (4 + (sizeId<<1))));
                 if (sizeId > 1)
                 {
-                    s_data->scaling_list_dc_coef_minus8[sizeId-2][matrixId] = Parser::ExpGolomb::readSe(nalu, offset);
+                    s_data->scaling_list_dc_coef_minus8[sizeId-2][matrixId] = bits.ReadSe();
                     nextCoef = s_data->scaling_list_dc_coef_minus8[sizeId-2][matrixId] + 8;
                 }
                 for (int i=0; i < coefNum; i++)
                 {
-                    s_data->scaling_list_delta_coef = Parser::ExpGolomb::readSe(nalu, offset);
+                    s_data->scaling_list_delta_coef = bits.ReadSe();
                     nextCoef = (nextCoef + s_data->scaling_list_delta_coef +256)%256;
                     s_data->ScalingList[sizeId][matrixId][i] = nextCoef;
                 }
@@ -1491,7 +1405,7 @@ void HevcParser::SpsData::ParseScalingList(AMFH265_scaling_list_data_t * s_data,
         }
     }
 }
-void HevcParser::SpsData::ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps, amf_int32 stRpsIdx, amf_uint32 number_short_term_ref_pic_sets, AMFH265_short_term_RPS_t rps_ref[], amf_uint8 *nalu, size_t /*size*/, size_t& offset)
+void HevcParser::SpsData::ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps, amf_int32 stRpsIdx, amf_uint32 number_short_term_ref_pic_sets, AMFH265_short_term_RPS_t rps_ref[], Parser::BitReader &bits)
 {
     amf_uint32 interRPSPred = 0;
     amf_uint32 delta_idx_minus1 = 0;
@@ -1499,7 +1413,7 @@ void HevcParser::SpsData::ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps,
 
     if (stRpsIdx != 0)
     {
-        interRPSPred = Parser::getBit(nalu, offset);
+        interRPSPred = bits.ReadBit();
     }
     if (interRPSPred)
     {
@@ -1508,18 +1422,18 @@ void HevcParser::SpsData::ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps,
         amf_bool use_delta_flag[16] = {0};
         if (unsigned(stRpsIdx) == number_short_term_ref_pic_sets)
         {
-            delta_idx_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
+            delta_idx_minus1 = bits.ReadUe();
         }
-        delta_rps_sign = Parser::getBit(nalu, offset);
-        abs_delta_rps_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
+        delta_rps_sign = bits.ReadBit();
+        abs_delta_rps_minus1 = bits.ReadUe();
         amf_int32 delta_rps = (amf_int32) (1 - 2*delta_rps_sign) * (abs_delta_rps_minus1 + 1);
         amf_int32 ref_idx = stRpsIdx - delta_idx_minus1 - 1;
         for (int j=0; j<= (rps_ref[ref_idx].num_negative_pics + rps_ref[ref_idx].num_positive_pics); j++)
         {
-            used_by_curr_pic_flag[j] = Parser::getBit(nalu, offset);
+            used_by_curr_pic_flag[j] = bits.ReadBit();
             if (!used_by_curr_pic_flag[j])
             {
-                use_delta_flag[j] = Parser::getBit(nalu, offset);
+                use_delta_flag[j] = bits.ReadBit();
             }
             else
             {
@@ -1583,117 +1497,117 @@ void HevcParser::SpsData::ParseShortTermRefPicSet(AMFH265_short_term_RPS_t *rps,
     }
     else
     {
-        rps->num_negative_pics = Parser::ExpGolomb::readUe(nalu, offset);
-        rps->num_positive_pics = Parser::ExpGolomb::readUe(nalu, offset);
+        rps->num_negative_pics = bits.ReadUe();
+        rps->num_positive_pics = bits.ReadUe();
         amf_int32 prev = 0;
         amf_int32 poc;
         amf_uint32 delta_poc_s0_minus1,delta_poc_s1_minus1;
         for (int j=0; j < rps->num_negative_pics; j++)
         {
-            delta_poc_s0_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
+            delta_poc_s0_minus1 = bits.ReadUe();
             poc = prev - delta_poc_s0_minus1 - 1;
             prev = poc;
             rps->deltaPOC[j] = poc;
-            rps->used_by_curr_pic[j] = Parser::getBit(nalu, offset);
+            rps->used_by_curr_pic[j] = bits.ReadBit();
         }
         prev = 0;
         for (int j=rps->num_negative_pics; j < rps->num_negative_pics + rps->num_positive_pics; j++)
         {
-            delta_poc_s1_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
+            delta_poc_s1_minus1 = bits.ReadUe();
             poc = prev + delta_poc_s1_minus1 + 1;
             prev = poc;
             rps->deltaPOC[j] = poc;
-            rps->used_by_curr_pic[j] = Parser::getBit(nalu, offset);
+            rps->used_by_curr_pic[j] = bits.ReadBit();
         }
         rps->num_of_pics = rps->num_negative_pics + rps->num_positive_pics;
         rps->num_of_delta_poc = rps->num_negative_pics + rps->num_positive_pics;
     }
 }
 
-void HevcParser::SpsData::ParseVUI(AMFH265_vui_parameters_t *vui, amf_uint32 maxNumSubLayersMinus1, amf_uint8 *nalu, size_t size, size_t &offset)
+void HevcParser::SpsData::ParseVUI(AMFH265_vui_parameters_t *vui, amf_uint32 maxNumSubLayersMinus1, Parser::BitReader &bits)
 {
-    vui->aspect_ratio_info_present_flag = Parser::getBit(nalu, offset);
+    vui->aspect_ratio_info_present_flag = bits.ReadBit();
     if (vui->aspect_ratio_info_present_flag)
     {
-        vui->aspect_ratio_idc = Parser::readBits(nalu, offset,8);
+        vui->aspect_ratio_idc = bits.ReadBits(8);
         if (vui->aspect_ratio_idc == 255)
         {
-            vui->sar_width = Parser::readBits(nalu, offset,16);
-            vui->sar_height = Parser::readBits(nalu, offset,16);
+            vui->sar_width = bits.ReadBits(16);
+            vui->sar_height = bits.ReadBits(16);
         }
     }
-    vui->overscan_info_present_flag = Parser::getBit(nalu, offset);
+    vui->overscan_info_present_flag = bits.ReadBit();
     if (vui->overscan_info_present_flag)
     {
-        vui->overscan_appropriate_flag = Parser::getBit(nalu, offset);
+        vui->overscan_appropriate_flag = bits.ReadBit();
     }
-    vui->video_signal_type_present_flag = Parser::getBit(nalu, offset);
+    vui->video_signal_type_present_flag = bits.ReadBit();
     if(vui->video_signal_type_present_flag)
     {
-        vui->video_format = Parser::readBits(nalu, offset,3);
-        vui->video_full_range_flag = Parser::getBit(nalu, offset);
-        vui->colour_description_present_flag = Parser::getBit(nalu, offset);
+        vui->video_format = bits.ReadBits(3);
+        vui->video_full_range_flag = bits.ReadBit();
+        vui->colour_description_present_flag = bits.ReadBit();
         if (vui->colour_description_present_flag)
         {
-            vui->colour_primaries = Parser::readBits(nalu, offset,8);
-            vui->transfer_characteristics = Parser::readBits(nalu, offset,8);
-            vui->matrix_coeffs = Parser::readBits(nalu, offset,8);
+            vui->colour_primaries = bits.ReadBits(8);
+            vui->transfer_characteristics = bits.ReadBits(8);
+            vui->matrix_coeffs = bits.ReadBits(8);
         }
     }
-    vui->chroma_loc_info_present_flag = Parser::getBit(nalu, offset);
+    vui->chroma_loc_info_present_flag = bits.ReadBit();
     if (vui->chroma_loc_info_present_flag)
     {
-        vui->chroma_sample_loc_type_top_field = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->chroma_sample_loc_type_bottom_field = Parser::ExpGolomb::readUe(nalu, offset);
+        vui->chroma_sample_loc_type_top_field = bits.ReadUe();
+        vui->chroma_sample_loc_type_bottom_field = bits.ReadUe();
     }
-    vui->neutral_chroma_indication_flag = Parser::getBit(nalu, offset);
-    vui->field_seq_flag = Parser::getBit(nalu, offset);
-    vui->frame_field_info_present_flag = Parser::getBit(nalu, offset);
-    vui->default_display_window_flag = Parser::getBit(nalu, offset);
+    vui->neutral_chroma_indication_flag = bits.ReadBit();
+    vui->field_seq_flag = bits.ReadBit();
+    vui->frame_field_info_present_flag = bits.ReadBit();
+    vui->default_display_window_flag = bits.ReadBit();
     if (vui->default_display_window_flag)
     {
-        vui->def_disp_win_left_offset = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->def_disp_win_right_offset = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->def_disp_win_top_offset = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->def_disp_win_bottom_offset = Parser::ExpGolomb::readUe(nalu, offset);
+        vui->def_disp_win_left_offset = bits.ReadUe();
+        vui->def_disp_win_right_offset = bits.ReadUe();
+        vui->def_disp_win_top_offset = bits.ReadUe();
+        vui->def_disp_win_bottom_offset = bits.ReadUe();
     }
-    vui->vui_timing_info_present_flag = Parser::getBit(nalu, offset);
+    vui->vui_timing_info_present_flag = bits.ReadBit();
     if (vui->vui_timing_info_present_flag)
     {
-        vui->vui_num_units_in_tick = Parser::readBits(nalu, offset,32);
-        vui->vui_time_scale = Parser::readBits(nalu, offset,32);
-        vui->vui_poc_proportional_to_timing_flag = Parser::getBit(nalu, offset);
+        vui->vui_num_units_in_tick = bits.ReadBits(32);
+        vui->vui_time_scale = bits.ReadBits(32);
+        vui->vui_poc_proportional_to_timing_flag = bits.ReadBit();
         if (vui->vui_poc_proportional_to_timing_flag)
         {
-            vui->vui_num_ticks_poc_diff_one_minus1 = Parser::ExpGolomb::readUe(nalu, offset);
+            vui->vui_num_ticks_poc_diff_one_minus1 = bits.ReadUe();
         }
-        vui->vui_hrd_parameters_present_flag = Parser::getBit(nalu, offset);
+        vui->vui_hrd_parameters_present_flag = bits.ReadBit();
         if (vui->vui_hrd_parameters_present_flag)
         {
-            ParseHrdParameters(&vui->hrd_parameters, 1, maxNumSubLayersMinus1, nalu, size, offset);
+            ParseHrdParameters(&vui->hrd_parameters, 1, maxNumSubLayersMinus1, bits);
         }
     }
-    vui->bitstream_restriction_flag = Parser::getBit(nalu, offset);
+    vui->bitstream_restriction_flag = bits.ReadBit();
     if (vui->bitstream_restriction_flag)
     {
-        vui->tiles_fixed_structure_flag = Parser::getBit(nalu, offset);
-        vui->motion_vectors_over_pic_boundaries_flag = Parser::getBit(nalu, offset);
-        vui->restricted_ref_pic_lists_flag = Parser::getBit(nalu, offset);
-        vui->min_spatial_segmentation_idc = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->max_bytes_per_pic_denom = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->max_bits_per_min_cu_denom = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->log2_max_mv_length_horizontal = Parser::ExpGolomb::readUe(nalu, offset);
-        vui->log2_max_mv_length_vertical = Parser::ExpGolomb::readUe(nalu, offset);
+        vui->tiles_fixed_structure_flag = bits.ReadBit();
+        vui->motion_vectors_over_pic_boundaries_flag = bits.ReadBit();
+        vui->restricted_ref_pic_lists_flag = bits.ReadBit();
+        vui->min_spatial_segmentation_idc = bits.ReadUe();
+        vui->max_bytes_per_pic_denom = bits.ReadUe();
+        vui->max_bits_per_min_cu_denom = bits.ReadUe();
+        vui->log2_max_mv_length_horizontal = bits.ReadUe();
+        vui->log2_max_mv_length_vertical = bits.ReadUe();
     }
 }
 
 
 //-------------------------------------------------------------------------------------------------
-bool HevcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /*size*/, std::map<amf_uint32, SpsData>&/*spsMap*/, std::map<amf_uint32, PpsData>& /*ppsMap*/)
+bool HevcParser::AccessUnitSigns::Parse(const amf_uint8 *nalu, size_t size, std::map<amf_uint32, SpsData>&/*spsMap*/, std::map<amf_uint32, PpsData>& /*ppsMap*/)
 {
-    size_t offset = 16; // 2 bytes NALU header
+    Parser::BitReader bits(nalu, size, 16); // 2 bytes NALU header
 
-    bNewPicture = Parser::getBit(nalu, offset);
+    bNewPicture = bits.ReadBit();
     return true;
 }
 //-------------------------------------------------------------------------------------------------
@@ -1702,7 +1616,7 @@ bool HevcParser::AccessUnitSigns::IsNewPicture()
     return bNewPicture;
 }
 //-------------------------------------------------------------------------------------------------
-void HevcParser::ExtraDataBuilder::AddSPS(amf_uint8 *sps, size_t size)
+void HevcParser::ExtraDataBuilder::AddSPS(const amf_uint8 *sps, size_t size)
 {
     m_SPSCount++;
     m_SPSSizes.push_back(size);
@@ -1715,7 +1629,7 @@ void HevcParser::ExtraDataBuilder::AddSPS(amf_uint8 *sps, size_t size)
     memcpy(data , sps, (size_t)spsSize);
 }
 //-------------------------------------------------------------------------------------------------
-void HevcParser::ExtraDataBuilder::AddPPS(amf_uint8 *pps, size_t size)
+void HevcParser::ExtraDataBuilder::AddPPS(const amf_uint8 *pps, size_t size)
 {
     m_PPSCount++;
     m_PPSSizes.push_back(size);
@@ -1829,59 +1743,6 @@ bool HevcParser::ExtraDataBuilder::GetExtradata(AMFByteArray   &extradata, bool
     return true;
 }
 //-------------------------------------------------------------------------------------------------
-#define ZEROBYTES_SHORTSTARTCODE 2 //indicates the number of zero bytes in the short start-code prefix
-//-------------------------------------------------------------------------------------------------
-size_t HevcParser::EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos)
-{
-    int count = 0;
-    if(end_bytepos < begin_bytepos)
-    {
-        return end_bytepos;
-    }
-    amf_uint8 *streamBuffer_i=streamBuffer+begin_bytepos;
-    amf_uint8 *streamBuffer_end=streamBuffer+end_bytepos;
-    int iReduceCount=0;
-    for(; streamBuffer_i!=streamBuffer_end; )
-    {
-        //starting from begin_bytepos to avoid header information
-        //in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
-        amf_uint8 tmp=*streamBuffer_i;
-        if(count == ZEROBYTES_SHORTSTARTCODE)
-        {
-            if(tmp == 0x03)
-            {
-                //check the 4th amf_uint8 after 0x000003, except when cabac_zero_word is used, in which case the last three bytes of this NAL unit must be 0x000003
-                if((streamBuffer_i+1 != streamBuffer_end) && (streamBuffer_i[1] > 0x03))
-                {
-                    return static_cast<size_t>(-1);
-                }
-                //if cabac_zero_word is used, the final amf_uint8 of this NAL unit(0x03) is discarded, and the last two bytes of RBSP must be 0x0000
-                if(streamBuffer_i+1 == streamBuffer_end)
-                {
-                    break;
-                }
-                memmove(streamBuffer_i,streamBuffer_i+1,streamBuffer_end-streamBuffer_i-1);
-                streamBuffer_end--;
-                iReduceCount++;
-                count = 0;
-                tmp = *streamBuffer_i;
-            }
-            else if(tmp < 0x03)
-            {
-            }
-        }
-        if(tmp == 0x00)
-        {
-            count++;
-        }
-        else
-        {
-            count = 0;
-        }
-        streamBuffer_i++;
-    }
-    return end_bytepos - begin_bytepos + iReduceCount;
-}
 
 //sizeId = 0
 int scaling_list_default_0 [1][6][16] =  {{{16,16,16,16,16,16,16,16,16,16,16,16,16,16,16,16},
@@ -1913,6 +1774,6 @@ AMF_RESULT              HevcParser::ReInit()
     m_currentFrameTimestamp = 0;
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
     m_PacketCount = 0;
-    m_bEof = false;
+    m_Window.Reset();
     return AMF_OK;
 }
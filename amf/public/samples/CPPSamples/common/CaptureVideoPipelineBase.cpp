@@ -168,8 +168,9 @@ public:
             {
                 m_pDecoderSync->Reset(m_iIndex);
             }
-            if(res == AMF_DECODER_NO_FREE_SURFACES)
+            if(res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
             {
+                NotifyOutputAvailable(0); // the component holds output that has to be queried first
                 return AMF_INPUT_FULL;
             }
         }
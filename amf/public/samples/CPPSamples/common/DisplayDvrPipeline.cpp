@@ -246,8 +246,9 @@ public:
             }
 
             res = m_pComponent->SubmitInput(pData);
-            if(res == AMF_DECODER_NO_FREE_SURFACES)
+            if(res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
             {
+                NotifyOutputAvailable(0); // the component holds output that has to be queried first
                 return AMF_INPUT_FULL;
             }
             m_framesSubmitted++;
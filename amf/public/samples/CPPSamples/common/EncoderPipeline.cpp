@@ -42,7 +42,6 @@ EncoderPipeline::EncoderPipeline(ParametersManagerPtr pParams) :
     m_framesEncoded(0),
     m_frameParameterFreq(0),
     m_dynamicParameterFreq(0),
-    m_stream(NULL),
     m_eStatus(PS_UnInitialized),
     m_RenderThread(this),
     m_PollingThread(this)
@@ -123,8 +122,7 @@ AMF_RESULT  EncoderPipeline::Init(int threadID)
         outputPath = outputPath.substr(0, pos_dot) + L"_" + (wchar_t)(threadID+L'0') + outputPath.substr(pos_dot);
     }
 
-    m_stream = AMFDataStream::Create(outputPath.c_str(), AMF_FileWrite);
-    if(m_stream == NULL )
+    if(m_writer.Open(outputPath.c_str()) != AMF_OK)
     {
         LOG_ERROR(L"Failed to open file: " << outputPath);
         return AMF_FAIL;
@@ -172,10 +170,7 @@ AMF_RESULT  EncoderPipeline::Terminate()
     m_PollingThread.RequestStop();
     m_PollingThread.WaitForStop();
 
-    if(m_stream != NULL)
-    {
-        m_stream = NULL;
-    }
+    m_writer.Close();
     return AMF_OK;
 }
 
@@ -247,11 +242,11 @@ void EncoderPipeline::PollingThread::Run()
             m_pHost->m_framesEncoded++; 
             amf::AMFBufferPtr buffer(data);
 
-            amf_size towrite = buffer->GetSize();
-            amf_size written = m_pHost->m_stream->Write(buffer->GetNative(), towrite);
-            if(written != towrite)
+            // queued for the writer thread - a slow disk no longer holds back QueryOutput()
+            res = m_pHost->m_writer.Write(buffer);
+            if(res != AMF_OK)
             {
-                LOG_ERROR(L"Failed to write "<< towrite << L"bytes");
+                LOG_ERROR(L"Failed to write "<< buffer->GetSize() << L"bytes");
             }
 
             if( m_pHost->m_framesEncoded == m_pHost->m_framesRequested)
@@ -267,6 +262,7 @@ void EncoderPipeline::PollingThread::Run()
             break;
         }
     }
+    m_pHost->m_writer.Flush();
     m_pHost->m_stat.Stop();
     m_pHost->m_stat.SetFrameCount(m_pHost->m_framesEncoded);
     m_pHost->SetStatus(PS_Eof);
@@ -34,6 +34,7 @@
 #include "../../../include/components/VideoEncoderHW_AVC.h"
 #include "EncoderStatistic.h"
 #include "FrameProvider.h"
+#include "AsyncStreamWriter.h"
 
 class EncoderPipeline
 {
@@ -84,7 +85,7 @@ protected:
     ParametersManagerPtr    m_params; 
     amf::AMFContextPtr      m_context;
     amf::AMFComponentPtr    m_encoder;
-    AMFDataStreamPtr        m_stream;
+    AsyncStreamWriter       m_writer;
 
     RenderThread            m_RenderThread;
     PollingThread           m_PollingThread;
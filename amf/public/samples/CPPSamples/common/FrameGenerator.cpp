@@ -0,0 +1,1066 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "FrameGenerator.h"
+#include "public/common/TraceAdapter.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || (defined(__i386__) && defined(__SSE2__))
+    #define FRAME_SIMD_X86
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define FRAME_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+#define AMF_FACILITY L"FrameGenerator"
+
+#define FRAME_GENERATOR_ALIGNMENT       64
+#define FRAME_GENERATOR_MAX_FREE_BLOCKS 16
+#define FRAME_GENERATOR_MIN_BAND_ROWS   32
+
+//-------------------------------------------------------------------------------------------------
+// Line kernels. Patterns are 16 bytes long and start at the beginning of the line, so a pixel
+// of 1, 2 or 4 components keeps its phase in every 16-byte block. Noise is four xorshift32
+// generators, one 16-byte block per step, the same in the scalar and SIMD versions.
+//-------------------------------------------------------------------------------------------------
+struct FrameKernels
+{
+    const char* pName;
+
+    void (*FillPattern)(const amf_uint8* pPattern, amf_uint8* pDst, amf_size count);
+    void (*AddOffset)(const amf_uint8* pIn, amf_uint8 offset, amf_uint8* pOut, amf_size count);
+    // repeats every byte 2 or 4 times, count input bytes
+    void (*Expand2)(const amf_uint8* pIn, amf_uint8* pOut, amf_size count);
+    void (*Expand4)(const amf_uint8* pIn, amf_uint8* pOut, amf_size count);
+    // background to foreground by the mask, 255 is all foreground; pAmplitude == NULL - no noise
+    void (*Blend)(const amf_uint8* pMask, const amf_uint8* pBackground, const amf_uint8* pForeground,
+                  const amf_uint8* pAmplitude, amf_uint32* pNoise, amf_uint8* pDst, amf_size count);
+    // 8-bit to MSB aligned 16-bit
+    void (*Widen16)(const amf_uint8* pIn, amf_uint16* pOut, amf_size count);
+};
+
+//-------------------------------------------------------------------------------------------------
+// scalar reference, also used for the SIMD tails
+//-------------------------------------------------------------------------------------------------
+static inline void NoiseNext(amf_uint32* pState)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        amf_uint32 x = pState[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        pState[i] = x;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void FillPattern_Scalar(const amf_uint8* pPattern, amf_uint8* pDst, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        memcpy(pDst + x, pPattern, 16);
+    }
+    memcpy(pDst + x, pPattern, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void AddOffset_Scalar(const amf_uint8* pIn, amf_uint8 offset, amf_uint8* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_uint8(pIn[x] + offset);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void Expand2_Scalar(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[2 * x] = pOut[2 * x + 1] = pIn[x];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void Expand4_Scalar(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[4 * x] = pOut[4 * x + 1] = pOut[4 * x + 2] = pOut[4 * x + 3] = pIn[x];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void Blend_Scalar(const amf_uint8* pMask, const amf_uint8* pBackground, const amf_uint8* pForeground,
+                         const amf_uint8* pAmplitude, amf_uint32* pNoise, amf_uint8* pDst, amf_size count)
+{
+    for (amf_size x = 0; x < count; x += 16)
+    {
+        const amf_size block = count - x < 16 ? count - x : 16;
+        if (pAmplitude != NULL)
+        {
+            NoiseNext(pNoise);
+        }
+        for (amf_size i = 0; i < block; i++)
+        {
+            amf_int32 m = pMask[x + i];
+            m += m >> 7; // 0..256
+            amf_int32 v = (pBackground[i] * (256 - m) + pForeground[i] * m) >> 8;
+            if (pAmplitude != NULL)
+            {
+                const amf_int32 r = amf_uint8(pNoise[i / 4] >> (8 * (i % 4)));
+                const amf_int32 a = pAmplitude[i];
+                v += ((r * (2 * a + 1)) >> 8) - a;
+                v = v < 0 ? 0 : (v > 255 ? 255 : v);
+            }
+            pDst[x + i] = amf_uint8(v);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void Widen16_Scalar(const amf_uint8* pIn, amf_uint16* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_uint16(pIn[x] << 8);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static const FrameKernels s_KernelsScalar =
+{
+    "scalar",
+    FillPattern_Scalar,
+    AddOffset_Scalar,
+    Expand2_Scalar,
+    Expand4_Scalar,
+    Blend_Scalar,
+    Widen16_Scalar,
+};
+
+#if defined(FRAME_SIMD_X86)
+//-------------------------------------------------------------------------------------------------
+// SSE2
+//-------------------------------------------------------------------------------------------------
+static void FillPattern_SSE2(const amf_uint8* pPattern, amf_uint8* pDst, amf_size count)
+{
+    const __m128i p = _mm_loadu_si128((const __m128i*)pPattern);
+    amf_size x = 0;
+    for (; x + 64 <= count; x += 64)
+    {
+        _mm_storeu_si128((__m128i*)(pDst + x), p);
+        _mm_storeu_si128((__m128i*)(pDst + x + 16), p);
+        _mm_storeu_si128((__m128i*)(pDst + x + 32), p);
+        _mm_storeu_si128((__m128i*)(pDst + x + 48), p);
+    }
+    for (; x + 16 <= count; x += 16)
+    {
+        _mm_storeu_si128((__m128i*)(pDst + x), p);
+    }
+    memcpy(pDst + x, pPattern, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void AddOffset_SSE2(const amf_uint8* pIn, amf_uint8 offset, amf_uint8* pOut, amf_size count)
+{
+    const __m128i o = _mm_set1_epi8(char(offset));
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_add_epi8(_mm_loadu_si128((const __m128i*)(pIn + x)), o));
+    }
+    AddOffset_Scalar(pIn + x, offset, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Expand2_SSE2(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pIn + x));
+        _mm_storeu_si128((__m128i*)(pOut + 2 * x), _mm_unpacklo_epi8(v, v));
+        _mm_storeu_si128((__m128i*)(pOut + 2 * x + 16), _mm_unpackhi_epi8(v, v));
+    }
+    Expand2_Scalar(pIn + x, pOut + 2 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Expand4_SSE2(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pIn + x));
+        const __m128i lo = _mm_unpacklo_epi8(v, v);
+        const __m128i hi = _mm_unpackhi_epi8(v, v);
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x), _mm_unpacklo_epi16(lo, lo));
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x + 16), _mm_unpackhi_epi16(lo, lo));
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x + 32), _mm_unpacklo_epi16(hi, hi));
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x + 48), _mm_unpackhi_epi16(hi, hi));
+    }
+    Expand4_Scalar(pIn + x, pOut + 4 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Blend_SSE2(const amf_uint8* pMask, const amf_uint8* pBackground, const amf_uint8* pForeground,
+                       const amf_uint8* pAmplitude, amf_uint32* pNoise, amf_uint8* pDst, amf_size count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c256 = _mm_set1_epi16(256);
+    const __m128i bg = _mm_loadu_si128((const __m128i*)pBackground);
+    const __m128i fg = _mm_loadu_si128((const __m128i*)pForeground);
+    const __m128i bgLo = _mm_unpacklo_epi8(bg, zero);
+    const __m128i bgHi = _mm_unpackhi_epi8(bg, zero);
+    const __m128i fgLo = _mm_unpacklo_epi8(fg, zero);
+    const __m128i fgHi = _mm_unpackhi_epi8(fg, zero);
+
+    amf_size x = 0;
+    if (pAmplitude == NULL)
+    {
+        for (; x + 16 <= count; x += 16)
+        {
+            const __m128i m = _mm_loadu_si128((const __m128i*)(pMask + x));
+            __m128i mLo = _mm_unpacklo_epi8(m, zero);
+            __m128i mHi = _mm_unpackhi_epi8(m, zero);
+            mLo = _mm_add_epi16(mLo, _mm_srli_epi16(mLo, 7));
+            mHi = _mm_add_epi16(mHi, _mm_srli_epi16(mHi, 7));
+            // at most 255 * 256, fits the unsigned 16-bit lanes
+            const __m128i vLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(bgLo, _mm_sub_epi16(c256, mLo)), _mm_mullo_epi16(fgLo, mLo)), 8);
+            const __m128i vHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(bgHi, _mm_sub_epi16(c256, mHi)), _mm_mullo_epi16(fgHi, mHi)), 8);
+            _mm_storeu_si128((__m128i*)(pDst + x), _mm_packus_epi16(vLo, vHi));
+        }
+    }
+    else
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)pAmplitude);
+        const __m128i aLo = _mm_unpacklo_epi8(a, zero);
+        const __m128i aHi = _mm_unpackhi_epi8(a, zero);
+        const __m128i scaleLo = _mm_add_epi16(_mm_add_epi16(aLo, aLo), _mm_set1_epi16(1));
+        const __m128i scaleHi = _mm_add_epi16(_mm_add_epi16(aHi, aHi), _mm_set1_epi16(1));
+        __m128i s = _mm_loadu_si128((const __m128i*)pNoise);
+
+        for (; x + 16 <= count; x += 16)
+        {
+            s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+            s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+            s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+
+            const __m128i m = _mm_loadu_si128((const __m128i*)(pMask + x));
+            __m128i mLo = _mm_unpacklo_epi8(m, zero);
+            __m128i mHi = _mm_unpackhi_epi8(m, zero);
+            mLo = _mm_add_epi16(mLo, _mm_srli_epi16(mLo, 7));
+            mHi = _mm_add_epi16(mHi, _mm_srli_epi16(mHi, 7));
+            __m128i vLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(bgLo, _mm_sub_epi16(c256, mLo)), _mm_mullo_epi16(fgLo, mLo)), 8);
+            __m128i vHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(bgHi, _mm_sub_epi16(c256, mHi)), _mm_mullo_epi16(fgHi, mHi)), 8);
+
+            // noise in -a..a, the signed sum saturates in the pack
+            const __m128i nLo = _mm_sub_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), scaleLo), 8), aLo);
+            const __m128i nHi = _mm_sub_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), scaleHi), 8), aHi);
+            vLo = _mm_add_epi16(vLo, nLo);
+            vHi = _mm_add_epi16(vHi, nHi);
+            _mm_storeu_si128((__m128i*)(pDst + x), _mm_packus_epi16(vLo, vHi));
+        }
+        _mm_storeu_si128((__m128i*)pNoise, s);
+    }
+    Blend_Scalar(pMask + x, pBackground, pForeground, pAmplitude, pNoise, pDst + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Widen16_SSE2(const amf_uint8* pIn, amf_uint16* pOut, amf_size count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pIn + x));
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_unpacklo_epi8(zero, v));
+        _mm_storeu_si128((__m128i*)(pOut + x + 8), _mm_unpackhi_epi8(zero, v));
+    }
+    Widen16_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static const FrameKernels s_KernelsSSE2 =
+{
+    "SSE2",
+    FillPattern_SSE2,
+    AddOffset_SSE2,
+    Expand2_SSE2,
+    Expand4_SSE2,
+    Blend_SSE2,
+    Widen16_SSE2,
+};
+#endif // FRAME_SIMD_X86
+
+#if defined(FRAME_SIMD_NEON)
+//-------------------------------------------------------------------------------------------------
+// NEON: structured stores do the byte repetition and the 8 to 16-bit widening
+//-------------------------------------------------------------------------------------------------
+static void FillPattern_NEON(const amf_uint8* pPattern, amf_uint8* pDst, amf_size count)
+{
+    const uint8x16_t p = vld1q_u8(pPattern);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        vst1q_u8(pDst + x, p);
+    }
+    memcpy(pDst + x, pPattern, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void AddOffset_NEON(const amf_uint8* pIn, amf_uint8 offset, amf_uint8* pOut, amf_size count)
+{
+    const uint8x16_t o = vdupq_n_u8(offset);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        vst1q_u8(pOut + x, vaddq_u8(vld1q_u8(pIn + x), o));
+    }
+    AddOffset_Scalar(pIn + x, offset, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Expand2_NEON(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        uint8x16x2_t v;
+        v.val[0] = v.val[1] = vld1q_u8(pIn + x);
+        vst2q_u8(pOut + 2 * x, v);
+    }
+    Expand2_Scalar(pIn + x, pOut + 2 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Expand4_NEON(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        uint8x16x4_t v;
+        v.val[0] = v.val[1] = v.val[2] = v.val[3] = vld1q_u8(pIn + x);
+        vst4q_u8(pOut + 4 * x, v);
+    }
+    Expand4_Scalar(pIn + x, pOut + 4 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static inline uint16x8_t BlendHalf_NEON(uint8x8_t mask, uint16x8_t bg, uint16x8_t fg)
+{
+    uint16x8_t m = vmovl_u8(mask);
+    m = vsraq_n_u16(m, m, 7);
+    return vshrq_n_u16(vmlaq_u16(vmulq_u16(bg, vsubq_u16(vdupq_n_u16(256), m)), fg, m), 8);
+}
+//-------------------------------------------------------------------------------------------------
+static void Blend_NEON(const amf_uint8* pMask, const amf_uint8* pBackground, const amf_uint8* pForeground,
+                       const amf_uint8* pAmplitude, amf_uint32* pNoise, amf_uint8* pDst, amf_size count)
+{
+    const uint8x16_t bg = vld1q_u8(pBackground);
+    const uint8x16_t fg = vld1q_u8(pForeground);
+    const uint16x8_t bgLo = vmovl_u8(vget_low_u8(bg));
+    const uint16x8_t bgHi = vmovl_u8(vget_high_u8(bg));
+    const uint16x8_t fgLo = vmovl_u8(vget_low_u8(fg));
+    const uint16x8_t fgHi = vmovl_u8(vget_high_u8(fg));
+
+    amf_size x = 0;
+    if (pAmplitude == NULL)
+    {
+        for (; x + 16 <= count; x += 16)
+        {
+            const uint8x16_t m = vld1q_u8(pMask + x);
+            const uint16x8_t vLo = BlendHalf_NEON(vget_low_u8(m), bgLo, fgLo);
+            const uint16x8_t vHi = BlendHalf_NEON(vget_high_u8(m), bgHi, fgHi);
+            vst1q_u8(pDst + x, vcombine_u8(vmovn_u16(vLo), vmovn_u16(vHi)));
+        }
+    }
+    else
+    {
+        const uint8x16_t a = vld1q_u8(pAmplitude);
+        const uint16x8_t aLo = vmovl_u8(vget_low_u8(a));
+        const uint16x8_t aHi = vmovl_u8(vget_high_u8(a));
+        const uint16x8_t scaleLo = vaddq_u16(vaddq_u16(aLo, aLo), vdupq_n_u16(1));
+        const uint16x8_t scaleHi = vaddq_u16(vaddq_u16(aHi, aHi), vdupq_n_u16(1));
+        uint32x4_t s = vld1q_u32(pNoise);
+
+        for (; x + 16 <= count; x += 16)
+        {
+            s = veorq_u32(s, vshlq_n_u32(s, 13));
+            s = veorq_u32(s, vshrq_n_u32(s, 17));
+            s = veorq_u32(s, vshlq_n_u32(s, 5));
+            const uint8x16_t r = vreinterpretq_u8_u32(s);
+
+            const uint8x16_t m = vld1q_u8(pMask + x);
+            const int16x8_t vLo = vreinterpretq_s16_u16(BlendHalf_NEON(vget_low_u8(m), bgLo, fgLo));
+            const int16x8_t vHi = vreinterpretq_s16_u16(BlendHalf_NEON(vget_high_u8(m), bgHi, fgHi));
+            const int16x8_t nLo = vsubq_s16(vreinterpretq_s16_u16(vshrq_n_u16(vmulq_u16(vmovl_u8(vget_low_u8(r)), scaleLo), 8)), vreinterpretq_s16_u16(aLo));
+            const int16x8_t nHi = vsubq_s16(vreinterpretq_s16_u16(vshrq_n_u16(vmulq_u16(vmovl_u8(vget_high_u8(r)), scaleHi), 8)), vreinterpretq_s16_u16(aHi));
+            vst1q_u8(pDst + x, vcombine_u8(vqmovun_s16(vaddq_s16(vLo, nLo)), vqmovun_s16(vaddq_s16(vHi, nHi))));
+        }
+        vst1q_u32(pNoise, s);
+    }
+    Blend_Scalar(pMask + x, pBackground, pForeground, pAmplitude, pNoise, pDst + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void Widen16_NEON(const amf_uint8* pIn, amf_uint16* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        uint8x16x2_t v;
+        v.val[0] = vdupq_n_u8(0);
+        v.val[1] = vld1q_u8(pIn + x);
+        vst2q_u8((amf_uint8*)(pOut + x), v);
+    }
+    Widen16_Scalar(pIn + x, pOut + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static const FrameKernels s_KernelsNEON =
+{
+    "NEON",
+    FillPattern_NEON,
+    AddOffset_NEON,
+    Expand2_NEON,
+    Expand4_NEON,
+    Blend_NEON,
+    Widen16_NEON,
+};
+#endif // FRAME_SIMD_NEON
+
+//-------------------------------------------------------------------------------------------------
+static const FrameKernels* GetFrameKernels(FRAME_GENERATOR_KERNEL_LEVEL level)
+{
+    switch (level)
+    {
+    case FRAME_GENERATOR_KERNEL_SCALAR:
+        return &s_KernelsScalar;
+#if defined(FRAME_SIMD_X86)
+    case FRAME_GENERATOR_KERNEL_SSE2:
+        return &s_KernelsSSE2;
+#endif
+#if defined(FRAME_SIMD_NEON)
+    case FRAME_GENERATOR_KERNEL_NEON:
+        return &s_KernelsNEON;
+#endif
+    default:
+        return NULL;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static const FrameKernels& GetBestFrameKernels()
+{
+#if defined(FRAME_SIMD_X86)
+    return s_KernelsSSE2;
+#elif defined(FRAME_SIMD_NEON)
+    return s_KernelsNEON;
+#else
+    return s_KernelsScalar;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+static amf_uint32 Mix32(amf_uint32 h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+//-------------------------------------------------------------------------------------------------
+static void SeedNoise(amf_uint32* pState, amf_int64 frame, amf_int32 layer, amf_int32 row)
+{
+    amf_uint32 h = amf_uint32(frame) * 0x9E3779B1u ^ amf_uint32(frame >> 32) ^ amf_uint32(layer) * 0x27D4EB2Fu ^ amf_uint32(row) * 0x165667B1u;
+    for (int i = 0; i < 4; i++)
+    {
+        h += 0x9E3779B9u;
+        const amf_uint32 x = Mix32(h);
+        pState[i] = x != 0 ? x : 1; // xorshift never leaves zero
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// half float of v / 255, truncated like AMFHalfFloat::ToHalfFloat
+static amf_uint16 HalfFromUnorm8(amf_uint8 v)
+{
+    if (v == 0)
+    {
+        return 0;
+    }
+    union
+    {
+        amf_float   f;
+        amf_uint32  u;
+    } bits;
+    bits.f = amf_float(v) / 255.0f;
+    const amf_uint32 exponent = ((bits.u >> 23) & 0xFF) - 127 + 15; // 1/255 is still a normal half
+    return amf_uint16((exponent << 10) | ((bits.u & 0x007FFFFF) >> 13));
+}
+//-------------------------------------------------------------------------------------------------
+static void RepeatPixel(amf_uint8* pPattern, const amf_uint8* pPixel, amf_int32 size)
+{
+    for (amf_int32 i = 0; i < 16; i++)
+    {
+        pPattern[i] = pPixel[i % size];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static amf_int32 PositiveMod(amf_int64 value, amf_int32 range)
+{
+    const amf_int64 r = value % range;
+    return amf_int32(r < 0 ? r + range : r);
+}
+
+//-------------------------------------------------------------------------------------------------
+// a pooled frame; the surface wrapping it owns the generator until the data is released
+//-------------------------------------------------------------------------------------------------
+class FrameGenerator::Block : public amf::AMFSurfaceObserver
+{
+public:
+    Block() : m_pData(NULL), m_size(0)
+    {
+    }
+    virtual ~Block()
+    {
+        amf_aligned_free(m_pData);
+    }
+    virtual void AMF_STD_CALL OnSurfaceDataRelease(amf::AMFSurface* /*pSurface*/) override
+    {
+        // the generator can go away together with its last outstanding surface
+        // and take this block with it, so nothing may touch members after this
+        FrameGenerator* pOwner = m_pOwner.Detach();
+        pOwner->ReturnBlock(this);
+        pOwner->Release();
+    }
+
+    amf_uint8*          m_pData;
+    amf_size            m_size;
+    FrameGeneratorPtr   m_pOwner;
+};
+//-------------------------------------------------------------------------------------------------
+class FrameGenerator::Worker : public amf::AMFThread
+{
+public:
+    Worker(FrameGenerator* pOwner, amf_int32 band) : m_pOwner(pOwner), m_band(band)
+    {
+    }
+
+    amf::AMFEvent   m_start;
+    amf::AMFEvent   m_done;
+
+protected:
+    virtual void Run() override
+    {
+        for (;;)
+        {
+            m_start.Lock();
+            if (StopRequested())
+            {
+                break;
+            }
+            m_pOwner->FillBand(m_band);
+            m_done.SetEvent();
+        }
+    }
+
+    FrameGenerator* m_pOwner;
+    amf_int32       m_band;
+};
+
+//-------------------------------------------------------------------------------------------------
+FrameGenerator::FrameGenerator() :
+    m_eFormat(amf::AMF_SURFACE_UNKNOWN),
+    m_width(0),
+    m_height(0),
+    m_pKernels(&GetBestFrameKernels()),
+    m_frame(0),
+    m_hPitch(0),
+    m_vPitch(0),
+    m_blockSize(0),
+    m_poolAllocations(0),
+    m_boxSize(0),
+    m_halfLUT(),
+    m_pDst(),
+    m_dstPitch(),
+    m_fillFrame(0),
+    m_bandRows(0)
+{
+    for (amf_int32 i = 0; i < 256; i++)
+    {
+        m_halfLUT[i] = HalfFromUnorm8(amf_uint8(i));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+FrameGenerator::~FrameGenerator()
+{
+    Terminate();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FrameGenerator::Init(amf::AMFContext* pContext, amf::AMF_SURFACE_FORMAT format, amf_int32 width, amf_int32 height,
+                                amf_int32 threads, amf_int32 poolSize)
+{
+    Terminate();
+
+    AMF_RETURN_IF_FALSE(width > 0 && height > 0, AMF_INVALID_ARG, L"Init() - invalid size %dx%d", width, height);
+
+    amf_int32 pixelSize = 0;
+    bool bYUV420 = false;
+    switch (format)
+    {
+    case amf::AMF_SURFACE_NV12:     pixelSize = 1; bYUV420 = true; break;
+    case amf::AMF_SURFACE_P010:     pixelSize = 2; bYUV420 = true; break;
+    case amf::AMF_SURFACE_BGRA:
+    case amf::AMF_SURFACE_RGBA:     pixelSize = 4; break;
+    case amf::AMF_SURFACE_RGBA_F16: pixelSize = 8; break;
+    default:
+        AMF_RETURN_IF_FALSE(false, AMF_NOT_SUPPORTED, L"Init() - format %s is not supported", amf::AMFSurfaceGetFormatName(format));
+    }
+
+    m_pContext = pContext;
+    m_eFormat = format;
+    m_width = width;
+    m_height = height;
+    m_frame = 0;
+
+    m_hPitch = (width * pixelSize + FRAME_GENERATOR_ALIGNMENT - 1) & ~(FRAME_GENERATOR_ALIGNMENT - 1);
+    m_vPitch = bYUV420 ? (height + 1) & ~1 : height;
+    m_blockSize = amf_size(m_hPitch) * m_vPitch;
+    if (bYUV420)
+    {
+        m_blockSize += m_blockSize / 2;
+    }
+
+    SetParams(m_params);
+
+    // bands of whole chroma rows, not so thin that waking a thread costs more than filling them
+    if (threads <= 0)
+    {
+        threads = amf_get_cpu_cores();
+    }
+    amf_int32 bands = AMF_MIN(threads, AMF_MAX(1, height / FRAME_GENERATOR_MIN_BAND_ROWS));
+    m_bandRows = (((height + bands - 1) / bands) + 1) & ~1;
+    bands = (height + m_bandRows - 1) / m_bandRows;
+
+    m_scratch.resize(bands);
+    for (amf_int32 i = 0; i < bands; i++)
+    {
+        m_scratch[i].mask.resize(width);
+        m_scratch[i].expanded.resize(amf_size(width) * 4);
+        m_scratch[i].line.resize(amf_size(width) * 4);
+    }
+    for (amf_int32 i = 1; i < bands; i++)
+    {
+        Worker* pWorker = new Worker(this, i);
+        pWorker->Start();
+        m_workers.push_back(pWorker);
+    }
+
+    if (m_pContext != NULL)
+    {
+        for (amf_int32 i = 0; i < poolSize; i++)
+        {
+            Block* pBlock = new Block();
+            pBlock->m_pData = (amf_uint8*)amf_aligned_alloc(m_blockSize, FRAME_GENERATOR_ALIGNMENT);
+            pBlock->m_size = m_blockSize;
+            if (pBlock->m_pData == NULL)
+            {
+                delete pBlock;
+                Terminate();
+                AMF_RETURN_IF_FALSE(false, AMF_OUT_OF_MEMORY, L"Init() - failed to allocate %d bytes", int(m_blockSize));
+            }
+            m_freeBlocks.push_back(pBlock);
+            m_poolAllocations++;
+        }
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FrameGenerator::Terminate()
+{
+    for (amf::amf_vector<Worker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        (*it)->RequestStop();
+        (*it)->m_start.SetEvent();
+        (*it)->WaitForStop();
+        delete *it;
+    }
+    m_workers.clear();
+    m_scratch.clear();
+
+    // blocks still held by surfaces are freed when they come back with a stale size
+    amf::AMFLock lock(&m_sync);
+    for (amf::amf_vector<Block*>::iterator it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it)
+    {
+        delete *it;
+    }
+    m_freeBlocks.clear();
+    m_blockSize = 0;
+    m_poolAllocations = 0;
+    m_pContext = NULL;
+    m_width = 0;
+    m_height = 0;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void FrameGenerator::SetParams(const FrameGeneratorParams& params)
+{
+    m_params = params;
+    m_params.complexity = AMF_MAX(0, AMF_MIN(100, m_params.complexity));
+
+    if (m_width == 0)
+    {
+        return;
+    }
+
+    const amf_uint8* bg = m_params.background;
+    const amf_uint8* fg = m_params.foreground;
+    const amf_uint8 amplitude = amf_uint8(2 + m_params.complexity * 62 / 100);
+
+    m_layers.clear();
+    Layer layer = {};
+    switch (m_eFormat)
+    {
+    case amf::AMF_SURFACE_NV12:
+    case amf::AMF_SURFACE_P010:
+        {
+            layer.depth = m_eFormat == amf::AMF_SURFACE_NV12 ? 8 : 16;
+            layer.width = m_width;
+            layer.height = m_height;
+            layer.components = 1;
+            RepeatPixel(layer.background, &bg[0], 1);
+            RepeatPixel(layer.foreground, &fg[0], 1);
+            memset(layer.amplitude, amplitude, sizeof(layer.amplitude));
+            m_layers.push_back(layer);
+
+            layer.plane = 1;
+            layer.width = (m_width + 1) / 2;
+            layer.height = (m_height + 1) / 2;
+            layer.components = 2;
+            layer.shift = 1;
+            RepeatPixel(layer.background, &bg[1], 2);
+            RepeatPixel(layer.foreground, &fg[1], 2);
+            memset(layer.amplitude, amplitude / 2, sizeof(layer.amplitude));
+            m_layers.push_back(layer);
+        }
+        break;
+    default:
+        {
+            // R, G, B in the parameters, alpha is constant and noise free
+            const bool bBGRA = m_eFormat == amf::AMF_SURFACE_BGRA;
+            const amf_uint8 alpha = m_params.alpha;
+            const amf_uint8 bgPixel[4] = { bBGRA ? bg[2] : bg[0], bg[1], bBGRA ? bg[0] : bg[2], alpha };
+            const amf_uint8 fgPixel[4] = { bBGRA ? fg[2] : fg[0], fg[1], bBGRA ? fg[0] : fg[2], alpha };
+            const amf_uint8 ampPixel[4] = { amplitude, amplitude, amplitude, 0 };
+            layer.depth = m_eFormat == amf::AMF_SURFACE_RGBA_F16 ? 0 : 8;
+            layer.width = m_width;
+            layer.height = m_height;
+            layer.components = 4;
+            RepeatPixel(layer.background, bgPixel, 4);
+            RepeatPixel(layer.foreground, fgPixel, 4);
+            RepeatPixel(layer.amplitude, ampPixel, 4);
+            m_layers.push_back(layer);
+        }
+        break;
+    }
+
+    m_boxSize = m_params.boxSize > 0 ? m_params.boxSize : AMF_MAX(2, m_height / 8);
+
+    // 0.25 to 1.8 levels per pixel, one ramp per subsampling
+    const amf_int32 step = 64 + m_params.complexity * 4;
+    for (amf_int32 shift = 0; shift < 2; shift++)
+    {
+        const amf_int32 width = (m_width + shift) >> shift;
+        m_ramp[shift].resize(width);
+        for (amf_int32 x = 0; x < width; x++)
+        {
+            m_ramp[shift][x] = amf_uint8(((x << shift) * step) >> 8);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FrameGenerator::SetKernelLevel(FRAME_GENERATOR_KERNEL_LEVEL level)
+{
+    // a query as much as a setting, so no error trace
+    const FrameKernels* pKernels = GetFrameKernels(level);
+    if (pKernels == NULL)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    m_pKernels = pKernels;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+const char* FrameGenerator::GetKernelName() const
+{
+    return static_cast<const FrameKernels*>(m_pKernels)->pName;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FrameGenerator::Generate(amf::AMFSurface** ppSurface)
+{
+    AMF_RETURN_IF_INVALID_POINTER(ppSurface, L"Generate() - ppSurface == NULL");
+    AMF_RETURN_IF_FALSE(m_pContext != NULL, AMF_NOT_INITIALIZED, L"Generate() - not initialized with a context");
+
+    Block* pBlock = NULL;
+    {
+        amf::AMFLock lock(&m_sync);
+        if (m_freeBlocks.empty() == false)
+        {
+            pBlock = m_freeBlocks.back();
+            m_freeBlocks.pop_back();
+        }
+    }
+    if (pBlock == NULL)
+    {
+        pBlock = new Block();
+        pBlock->m_pData = (amf_uint8*)amf_aligned_alloc(m_blockSize, FRAME_GENERATOR_ALIGNMENT);
+        pBlock->m_size = m_blockSize;
+        if (pBlock->m_pData == NULL)
+        {
+            delete pBlock;
+            AMF_RETURN_IF_FALSE(false, AMF_OUT_OF_MEMORY, L"Generate() - failed to allocate %d bytes", int(m_blockSize));
+        }
+        m_poolAllocations++;
+    }
+
+    amf_uint8* pUV = pBlock->m_pData + amf_size(m_hPitch) * m_vPitch;
+    AMF_RESULT res = FillHost(pBlock->m_pData, m_hPitch, pUV, m_hPitch, m_frame);
+    if (res == AMF_OK)
+    {
+        res = m_pContext->CreateSurfaceFromHostNative(m_eFormat, m_width, m_height, m_hPitch, m_vPitch, pBlock->m_pData, ppSurface, pBlock);
+    }
+    if (res != AMF_OK)
+    {
+        ReturnBlock(pBlock);
+        AMF_RETURN_IF_FAILED(res, L"Generate() - CreateSurfaceFromHostNative() failed");
+    }
+    pBlock->m_pOwner = this;
+    m_frame++;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FrameGenerator::Fill(amf::AMFSurface* pSurface, amf_int64 frame)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pSurface, L"Fill() - pSurface == NULL");
+    AMF_RETURN_IF_FALSE(pSurface->GetMemoryType() == amf::AMF_MEMORY_HOST, AMF_INVALID_ARG, L"Fill() - surface is not in host memory");
+    AMF_RETURN_IF_FALSE(pSurface->GetFormat() == m_eFormat, AMF_INVALID_ARG, L"Fill() - surface format does not match");
+
+    amf::AMFPlane* pPlane0 = pSurface->GetPlaneAt(0);
+    AMF_RETURN_IF_INVALID_POINTER(pPlane0, L"Fill() - no planes");
+    AMF_RETURN_IF_FALSE(pPlane0->GetWidth() == m_width && pPlane0->GetHeight() == m_height, AMF_INVALID_ARG,
+        L"Fill() - surface size %dx%d does not match %dx%d", pPlane0->GetWidth(), pPlane0->GetHeight(), m_width, m_height);
+
+    amf::AMFPlane* pPlane1 = pSurface->GetPlanesCount() > 1 ? pSurface->GetPlaneAt(1) : NULL;
+    return FillHost(pPlane0->GetNative(), pPlane0->GetHPitch(),
+                    pPlane1 != NULL ? pPlane1->GetNative() : NULL, pPlane1 != NULL ? pPlane1->GetHPitch() : 0, frame);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FrameGenerator::FillHost(void* pData0, amf_int32 pitch0, void* pData1, amf_int32 pitch1, amf_int64 frame)
+{
+    AMF_RETURN_IF_FALSE(m_width > 0, AMF_NOT_INITIALIZED, L"FillHost() - not initialized");
+    AMF_RETURN_IF_INVALID_POINTER(pData0, L"FillHost() - pData0 == NULL");
+    AMF_RETURN_IF_FALSE(m_layers.size() < 2 || pData1 != NULL, AMF_INVALID_ARG, L"FillHost() - UV plane is missing");
+
+    m_pDst[0] = (amf_uint8*)pData0;
+    m_pDst[1] = (amf_uint8*)pData1;
+    m_dstPitch[0] = pitch0;
+    m_dstPitch[1] = pitch1;
+    PrepareFrame(frame);
+
+    for (amf::amf_vector<Worker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        (*it)->m_start.SetEvent();
+    }
+    FillBand(0);
+    for (amf::amf_vector<Worker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        (*it)->m_done.Lock();
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void FrameGenerator::PrepareFrame(amf_int64 frame)
+{
+    m_fillFrame = frame;
+    m_boxes.clear();
+    if ((m_params.patterns & FRAME_PATTERN_BOXES) == 0)
+    {
+        return;
+    }
+
+    // the first box runs down the diagonal from the top left corner and restarts there once it
+    // reaches the bottom, clipped on the right in portrait frames; the others start at scattered
+    // positions at up to three times its speed and wrap around each axis
+    const amf_int32 count = 1 + m_params.complexity * 15 / 100;
+    const amf_int32 rangeX = AMF_MAX(1, m_width - m_boxSize);
+    const amf_int32 rangeY = AMF_MAX(1, m_height - m_boxSize);
+    Box box;
+    box.x = box.y = PositiveMod(amf_int64(m_params.motion) * frame, rangeY);
+    m_boxes.push_back(box);
+    for (amf_int32 i = 1; i < count; i++)
+    {
+        const amf_int64 startX = Mix32(amf_uint32(2 * i)) % amf_uint32(rangeX);
+        const amf_int64 startY = Mix32(amf_uint32(2 * i + 1)) % amf_uint32(rangeY);
+        const amf_int64 speedX = amf_int64(m_params.motion) * (1 + i % 3);
+        const amf_int64 speedY = amf_int64(m_params.motion) * (1 + (i / 3) % 2);
+
+        box.x = PositiveMod(startX + speedX * frame, rangeX);
+        box.y = PositiveMod(startY + speedY * frame, rangeY);
+        m_boxes.push_back(box);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void FrameGenerator::FillBand(amf_int32 band)
+{
+    const amf_int32 y0 = band * m_bandRows;
+    const amf_int32 y1 = AMF_MIN(m_height, y0 + m_bandRows);
+    const bool bLast = y1 == m_height;
+
+    for (amf_size i = 0; i < m_layers.size(); i++)
+    {
+        const Layer& layer = m_layers[i];
+        const amf_int32 first = y0 >> layer.shift;
+        const amf_int32 last = bLast ? layer.height : y1 >> layer.shift;
+        for (amf_int32 y = first; y < last; y++)
+        {
+            FillLine(amf_int32(i), y, m_scratch[band], m_pDst[layer.plane] + amf_size(y) * m_dstPitch[layer.plane]);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void FrameGenerator::FillLine(amf_int32 index, amf_int32 y, Scratch& scratch, amf_uint8* pDst)
+{
+    const FrameKernels& kernels = *static_cast<const FrameKernels*>(m_pKernels);
+    const Layer& layer = m_layers[index];
+    const amf_size count = amf_size(layer.width) * layer.components;
+    const bool bGradient = (m_params.patterns & FRAME_PATTERN_GRADIENT) != 0;
+    const bool bNoise = (m_params.patterns & FRAME_PATTERN_NOISE) != 0;
+
+    amf_uint8* pLine = layer.depth == 8 ? pDst : scratch.line.data();
+
+    if (bGradient == false && bNoise == false)
+    {
+        // flat colors: pattern stores only
+        kernels.FillPattern(layer.background, pLine, count);
+        for (amf::amf_vector<Box>::const_iterator it = m_boxes.begin(); it != m_boxes.end(); ++it)
+        {
+            if (y >= (it->y >> layer.shift) && y < ((it->y + m_boxSize) >> layer.shift))
+            {
+                const amf_int32 x0 = it->x >> layer.shift;
+                const amf_int32 x1 = AMF_MIN(layer.width, (it->x + m_boxSize) >> layer.shift);
+                if (x1 > x0)
+                {
+                    kernels.FillPattern(layer.foreground, pLine + amf_size(x0) * layer.components, amf_size(x1 - x0) * layer.components);
+                }
+            }
+        }
+    }
+    else
+    {
+        amf_uint8* pMask = scratch.mask.data();
+        if (bGradient)
+        {
+            const amf_int32 step = 64 + m_params.complexity * 4;
+            const amf_int64 offset = ((amf_int64(y << layer.shift) * step) >> 8) + m_fillFrame * m_params.motion;
+            kernels.AddOffset(m_ramp[layer.shift].data(), amf_uint8(offset), pMask, layer.width);
+        }
+        else
+        {
+            memset(pMask, 0, layer.width);
+        }
+        for (amf::amf_vector<Box>::const_iterator it = m_boxes.begin(); it != m_boxes.end(); ++it)
+        {
+            if (y >= (it->y >> layer.shift) && y < ((it->y + m_boxSize) >> layer.shift))
+            {
+                const amf_int32 x0 = it->x >> layer.shift;
+                const amf_int32 x1 = AMF_MIN(layer.width, (it->x + m_boxSize) >> layer.shift);
+                if (x1 > x0)
+                {
+                    memset(pMask + x0, 255, x1 - x0);
+                }
+            }
+        }
+
+        if (layer.components == 2)
+        {
+            kernels.Expand2(pMask, scratch.expanded.data(), layer.width);
+            pMask = scratch.expanded.data();
+        }
+        else if (layer.components == 4)
+        {
+            kernels.Expand4(pMask, scratch.expanded.data(), layer.width);
+            pMask = scratch.expanded.data();
+        }
+
+        amf_uint32 noise[4];
+        if (bNoise)
+        {
+            SeedNoise(noise, m_fillFrame, index, y);
+        }
+        kernels.Blend(pMask, layer.background, layer.foreground, bNoise ? layer.amplitude : NULL, noise, pLine, count);
+    }
+
+    if (layer.depth == 16)
+    {
+        kernels.Widen16(pLine, (amf_uint16*)pDst, count);
+    }
+    else if (layer.depth == 0)
+    {
+        amf_uint16* pOut = (amf_uint16*)pDst;
+        for (amf_size x = 0; x < count; x++)
+        {
+            pOut[x] = m_halfLUT[pLine[x]];
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void FrameGenerator::ReturnBlock(Block* pBlock)
+{
+    {
+        amf::AMFLock lock(&m_sync);
+        if (pBlock->m_size == m_blockSize && m_freeBlocks.size() < FRAME_GENERATOR_MAX_FREE_BLOCKS)
+        {
+            m_freeBlocks.push_back(pBlock);
+            return;
+        }
+    }
+    delete pBlock;
+}
+
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT FillPlaneWithPattern(amf::AMFPlane* pPlane, const void* pPattern, amf_size patternSize)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pPlane, L"FillPlaneWithPattern() - pPlane == NULL");
+    AMF_RETURN_IF_INVALID_POINTER(pPattern, L"FillPlaneWithPattern() - pPattern == NULL");
+    AMF_RETURN_IF_FALSE(patternSize > 0 && patternSize <= 16 && (16 % patternSize) == 0, AMF_INVALID_ARG,
+        L"FillPlaneWithPattern() - pattern size %d does not divide 16", int(patternSize));
+
+    amf_uint8 pattern[16];
+    RepeatPixel(pattern, (const amf_uint8*)pPattern, amf_int32(patternSize));
+
+    const FrameKernels& kernels = GetBestFrameKernels();
+    const amf_size count = amf_size(pPlane->GetWidth()) * pPlane->GetPixelSizeInBytes();
+    const amf_int32 height = pPlane->GetHeight();
+    const amf_int32 pitch = pPlane->GetHPitch();
+    amf_uint8* pData = (amf_uint8*)pPlane->GetNative();
+    for (amf_int32 y = 0; y < height; y++)
+    {
+        kernels.FillPattern(pattern, pData + amf_size(y) * pitch, count);
+    }
+    return AMF_OK;
+}
@@ -0,0 +1,185 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "public/include/core/Context.h"
+#include "public/common/InterfaceImpl.h"
+#include "public/common/Thread.h"
+#include "public/common/AMFSTL.h"
+
+//-------------------------------------------------------------------------------------------------
+// FrameGenerator - synthetic host frames for encoder benchmarks that must not be limited by the
+// frame source. Frames come from a pool of aligned host blocks wrapped with
+// CreateSurfaceFromHostNative, so steady state does not allocate: a block goes back to the pool
+// when the last reference to its surface is released. Lines are built by SSE2/NEON kernels and
+// the frame is split into row bands that worker threads fill in parallel.
+// Supported formats: NV12, P010, BGRA, RGBA, RGBA_F16.
+//-------------------------------------------------------------------------------------------------
+enum FRAME_GENERATOR_PATTERN
+{
+    FRAME_PATTERN_SOLID     = 0x0,  // background color only
+    FRAME_PATTERN_GRADIENT  = 0x1,  // diagonal background to foreground ramp that moves with the frame index
+    FRAME_PATTERN_BOXES     = 0x2,  // foreground squares moving across the frame
+    FRAME_PATTERN_NOISE     = 0x4,  // new random noise on every frame, on top of the other patterns
+};
+
+enum FRAME_GENERATOR_KERNEL_LEVEL
+{
+    FRAME_GENERATOR_KERNEL_SCALAR = 0,
+    FRAME_GENERATOR_KERNEL_SSE2,
+    FRAME_GENERATOR_KERNEL_NEON,
+};
+
+struct FrameGeneratorParams
+{
+    amf_uint32  patterns;       // FRAME_PATTERN_* flags
+    amf_int32   complexity;     // 0..100 - noise amplitude, number of boxes and gradient steepness
+    amf_uint8   background[3];  // Y, U, V for YUV formats, R, G, B for RGB formats
+    amf_uint8   foreground[3];
+    amf_int32   boxSize;        // pixels, 0 - an eighth of the frame height
+    amf_int32   motion;         // pixels per frame
+    amf_uint8   alpha;          // RGB formats, 255 - opaque
+
+    FrameGeneratorParams() :
+        patterns(FRAME_PATTERN_BOXES),
+        complexity(0),
+        background{ 16, 128, 128 },
+        foreground{ 235, 128, 128 },
+        boxSize(0),
+        motion(1),
+        alpha(255)
+    {
+    }
+};
+
+class FrameGenerator : public amf::AMFInterfaceImpl<amf::AMFInterface>
+{
+public:
+    FrameGenerator();
+    virtual ~FrameGenerator();
+
+    // pContext can be NULL when only FillHost() is used
+    // threads: 0 - one per CPU core; poolSize - blocks allocated up front, the pool grows on demand
+    AMF_RESULT  Init(amf::AMFContext* pContext, amf::AMF_SURFACE_FORMAT format, amf_int32 width, amf_int32 height,
+                     amf_int32 threads = 0, amf_int32 poolSize = 4);
+    AMF_RESULT  Terminate();
+
+    void                        SetParams(const FrameGeneratorParams& params);
+    const FrameGeneratorParams& GetParams() const { return m_params; }
+    // AMF_NOT_SUPPORTED if this build has no kernels for the level; the best level is the default
+    AMF_RESULT                  SetKernelLevel(FRAME_GENERATOR_KERNEL_LEVEL level);
+    const char*                 GetKernelName() const;
+
+    // next frame of the sequence in a pooled host surface
+    AMF_RESULT  Generate(amf::AMFSurface** ppSurface);
+    // given frame of the sequence into a host surface of the generator format and size
+    AMF_RESULT  Fill(amf::AMFSurface* pSurface, amf_int64 frame);
+    // same into raw memory; pData1/pitch1 is the UV plane of NV12 and P010, ignored otherwise
+    AMF_RESULT  FillHost(void* pData0, amf_int32 pitch0, void* pData1, amf_int32 pitch1, amf_int64 frame);
+
+    amf_int64   GetFrameIndex() const { return m_frame; }
+    amf_int32   GetThreadCount() const { return amf_int32(m_workers.size()) + 1; }
+    amf_int32   GetPoolAllocations() const { return m_poolAllocations; }   // blocks allocated so far
+
+private:
+    class Block;
+    class Worker;
+    friend class Block;
+    friend class Worker;
+
+    struct Box
+    {
+        amf_int32 x;
+        amf_int32 y;
+    };
+    // one destination plane, generated as a line of 8-bit components
+    struct Layer
+    {
+        amf_int32   plane;
+        amf_int32   width;          // pixels
+        amf_int32   height;
+        amf_int32   components;     // bytes per pixel of the 8-bit line - 1 for Y, 2 for UV, 4 for RGBA
+        amf_int32   shift;          // chroma subsampling
+        amf_int32   depth;          // 8, 16 (MSB aligned) or 0 for half float
+        amf_uint8   background[16]; // one pixel repeated over 16 bytes
+        amf_uint8   foreground[16];
+        amf_uint8   amplitude[16];  // noise amplitude per component
+    };
+    struct Scratch
+    {
+        amf::amf_vector<amf_uint8>  mask;
+        amf::amf_vector<amf_uint8>  expanded;
+        amf::amf_vector<amf_uint8>  line;
+    };
+
+    void        PrepareFrame(amf_int64 frame);
+    void        FillBand(amf_int32 band);
+    void        FillLine(amf_int32 index, amf_int32 y, Scratch& scratch, amf_uint8* pDst);
+    void        ReturnBlock(Block* pBlock);
+
+    amf::AMFCriticalSection     m_sync;
+    amf::AMFContextPtr          m_pContext;
+    amf::AMF_SURFACE_FORMAT     m_eFormat;
+    amf_int32                   m_width;
+    amf_int32                   m_height;
+    FrameGeneratorParams        m_params;
+    const void*                 m_pKernels;
+    amf_int64                   m_frame;
+
+    // pool
+    amf_int32                   m_hPitch;
+    amf_int32                   m_vPitch;
+    amf_size                    m_blockSize;
+    amf::amf_vector<Block*>     m_freeBlocks;
+    amf_int32                   m_poolAllocations;
+
+    // per-frame state shared with the workers
+    amf::amf_vector<Layer>      m_layers;
+    amf::amf_vector<Box>        m_boxes;
+    amf_int32                   m_boxSize;
+    amf::amf_vector<amf_uint8>  m_ramp[2];  // gradient at luma and chroma resolution
+    amf_uint16                  m_halfLUT[256];
+    amf_uint8*                  m_pDst[2];
+    amf_int32                   m_dstPitch[2];
+    amf_int64                   m_fillFrame;
+
+    amf::amf_vector<Worker*>    m_workers;
+    amf::amf_vector<Scratch>    m_scratch;  // one per band, the calling thread fills band 0
+    amf_int32                   m_bandRows;
+};
+typedef amf::AMFInterfacePtr_T<FrameGenerator> FrameGeneratorPtr;
+
+//-------------------------------------------------------------------------------------------------
+// fills the visible part of a host plane with a repeating byte pattern - one pixel of
+// 1, 2, 4, 8 or 16 bytes - with the same kernels the generator uses
+AMF_RESULT FillPlaneWithPattern(amf::AMFPlane* pPlane, const void* pPattern, amf_size patternSize);
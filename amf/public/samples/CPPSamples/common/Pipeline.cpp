@@ -32,23 +32,134 @@
 #include "Pipeline.h"
 #include "public/common/Thread.h"
 #include "CmdLogger.h"
+#include "public/common/DataStream.h"
 #include <sstream>
+#include <deque>
+#include <list>
+#include <algorithm>
+#include <atomic>
+#include <map>
 
 #pragma warning(disable:4355)
 
-typedef amf::AMFQueue<amf::AMFDataPtr>   DataQueue;
+typedef amf::AMFRingQueue<amf::AMFDataPtr>   DataQueue;
+
+// SWM_WakeOnData timeouts (ms): waits on element progress the pipeline cannot observe keep a short
+// safety-net timeout, waits on pipeline-driven state changes (unfreeze, restart, stop) sleep longer
+static const amf_ulong WAKE_POLL_TIMEOUT = 1;
+static const amf_ulong WAKE_IDLE_TIMEOUT = 50;
+
+// latency matching: submit times kept for inputs that have not produced output yet
+static const amf_size MAX_PENDING_SUBMITS = 1024;
 
 class PipelineConnector;
 class InputSlot;
 class OutputSlot;
 //-------------------------------------------------------------------------------------------------
-class Slot : public amf::AMFThread
+class PipelineTask
+{
+    friend class PipelineThreadPool;
+public:
+    enum StepResult
+    {
+        StepProgress,       // did some work - run again
+        StepWaitWake,       // waits on pipeline state (queues, freeze, EOF) - parked until Wake()
+        StepWaitElement,    // waits on element progress the pipeline cannot observe - parked until Wake() or WAKE_POLL_TIMEOUT
+    };
+
+    PipelineTask() : m_eState(TaskIdle), m_iWorker(0), m_iParkSequence(0), m_bWakeRequested(false), m_bRemoveRequested(false),
+        m_RemovedEvent(false, false), m_bTimerArmed(false), m_iTimerSequence(0) {}
+    virtual ~PipelineTask(){}
+
+    // one non-blocking piece of work
+    virtual StepResult Step() = 0;
+private:
+    enum TaskState
+    {
+        TaskIdle,
+        TaskQueued,
+        TaskRunning,
+        TaskParked,
+    };
+    typedef std::multimap<amf_pts, PipelineTask*> TimerMap;
+
+    // guarded by m_cs
+    amf::AMFCriticalSection m_cs;
+    TaskState               m_eState;
+    amf_int32               m_iWorker;          // deque the task is queued on or the worker that ran it last
+    amf_int64               m_iParkSequence;    // tells a timer armed for this park from a stale one
+    bool                    m_bWakeRequested;
+    bool                    m_bRemoveRequested;
+    amf::AMFEvent           m_RemovedEvent;
+
+    // guarded by PipelineThreadPool::m_TimerCs
+    bool                    m_bTimerArmed;
+    TimerMap::iterator      m_Timer;
+    amf_int64               m_iTimerSequence;
+};
+//-------------------------------------------------------------------------------------------------
+// Process-wide work-stealing pool shared by all CT_ThreadPool connections: one worker per core,
+// each with its own locked deque. A worker runs tasks from the front of its deque and steals from
+// the back of the others when it runs dry. A task that made no progress is parked and requeued by
+// Wake() from the queue push and element notification paths; only waits on element progress get a
+// WAKE_POLL_TIMEOUT safety-net timer, kept in a deadline ordered map.
+// Lock order: m_TimerCs, then PipelineTask::m_cs, then a worker's m_cs.
+//-------------------------------------------------------------------------------------------------
+class PipelineThreadPool
+{
+public:
+    static std::shared_ptr<PipelineThreadPool> GetShared();
+
+    PipelineThreadPool(amf_int32 iWorkers);
+    ~PipelineThreadPool();
+
+    void Add(PipelineTask* pTask);
+    void Remove(PipelineTask* pTask); // waits while the task is running
+    void Wake(PipelineTask* pTask);
+
+private:
+    class Worker : public amf::AMFThread
+    {
+    public:
+        Worker(PipelineThreadPool* pPool, amf_int32 index) : m_WakeEvent(false, false), m_bIdle(false), m_pPool(pPool), m_iIndex(index) {}
+        virtual ~Worker(){}
+
+        amf::AMFCriticalSection     m_cs;
+        std::deque<PipelineTask*>   m_Tasks;
+        amf::AMFEvent               m_WakeEvent;
+        std::atomic<bool>           m_bIdle;
+    protected:
+        virtual void Run();
+
+        PipelineThreadPool*         m_pPool;
+        amf_int32                   m_iIndex;
+    };
+
+    PipelineTask* Next(amf_int32 worker);
+    void Done(PipelineTask* pTask, amf_int32 worker, PipelineTask::StepResult eResult);
+    void Enqueue(PipelineTask* pTask, amf_int32 worker, bool bFromOwner = false);
+    void ArmTimer(PipelineTask* pTask, amf_int64 iParkSequence);
+    void DisarmTimer(PipelineTask* pTask);
+    amf_ulong FireTimers(); // returns ms until the next deadline
+
+    std::vector<Worker*>            m_Workers;
+    std::atomic<amf_int32>          m_iNextWorker;
+
+    amf::AMFCriticalSection         m_TimerCs;
+    PipelineTask::TimerMap          m_Timers;
+    std::atomic<amf_pts>            m_NextDeadline;     // earliest armed timer, 0 - none
+};
+//-------------------------------------------------------------------------------------------------
+class Slot : public amf::AMFThread, public PipelineTask
 {
 public:
     ConnectionThreading     m_eThreading;
+    SlotWaitMode            m_eWaitMode;
+    PipelineThreadPool     *m_pThreadPool;
     PipelineConnector      *m_pConnector;
     amf_int32               m_iThisSlot;
     amf::AMFPreciseWaiter   m_waiter;
+    amf::AMFEvent           m_WakeEvent;
     bool                    m_bEof;
     bool                    m_bFrozen;
     
@@ -56,14 +167,18 @@ public:
     Slot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot);
     virtual ~Slot(){}
 
+    virtual bool Start();
     virtual void Stop();
     virtual bool StopRequested();
     virtual bool IsEof(){return m_bEof;}
     virtual void OnEof();
-    virtual void Restart(){m_bEof = false;}
+    virtual void Restart(){m_bEof = false; Wake();}
 
     virtual AMF_RESULT Freeze() { m_bFrozen = true; return AMF_OK;}
-    virtual AMF_RESULT UnFreeze(){ m_bFrozen = false; return AMF_OK;}
+    virtual AMF_RESULT UnFreeze(){ m_bFrozen = false; Wake(); return AMF_OK;}
+
+    void Wake();
+    void Idle(amf_ulong ulTimeout, bool bCountIdle = true); // bCountIdle = false: the wait is accounted as blocked time
     virtual AMF_RESULT Flush() = 0;
 
 };
@@ -78,9 +193,17 @@ public:
 
     // pull 
     virtual void Run();
+    virtual StepResult Step();
     AMF_RESULT Drain();
     AMF_RESULT SubmitInput(amf::AMFData* pData, amf_ulong ulTimeout, bool poll);
     virtual AMF_RESULT Flush() {return AMF_OK;}
+protected:
+    // CT_ThreadPool: input the element could not take yet, retried on the next Step()
+    amf::AMFDataPtr         m_pPendingData;
+    bool                    m_bHasPending;
+    bool                    m_bResubmitPending;
+    bool                    m_bDrainPending;
+    amf_pts                 m_inputFullSince;   // first AMF_INPUT_FULL for the current input, 0 - none
 };
 typedef std::shared_ptr<InputSlot> InputSlotPtr;
 //-------------------------------------------------------------------------------------------------
@@ -94,14 +217,21 @@ public:
     virtual ~OutputSlot(){}
 
     virtual void Run();
+    virtual StepResult Step();
     AMF_RESULT QueryOutput(amf::AMFData** ppData, amf_ulong ulTimeout);
     AMF_RESULT Poll();
     virtual void Restart();
     virtual AMF_RESULT Flush();
+protected:
+    amf_int64               m_iDataPolled;
+    // CT_ThreadPool: output the queue had no room for, retried on the next Step()
+    amf::AMFDataPtr         m_pPendingData;
+    bool                    m_bHasPending;
+    amf_pts                 m_queueFullSince;
 };
 typedef std::shared_ptr<OutputSlot> OutputSlotPtr;
 //-------------------------------------------------------------------------------------------------
-class PipelineConnector
+class PipelineConnector : public PipelineElementObserver
 {
     friend class Pipeline;
     friend class InputSlot;
@@ -137,6 +267,21 @@ public:
 
     void SetStatSlot(amf_int32 slot) {m_iStatSlot = slot;}
 
+    // SWM_WakeOnData notifications
+    virtual void OnOutputAvailable(amf_int32 slot);
+    void WakeOutputSlots();
+    void WakeInputSlots();
+
+    // telemetry, called from slot threads
+    void OnInputAccepted(amf_int32 slot);
+    void OnOutputProduced(amf_int32 slot);
+    void OnQueuePush(amf_size depth);
+    void AddInputFullTime(amf_pts time)  { m_inputFullTime += time; }
+    void AddQueueFullTime(amf_pts time)  { m_queueFullTime += time; }
+    void AddIdleTime(amf_pts time)       { m_idleTime += time; }
+    void GetStats(PipelineElementStats& stats);
+    void ResetStats();
+
 protected:
     Pipeline*               m_pPipeline;
     PipelineElementPtr      m_pElement;
@@ -145,16 +290,48 @@ protected:
     amf_int64               m_iPollFramesProcessed;
     amf_int32               m_iStatSlot;
 
+    amf::AMFCriticalSection     m_statsCs;
+    PipelineLatencyHistogram    m_latency;
+    std::deque<amf_pts>         m_submitTimes;
+    amf_int64                   m_queueDepthSum;
+    amf_int64                   m_queueDepthSamples;
+    amf_int64                   m_queueDepthMax;
+    std::atomic<amf_pts>        m_inputFullTime;
+    std::atomic<amf_pts>        m_queueFullTime;
+    std::atomic<amf_pts>        m_idleTime;
+
     std::vector<InputSlotPtr>               m_InputSlots;
     std::vector<OutputSlotPtr>              m_OutputSlots;
 };
 //-------------------------------------------------------------------------------------------------
+// periodic telemetry dump, one snapshot per period and a final one on stop
+class PipelineStatsThread : public amf::AMFThread
+{
+public:
+    PipelineStatsThread(const Pipeline* pPipeline, amf_ulong periodMs, PipelineStatsFormat eFormat, const std::wstring& path);
+
+    void Stop();
+protected:
+    virtual void Run();
+    void Dump();
+
+    const Pipeline*         m_pPipeline;
+    amf_ulong               m_period;
+    PipelineStatsFormat     m_eFormat;
+    std::wstring            m_path;
+    amf::AMFDataStreamPtr   m_pStream;
+    amf::AMFEvent           m_StopEvent;
+};
+//-------------------------------------------------------------------------------------------------
 // class Pipeline
 //-------------------------------------------------------------------------------------------------
 Pipeline::Pipeline() : 
     m_state(PipelineStateNotReady),
+    m_eWaitMode(SWM_Poll),
     m_startTime(0),
-    m_stopTime(0)
+    m_stopTime(0),
+    m_statsPeriod(0),
+    m_eStatsFormat(PSF_Text)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -200,6 +377,17 @@ AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 slot, Pipeli
     {
         OutputSlotPtr pOutoutSlot = OutputSlotPtr(new OutputSlot(eThreading, upstreamConnector.get() , upstreamSlot, queueSize));
         InputSlotPtr pInputSlot = InputSlotPtr(new InputSlot(eThreading, connector.get(), slot));
+        pOutoutSlot->m_eWaitMode = m_eWaitMode;
+        pInputSlot->m_eWaitMode = m_eWaitMode;
+        if(eThreading == CT_ThreadPool)
+        {
+            if(m_pThreadPool == NULL)
+            {
+                m_pThreadPool = PipelineThreadPool::GetShared();
+            }
+            pOutoutSlot->m_pThreadPool = m_pThreadPool.get();
+            pInputSlot->m_pThreadPool = m_pThreadPool.get();
+        }
         pOutoutSlot->m_pDownstreamInputSlot = pInputSlot.get();
         pInputSlot->m_pUpstreamOutputSlot = pOutoutSlot.get();
         upstreamConnector->AddOutputSlot(pOutoutSlot);
@@ -211,6 +399,13 @@ AMF_RESULT Pipeline::Connect(PipelineElementPtr pElement, amf_int32 slot, Pipeli
     m_state = PipelineStateReady;
     return AMF_OK;
 }
+//-------------------------------------------------------------------------------------------------
+void Pipeline::SetSlotWaitMode(SlotWaitMode eMode)
+{
+    amf::AMFLock lock(&m_cs);
+    m_eWaitMode = eMode;
+}
+//-------------------------------------------------------------------------------------------------
 PipelineElementPtr Pipeline::GetLastElement()
 {
     PipelineElementPtr res;
@@ -257,18 +452,33 @@ AMF_RESULT Pipeline::Start()
     {
         (*it)->Start();
     }
+    if(m_statsPeriod > 0)
+    {
+        m_pStatsThread = std::make_shared<PipelineStatsThread>(this, m_statsPeriod, m_eStatsFormat, m_statsPath);
+        m_pStatsThread->Start();
+    }
     m_state = PipelineStateRunning;
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT Pipeline::Stop()
 {
+    std::shared_ptr<PipelineStatsThread> pStatsThread;
+    {
+        amf::AMFLock lock(&m_cs);
+        pStatsThread.swap(m_pStatsThread);
+    }
+    if(pStatsThread != NULL)
+    {
+        pStatsThread->Stop(); // final snapshot while connectors are still there
+    }
     for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end(); it++)
     {
         (*it)->Stop();
     }
     amf::AMFLock lock(&m_cs);
     m_connectors.clear();
+    m_pThreadPool.reset();
     m_state = PipelineStateNotReady;
     return AMF_OK;
 }
@@ -318,6 +528,7 @@ void Pipeline::DisplayResult()
             std::wstring text = (*it)->m_pElement->GetDisplayResult();
             LOG_SUCCESS(text);
         }
+        LOG_INFO(GetStatsText());
 
 
         messageStream << L" Frames processed: " << frameCount;
@@ -364,6 +575,111 @@ amf_int64 Pipeline::GetNumberOfProcessedFrames()
     return last->GetSubmitFramesProcessed();
 }
 
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Pipeline::GetElementStats(std::vector<PipelineElementStats>& stats) const
+{
+    amf::AMFLock lock(&m_cs);
+    stats.resize(m_connectors.size());
+    amf_int32 index = 0;
+    for(ConnectorList::const_iterator it = m_connectors.begin(); it != m_connectors.end(); it++, index++)
+    {
+        stats[index].index = index;
+        (*it)->GetStats(stats[index]);
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+static double StatsMs(amf_pts time)
+{
+    return double(time) / double(AMF_MILLISECOND);
+}
+//-------------------------------------------------------------------------------------------------
+std::wstring Pipeline::GetStatsText() const
+{
+    std::vector<PipelineElementStats> stats;
+    GetElementStats(stats);
+
+    std::wstringstream messageStream;
+    messageStream.precision(2);
+    messageStream.setf(std::ios::fixed, std::ios::floatfield);
+
+    for(std::vector<PipelineElementStats>::const_iterator it = stats.begin(); it != stats.end(); it++)
+    {
+        if(it != stats.begin())
+        {
+            messageStream << L"\n";
+        }
+        messageStream << L"[" << it->index << L"] frames in " << it->framesSubmitted << L" out " << it->framesPolled;
+        if(it->latencyCount > 0)
+        {
+            messageStream << L" | latency ms: mean " << StatsMs(it->latencyMean)
+                << L" p50 " << StatsMs(it->latencyP50)
+                << L" p90 " << StatsMs(it->latencyP90)
+                << L" p99 " << StatsMs(it->latencyP99)
+                << L" max " << StatsMs(it->latencyMax);
+        }
+        if(it->queueCapacity > 0)
+        {
+            messageStream << L" | queue avg " << it->queueDepthAverage << L" max " << it->queueDepthMax << L"/" << it->queueCapacity;
+        }
+        messageStream << L" | ms: input full " << StatsMs(it->inputFullTime)
+            << L" queue full " << StatsMs(it->queueFullTime)
+            << L" idle " << StatsMs(it->idleTime);
+    }
+    return messageStream.str();
+}
+//-------------------------------------------------------------------------------------------------
+std::string Pipeline::GetStatsJSON() const
+{
+    std::vector<PipelineElementStats> stats;
+    GetElementStats(stats);
+
+    std::ostringstream json;
+    json.precision(3);
+    json.setf(std::ios::fixed, std::ios::floatfield);
+
+    const amf_pts now = (GetState() == PipelineStateRunning) ? amf_high_precision_clock() : m_stopTime;
+    json << "{\"elapsed_ms\":" << StatsMs(now - m_startTime) << ",\"elements\":[";
+    for(std::vector<PipelineElementStats>::const_iterator it = stats.begin(); it != stats.end(); it++)
+    {
+        json << (it != stats.begin() ? "," : "")
+            << "{\"index\":" << it->index
+            << ",\"frames_submitted\":" << it->framesSubmitted
+            << ",\"frames_polled\":" << it->framesPolled
+            << ",\"latency_ms\":{\"count\":" << it->latencyCount
+            << ",\"min\":" << StatsMs(it->latencyMin)
+            << ",\"mean\":" << StatsMs(it->latencyMean)
+            << ",\"p50\":" << StatsMs(it->latencyP50)
+            << ",\"p90\":" << StatsMs(it->latencyP90)
+            << ",\"p99\":" << StatsMs(it->latencyP99)
+            << ",\"max\":" << StatsMs(it->latencyMax)
+            << ",\"histogram\":[";
+        // [lower, upper, count] per non-empty bucket
+        for(std::vector<PipelineHistogramBucket>::const_iterator b = it->latencyBuckets.begin(); b != it->latencyBuckets.end(); b++)
+        {
+            json << (b != it->latencyBuckets.begin() ? "," : "")
+                << "[" << StatsMs(b->lowerBound) << "," << StatsMs(b->upperBound) << "," << b->count << "]";
+        }
+        json << "]}"
+            << ",\"queue\":{\"capacity\":" << it->queueCapacity
+            << ",\"avg\":" << it->queueDepthAverage
+            << ",\"max\":" << it->queueDepthMax << "}"
+            << ",\"input_full_ms\":" << StatsMs(it->inputFullTime)
+            << ",\"queue_full_ms\":" << StatsMs(it->queueFullTime)
+            << ",\"idle_ms\":" << StatsMs(it->idleTime)
+            << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+//-------------------------------------------------------------------------------------------------
+void Pipeline::SetStatsDump(amf_ulong periodMs, PipelineStatsFormat eFormat, const wchar_t* pFilePath)
+{
+    amf::AMFLock lock(&m_cs);
+    m_statsPeriod = periodMs;
+    m_eStatsFormat = eFormat;
+    m_statsPath = pFilePath != NULL ? pFilePath : L"";
+}
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT Pipeline::Restart()
 {
@@ -413,19 +729,66 @@ AMF_RESULT Pipeline::Flush()
 //-------------------------------------------------------------------------------------------------
 Slot::Slot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot) :
     m_eThreading(eThreading),
+    m_eWaitMode(SWM_Poll),
+    m_pThreadPool(NULL),
     m_pConnector(connector),
     m_iThisSlot(thisSlot),
+    m_WakeEvent(false, false),
     m_bEof(false),
     m_bFrozen(false)
 {
 }
 //-------------------------------------------------------------------------------------------------
+bool Slot::Start()
+{
+    if(m_pThreadPool != NULL)
+    {
+        m_pThreadPool->Add(this);
+        return true;
+    }
+    return amf::AMFThread::Start();
+}
+//-------------------------------------------------------------------------------------------------
 void Slot::Stop()
 {
+    if(m_pThreadPool != NULL)
+    {
+        m_pThreadPool->Remove(this);
+    }
     RequestStop();
+    Wake();
     WaitForStop();
 }
 //-------------------------------------------------------------------------------------------------
+void Slot::Wake()
+{
+    if(m_eWaitMode == SWM_WakeOnData)
+    {
+        m_WakeEvent.SetEvent();
+    }
+    if(m_pThreadPool != NULL)
+    {
+        m_pThreadPool->Wake(this);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void Slot::Idle(amf_ulong ulTimeout, bool bCountIdle)
+{
+    const amf_pts start = bCountIdle ? amf_high_precision_clock() : 0;
+    if(m_eWaitMode == SWM_WakeOnData)
+    {
+        m_WakeEvent.Lock(ulTimeout);
+    }
+    else
+    {
+        m_waiter.Wait(1);
+    }
+    if(bCountIdle)
+    {
+        m_pConnector->AddIdleTime(amf_high_precision_clock() - start);
+    }
+}
+//-------------------------------------------------------------------------------------------------
 void Slot::OnEof()
 {
     m_bEof = true;
@@ -441,7 +804,11 @@ bool Slot::StopRequested()
 //-------------------------------------------------------------------------------------------------
 InputSlot::InputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot) :
         Slot(eThreading, connector, thisSlot),
-        m_pUpstreamOutputSlot(NULL)
+        m_pUpstreamOutputSlot(NULL),
+        m_bHasPending(false),
+        m_bResubmitPending(false),
+        m_bDrainPending(false),
+        m_inputFullSince(0)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -453,7 +820,7 @@ void InputSlot::Run()
     {
         if(m_bFrozen)
         {
-            m_waiter.Wait(1);
+            Idle(WAKE_IDLE_TIMEOUT);
             continue;
         }
         if(!IsEof()) // after EOF thread waits for stop
@@ -467,17 +834,64 @@ void InputSlot::Run()
             }
             else
             {
-                m_waiter.Wait(1);
+                Idle(WAKE_POLL_TIMEOUT);
             }
         }
         else
         {
-            m_waiter.Wait(1);
+            Idle(WAKE_IDLE_TIMEOUT);
         }
 
     }
 }
 //-------------------------------------------------------------------------------------------------
+PipelineTask::StepResult InputSlot::Step()
+{
+    if(m_bFrozen || StopRequested())
+    {
+        return StepWaitWake;
+    }
+    if(m_bDrainPending)
+    {
+        if(m_pConnector->m_pElement->Drain(m_iThisSlot) == AMF_INPUT_FULL)
+        {
+            return StepWaitElement;
+        }
+        m_bDrainPending = false;
+        m_pConnector->WakeOutputSlots();
+        m_pConnector->PollAll();
+        return StepProgress;
+    }
+    if(IsEof())
+    {
+        return StepWaitWake;
+    }
+    if(!m_bHasPending)
+    {
+        amf::AMFDataPtr data;
+        AMF_RESULT res = m_pUpstreamOutputSlot->QueryOutput(&data, 0);
+        if(!((res == AMF_OK && data != NULL) || res == AMF_EOF) || m_bFrozen)
+        {
+            return StepWaitWake; // the upstream push wakes this slot
+        }
+        if(data == NULL)
+        {
+            OnEof();
+            m_bDrainPending = true;
+            return StepProgress;
+        }
+        m_pPendingData = data;
+        m_bHasPending = true;
+    }
+    if(SubmitInput(m_pPendingData, 0, false) == AMF_INPUT_FULL)
+    {
+        return StepWaitElement;
+    }
+    m_pPendingData = NULL;
+    m_bHasPending = false;
+    return StepProgress;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT InputSlot::Drain()
 {
     AMF_RESULT res = AMF_OK;
@@ -487,13 +901,13 @@ AMF_RESULT InputSlot::Drain()
         res = m_pConnector->m_pElement->Drain(m_iThisSlot);
         if(res != AMF_INPUT_FULL)
         {
-
+            m_pConnector->WakeOutputSlots(); // drain completed - flushed output may be ready
             break;
         }
         // LOG_INFO(L"m_pElement->Drain() returned AMF_INPUT_FULL");
         if(this->m_eThreading != CT_Direct)
         {
-            m_waiter.Wait(1);
+            Idle(WAKE_POLL_TIMEOUT);
         }
         else
         {
@@ -516,6 +930,12 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong /*ulTimeout*/,
     }
     else
     {
+        if(m_bResubmitPending)
+        {
+            m_bResubmitPending = false;
+            res = AMF_REPEAT;
+            pData = NULL;
+        }
         //push input
         while(!StopRequested())
         {
@@ -542,6 +962,15 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong /*ulTimeout*/,
             }
             else if(res == AMF_INPUT_FULL  || res == AMF_DECODER_NO_FREE_SURFACES)
             {
+                if(m_inputFullSince == 0)
+                {
+                    m_inputFullSince = amf_high_precision_clock();
+                }
+                if(m_eThreading == CT_ThreadPool)
+                {
+                    m_bResubmitPending = (pData == NULL); // after AMF_REPEAT only the resubmit is outstanding
+                    return AMF_INPUT_FULL; // pool task retries once woken instead of blocking a worker
+                }
                 if(poll)
                 {
                     res = m_pConnector->PollAll(); // no poll thread: poll right here
@@ -557,7 +986,7 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong /*ulTimeout*/,
 
                 // if input is full, also need to wait a bit 
                 // for input to be processed...
-                m_waiter.Wait(1); // wait till Poll thread clears input
+                Idle(WAKE_POLL_TIMEOUT, false); // wait till Poll thread clears input
             }
             else if(res == AMF_REPEAT)
             {
@@ -565,12 +994,19 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong /*ulTimeout*/,
             }
             else
             {
+                if(m_inputFullSince != 0)
+                {
+                    m_pConnector->AddInputFullTime(amf_high_precision_clock() - m_inputFullSince);
+                    m_inputFullSince = 0;
+                }
                 if(res == AMF_OK || res == AMF_RESOLUTION_UPDATED)
                 {
                     if(pData != NULL && m_iThisSlot == m_pConnector->m_iStatSlot)
                     {
                         m_pConnector->m_iSubmitFramesProcessed++;
+                        m_pConnector->OnInputAccepted(m_iThisSlot);
                     }
+                    m_pConnector->WakeOutputSlots();
                 }
                 else if(res != AMF_EOF)
                 {
@@ -600,7 +1036,10 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong /*ulTimeout*/,
 //-------------------------------------------------------------------------------------------------
 OutputSlot::OutputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot, amf_int32 queueSize) :
     Slot(eThreading, connector, thisSlot),
-    m_pDownstreamInputSlot(NULL)
+    m_pDownstreamInputSlot(NULL),
+    m_iDataPolled(0),
+    m_bHasPending(false),
+    m_queueFullSince(0)
 {
     m_dataQueue.SetQueueSize(queueSize);
 }
@@ -612,7 +1051,7 @@ void OutputSlot::Run()
     {
         if(m_bFrozen)
         {
-            m_waiter.Wait(1);
+            Idle(WAKE_IDLE_TIMEOUT);
             continue;
         }
 
@@ -621,14 +1060,46 @@ void OutputSlot::Run()
             res = Poll();
             if(res != AMF_OK) // 
             {
-                m_waiter.Wait(1);
+                Idle(WAKE_POLL_TIMEOUT);
             }
         }
         else
         {
-            m_waiter.Wait(1);
+            Idle(WAKE_IDLE_TIMEOUT);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+PipelineTask::StepResult OutputSlot::Step()
+{
+    if(m_bFrozen || StopRequested())
+    {
+        return StepWaitWake;
+    }
+    if(m_bHasPending)
+    {
+        amf_ulong id = 0;
+        if(!m_dataQueue.Add(id, m_pPendingData, 0, 0))
+        {
+            return StepWaitWake; // the downstream slot wakes this one when it takes from the queue
         }
+        m_pConnector->AddQueueFullTime(amf_high_precision_clock() - m_queueFullSince);
+        m_pConnector->OnQueuePush(m_dataQueue.GetSize());
+        m_pPendingData = NULL;
+        m_bHasPending = false;
+        m_pDownstreamInputSlot->Wake();
+        return StepProgress;
+    }
+    if(IsEof())
+    {
+        return StepWaitWake;
     }
+    const amf_int64 polled = m_iDataPolled;
+    if(Poll() == AMF_INPUT_FULL)
+    {
+        return StepWaitWake; // polled data is pending on a full queue
+    }
+    return m_iDataPolled != polled ? StepProgress : StepWaitElement;
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT OutputSlot::QueryOutput(amf::AMFData** ppData, amf_ulong ulTimeout) 
@@ -647,13 +1118,18 @@ AMF_RESULT OutputSlot::QueryOutput(amf::AMFData** ppData, amf_ulong ulTimeout)
         {
             OnEof();
         }
+        else if(*ppData != NULL)
+        {
+            m_pConnector->OnOutputProduced(m_iThisSlot);
+        }
         return res;
     }
-    // m_eThreading == CT_ThreadQueue
+    // m_eThreading == CT_ThreadQueue || m_eThreading == CT_ThreadPool
     amf::AMFDataPtr data;
     amf_ulong id=0;
     if(m_dataQueue.Get(id, data, ulTimeout))
     {
+        Wake(); // room in the queue for pending output
         if(m_bFrozen)
         {
             return AMF_OK;
@@ -692,15 +1168,22 @@ AMF_RESULT OutputSlot::Poll()
         {
             OnEof();
         }
-        if(data != NULL && m_iThisSlot == m_pConnector->m_iStatSlot)
+        if(data != NULL)
+        {
+            m_pConnector->OnOutputProduced(m_iThisSlot); // EOF is not included
+        }
+        if(data != NULL)
         {
-            m_pConnector->m_iPollFramesProcessed++; // EOF is not included
+            m_iDataPolled++;
+            m_pConnector->WakeInputSlots(); // element may have room for more input now
         }
         if(data != NULL || res == AMF_EOF) // EOF is sent as NULL data to the next element
         {
             // have data - send it
-            if(m_eThreading == CT_ThreadQueue)
+            if(m_eThreading == CT_ThreadQueue || m_eThreading == CT_ThreadPool)
             {
+                const amf_pts pushStart = amf_high_precision_clock();
+                bool bQueueFull = false;
                 while(!StopRequested())
                 {
                     if(m_bFrozen)
@@ -708,10 +1191,26 @@ AMF_RESULT OutputSlot::Poll()
                         break;
                     }
                     amf_ulong id=0;
-                    if(m_dataQueue.Add(id, data, 0, 50))
+                    // first attempt does not wait so that only time spent on a full queue is accounted
+                    if(m_dataQueue.Add(id, data, 0, (m_eThreading == CT_ThreadPool || !bQueueFull) ? 0 : 50))
                     {
+                        if(bQueueFull)
+                        {
+                            m_pConnector->AddQueueFullTime(amf_high_precision_clock() - pushStart);
+                        }
+                        m_pConnector->OnQueuePush(m_dataQueue.GetSize());
+                        m_pDownstreamInputSlot->Wake();
                         break;
                     }
+                    bQueueFull = true;
+                    if(m_eThreading == CT_ThreadPool)
+                    {
+                        // queue is full: keep the data and let the pool retry once the queue drains
+                        m_pPendingData = data;
+                        m_bHasPending = true;
+                        m_queueFullSince = pushStart;
+                        return AMF_INPUT_FULL;
+                    }
                 }
             }
             else
@@ -745,15 +1244,321 @@ AMF_RESULT OutputSlot::Poll()
 void OutputSlot::Restart()
 {
     m_dataQueue.Clear();
+    m_pPendingData = NULL;
+    m_bHasPending = false;
     Slot::Restart();
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT OutputSlot::Flush()
 {
     m_dataQueue.Clear();
+    m_pPendingData = NULL;
+    m_bHasPending = false;
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+// class PipelineThreadPool
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<PipelineThreadPool> PipelineThreadPool::GetShared()
+{
+    static amf::AMFCriticalSection              s_cs;
+    static std::weak_ptr<PipelineThreadPool>    s_pPool;
+
+    amf::AMFLock lock(&s_cs);
+    std::shared_ptr<PipelineThreadPool> pPool = s_pPool.lock();
+    if(pPool == NULL)
+    {
+        amf_int32 iWorkers = 4;
+#if defined(_WIN32) || defined(__linux__)
+        iWorkers = amf_get_cpu_cores();
+#endif
+        pPool = std::make_shared<PipelineThreadPool>(std::max(iWorkers, 2));
+        s_pPool = pPool;
+    }
+    return pPool;
+}
+//-------------------------------------------------------------------------------------------------
+PipelineThreadPool::PipelineThreadPool(amf_int32 iWorkers) :
+    m_iNextWorker(0),
+    m_NextDeadline(0)
+{
+    for(amf_int32 i = 0; i < iWorkers; i++)
+    {
+        m_Workers.push_back(new Worker(this, i));
+    }
+    for(amf_size i = 0; i < m_Workers.size(); i++)
+    {
+        m_Workers[i]->Start();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+PipelineThreadPool::~PipelineThreadPool()
+{
+    for(amf_size i = 0; i < m_Workers.size(); i++)
+    {
+        m_Workers[i]->RequestStop();
+        m_Workers[i]->m_WakeEvent.SetEvent();
+    }
+    for(amf_size i = 0; i < m_Workers.size(); i++)
+    {
+        m_Workers[i]->WaitForStop();
+        delete m_Workers[i];
+    }
+    m_Workers.clear();
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::Add(PipelineTask* pTask)
+{
+    amf::AMFLock lock(&pTask->m_cs);
+    if(pTask->m_eState != PipelineTask::TaskIdle)
+    {
+        return;
+    }
+    pTask->m_bRemoveRequested = false;
+    Enqueue(pTask, m_iNextWorker.fetch_add(1) % (amf_int32)m_Workers.size());
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::Remove(PipelineTask* pTask)
+{
+    {
+        amf::AMFLock timerLock(&m_TimerCs);
+        amf::AMFLock lock(&pTask->m_cs);
+        DisarmTimer(pTask);
+        switch(pTask->m_eState)
+        {
+        case PipelineTask::TaskIdle:
+            return;
+        case PipelineTask::TaskParked:
+            pTask->m_eState = PipelineTask::TaskIdle;
+            return;
+        case PipelineTask::TaskQueued:
+            {
+                Worker* pWorker = m_Workers[pTask->m_iWorker];
+                amf::AMFLock workerLock(&pWorker->m_cs);
+                std::deque<PipelineTask*>::iterator it = std::find(pWorker->m_Tasks.begin(), pWorker->m_Tasks.end(), pTask);
+                if(it != pWorker->m_Tasks.end())
+                {
+                    pWorker->m_Tasks.erase(it);
+                    pTask->m_eState = PipelineTask::TaskIdle;
+                    return;
+                }
+            }
+            break; // a worker has just taken it
+        default:
+            break;
+        }
+        // running or about to run: the worker drops it and signals
+        pTask->m_bRemoveRequested = true;
+        pTask->m_RemovedEvent.ResetEvent();
+    }
+    pTask->m_RemovedEvent.Lock();
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::Wake(PipelineTask* pTask)
+{
+    amf::AMFLock lock(&pTask->m_cs);
+    if(pTask->m_eState == PipelineTask::TaskParked)
+    {
+        Enqueue(pTask, pTask->m_iWorker); // an armed timer goes stale, the next park rearms it
+    }
+    else if(pTask->m_eState == PipelineTask::TaskRunning)
+    {
+        pTask->m_bWakeRequested = true;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::Enqueue(PipelineTask* pTask, amf_int32 worker, bool bFromOwner)
+{
+    // pTask->m_cs must be locked
+    pTask->m_eState = PipelineTask::TaskQueued;
+    pTask->m_iWorker = worker;
+    Worker* pWorker = m_Workers[worker];
+    bool bBacklog = false;
+    {
+        amf::AMFLock lock(&pWorker->m_cs);
+        pWorker->m_Tasks.push_back(pTask);
+        bBacklog = pWorker->m_Tasks.size() > 1;
+    }
+    pWorker->m_WakeEvent.SetEvent();
+    // a worker requeueing its own task picks it up next unless other tasks are waiting
+    if(!pWorker->m_bIdle.load(std::memory_order_acquire) && (!bFromOwner || bBacklog))
+    {
+        // the owner is busy: let an idle worker steal the task
+        for(amf_size i = 0; i < m_Workers.size(); i++)
+        {
+            if(m_Workers[i]->m_bIdle.load(std::memory_order_acquire))
+            {
+                m_Workers[i]->m_WakeEvent.SetEvent();
+                break;
+            }
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::ArmTimer(PipelineTask* pTask, amf_int64 iParkSequence)
+{
+    amf::AMFLock timerLock(&m_TimerCs);
+    amf::AMFLock lock(&pTask->m_cs);
+    if(pTask->m_eState != PipelineTask::TaskParked || pTask->m_iParkSequence != iParkSequence)
+    {
+        return; // woken or removed since it was parked
+    }
+    DisarmTimer(pTask);
+    const amf_pts deadline = amf_high_precision_clock() + amf_pts(WAKE_POLL_TIMEOUT) * AMF_MILLISECOND;
+    pTask->m_Timer = m_Timers.insert(std::make_pair(deadline, pTask));
+    pTask->m_bTimerArmed = true;
+    pTask->m_iTimerSequence = iParkSequence;
+    m_NextDeadline.store(m_Timers.begin()->first, std::memory_order_release);
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::DisarmTimer(PipelineTask* pTask)
+{
+    // m_TimerCs must be locked
+    if(pTask->m_bTimerArmed)
+    {
+        m_Timers.erase(pTask->m_Timer);
+        pTask->m_bTimerArmed = false;
+        m_NextDeadline.store(m_Timers.empty() ? 0 : m_Timers.begin()->first, std::memory_order_release);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+amf_ulong PipelineThreadPool::FireTimers()
+{
+    amf_pts next = m_NextDeadline.load(std::memory_order_acquire);
+    amf_pts now = amf_high_precision_clock();
+    if(next == 0 || next > now)
+    {
+        return next == 0 ? AMF_INFINITE : amf_ulong((next - now + AMF_MILLISECOND - 1) / AMF_MILLISECOND);
+    }
+    amf::AMFLock timerLock(&m_TimerCs);
+    now = amf_high_precision_clock();
+    while(!m_Timers.empty() && m_Timers.begin()->first <= now)
+    {
+        PipelineTask* pTask = m_Timers.begin()->second;
+        m_Timers.erase(m_Timers.begin());
+
+        amf::AMFLock lock(&pTask->m_cs);
+        pTask->m_bTimerArmed = false;
+        if(pTask->m_eState == PipelineTask::TaskParked && pTask->m_iParkSequence == pTask->m_iTimerSequence)
+        {
+            Enqueue(pTask, pTask->m_iWorker);
+        }
+    }
+    next = m_Timers.empty() ? 0 : m_Timers.begin()->first;
+    m_NextDeadline.store(next, std::memory_order_release);
+    return next == 0 ? AMF_INFINITE : amf_ulong((next - now + AMF_MILLISECOND - 1) / AMF_MILLISECOND);
+}
+//-------------------------------------------------------------------------------------------------
+PipelineTask* PipelineThreadPool::Next(amf_int32 worker)
+{
+    while(true)
+    {
+        PipelineTask* pTask = NULL;
+        {
+            Worker* pOwn = m_Workers[worker];
+            amf::AMFLock lock(&pOwn->m_cs);
+            if(!pOwn->m_Tasks.empty())
+            {
+                pTask = pOwn->m_Tasks.front();
+                pOwn->m_Tasks.pop_front();
+            }
+        }
+        // steal from the back of the first neighbour with queued work
+        const amf_int32 count = (amf_int32)m_Workers.size();
+        for(amf_int32 i = 1; i < count && pTask == NULL; i++)
+        {
+            Worker* pVictim = m_Workers[(worker + i) % count];
+            amf::AMFLock lock(&pVictim->m_cs);
+            if(!pVictim->m_Tasks.empty())
+            {
+                pTask = pVictim->m_Tasks.back();
+                pVictim->m_Tasks.pop_back();
+            }
+        }
+        if(pTask == NULL)
+        {
+            return NULL;
+        }
+        bool bRemoved = false;
+        {
+            amf::AMFLock lock(&pTask->m_cs);
+            if(pTask->m_bRemoveRequested)
+            {
+                pTask->m_bRemoveRequested = false;
+                pTask->m_eState = PipelineTask::TaskIdle;
+                bRemoved = true;
+            }
+            else
+            {
+                pTask->m_eState = PipelineTask::TaskRunning;
+                pTask->m_iWorker = worker;
+                pTask->m_bWakeRequested = false;
+            }
+        }
+        if(!bRemoved)
+        {
+            return pTask;
+        }
+        pTask->m_RemovedEvent.SetEvent(); // last access: Remove() returns and the task may be destroyed
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::Done(PipelineTask* pTask, amf_int32 worker, PipelineTask::StepResult eResult)
+{
+    amf_int64 iParkSequence = 0;
+    {
+        amf::AMFLock lock(&pTask->m_cs);
+        if(pTask->m_bRemoveRequested)
+        {
+            pTask->m_bRemoveRequested = false;
+            pTask->m_eState = PipelineTask::TaskIdle;
+        }
+        else if(eResult == PipelineTask::StepProgress || pTask->m_bWakeRequested)
+        {
+            Enqueue(pTask, worker, true);
+            return;
+        }
+        else
+        {
+            pTask->m_eState = PipelineTask::TaskParked;
+            iParkSequence = ++pTask->m_iParkSequence;
+        }
+    }
+    if(iParkSequence == 0)
+    {
+        pTask->m_RemovedEvent.SetEvent(); // last access: Remove() returns and the task may be destroyed
+    }
+    else if(eResult == PipelineTask::StepWaitElement)
+    {
+        ArmTimer(pTask, iParkSequence);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineThreadPool::Worker::Run()
+{
+    while(!StopRequested())
+    {
+        const amf_ulong timeout = m_pPool->FireTimers();
+        PipelineTask* pTask = m_pPool->Next(m_iIndex);
+        if(pTask == NULL)
+        {
+            // idle before the second look so that a task pushed in between wakes this worker
+            m_bIdle.store(true, std::memory_order_seq_cst);
+            pTask = m_pPool->Next(m_iIndex);
+            if(pTask == NULL)
+            {
+                m_WakeEvent.Lock(timeout);
+            }
+            m_bIdle.store(false, std::memory_order_release);
+            if(pTask == NULL)
+            {
+                continue;
+            }
+        }
+        m_pPool->Done(pTask, m_iIndex, pTask->Step());
+    }
+}
+//-------------------------------------------------------------------------------------------------
 // class PipelineConnector
 //-------------------------------------------------------------------------------------------------
 PipelineConnector::PipelineConnector(Pipeline *host, PipelineElementPtr element)  : 
@@ -762,13 +1567,21 @@ PipelineConnector::PipelineConnector(Pipeline *host, PipelineElementPtr element)
   m_bStop(false),
   m_iSubmitFramesProcessed(0),
   m_iPollFramesProcessed(0),
-  m_iStatSlot(0)
+  m_iStatSlot(0),
+  m_queueDepthSum(0),
+  m_queueDepthSamples(0),
+  m_queueDepthMax(0),
+  m_inputFullTime(0),
+  m_queueFullTime(0),
+  m_idleTime(0)
 {
+    m_pElement->SetObserver(this);
 }
 //-------------------------------------------------------------------------------------------------
 PipelineConnector::~PipelineConnector()
 {
     Stop();
+    m_pElement->SetObserver(NULL);
 }
 //-------------------------------------------------------------------------------------------------
 void PipelineConnector::Start()
@@ -779,7 +1592,7 @@ void PipelineConnector::Start()
     {
         InputSlotPtr pSlot = m_InputSlots[i];
 
-        if(pSlot->m_eThreading == CT_ThreadQueue || pSlot->m_eThreading == CT_ThreadPoll)
+        if(pSlot->m_eThreading == CT_ThreadQueue || pSlot->m_eThreading == CT_ThreadPoll || pSlot->m_eThreading == CT_ThreadPool)
         {
             pSlot->Start();
         }
@@ -788,7 +1601,10 @@ void PipelineConnector::Start()
     {
         OutputSlotPtr pSlot = m_OutputSlots[i];
 
-        if(pSlot->m_eThreading == CT_ThreadQueue || m_pElement->GetInputSlotCount() == 0 )
+        // a source on CT_Direct needs a thread to drive it; on CT_ThreadPoll the downstream input thread
+        // pulls from it and a second puller could submit data behind the EOF
+        if(pSlot->m_eThreading == CT_ThreadQueue || pSlot->m_eThreading == CT_ThreadPool ||
+            (m_pElement->GetInputSlotCount() == 0 && pSlot->m_eThreading == CT_Direct))
         {
             pSlot->Start();
         }
@@ -848,6 +1664,91 @@ void PipelineConnector::Restart()
         m_OutputSlots[i]->Restart();
     }
     m_iSubmitFramesProcessed = 0;
+    ResetStats();
+}
+//-------------------------------------------------------------------------------------------------
+// telemetry
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::OnInputAccepted(amf_int32 /*slot*/)
+{
+    if(m_OutputSlots.empty())
+    {
+        return; // sink - nothing to match the input with
+    }
+    amf::AMFLock lock(&m_statsCs);
+    m_submitTimes.push_back(amf_high_precision_clock());
+    if(m_submitTimes.size() > MAX_PENDING_SUBMITS)
+    {
+        m_submitTimes.pop_front(); // element drops or merges inputs - keep the window bounded
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::OnOutputProduced(amf_int32 slot)
+{
+    if(slot != m_iStatSlot)
+    {
+        return;
+    }
+    m_iPollFramesProcessed++;
+
+    amf::AMFLock lock(&m_statsCs);
+    if(!m_submitTimes.empty()) // sources and elements producing more output than input have no match
+    {
+        m_latency.Record(amf_high_precision_clock() - m_submitTimes.front());
+        m_submitTimes.pop_front();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::OnQueuePush(amf_size depth)
+{
+    amf::AMFLock lock(&m_statsCs);
+    m_queueDepthSum += (amf_int64)depth;
+    m_queueDepthSamples++;
+    m_queueDepthMax = AMF_MAX(m_queueDepthMax, (amf_int64)depth);
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::GetStats(PipelineElementStats& stats)
+{
+    stats.framesSubmitted = m_iSubmitFramesProcessed;
+    stats.framesPolled = m_iPollFramesProcessed;
+    stats.inputFullTime = m_inputFullTime;
+    stats.queueFullTime = m_queueFullTime;
+    stats.idleTime = m_idleTime;
+
+    stats.queueCapacity = 0;
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        if(m_OutputSlots[i]->m_eThreading == CT_ThreadQueue || m_OutputSlots[i]->m_eThreading == CT_ThreadPool)
+        {
+            stats.queueCapacity = AMF_MAX(stats.queueCapacity, (amf_int32)m_OutputSlots[i]->m_dataQueue.GetQueueSize());
+        }
+    }
+
+    amf::AMFLock lock(&m_statsCs);
+    stats.queueDepthAverage = m_queueDepthSamples > 0 ? double(m_queueDepthSum) / double(m_queueDepthSamples) : 0.;
+    stats.queueDepthMax = m_queueDepthMax;
+
+    stats.latencyCount = m_latency.GetCount();
+    stats.latencyMin = m_latency.GetMin();
+    stats.latencyMean = m_latency.GetMean();
+    stats.latencyP50 = m_latency.GetPercentile(50.);
+    stats.latencyP90 = m_latency.GetPercentile(90.);
+    stats.latencyP99 = m_latency.GetPercentile(99.);
+    stats.latencyMax = m_latency.GetMax();
+    m_latency.GetBuckets(stats.latencyBuckets);
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::ResetStats()
+{
+    amf::AMFLock lock(&m_statsCs);
+    m_latency.Reset();
+    m_submitTimes.clear();
+    m_queueDepthSum = 0;
+    m_queueDepthSamples = 0;
+    m_queueDepthMax = 0;
+    m_inputFullTime = 0;
+    m_queueFullTime = 0;
+    m_idleTime = 0;
 }
 //-------------------------------------------------------------------------------------------------
 // a-sync operations from threads
@@ -871,7 +1772,7 @@ AMF_RESULT PipelineConnector::PollAll()
         {
             bEof =  true;
         }
-        else if(res != AMF_OK )
+        else if(res != AMF_OK && res != AMF_REPEAT) // no output on one slot must not starve the others
         {
             break;
         }
@@ -879,6 +1780,43 @@ AMF_RESULT PipelineConnector::PollAll()
     return bEof ? AMF_EOF : res;
 }
 //-------------------------------------------------------------------------------------------------
+void PipelineConnector::OnOutputAvailable(amf_int32 slot)
+{
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        OutputSlotPtr pSlot = m_OutputSlots[i];
+        if(pSlot->m_iThisSlot == slot)
+        {
+            pSlot->Wake();
+            if(pSlot->m_eThreading == CT_ThreadPoll)
+            {
+                pSlot->m_pDownstreamInputSlot->Wake(); // downstream thread polls this element directly
+            }
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::WakeOutputSlots()
+{
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        OutputSlotPtr pSlot = m_OutputSlots[i];
+        pSlot->Wake();
+        if(pSlot->m_eThreading == CT_ThreadPoll)
+        {
+            pSlot->m_pDownstreamInputSlot->Wake();
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::WakeInputSlots()
+{
+    for(amf_size i = 0; i < m_InputSlots.size(); i++)
+    {
+        m_InputSlots[i]->Wake();
+    }
+}
+//-------------------------------------------------------------------------------------------------
 void PipelineConnector::AddInputSlot(InputSlotPtr pSlot)
 {
     m_InputSlots.push_back(pSlot);
@@ -928,6 +1866,165 @@ AMF_RESULT PipelineConnector::Flush()
     return m_pElement->Flush();
 }
 //-------------------------------------------------------------------------------------------------
+// class PipelineStatsThread
+//-------------------------------------------------------------------------------------------------
+PipelineStatsThread::PipelineStatsThread(const Pipeline* pPipeline, amf_ulong periodMs, PipelineStatsFormat eFormat, const std::wstring& path) :
+    m_pPipeline(pPipeline),
+    m_period(periodMs),
+    m_eFormat(eFormat),
+    m_path(path),
+    m_StopEvent(false, true)
+{
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineStatsThread::Stop()
+{
+    RequestStop();
+    m_StopEvent.SetEvent();
+    WaitForStop();
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineStatsThread::Run()
+{
+    if(!m_path.empty())
+    {
+        // appended so that restarts and several pipelines sharing a file keep all snapshots
+        if(amf::AMFDataStream::OpenDataStream(m_path.c_str(), amf::AMFSO_APPEND, amf::AMFFS_SHARE_READ, &m_pStream) != AMF_OK)
+        {
+            LOG_ERROR(L"Failed to open stats file " << m_path);
+        }
+    }
+    while(!StopRequested())
+    {
+        if(m_StopEvent.Lock(m_period))
+        {
+            break;
+        }
+        Dump();
+    }
+    Dump();
+    m_pStream = NULL;
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineStatsThread::Dump()
+{
+    if(m_pStream != NULL)
+    {
+        std::string text = m_eFormat == PSF_JSON ? m_pPipeline->GetStatsJSON() : amf::amf_from_unicode_to_utf8(m_pPipeline->GetStatsText().c_str()).c_str();
+        text += "\n";
+        m_pStream->Write(text.c_str(), text.length(), NULL);
+    }
+    else if(m_eFormat == PSF_JSON)
+    {
+        LOG_INFO(amf::amf_from_utf8_to_unicode(m_pPipeline->GetStatsJSON().c_str()).c_str());
+    }
+    else
+    {
+        LOG_INFO(m_pPipeline->GetStatsText());
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// class PipelineLatencyHistogram
+//-------------------------------------------------------------------------------------------------
+static const amf_int32 HISTOGRAM_SUB_BUCKET_BITS  = 5;
+static const amf_int32 HISTOGRAM_SUB_BUCKET_COUNT = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+static const amf_int32 HISTOGRAM_MAX_EXPONENT     = 40; // 2^41 * 100 ns ~ 2.5 days, larger values are clamped
+static const amf_int32 HISTOGRAM_BUCKET_COUNT     = (HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BUCKET_BITS + 2) << HISTOGRAM_SUB_BUCKET_BITS;
+//-------------------------------------------------------------------------------------------------
+PipelineLatencyHistogram::PipelineLatencyHistogram() :
+    m_counts(HISTOGRAM_BUCKET_COUNT, 0),
+    m_count(0),
+    m_sum(0),
+    m_min(0),
+    m_max(0)
+{
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineLatencyHistogram::Record(amf_pts value)
+{
+    if(value < 0)
+    {
+        value = 0;
+    }
+    m_counts[BucketIndex(value)]++;
+    m_min = m_count > 0 ? AMF_MIN(m_min, value) : value;
+    m_max = AMF_MAX(m_max, value);
+    m_sum += value;
+    m_count++;
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineLatencyHistogram::Reset()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+//-------------------------------------------------------------------------------------------------
+amf_pts PipelineLatencyHistogram::GetPercentile(double percentile) const
+{
+    if(m_count == 0)
+    {
+        return 0;
+    }
+    amf_int64 target = (amf_int64)(percentile / 100. * double(m_count) + 0.5);
+    target = AMF_MAX(target, (amf_int64)1);
+
+    amf_int64 cumulative = 0;
+    for(amf_int32 i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        cumulative += m_counts[i];
+        if(cumulative >= target)
+        {
+            return AMF_MIN(BucketLowerBound(i + 1) - 1, m_max);
+        }
+    }
+    return m_max;
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineLatencyHistogram::GetBuckets(std::vector<PipelineHistogramBucket>& buckets) const
+{
+    buckets.clear();
+    for(amf_int32 i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        if(m_counts[i] != 0)
+        {
+            PipelineHistogramBucket bucket = {BucketLowerBound(i), BucketLowerBound(i + 1) - 1, m_counts[i]};
+            buckets.push_back(bucket);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+amf_int32 PipelineLatencyHistogram::BucketIndex(amf_pts value)
+{
+    if(value < HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        return (amf_int32)value;
+    }
+    const amf_pts maxValue = ((amf_pts)1 << (HISTOGRAM_MAX_EXPONENT + 1)) - 1;
+    value = AMF_MIN(value, maxValue);
+
+    amf_int32 exponent = HISTOGRAM_SUB_BUCKET_BITS;
+    while((value >> (exponent + 1)) != 0)
+    {
+        exponent++;
+    }
+    // top HISTOGRAM_SUB_BUCKET_BITS bits below the leading one select the linear sub-bucket
+    return ((exponent - HISTOGRAM_SUB_BUCKET_BITS + 1) << HISTOGRAM_SUB_BUCKET_BITS) +
+        (amf_int32)((value >> (exponent - HISTOGRAM_SUB_BUCKET_BITS)) - HISTOGRAM_SUB_BUCKET_COUNT);
+}
+//-------------------------------------------------------------------------------------------------
+amf_pts PipelineLatencyHistogram::BucketLowerBound(amf_int32 index)
+{
+    if(index < HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    const amf_int32 exponent = (index >> HISTOGRAM_SUB_BUCKET_BITS) + HISTOGRAM_SUB_BUCKET_BITS - 1;
+    return (amf_pts)(HISTOGRAM_SUB_BUCKET_COUNT + (index & (HISTOGRAM_SUB_BUCKET_COUNT - 1))) << (exponent - HISTOGRAM_SUB_BUCKET_BITS);
+}
+//-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
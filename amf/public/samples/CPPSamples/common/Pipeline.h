@@ -33,6 +33,8 @@
 
 #include "PipelineElement.h"
 #include <vector>
+#include <memory>
+#include <string>
 
 enum PipelineState
 {
@@ -47,9 +49,80 @@ enum ConnectionThreading
     CT_ThreadQueue,
     CT_ThreadPoll,
     CT_Direct,
+    CT_ThreadPool,      // like CT_ThreadQueue but slots run as work items on a shared core-sized pool
+};
+enum SlotWaitMode
+{
+    SWM_Poll,           // idle slot threads sleep 1 ms and poll again
+    SWM_WakeOnData,     // idle slot threads are woken by queue pushes, accepted input, drain completion and PipelineElement::NotifyOutputAvailable
 };
 
+enum PipelineStatsFormat
+{
+    PSF_Text,
+    PSF_JSON,
+};
+//-------------------------------------------------------------------------------------------------
+// Log-linear latency histogram in the spirit of HdrHistogram: values (100 ns units) are bucketed by
+// power of two with 32 linear sub-buckets each, so any recorded value is known within ~3%.
+// Not thread safe - the owner serializes access.
+//-------------------------------------------------------------------------------------------------
+struct PipelineHistogramBucket
+{
+    amf_pts     lowerBound;
+    amf_pts     upperBound;
+    amf_int64   count;
+};
+class PipelineLatencyHistogram
+{
+public:
+    PipelineLatencyHistogram();
+
+    void        Record(amf_pts value);
+    void        Reset();
+
+    amf_int64   GetCount() const { return m_count; }
+    amf_pts     GetMin() const { return m_count > 0 ? m_min : 0; }
+    amf_pts     GetMax() const { return m_max; }
+    amf_pts     GetMean() const { return m_count > 0 ? m_sum / m_count : 0; }
+    amf_pts     GetPercentile(double percentile) const; // upper bound of the bucket holding the percentile
+    void        GetBuckets(std::vector<PipelineHistogramBucket>& buckets) const; // non-empty buckets only
+private:
+    static amf_int32    BucketIndex(amf_pts value);
+    static amf_pts      BucketLowerBound(amf_int32 index);
+
+    std::vector<amf_int64>  m_counts;
+    amf_int64               m_count;
+    amf_pts                 m_sum;
+    amf_pts                 m_min;
+    amf_pts                 m_max;
+};
+//-------------------------------------------------------------------------------------------------
+// per-connector telemetry snapshot, times in 100 ns units
+struct PipelineElementStats
+{
+    amf_int32   index;                  // connection order
+    amf_int64   framesSubmitted;        // accepted by the element on the stat slot
+    amf_int64   framesPolled;           // produced by the element on the stat slot
+    amf_int64   latencyCount;           // submit->output, inputs matched to outputs in order
+    amf_pts     latencyMin;
+    amf_pts     latencyMean;
+    amf_pts     latencyP50;
+    amf_pts     latencyP90;
+    amf_pts     latencyP99;
+    amf_pts     latencyMax;
+    amf_int32   queueCapacity;          // output queues of this element (CT_ThreadQueue, CT_ThreadPool)
+    double      queueDepthAverage;      // sampled on every push
+    amf_int64   queueDepthMax;
+    amf_pts     inputFullTime;          // waiting for the element to accept input (AMF_INPUT_FULL)
+    amf_pts     queueFullTime;          // waiting for room in a full output queue
+    amf_pts     idleTime;               // slot threads waiting with nothing to do
+    std::vector<PipelineHistogramBucket> latencyBuckets;
+};
+//-------------------------------------------------------------------------------------------------
 class PipelineConnector;
+class PipelineThreadPool;
+class PipelineStatsThread;
 class Pipeline
 {
     friend class PipelineConnector;
@@ -62,6 +135,7 @@ public:
     AMF_RESULT Connect(PipelineElementPtr pElement, amf_int32 slot, PipelineElementPtr upstreamElement, amf_int32 upstreamSlot, amf_int32 queueSize, ConnectionThreading eThreading = CT_ThreadQueue);
     AMF_RESULT SetStatSlot(PipelineElementPtr pElement, amf_int32 slot);
     PipelineElementPtr GetLastElement();
+    void SetSlotWaitMode(SlotWaitMode eMode); // applies to connections made after the call
 
     virtual AMF_RESULT      Start();
     virtual AMF_RESULT      Stop();
@@ -74,6 +148,13 @@ public:
     double                  GetProcessingTime();
     amf_int64               GetNumberOfProcessedFrames();
 
+    // per-element telemetry: latency histograms, queue occupancy, blocked and idle time
+    AMF_RESULT              GetElementStats(std::vector<PipelineElementStats>& stats) const;
+    std::wstring            GetStatsText() const;
+    std::string             GetStatsJSON() const;
+    // periodic dump while running: to the log, or appended to pFilePath (JSON - one object per line)
+    void                    SetStatsDump(amf_ulong periodMs, PipelineStatsFormat eFormat = PSF_Text, const wchar_t* pFilePath = NULL);
+
 protected:
     virtual AMF_RESULT      Freeze();
     virtual AMF_RESULT      UnFreeze();
@@ -87,5 +168,11 @@ protected:
     typedef std::vector<PipelineConnectorPtr> ConnectorList;
     ConnectorList                       m_connectors;
     PipelineState                       m_state;
+    SlotWaitMode                        m_eWaitMode;
+    std::shared_ptr<PipelineThreadPool> m_pThreadPool;
+    std::shared_ptr<PipelineStatsThread> m_pStatsThread;
+    amf_ulong                           m_statsPeriod;
+    PipelineStatsFormat                 m_eStatsFormat;
+    std::wstring                        m_statsPath;
     mutable amf::AMFCriticalSection     m_cs;
 };
\ No newline at end of file
@@ -36,12 +36,21 @@
 #include "public/include/components/Component.h"
 #include "public/common/DataStream.h"
 #include "public/common/Thread.h"
+#include "AsyncStreamWriter.h"
 #include "SurfaceUtils.h"
 #include "CmdLogger.h"
 #include <vector>
 
 class Pipeline;
 //-------------------------------------------------------------------------------------------------
+class PipelineElementObserver
+{
+public:
+    virtual void OnOutputAvailable(amf_int32 slot) = 0;
+protected:
+    virtual ~PipelineElementObserver(){}
+};
+//-------------------------------------------------------------------------------------------------
 class PipelineElement
 {
 public:
@@ -64,11 +73,24 @@ public:
     virtual AMF_RESULT OnEof() { return AMF_EOF; }
     virtual std::wstring       GetDisplayResult() { return std::wstring(); }
 
+    void SetObserver(PipelineElementObserver* pObserver) { m_pObserver = pObserver; }
+
     virtual ~PipelineElement(){}
 protected:
-    PipelineElement() : m_host(0), m_bFrozen(false){}
+    PipelineElement() : m_host(0), m_pObserver(NULL), m_bFrozen(false){}
+
+    // elements producing output the pipeline did not ask for - e.g. a component that refuses input
+    // because finished frames wait to be queried - call this to wake the slot polling that output
+    void NotifyOutputAvailable(amf_int32 slot)
+    {
+        if(m_pObserver != NULL)
+        {
+            m_pObserver->OnOutputAvailable(slot);
+        }
+    }
 
     Pipeline* m_host;
+    PipelineElementObserver* m_pObserver;
     bool    m_bFrozen;
     mutable amf::AMFCriticalSection m_cs;
 };
@@ -78,14 +100,20 @@ typedef std::shared_ptr<PipelineElement> PipelineElementPtr;
 class StreamWriter : public PipelineElement
 {
 public:
-    StreamWriter(amf::AMFDataStream *pDataStream)
+    // bAsync moves the writes to an AsyncStreamWriter I/O thread; a full queue returns AMF_INPUT_FULL
+    StreamWriter(amf::AMFDataStream *pDataStream, bool bAsync = false)
         :m_pDataStream(pDataStream), m_framesWritten(0),
-        m_maxSize(0), m_totalSize(0)
+        m_maxSize(0), m_totalSize(0), m_bAsync(false)
     {
+        if(bAsync)
+        {
+            m_bAsync = m_AsyncWriter.Open(pDataStream) == AMF_OK;
+        }
     }
 
     virtual ~StreamWriter()
     {
+        m_AsyncWriter.Close();
 //        LOG_DEBUG(L"Stream Writer: written frames:" << m_framesWritten << L"\n");
     }
 
@@ -106,8 +134,19 @@ public:
             amf::AMFBufferPtr pBuffer(pData);
 
             amf_size towrite = pBuffer->GetSize();
-            amf_size written = 0;
-            m_pDataStream->Write(pBuffer->GetNative(), towrite, &written);
+            if(m_bAsync)
+            {
+                res = m_AsyncWriter.Write(pBuffer, 0);
+                if(res != AMF_OK)
+                {
+                    return res;
+                }
+            }
+            else
+            {
+                amf_size written = 0;
+                m_pDataStream->Write(pBuffer->GetNative(), towrite, &written);
+            }
             m_framesWritten++;
             if(m_maxSize < towrite)
             {
@@ -117,7 +156,11 @@ public:
         }
         else
         {
-            res = AMF_EOF;
+            res = m_bAsync ? m_AsyncWriter.Flush() : AMF_OK;
+            if(res == AMF_OK)
+            {
+                res = AMF_EOF;
+            }
         }
         return res;
     }
@@ -125,6 +168,14 @@ public:
     {
         return AMF_NOT_SUPPORTED;
     }
+    virtual AMF_RESULT Drain(amf_int32 /*inputSlot*/)
+    {
+        if(m_bAsync && m_AsyncWriter.GetQueueDepth() > 0)
+        {
+            return AMF_INPUT_FULL; // retried by the input slot until the I/O thread catches up
+        }
+        return AMF_OK;
+    }
     virtual std::wstring       GetDisplayResult()
     {
         amf::AMFLock lock(&m_cs);
@@ -136,6 +187,10 @@ public:
             messageStream << L" Average (Max) Frame size: " << m_totalSize / m_framesWritten << L" bytes (" << m_maxSize << " bytes)";
             ret = messageStream.str();
         }
+        if(m_bAsync)
+        {
+            ret += m_AsyncWriter.GetDisplayResult();
+        }
         return ret;
     }
 private:
@@ -143,6 +198,8 @@ private:
     amf_int                 m_framesWritten;
     amf_size                m_maxSize;
     amf_int64               m_totalSize;
+    bool                    m_bAsync;
+    AsyncStreamWriter       m_AsyncWriter;
 };
 //-------------------------------------------------------------------------------------------------
 typedef std::shared_ptr<StreamWriter> StreamWriterPtr;
@@ -211,6 +268,7 @@ public:
     {
     }
 
+    virtual amf_int32 GetInputSlotCount() const { return 1; }
     virtual amf_int32 GetOutputSlotCount() const { return 0; }
 
     virtual AMF_RESULT SubmitInput(amf::AMFData* pData)
@@ -517,8 +575,9 @@ public:
         else
         {
             res = m_pComponent->SubmitInput(pData);
-            if(res == AMF_DECODER_NO_FREE_SURFACES)
+            if(res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
             {
+                NotifyOutputAvailable(0); // the component holds output that has to be queried first
                 return AMF_INPUT_FULL;
             }
         }
@@ -533,8 +592,9 @@ public:
 
         AMF_RESULT res = AMF_OK;
         res = m_pComponent->SubmitInput(NULL);
-        if (res == AMF_DECODER_NO_FREE_SURFACES)
+        if (res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
         {
+            NotifyOutputAvailable(0);
             return AMF_INPUT_FULL;
         }
         return res;
@@ -630,8 +690,9 @@ public:
             { 
                 res = m_pComponent->SubmitInput(pData);
             }
-            if(res == AMF_DECODER_NO_FREE_SURFACES)
+            if(res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
             {
+                NotifyOutputsAvailable(); // the component holds output that has to be queried first
                 return AMF_INPUT_FULL;
             }
 
@@ -663,8 +724,9 @@ public:
         {
             res = m_pComponent->SubmitInput(NULL);
         }
-        if (res == AMF_DECODER_NO_FREE_SURFACES)
+        if (res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
         {
+            NotifyOutputsAvailable();
             return AMF_INPUT_FULL;
         }
         return res;
@@ -737,6 +799,14 @@ public:
     }
 
 protected:
+    void NotifyOutputsAvailable()
+    {
+        for(amf_int32 slot = 0; slot < m_pComponent->GetOutputCount(); slot++)
+        {
+            NotifyOutputAvailable(slot);
+        }
+    }
+
     amf::AMFComponentExPtr    m_pComponent;
     std::vector<bool>         m_bEof;
 };
@@ -323,9 +323,9 @@ AMF_RESULT PlaybackPipelineBase::Init()
     if( streamType != BitStreamUnknown && streamType != BitStreamIVF)
     {
 #if !defined(METRO_APP)
-        amf::AMFDataStream::OpenDataStream(inputPath.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pVideoStream);
+        amf::AMFDataStream::OpenMappedDataStream(inputPath.c_str(), amf::AMFFS_SHARE_READ, &m_pVideoStream);
 #else
-        amf::AMFDataStream::OpenDataStream(inputPath.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pVideoStream);
+        amf::AMFDataStream::OpenMappedDataStream(inputPath.c_str(), amf::AMFFS_SHARE_READ, &m_pVideoStream);
 #endif
         CHECK_RETURN(m_pVideoStream != NULL, AMF_FILE_NOT_OPEN, "Open File");
 
@@ -344,7 +344,7 @@ AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pC
         return AMF_FAIL;
     }
 
-    amf::AMFDataStream::OpenDataStream(path.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pDataStream);
+    amf::AMFDataStream::OpenMappedDataStream(path.c_str(), amf::AMFFS_SHARE_READ, &m_pDataStream);
     if (!m_pDataStream)
     {
         LOG_ERROR("Cannot open input file: " << path.c_str() );
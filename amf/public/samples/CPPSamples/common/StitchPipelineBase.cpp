@@ -200,8 +200,9 @@ public:
             {
                 m_pDecoderSync->Reset(m_iIndex);
             }
-            if(res == AMF_DECODER_NO_FREE_SURFACES)
+            if(res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
             {
+                NotifyOutputAvailable(0); // the component holds output that has to be queried first
                 return AMF_INPUT_FULL;
             }
         }
@@ -1195,7 +1196,7 @@ AMF_RESULT StitchStream::InitDemuxer(
 
     if (streamType != BitStreamUnknown)
     {
-        amf::AMFDataStream::OpenDataStream(filename, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pStream);
+        amf::AMFDataStream::OpenMappedDataStream(filename, amf::AMFFS_SHARE_READ, &m_pStream);
         AMF_RETURN_IF_FALSE(m_pStream != NULL, AMF_FILE_NOT_OPEN, L"Open File");
         m_pParser = BitStreamParser::Create(m_pStream, streamType, pContext);
         AMF_RETURN_IF_FALSE(m_pParser != NULL, AMF_FILE_NOT_OPEN, L"BitStreamParser::Create");
@@ -1351,7 +1352,7 @@ AMF_RESULT StitchStream::GetMediaInfo(amf::AMFContext *pContext,
 
     if (streamType != BitStreamUnknown)
     {
-        amf::AMFDataStream::OpenDataStream(filename, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pStream);
+        amf::AMFDataStream::OpenMappedDataStream(filename, amf::AMFFS_SHARE_READ, &m_pStream);
         AMF_RETURN_IF_FALSE(m_pStream != NULL, AMF_FILE_NOT_OPEN, L"Open File");
         m_pParser = BitStreamParser::Create(m_pStream, streamType, pContext);
         AMF_RETURN_IF_FALSE(m_pParser != NULL, AMF_FILE_NOT_OPEN, L"BitStreamParser::Create");
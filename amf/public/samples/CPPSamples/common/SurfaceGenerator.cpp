@@ -32,6 +32,7 @@
 
 #include "SurfaceGenerator.h"
 #include "AMFHalfFloat.h"
+#include "FrameGenerator.h"
 
 
 #ifdef _WIN32
@@ -207,35 +208,9 @@ AMF_RESULT FillNV12SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 Y, amf_
     AMF_RETURN_IF_INVALID_POINTER(pPlaneY);
     AMF_RETURN_IF_INVALID_POINTER(pPlaneUV);
 
-    amf_int32 widthY = pPlaneY->GetWidth();
-    amf_int32 heightY = pPlaneY->GetHeight();
-    amf_int32 lineY = pPlaneY->GetHPitch();
-
-    amf_uint8* pDataY = (amf_uint8*)pPlaneY->GetNative();
-
-    for (amf_int32 y = 0; y < heightY; y++)
-    {
-        amf_uint8* pDataLine = pDataY + y * lineY;
-        memset(pDataLine, Y, widthY);
-    }
-
-    amf_int32 widthUV = pPlaneUV->GetWidth();
-    amf_int32 heightUV = pPlaneUV->GetHeight();
-    amf_int32 lineUV = pPlaneUV->GetHPitch();
-
-    amf_uint8* pDataUV = (amf_uint8*)pPlaneUV->GetNative();
-
-    for (amf_int32 y = 0; y < heightUV; y++)
-    {
-        amf_uint8* pDataLine = pDataUV + y * lineUV;
-        for (amf_int32 x = 0; x < widthUV; x++)
-        {
-            *pDataLine++ = U;
-            *pDataLine++ = V;
-        }
-    }
-
-    return AMF_OK;
+    const amf_uint8 UV[2] = { U, V };
+    AMF_RETURN_IF_FAILED(FillPlaneWithPattern(pPlaneY, &Y, sizeof(Y)));
+    return FillPlaneWithPattern(pPlaneUV, UV, sizeof(UV));
 }
 
 AMF_RESULT FillRGBASurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R, amf_uint8 G, amf_uint8 B)
@@ -243,25 +218,8 @@ AMF_RESULT FillRGBASurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R, amf_
     amf::AMFPlane* pPlane = pSurface->GetPlaneAt(0);
     AMF_RETURN_IF_INVALID_POINTER(pPlane);
 
-    amf_int32 width = pPlane->GetWidth();
-    amf_int32 height = pPlane->GetHeight();
-    amf_int32 line = pPlane->GetHPitch();
-
-    amf_uint8* pData = (amf_uint8*)pPlane->GetNative();
-
-    for (amf_int32 y = 0; y < height; y++)
-    {
-        amf_uint8* pDataLine = pData + y * line;
-        for (amf_int32 x = 0; x < width; x++)
-        {
-            *pDataLine++ = R;
-            *pDataLine++ = G;
-            *pDataLine++ = B;
-            *pDataLine++ = 255; //A
-        }
-    }
-
-    return AMF_OK;
+    const amf_uint8 color[4] = { R, G, B, 255 };
+    return FillPlaneWithPattern(pPlane, color, sizeof(color));
 }
 
 AMF_RESULT FillBGRASurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R, amf_uint8 G, amf_uint8 B)
@@ -269,25 +227,8 @@ AMF_RESULT FillBGRASurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R, amf_
     amf::AMFPlane* pPlane = pSurface->GetPlaneAt(0);
     AMF_RETURN_IF_INVALID_POINTER(pPlane);
 
-    amf_int32 width = pPlane->GetWidth();
-    amf_int32 height = pPlane->GetHeight();
-    amf_int32 line = pPlane->GetHPitch();
-
-    amf_uint8* pData = (amf_uint8*)pPlane->GetNative();
-
-    for (amf_int32 y = 0; y < height; y++)
-    {
-        amf_uint8* pDataLine = pData + y * line;
-        for (amf_int32 x = 0; x < width; x++)
-        {
-            *pDataLine++ = B;
-            *pDataLine++ = G;
-            *pDataLine++ = R;
-            *pDataLine++ = 255; //A
-        }
-    }
-
-    return AMF_OK;
+    const amf_uint8 color[4] = { B, G, R, 255 };
+    return FillPlaneWithPattern(pPlane, color, sizeof(color));
 }
 
 amf_uint16 AMFHalfFloat::m_basetable[512];
@@ -299,30 +240,14 @@ AMF_RESULT FillRGBA_F16SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R,
     amf::AMFPlane* pPlane = pSurface->GetPlaneAt(0);
     AMF_RETURN_IF_INVALID_POINTER(pPlane);
 
-    amf_int32 width = pPlane->GetWidth();
-    amf_int32 height = pPlane->GetHeight();
-    amf_int32 line = pPlane->GetHPitch();
-
-    amf_uint8* pData = (amf_uint8*)pPlane->GetNative();
-
-    amf_uint16 fR = AMFHalfFloat::ToHalfFloat((float)R / 255.f);
-    amf_uint16 fG = AMFHalfFloat::ToHalfFloat((float)G / 255.f);
-    amf_uint16 fB = AMFHalfFloat::ToHalfFloat((float)B / 255.f);
-    amf_uint16 fA = AMFHalfFloat::ToHalfFloat((float)255.f / 255.f);
-
-    for (amf_int32 y = 0; y < height; y++)
+    const amf_uint16 color[4] =
     {
-        amf_uint16* pDataLine = (amf_uint16*)(pData + y * line);
-        for (amf_int32 x = 0; x < width; x++)
-        {
-            *pDataLine++ = fR;
-            *pDataLine++ = fG;
-            *pDataLine++ = fB;
-            *pDataLine++ = fA; //A
-        }
-    }
-
-    return AMF_OK;
+        AMFHalfFloat::ToHalfFloat((float)R / 255.f),
+        AMFHalfFloat::ToHalfFloat((float)G / 255.f),
+        AMFHalfFloat::ToHalfFloat((float)B / 255.f),
+        AMFHalfFloat::ToHalfFloat((float)255.f / 255.f),
+    };
+    return FillPlaneWithPattern(pPlane, color, sizeof(color));
 }
 
 AMF_RESULT FillR10G10B10A2SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R, amf_uint8 G, amf_uint8 B)
@@ -330,29 +255,13 @@ AMF_RESULT FillR10G10B10A2SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8
     amf::AMFPlane* pPlane = pSurface->GetPlaneAt(0);
     AMF_RETURN_IF_INVALID_POINTER(pPlane);
 
-    amf_int32 width = pPlane->GetWidth();
-    amf_int32 height = pPlane->GetHeight();
-    amf_int32 line = pPlane->GetHPitch();
-
-    amf_uint8* pData = (amf_uint8*)pPlane->GetNative();
-
     amf_uint32 r10 = ((amf_uint32)R * 0x3FF / 0xFF) << 2;
     amf_uint32 g10 = ((amf_uint32)G * 0x3FF / 0xFF) << 12;
     amf_uint32 b10 = ((amf_uint32)B * 0x3FF / 0xFF) << 22;
     amf_uint32 a2 = 0x3;
 
     amf_uint32 color = r10 | g10 | b10 | a2;
-
-    for (amf_int32 y = 0; y < height; y++)
-    {
-        amf_uint32* pDataLine = (amf_uint32*)(pData + y * line);
-        for (amf_int32 x = 0; x < width; x++)
-        {
-            *pDataLine++ = color;
-        }
-    }
-
-    return AMF_OK;
+    return FillPlaneWithPattern(pPlane, &color, sizeof(color));
 }
 
 AMF_RESULT FillP010SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 Y, amf_uint8 U, amf_uint8 V)
@@ -362,35 +271,11 @@ AMF_RESULT FillP010SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 Y, amf_
     AMF_RETURN_IF_INVALID_POINTER(pPlaneY);
     AMF_RETURN_IF_INVALID_POINTER(pPlaneUV);
 
-    amf_int32 widthY = pPlaneY->GetWidth();
-    amf_int32 heightY = pPlaneY->GetHeight();
-    amf_int32 lineY = pPlaneY->GetHPitch();
-
-    amf_uint8* pDataY = (amf_uint8*)pPlaneY->GetNative();
-
-    for (amf_int32 y = 0; y < heightY; y++)
-    {
-        amf_uint8* pDataLine = pDataY + y * lineY;
-        memset(pDataLine, Y, widthY);
-    }
-
-    amf_int32 widthUV = pPlaneUV->GetWidth();
-    amf_int32 heightUV = pPlaneUV->GetHeight();
-    amf_int32 lineUV = pPlaneUV->GetHPitch();
-
-    amf_uint8* pDataUV = (amf_uint8*)pPlaneUV->GetNative();
-
-    for (amf_int32 y = 0; y < heightUV; y++)
-    {
-        amf_uint8* pDataLine = pDataUV + y * lineUV;
-        for (amf_int32 x = 0; x < widthUV; x++)
-        {
-            *pDataLine++ = U;
-            *pDataLine++ = V;
-        }
-    }
-
-    return AMF_OK;
+    // 16-bit samples with the value in the upper bits
+    const amf_uint16 Y16 = amf_uint16(Y << 8);
+    const amf_uint16 UV16[2] = { amf_uint16(U << 8), amf_uint16(V << 8) };
+    AMF_RETURN_IF_FAILED(FillPlaneWithPattern(pPlaneY, &Y16, sizeof(Y16)));
+    return FillPlaneWithPattern(pPlaneUV, UV16, sizeof(UV16));
 }
 
 AMF_RESULT FillRGBA_RGBA16SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8 R, amf_uint8 G, amf_uint8 B)
@@ -398,30 +283,8 @@ AMF_RESULT FillRGBA_RGBA16SurfaceWithColor(amf::AMFSurface* pSurface, amf_uint8
     amf::AMFPlane* pPlane = pSurface->GetPlaneAt(0);
     AMF_RETURN_IF_INVALID_POINTER(pPlane);
 
-    amf_int32 width = pPlane->GetWidth();
-    amf_int32 height = pPlane->GetHeight();
-    amf_int32 line = pPlane->GetHPitch();
-
-    amf_uint8* pData = (amf_uint8*)pPlane->GetNative();
-
-    amf_uint16 fR = R << 8;
-    amf_uint16 fG = G << 8;
-    amf_uint16 fB = B << 8;
-    amf_uint16 fA = 255 << 8;
-
-    for (amf_int32 y = 0; y < height; y++)
-    {
-        amf_uint16* pDataLine = (amf_uint16*)(pData + y * line);
-        for (amf_int32 x = 0; x < width; x++)
-        {
-            *pDataLine++ = fR;
-            *pDataLine++ = fG;
-            *pDataLine++ = fB;
-            *pDataLine++ = fA; //A
-        }
-    }
-
-    return AMF_OK;
+    const amf_uint16 color[4] = { amf_uint16(R << 8), amf_uint16(G << 8), amf_uint16(B << 8), amf_uint16(255 << 8) };
+    return FillPlaneWithPattern(pPlane, color, sizeof(color));
 }
 
 AMF_RESULT FillSurfaceVulkan(amf::AMFContext* pContext, amf::AMFSurface* pSurface, amf_bool isRefFrame)
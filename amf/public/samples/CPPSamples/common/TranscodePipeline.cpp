@@ -52,6 +52,8 @@ const wchar_t* TranscodePipeline::PARAM_NAME_SCALE_WIDTH  = L"WIDTH";
 const wchar_t* TranscodePipeline::PARAM_NAME_SCALE_HEIGHT = L"HEIGHT";
 const wchar_t* TranscodePipeline::PARAM_NAME_FRAMES       = L"FRAMES";
 const wchar_t* TranscodePipeline::PARAM_NAME_SCALE_TYPE   = L"SCALETYPE";
+const wchar_t* TranscodePipeline::PARAM_NAME_STATS_INTERVAL = L"STATSINTERVAL";
+const wchar_t* TranscodePipeline::PARAM_NAME_STATS_FILE     = L"STATSFILE";
 
 
 // NOTE: codec ID for ffmpeg 4.1.3 - id can change with different ffmpeg versions
@@ -99,8 +101,9 @@ public:
 
 
             res = m_pComponent->SubmitInput(pData);
-            if(res == AMF_DECODER_NO_FREE_SURFACES)
+            if(res == AMF_DECODER_NO_FREE_SURFACES || res == AMF_INPUT_FULL)
             {
+                NotifyOutputAvailable(0); // the component holds output that has to be queried first
                 return AMF_INPUT_FULL;
             }
             m_framesSubmitted++;
@@ -393,6 +396,32 @@ AMF_RESULT TranscodePipeline::Init(const wchar_t* path, IRandomAccessStream^ inp
     amf_int64 frames = 0;
     pParams->GetParam(PARAM_NAME_FRAMES, frames);
 
+    // per-element telemetry dump
+    amf_int64 statsInterval = 0;
+    pParams->GetParam(PARAM_NAME_STATS_INTERVAL, statsInterval);
+    std::wstring statsPath;
+    pParams->GetParamWString(PARAM_NAME_STATS_FILE, statsPath);
+    if(statsInterval > 0 || !statsPath.empty())
+    {
+        PipelineStatsFormat eStatsFormat = PSF_Text;
+        std::wstring::size_type pos_dot = statsPath.rfind(L'.');
+        if(pos_dot != std::wstring::npos)
+        {
+            std::wstring ext = statsPath.substr(pos_dot);
+            if(ext == L".json" || ext == L".JSON")
+            {
+                eStatsFormat = PSF_JSON;
+            }
+            if(threadID != -1)
+            {
+                std::wstringstream prntstream;
+                prntstream << threadID;
+                statsPath = statsPath.substr(0, pos_dot) + L"_" + prntstream.str() + ext;
+            }
+        }
+        SetStatsDump(statsInterval > 0 ? (amf_ulong)statsInterval : 1000, eStatsFormat, statsPath.empty() ? NULL : statsPath.c_str());
+    }
+
 
     //---------------------------------------------------------------------------------------------
     // Init context and devices
@@ -468,9 +497,9 @@ AMF_RESULT TranscodePipeline::Init(const wchar_t* path, IRandomAccessStream^ inp
     if( inStreamType != BitStreamUnknown)
     {
 #if !defined(METRO_APP)
-        amf::AMFDataStream::OpenDataStream(inputPath.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pStreamIn);
+        amf::AMFDataStream::OpenMappedDataStream(inputPath.c_str(), amf::AMFFS_SHARE_READ, &m_pStreamIn);
 #else
-        amf::AMFDataStream::OpenDataStream(inputPath.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pStreamIn);
+        amf::AMFDataStream::OpenMappedDataStream(inputPath.c_str(), amf::AMFFS_SHARE_READ, &m_pStreamIn);
 #endif
         CHECK_RETURN(m_pStreamIn != NULL, AMF_FILE_NOT_OPEN, "Open File");
 
@@ -595,7 +624,7 @@ AMF_RESULT TranscodePipeline::Init(const wchar_t* path, IRandomAccessStream^ inp
         m_pStreamOut = AMFDataStream::Create(outputStream);
         CHECK_RETURN(m_pStreamOut != NULL, AMF_FILE_NOT_OPEN, "Open File");
 #endif//#if !defined(METRO_APP)
-        m_pStreamWriter = StreamWriterPtr(new StreamWriter(m_pStreamOut));
+        m_pStreamWriter = StreamWriterPtr(new StreamWriter(m_pStreamOut, true));
     }
     else
     {
@@ -71,6 +71,8 @@ public:
     static const wchar_t* PARAM_NAME_SCALE_HEIGHT;
     static const wchar_t* PARAM_NAME_FRAMES;
     static const wchar_t* PARAM_NAME_SCALE_TYPE;
+    static const wchar_t* PARAM_NAME_STATS_INTERVAL;
+    static const wchar_t* PARAM_NAME_STATS_FILE;
 
 
 
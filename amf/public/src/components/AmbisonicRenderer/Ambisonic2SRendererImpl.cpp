@@ -38,6 +38,7 @@
 #include "public/include/core/Context.h"
 #include "public/include/core/Trace.h"
 #include "public/common/TraceAdapter.h"
+#include "public/common/AudioConvert.h"
 #include "public/common/AMFFactory.h"
 
 
@@ -86,14 +87,21 @@ void Ambi2Stereo::loadTabulatedHRTFs()
     
     m_convolution = new convolution(IRTABLEN,responseLength);
     m_convolution->init();
+    if (convolutionEngine == AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT)
+    {
+        // falls back to the time domain path if the block size is not a power of two
+        m_convolution->initPartitioned(bufSize);
+    }
 
 }
 
-Ambi2Stereo::Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM decodemethod, amf_int64 inSampleRate_) :
+Ambi2Stereo::Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM decodemethod, amf_int64 inSampleRate_,
+                         AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM convolutionEngine_) :
 inSampleRate(inSampleRate_)
 {
     m_convolution = NULL;
     method = decodemethod;
+    convolutionEngine = convolutionEngine_;
 
     bufSize = 64;
     prevHeadTheta = prevHeadPhi = 0.0;
@@ -339,6 +347,10 @@ void Ambi2Stereo::process(float newtheta, float newphi, int nSamples, float *W,
 
             //pConvolution->ProcessDirect(Responses, Data, OutData, bufSize, &nProcessed, nzFL); 
             for (int k = 0; k < 8; k++){
+               if (m_convolution->isPartitioned()){
+                   m_convolution->frequencyDomainCPU(Responses[k], nzFL[k * 2], nzFL[k * 2 + 1], Data[k], OutData[k], k, bufSize, responseLength);
+                   continue;
+               }
                m_convolution->timeDomainCPU(Responses[k], nzFL[k * 2], nzFL[k * 2 + 1], Data[k], OutData[k], k, bufSize, responseLength);
             }
 
@@ -429,6 +441,12 @@ const AMFEnumDescriptionEntry AMF_AMBISONIC2SRENDERER_MODE_ENUM_DESCRIPTION[] =
 
 };
 
+const AMFEnumDescriptionEntry AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM_DESCRIPTION[] = {
+{ AMF_AMBISONIC2SRENDERER_CONVOLUTION_TIME_DOMAIN, L"Time domain" },
+{ AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT, L"Partitioned FFT" },
+{ 0, NULL }
+};
+
 
 //
 //
@@ -458,6 +476,7 @@ AMFAmbisonic2SRendererImpl::AMFAmbisonic2SRendererImpl(AMFContext* pContext)
   ,  m_ptsNext(0)
   ,  m_ambi2S(NULL)
   , m_eMode(AMF_AMBISONIC2SRENDERER_MODE_HRTF_MIT1)
+  , m_eConvolution(AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT)
   , m_ptsLastTime(-1LL)
 {
     AMFPrimitivePropertyInfoMapBegin
@@ -471,6 +490,7 @@ AMFAmbisonic2SRendererImpl::AMFAmbisonic2SRendererImpl(AMFContext* pContext)
         AMFPropertyInfoEnum(AMF_AMBISONIC2SRENDERER_IN_AUDIO_SAMPLE_FORMAT,     L"input Sample Format", AMFAF_FLTP, AMF_SAMPLE_INPUT_FORMAT_ENUM_DESCRIPTION, false),
 
         AMFPropertyInfoEnum(AMF_AMBISONIC2SRENDERER_MODE,                       L"Mode", AMF_AMBISONIC2SRENDERER_MODE_HRTF_MIT1, AMF_AMBISONIC2SRENDERER_MODE_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoEnum(AMF_AMBISONIC2SRENDERER_CONVOLUTION,                L"Convolution engine", AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT, AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM_DESCRIPTION, false),
 
         AMFPropertyInfoInt64(AMF_AMBISONIC2SRENDERER_W,                         L"w channel", 0, 0, 3, true),
         AMFPropertyInfoInt64(AMF_AMBISONIC2SRENDERER_X,                         L"x channel", 1, 0, 3, true),
@@ -527,6 +547,9 @@ AMF_RESULT AMF_STD_CALL  AMFAmbisonic2SRendererImpl::Init(AMF_SURFACE_FORMAT /*f
     amf_int64 mode;
     GetProperty(AMF_AMBISONIC2SRENDERER_MODE, &mode);
     m_eMode = (AMF_AMBISONIC2SRENDERER_MODE_ENUM)mode;
+    amf_int64 convolutionEngine;
+    GetProperty(AMF_AMBISONIC2SRENDERER_CONVOLUTION, &convolutionEngine);
+    m_eConvolution = (AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM)convolutionEngine;
     GetProperty(AMF_AMBISONIC2SRENDERER_X, &m_xIndex);
     GetProperty(AMF_AMBISONIC2SRENDERER_Y, &m_yIndex);
     GetProperty(AMF_AMBISONIC2SRENDERER_Z, &m_zIndex);
@@ -545,7 +568,7 @@ AMF_RESULT AMF_STD_CALL  AMFAmbisonic2SRendererImpl::Init(AMF_SURFACE_FORMAT /*f
     GetProperty(AMF_AMBISONIC2SRENDERER_OUT_AUDIO_SAMPLE_FORMAT, &format);
     m_outSampleFormat = (AMF_AUDIO_FORMAT)format;
 
-    m_ambi2S = new Ambi2Stereo(m_eMode, inSampleRate);
+    m_ambi2S = new Ambi2Stereo(m_eMode, inSampleRate, m_eConvolution);
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -700,110 +723,17 @@ AMF_RESULT AMF_STD_CALL  AMFAmbisonic2SRendererImpl::QueryOutput(AMFData** ppDat
 
     AMF_RETURN_IF_FALSE(pInputAsFLTP != NULL, AMF_OUT_OF_MEMORY, L"QueryOutput() - No memory");
 
-    //////TODO: optimize if needed
-
-    ///ibuf: hold each channel as input
-    uint8_t *ibuf[s_InputChannelCount] = { pMemIn };
-    //int istride[s_InputChannelCount] = { iSampleSizeIn };
     ///inputFloats: hold each channel of input converted to float
     float *inputFloats[s_InputChannelCount] = { pInputAsFLTP };
-
-    if ( IsAudioPlanar(m_inSampleFormat) )
-    {
-        //copy and convert planner input
-        for (amf_int32 ch = 0; ch < m_inChannels; ch++)
-        {
-            ibuf[ch] = (amf_uint8*) pMemIn + ch * (iSampleSizeIn * iSamplesIn);
-            //istride[ch] = iSampleSizeIn;
-
-            inputFloats[ch] = pInputAsFLTP + (ch * iSamplesIn);
-
-            switch (m_inSampleFormat)
-            {
-                case AMFAF_S16P:
-                {
-                    float koeff = (float)0x7FFF;
-                    amf_int16* theInput = (amf_int16*)ibuf[ch];
-                    for (amf_int64 cc = 0; cc < iSamplesIn; cc++)
-                    {
-                        inputFloats[ch][cc] = (amf_float) (*theInput) / koeff;
-                        theInput++;
-                    }
-                }
-                break;
-                case AMFAF_S32P:
-                {
-                    float koeff = (float)0x7FFFFFFF;
-                    amf_int32* theInput = (amf_int32*)ibuf[ch];
-                    for (amf_int64 cc = 0; cc < iSamplesIn; cc++)
-                    {
-                        inputFloats[ch][cc] = (amf_float) (*theInput) / koeff;
-                        theInput++;
-                    }
-                }
-                break;
-                case AMFAF_FLTP:
-                {
-                    amf_float* theInput = (amf_float*)ibuf[ch];
-                    for (amf_int64 cc = 0; cc < iSamplesIn; cc++)
-                    {
-                        inputFloats[ch][cc] = (*theInput);
-                        theInput++;
-                    }
-                }
-                break;
-            }
-
-        }
-    }
-    else
+    for (amf_int32 ch = 0; ch < m_inChannels; ch++)
     {
-        switch (m_inSampleFormat)
-        {
-            case AMFAF_S16:
-            {
-                float koeff = (float)0x7FFF;
-                amf_int16* theInput = (amf_int16*)pMemIn;
-                for (amf_int64 cc = 0; cc < iSamplesIn; cc++)
-                {
-                    for (amf_int32 ch = 0; ch < m_inChannels; ch++)
-                    {
-                        inputFloats[ch][cc] = (amf_float) (*theInput) / koeff;
-                        theInput++;
-                    }
-                }
-            }
-            break;
-            case AMFAF_S32:
-            {
-                float koeff = (float)0x7FFFFFFF;
-                amf_int32* theInput = (amf_int32*)pMemIn;
-                for (amf_int64 cc = 0; cc < iSamplesIn; cc++)
-                {
-                    for (amf_int32 ch = 0; ch < m_inChannels; ch++)
-                    {
-                        inputFloats[ch][cc] = (amf_float) (*theInput) / koeff;
-                        theInput++;
-                    }
-                }
-            }
-            break;
-            case AMFAF_FLT:
-            {
-                amf_float* theInput = (amf_float*)pMemIn;
-                for (amf_int64 cc = 0; cc < iSamplesIn; cc++)
-                {
-                    for (amf_int32 ch = 0; ch < m_inChannels; ch++)
-                    {
-                        inputFloats[ch][cc] = (*theInput);
-                        theInput++;
-                    }
-                }
-            }
-            break;
-        }
+        inputFloats[ch] = pInputAsFLTP + (ch * iSamplesIn);
     }
 
+    //convert planar or interleaved input to planar float
+    AMF_RESULT res = AMFAudioConvertBuffer(m_inSampleFormat, pMemIn, AMFAF_FLTP, pInputAsFLTP, (amf_int32)m_inChannels, (amf_size)iSamplesIn);
+    AMF_RETURN_IF_FAILED(res, L"QueryOutput() - AMFAudioConvertBuffer failed");
+
 
 
         //////TODO
@@ -56,6 +56,7 @@ namespace amf
         amf_int64    inSampleRate;
         unsigned int responseLength;
         AMF_AMBISONIC2SRENDERER_MODE_ENUM method;
+        AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM convolutionEngine;
         float *theta, *phi;
         float prevHeadTheta, prevHeadPhi;
 
@@ -71,7 +72,8 @@ namespace amf
         convolution *m_convolution;
 
     public:
-        Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM  method, amf_int64 inSampleRate);
+        Ambi2Stereo(AMF_AMBISONIC2SRENDERER_MODE_ENUM  method, amf_int64 inSampleRate,
+                    AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM convolutionEngine = AMF_AMBISONIC2SRENDERER_CONVOLUTION_PARTITIONED_FFT);
         ~Ambi2Stereo();
 
         void process(float theta, float phi, int nSamples, float *W, float *X, float *Y, float *Z, float *left, float *right);
@@ -137,6 +139,7 @@ namespace amf
         amf_int64                           m_inChannels;
 
         AMF_AMBISONIC2SRENDERER_MODE_ENUM   m_eMode;
+        AMF_AMBISONIC2SRENDERER_CONVOLUTION_ENUM m_eConvolution;
 
         amf_int64                           m_wIndex;
         amf_int64                           m_xIndex;
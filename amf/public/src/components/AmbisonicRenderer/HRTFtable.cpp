@@ -139,7 +139,7 @@ bool getIR(float srate, int idx, float *elevation, float *azimuth, int IRlength,
 
 // check data format:
     RiffWave fhd;
-    unsigned long length;
+    unsigned int length;
 
     memset(&fhd, 0, sizeof(fhd));
 
@@ -23,17 +23,34 @@
 #include "public/include/core/Interface.h"
 #include "public/include/core/Data.h"
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include "convolution.h"
 
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || (defined(__i386__) && defined(__SSE2__))
+    #define CONVOLUTION_SIMD_SSE
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define CONVOLUTION_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+#define CONVOLUTION_PI 3.1415926535897932384626433
+
 convolution::convolution(int nChannels, int responseLength){
     m_nChannels = nChannels;
     m_ResponseLength = responseLength;
     m_sampHistPos = NULL;
     m_SampleHistory = NULL;
+
+    m_BlockLength = 0;
+    m_Partitions = 0;
+    m_BinStride = 0;
 }
 
 bool convolution::init(){
     m_sampHistPos = new int[m_nChannels];
+    memset(m_sampHistPos, 0, m_nChannels*sizeof(int));
 
     m_SampleHistory = new float*[m_nChannels];
     
@@ -48,14 +65,14 @@ bool convolution::init(){
 
 convolution::~convolution(){
     if (m_sampHistPos != NULL){
-        delete m_sampHistPos;
+        delete[] m_sampHistPos;
     }
     if (m_SampleHistory != NULL){
         for (int i = 0; i < m_nChannels; i++){
             if (m_SampleHistory[i] != NULL)
-                delete m_SampleHistory[i];
+                delete[] m_SampleHistory[i];
         }
-        delete m_SampleHistory;
+        delete[] m_SampleHistory;
     }
 }
 
@@ -87,3 +104,305 @@ void convolution::timeDomainCPU(
     }
     m_sampHistPos[chanIdx] += (int)datalength;
 }
+
+//-------------------------------------------------------------------------------------------------
+// real FFT
+//-------------------------------------------------------------------------------------------------
+realFFT::realFFT() :
+    m_Length(0),
+    m_Half(0)
+{
+}
+
+bool realFFT::init(amf_size length)
+{
+    if (length < 4 || (length & (length - 1)) != 0)
+    {
+        return false;
+    }
+    m_Length = length;
+    m_Half = length / 2;
+
+    amf_uint32 bits = 0;
+    while (((amf_size)1 << bits) < m_Half)
+    {
+        bits++;
+    }
+    m_BitReverse.resize(m_Half);
+    for (amf_size i = 0; i < m_Half; i++)
+    {
+        amf_uint32 reversed = 0;
+        for (amf_uint32 b = 0; b < bits; b++)
+        {
+            reversed |= (amf_uint32)((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_BitReverse[i] = reversed;
+    }
+
+    m_CosHalf.resize(m_Half / 2);
+    m_SinHalf.resize(m_Half / 2);
+    for (amf_size k = 0; k < m_Half / 2; k++)
+    {
+        m_CosHalf[k] = (float)cos(2.0 * CONVOLUTION_PI * (double)k / (double)m_Half);
+        m_SinHalf[k] = (float)sin(2.0 * CONVOLUTION_PI * (double)k / (double)m_Half);
+    }
+
+    m_Cos.resize(m_Half + 1);
+    m_Sin.resize(m_Half + 1);
+    for (amf_size k = 0; k <= m_Half; k++)
+    {
+        m_Cos[k] = (float)cos(2.0 * CONVOLUTION_PI * (double)k / (double)m_Length);
+        m_Sin[k] = (float)sin(2.0 * CONVOLUTION_PI * (double)k / (double)m_Length);
+    }
+
+    m_WorkRe.resize(m_Half);
+    m_WorkIm.resize(m_Half);
+    return true;
+}
+
+// in-place forward transform of m_Half points; the inverse is obtained by swapping re and im
+void realFFT::complexFFT(float *re, float *im)
+{
+    for (amf_size i = 0; i < m_Half; i++)
+    {
+        amf_size j = m_BitReverse[i];
+        if (j > i)
+        {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (amf_size len = 2; len <= m_Half; len <<= 1)
+    {
+        const amf_size half = len / 2;
+        const amf_size step = m_Half / len;
+        for (amf_size i = 0; i < m_Half; i += len)
+        {
+            for (amf_size j = 0; j < half; j++)
+            {
+                const float wr = m_CosHalf[j * step];
+                const float wi = -m_SinHalf[j * step];
+
+                float *aRe = re + i + j;
+                float *aIm = im + i + j;
+                float *bRe = aRe + half;
+                float *bIm = aIm + half;
+
+                const float tr = *bRe * wr - *bIm * wi;
+                const float ti = *bRe * wi + *bIm * wr;
+                *bRe = *aRe - tr;
+                *bIm = *aIm - ti;
+                *aRe += tr;
+                *aIm += ti;
+            }
+        }
+    }
+}
+
+void realFFT::forward(const float *in, float *re, float *im)
+{
+    float *zr = &m_WorkRe[0];
+    float *zi = &m_WorkIm[0];
+    for (amf_size n = 0; n < m_Half; n++)
+    {
+        zr[n] = in[2 * n];
+        zi[n] = in[2 * n + 1];
+    }
+    complexFFT(zr, zi);
+
+    // split the packed transform into the even / odd sample spectra and merge them
+    for (amf_size k = 0; k <= m_Half; k++)
+    {
+        const amf_size a = k == m_Half ? 0 : k;
+        const amf_size b = k == 0 ? 0 : m_Half - k;
+
+        const float evenRe = 0.5f * (zr[a] + zr[b]);
+        const float evenIm = 0.5f * (zi[a] - zi[b]);
+        const float oddRe  = 0.5f * (zi[a] + zi[b]);
+        const float oddIm  = -0.5f * (zr[a] - zr[b]);
+
+        re[k] = evenRe + oddRe * m_Cos[k] + oddIm * m_Sin[k];
+        im[k] = evenIm + oddIm * m_Cos[k] - oddRe * m_Sin[k];
+    }
+}
+
+void realFFT::inverse(const float *re, const float *im, float *out)
+{
+    float *zr = &m_WorkRe[0];
+    float *zi = &m_WorkIm[0];
+    for (amf_size k = 0; k < m_Half; k++)
+    {
+        const amf_size b = m_Half - k;
+
+        const float evenRe = 0.5f * (re[k] + re[b]);
+        const float evenIm = 0.5f * (im[k] - im[b]);
+        const float diffRe = 0.5f * (re[k] - re[b]);
+        const float diffIm = 0.5f * (im[k] + im[b]);
+
+        const float oddRe = diffRe * m_Cos[k] - diffIm * m_Sin[k];
+        const float oddIm = diffRe * m_Sin[k] + diffIm * m_Cos[k];
+
+        zr[k] = evenRe - oddIm;
+        zi[k] = evenIm + oddRe;
+    }
+    complexFFT(zi, zr);
+
+    const float scale = 1.0f / (float)m_Half;
+    for (amf_size n = 0; n < m_Half; n++)
+    {
+        out[2 * n]     = zr[n] * scale;
+        out[2 * n + 1] = zi[n] * scale;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// uniformly partitioned overlap-save convolution
+//-------------------------------------------------------------------------------------------------
+static void ComplexMultiplyAccumulate(const float *xRe, const float *xIm, const float *hRe, const float *hIm,
+                                      float *accRe, float *accIm, amf_size count)
+{
+    amf_size k = 0;
+#if defined(CONVOLUTION_SIMD_SSE)
+    for (; k + 4 <= count; k += 4)
+    {
+        const __m128 xr = _mm_loadu_ps(xRe + k);
+        const __m128 xi = _mm_loadu_ps(xIm + k);
+        const __m128 hr = _mm_loadu_ps(hRe + k);
+        const __m128 hi = _mm_loadu_ps(hIm + k);
+        const __m128 re = _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi));
+        const __m128 im = _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr));
+        _mm_storeu_ps(accRe + k, _mm_add_ps(_mm_loadu_ps(accRe + k), re));
+        _mm_storeu_ps(accIm + k, _mm_add_ps(_mm_loadu_ps(accIm + k), im));
+    }
+#elif defined(CONVOLUTION_SIMD_NEON)
+    for (; k + 4 <= count; k += 4)
+    {
+        const float32x4_t xr = vld1q_f32(xRe + k);
+        const float32x4_t xi = vld1q_f32(xIm + k);
+        const float32x4_t hr = vld1q_f32(hRe + k);
+        const float32x4_t hi = vld1q_f32(hIm + k);
+        float32x4_t re = vld1q_f32(accRe + k);
+        float32x4_t im = vld1q_f32(accIm + k);
+        re = vmlsq_f32(vmlaq_f32(re, xr, hr), xi, hi);
+        im = vmlaq_f32(vmlaq_f32(im, xr, hi), xi, hr);
+        vst1q_f32(accRe + k, re);
+        vst1q_f32(accIm + k, im);
+    }
+#endif
+    for (; k < count; k++)
+    {
+        accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+        accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+    }
+}
+
+bool convolution::initPartitioned(amf_size blockLength)
+{
+    if (blockLength < 2 || (blockLength & (blockLength - 1)) != 0)
+    {
+        return false;
+    }
+    if (!m_FFT.init(blockLength * 2))
+    {
+        return false;
+    }
+
+    m_BlockLength = blockLength;
+    m_Partitions = (m_ResponseLength + blockLength - 1) / blockLength;
+    m_BinStride = (blockLength + 1 + 3) & ~(amf_size)3;
+
+    const amf_size slotSize = m_BinStride * 2;
+    m_Channels.resize(m_nChannels);
+    for (int i = 0; i < m_nChannels; i++)
+    {
+        partitionedChannel &channel = m_Channels[i];
+        channel.input.assign(blockLength * 2, 0.0f);
+        channel.inputSpectra.assign(m_Partitions * slotSize, 0.0f);
+        channel.filterSpectra.assign(m_Partitions * slotSize, 0.0f);
+        channel.filterCache.assign(m_Partitions * blockLength, 0.0f);
+        channel.filterValid.assign(m_Partitions, false);
+        channel.fdlPos = 0;
+    }
+    m_Work.assign(blockLength * 2, 0.0f);
+    m_AccRe.assign(m_BinStride, 0.0f);
+    m_AccIm.assign(m_BinStride, 0.0f);
+    return true;
+}
+
+bool convolution::frequencyDomainCPU(
+    const float *resp,
+    amf_uint32 firstNonZero,
+    amf_uint32 lastNonZero,
+    const float *in,
+    float *out,
+    int chanIdx,
+    amf_size datalength,
+    amf_size convlength)
+{
+    if (m_BlockLength == 0 || datalength % m_BlockLength != 0 || convlength > (amf_size)m_ResponseLength ||
+        chanIdx < 0 || chanIdx >= m_nChannels)
+    {
+        return false;
+    }
+    for (amf_size i = 0; i < datalength; i += m_BlockLength)
+    {
+        processBlock(resp, firstNonZero, lastNonZero, in + i, out + i, chanIdx, convlength);
+    }
+    return true;
+}
+
+void convolution::processBlock(const float *resp, amf_uint32 firstNonZero, amf_uint32 lastNonZero, const float *in, float *out,
+                               int chanIdx, amf_size convlength)
+{
+    partitionedChannel &channel = m_Channels[chanIdx];
+    const amf_size B = m_BlockLength;
+    const amf_size slotSize = m_BinStride * 2;
+    const amf_size bins = B + 1;
+    const amf_size partitions = (convlength + B - 1) / B;
+
+    // slide the input window and push its spectrum into the delay line
+    memcpy(&channel.input[0], &channel.input[B], B * sizeof(float));
+    memcpy(&channel.input[B], in, B * sizeof(float));
+
+    float *inputSlot = &channel.inputSpectra[channel.fdlPos * slotSize];
+    m_FFT.forward(&channel.input[0], inputSlot, inputSlot + m_BinStride);
+
+    memset(&m_AccRe[0], 0, m_BinStride * sizeof(float));
+    memset(&m_AccIm[0], 0, m_BinStride * sizeof(float));
+
+    for (amf_size p = 0; p < partitions; p++)
+    {
+        const amf_size start = p * B;
+        const amf_size end = start + B < convlength ? start + B : convlength;
+        if (firstNonZero > lastNonZero || end <= firstNonZero || start > lastNonZero)
+        {
+            continue;   // partition is silent
+        }
+
+        // responses are re-evaluated per block while the head moves; only transform partitions that changed
+        float *cache = &channel.filterCache[start];
+        float *filterSlot = &channel.filterSpectra[p * slotSize];
+        const amf_size count = end - start;
+        if (!channel.filterValid[p] || memcmp(cache, resp + start, count * sizeof(float)) != 0)
+        {
+            memcpy(cache, resp + start, count * sizeof(float));
+            memset(cache + count, 0, (B - count) * sizeof(float));
+
+            memcpy(&m_Work[0], cache, B * sizeof(float));
+            memset(&m_Work[B], 0, B * sizeof(float));
+            m_FFT.forward(&m_Work[0], filterSlot, filterSlot + m_BinStride);
+            channel.filterValid[p] = true;
+        }
+
+        const amf_size slot = (channel.fdlPos + m_Partitions - p) % m_Partitions;
+        const float *x = &channel.inputSpectra[slot * slotSize];
+        ComplexMultiplyAccumulate(x, x + m_BinStride, filterSlot, filterSlot + m_BinStride, &m_AccRe[0], &m_AccIm[0], bins);
+    }
+
+    // the second half of the circular result is the valid linear convolution
+    m_FFT.inverse(&m_AccRe[0], &m_AccIm[0], &m_Work[0]);
+    memcpy(out, &m_Work[B], B * sizeof(float));
+
+    channel.fdlPos = (channel.fdlPos + 1) % m_Partitions;
+}
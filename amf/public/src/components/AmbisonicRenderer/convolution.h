@@ -22,6 +22,32 @@
 
 #pragma once 
 
+#include <vector>
+
+// radix-2 real FFT of length 2 * halfLength computed through a complex FFT of
+// halfLength points; spectra are stored split (re / im) with halfLength + 1 bins
+class realFFT
+{
+public:
+    realFFT();
+    bool init(amf_size length);
+
+    amf_size getLength() const { return m_Length; }
+
+    void forward(const float *in, float *re, float *im);
+    void inverse(const float *re, const float *im, float *out);     // scaled by 1 / length
+
+private:
+    void complexFFT(float *re, float *im);
+
+    amf_size m_Length;
+    amf_size m_Half;
+
+    std::vector<amf_uint32> m_BitReverse;
+    std::vector<float> m_CosHalf, m_SinHalf;    // twiddles of the halfLength complex FFT
+    std::vector<float> m_Cos, m_Sin;            // split / merge twiddles of the real FFT
+    std::vector<float> m_WorkRe, m_WorkIm;
+};
 
 class convolution
 {
@@ -30,15 +56,44 @@ public:
     ~convolution();
     bool init();
 
+    // uniformly partitioned overlap-save engine; blockLength must be a power of two
+    // and every frequencyDomainCPU call must pass a multiple of it
+    bool initPartitioned(amf_size blockLength);
+    bool isPartitioned() const { return m_BlockLength != 0; }
+
 void timeDomainCPU( float *resp, amf_uint32 firstNonZero, amf_uint32 lastNonZero, float *in, float *out, int chanIdx,
                       amf_size datalength, amf_size convlength);
 
+    bool frequencyDomainCPU(const float *resp, amf_uint32 firstNonZero, amf_uint32 lastNonZero, const float *in, float *out, int chanIdx,
+                      amf_size datalength, amf_size convlength);
+
 private:
+    void processBlock(const float *resp, amf_uint32 firstNonZero, amf_uint32 lastNonZero, const float *in, float *out, int chanIdx,
+                      amf_size convlength);
+
     int m_nChannels;
     int m_ResponseLength;
 
     int *m_sampHistPos;
     float **m_SampleHistory;
 
+    // partitioned engine state
+    struct partitionedChannel
+    {
+        std::vector<float> input;           // previous + current block
+        std::vector<float> inputSpectra;    // frequency-domain delay line, m_Partitions slots of re + im
+        std::vector<float> filterSpectra;   // one slot per filter partition
+        std::vector<float> filterCache;     // time-domain copy of the response the spectra were built from
+        std::vector<bool>  filterValid;
+        amf_size           fdlPos;
+    };
+
+    amf_size m_BlockLength;
+    amf_size m_Partitions;
+    amf_size m_BinStride;                   // blockLength + 1 bins rounded up to the SIMD width
 
+    realFFT m_FFT;
+    std::vector<partitionedChannel> m_Channels;
+    std::vector<float> m_Work;
+    std::vector<float> m_AccRe, m_AccIm;
 };
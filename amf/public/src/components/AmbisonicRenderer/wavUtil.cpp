@@ -87,7 +87,7 @@ bool ReadWaveFile(char *fileName, int *pSamplesPerSec, int *pBitsPerSample, int
 {
 	FILE *fpIn = NULL;
 	RiffWave fhd;
-	unsigned long length;
+	unsigned int length;
 
 	memset(&fhd, 0, sizeof(fhd));
 
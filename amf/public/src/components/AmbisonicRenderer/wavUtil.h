@@ -22,6 +22,8 @@
 
 #pragma pack(push,1)
 
+    /* header fields are 32 bits on disk: avoid long, it is 64 bits on LP64 platforms */
+
     /*\
     |*|----====< ".WAV" file definition >====----
     |*|
@@ -48,15 +50,15 @@
         typedef struct {
 	    short  formatTag;		/* format category		*/
 	    short  nChannels;		/* stereo/mono			*/
-	    long nSamplesPerSec;	/* sample rate			*/
-	    long nAvgBytesPerSec;	/* stereo * sample rate 	*/
+	    int  nSamplesPerSec;	/* sample rate			*/
+	    int  nAvgBytesPerSec;	/* stereo * sample rate 	*/
 	    short  nBlockAlign;		/* block alignment (1=byte)	*/
 	    short  nBitsPerSample;	/* # byte bits per sample	*/
 	} WaveInfo;
 
 	typedef struct {
 	    char name[4];
-	    long length;
+	    int  length;
 	    WaveInfo info;
 	} WaveFormat;
 
@@ -64,7 +66,7 @@
 
         typedef struct {
 	    char name[4];
-	    unsigned long length;
+	    unsigned int length;
 	} DataHeader;
 
     /* Total Wave Header data in a wave file				*/
@@ -79,7 +81,7 @@
 
 	typedef struct {
 	    char name[4];
-	    long length;
+	    int  length;
 	} RiffHeader;
 
     /* Riff wrapped WaveFormat Block					*/
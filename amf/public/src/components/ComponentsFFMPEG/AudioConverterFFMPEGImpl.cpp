@@ -37,6 +37,7 @@
 #include "public/include/core/Context.h"
 #include "public/include/core/Trace.h"
 #include "public/common/TraceAdapter.h"
+#include "public/common/AudioConvert.h"
 
 
 #define AMF_FACILITY L"AMFAudioConverterFFMPEGImpl"
@@ -76,6 +77,7 @@ const AMFEnumDescriptionEntry AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION[] =
 AMFAudioConverterFFMPEGImpl::AMFAudioConverterFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_pResampler(NULL),
+    m_bDirectConvert(false),
     m_pTempBuffer(NULL),
     m_uiTempBufferSize(0),
     m_inSampleFormat(AMFAF_UNKNOWN),
@@ -149,7 +151,14 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*
     av_channel_layout_from_mask(&m_outChannelLayout, channelLayout);
 
     // If there is a mismatch between input and output formats, sample rate and channels, a converter is required
-    if ((m_outSampleFormat != m_inSampleFormat) || (m_outSampleRate != m_inSampleRate) || (m_outChannels != m_inChannels))
+    // When only the sample format or the planar/packed layout differ, the shared conversion kernels
+    // handle it sample for sample and swresample with its buffering is not needed
+    if ((m_outSampleFormat != m_inSampleFormat) && (m_outSampleRate == m_inSampleRate) && (m_outChannels == m_inChannels) &&
+        AMFAudioConvertSupported(m_inSampleFormat, m_outSampleFormat))
+    {
+        m_bDirectConvert = true;
+    }
+    else if ((m_outSampleFormat != m_inSampleFormat) || (m_outSampleRate != m_inSampleRate) || (m_outChannels != m_inChannels))
     {
         m_pResampler = swr_alloc();
         AMF_RETURN_IF_FALSE(m_pResampler != NULL, AMF_FAIL, L"Init() - m_pResampler alloc failed")
@@ -182,6 +191,8 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::Terminate()
     m_pInputData = nullptr;
     AMFTraceInfo(AMF_FACILITY, L"Submitted %d, Queried %d", (int)m_audioFrameSubmitCount, (int)m_audioFrameQueryCount);
     
+    m_bDirectConvert = false;
+
     if (m_pResampler != NULL)
     {
         if (swr_is_initialized(m_pResampler))
@@ -310,6 +321,11 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
     *ppData = NULL;
 
 
+    if (m_bDirectConvert)
+    {
+        return QueryOutputDirect(ppData);
+    }
+
     //
     // If no conversion is required, just pass through
     if (m_pResampler == nullptr)
@@ -515,6 +531,39 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFAudioConverterFFMPEGImpl::QueryOutputDirect(AMFData** ppData)
+{
+    // samples map one to one, so nothing is buffered and every
+    // input buffer produces exactly one output buffer
+    if (m_pInputData == nullptr)
+    {
+        return m_bEof ? AMF_EOF : AMF_REPEAT;
+    }
+
+    const amf_int32  sampleCount = m_pInputData->GetSampleCount();
+
+    AMFAudioBufferPtr pOutputAudioBuffer;
+    AMF_RESULT  err = m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_outSampleFormat, sampleCount,
+                                                   (amf_int32) m_outSampleRate, (amf_int32) m_outChannels, &pOutputAudioBuffer);
+    AMF_RETURN_IF_FAILED(err, L"QueryOutputDirect() - AllocAudioBuffer failed");
+
+    err = AMFAudioConvertBuffer(m_inSampleFormat, m_pInputData->GetNative(), m_outSampleFormat, pOutputAudioBuffer->GetNative(),
+                                (amf_int32) m_inChannels, (amf_size) sampleCount);
+    AMF_RETURN_IF_FAILED(err, L"QueryOutputDirect() - AMFAudioConvertBuffer failed");
+
+    m_pInputData->CopyTo(pOutputAudioBuffer, false);
+    pOutputAudioBuffer->SetPts(m_pInputData->GetPts());
+    pOutputAudioBuffer->SetDuration(AMF_SECOND * sampleCount / m_outSampleRate);
+    m_ptsNext = pOutputAudioBuffer->GetPts() + pOutputAudioBuffer->GetDuration();
+    m_ptsPrevEnd = m_pInputData->GetPts() + m_pInputData->GetDuration();
+
+    m_pInputData = nullptr;
+    *ppData = pOutputAudioBuffer.Detach();
+    m_audioFrameQueryCount++;
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL AMFAudioConverterFFMPEGImpl::InitResampler()
 {
     AMF_RETURN_IF_INVALID_POINTER(m_pResampler, L"SetResamplerOptions() - m_pResampler == NULL");
@@ -99,6 +99,7 @@ namespace amf
         AMFContextPtr            m_pContext;
 
         SwrContext*              m_pResampler;
+        bool                     m_bDirectConvert;   // only format or layout differ - converted without swresample
 
         AMFAudioBufferPtr        m_pInputData;
 
@@ -128,6 +129,7 @@ namespace amf
 
         AMF_RESULT AMF_STD_CALL InitResampler();
         AMF_RESULT AMF_STD_CALL ReInitOnGap();
+        AMF_RESULT AMF_STD_CALL QueryOutputDirect(AMFData** ppData);
 
 
         AMFAudioConverterFFMPEGImpl(const AMFAudioConverterFFMPEGImpl&);
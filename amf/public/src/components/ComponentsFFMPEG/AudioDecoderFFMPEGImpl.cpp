@@ -39,6 +39,7 @@
 #include "public/include/core/Trace.h"
 #include "public/common/TraceAdapter.h"
 #include "public/common/PropertyStorageImpl.h"
+#include "public/common/AudioConvert.h"
 
 #define AMF_FACILITY L"AMFAudioDecoderFFMPEGImpl"
 
@@ -77,6 +78,7 @@ AMFAudioDecoderFFMPEGImpl::AMFAudioDecoderFFMPEGImpl(AMFContext* pContext)
     m_bDecodingEnabled(true),
     m_bEof(false),
     m_pCodecContext(nullptr),
+    m_outSampleFormat(AMFAF_UNKNOWN),
     m_SeekPts(0),
     m_dtsId(0),
     m_ptsLastDataOffset(0),
@@ -108,6 +110,7 @@ AMFAudioDecoderFFMPEGImpl::AMFAudioDecoderFFMPEGImpl(AMFContext* pContext)
         AMFPropertyInfoEnum(AUDIO_DECODER_OUT_AUDIO_SAMPLE_FORMAT, L"Sample Format Out", AMFAF_UNKNOWN, AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION, true),
         AMFPropertyInfoInt64(AUDIO_DECODER_OUT_AUDIO_CHANNEL_LAYOUT, L"Channel layout out (0 - default)", 0, 0, INT_MAX, true),
         AMFPropertyInfoInt64(AUDIO_DECODER_OUT_AUDIO_BLOCK_ALIGN, L"Block Align Out", 0, 0, INT_MAX, true),
+        AMFPropertyInfoEnum(AUDIO_DECODER_OUT_AUDIO_REQUESTED_FORMAT, L"Requested Sample Format Out", AMFAF_UNKNOWN, AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION, true),
     AMFPrimitivePropertyInfoMapEnd
 
     InitFFMPEG();
@@ -257,6 +260,23 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*fo
 		sampleFormat = AMFAF_UNKNOWN; break;
 	}
 
+    // decoded samples can be converted to the requested format on the
+    // copy into the output buffer, which saves a separate converter pass
+    amf_int64  requestedFormat = AMFAF_UNKNOWN;
+    GetProperty(AUDIO_DECODER_OUT_AUDIO_REQUESTED_FORMAT, &requestedFormat);
+    if (requestedFormat != AMFAF_UNKNOWN && requestedFormat != sampleFormat)
+    {
+        if (AMFAudioConvertSupported((AMF_AUDIO_FORMAT) sampleFormat, (AMF_AUDIO_FORMAT) requestedFormat))
+        {
+            sampleFormat = requestedFormat;
+        }
+        else
+        {
+            AMFTraceWarning(AMF_FACILITY, L"Init() - cannot convert decoded format %d to requested format %d, keeping decoded format", (int) sampleFormat, (int) requestedFormat);
+        }
+    }
+    m_outSampleFormat = (AMF_AUDIO_FORMAT) sampleFormat;
+
     // output properties
     AMF_RETURN_IF_FAILED(SetProperty(AUDIO_DECODER_OUT_AUDIO_SAMPLE_FORMAT, sampleFormat));
     AMF_RETURN_IF_FAILED(SetProperty(AUDIO_DECODER_OUT_AUDIO_SAMPLE_RATE, m_pCodecContext->sample_rate));
@@ -574,11 +594,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     // information and return the data
     if (decoded_frame.nb_samples > 0)
     {
-        // get the sample format of the input
-        amf_int64  sampleFormat = AMFAF_UNKNOWN;
-        GetProperty(AUDIO_DECODER_IN_AUDIO_SAMPLE_FORMAT, &sampleFormat);
-
-
         //
         // allocate a buffer large enough to contain the data we decoded
         // if the allocation fails, we have a bigger issue than trying to 
@@ -586,7 +601,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
         AMFAudioBufferPtr  pOutputAudioBuffer;
         AMF_RESULT err = m_pContext->AllocAudioBuffer(
             AMF_MEMORY_HOST,
-            (AMF_AUDIO_FORMAT) sampleFormat,
+            m_outSampleFormat,
             decoded_frame.nb_samples,
             m_pCodecContext->sample_rate,
             m_pCodecContext->ch_layout.nb_channels,
@@ -598,17 +613,37 @@ AMF_RESULT AMF_STD_CALL  AMFAudioDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
 
 
         //
-        // copy data to output buffer
-        const amf_bool   isPlanar        = IsAudioPlanar((AMF_AUDIO_FORMAT) sampleFormat);
-        const amf_int32  audioSampleSize = GetAudioSampleSize((AMF_AUDIO_FORMAT) sampleFormat) * (isPlanar ? 1 : m_pCodecContext->ch_layout.nb_channels);
-        const amf_int32  outputChannels  = isPlanar ? m_pCodecContext->ch_layout.nb_channels : 1;
-        for (amf_int32 ch = 0; ch < outputChannels; ch++)
+        // copy data to output buffer, converting it if a different format was requested
+        const AMF_AUDIO_FORMAT  decodedFormat = GetAMFAudioFormat((AVSampleFormat) decoded_frame.format);
+        const amf_int32         channels      = m_pCodecContext->ch_layout.nb_channels;
+        if (decodedFormat == m_outSampleFormat)
         {
-            AMF_RETURN_IF_INVALID_POINTER(decoded_frame.data[ch], L"QueryOutput() - decoded_frame.data[%d] is NULL", ch);
-
-            const int  iDataSize = audioSampleSize * decoded_frame.nb_samples;
-            memcpy(pMemOut, decoded_frame.data[ch], iDataSize);
-            pMemOut += iDataSize;
+            const amf_bool   isPlanar        = IsAudioPlanar(m_outSampleFormat);
+            const amf_int32  audioSampleSize = GetAudioSampleSize(m_outSampleFormat) * (isPlanar ? 1 : channels);
+            const amf_int32  outputChannels  = isPlanar ? channels : 1;
+            for (amf_int32 ch = 0; ch < outputChannels; ch++)
+            {
+                AMF_RETURN_IF_INVALID_POINTER(decoded_frame.extended_data[ch], L"QueryOutput() - decoded_frame.extended_data[%d] is NULL", ch);
+
+                const int  iDataSize = audioSampleSize * decoded_frame.nb_samples;
+                memcpy(pMemOut, decoded_frame.extended_data[ch], iDataSize);
+                pMemOut += iDataSize;
+            }
+        }
+        else
+        {
+            AMF_RETURN_IF_FALSE(channels <= AMF_AUDIO_CONVERT_MAX_CHANNELS, AMF_NOT_SUPPORTED, L"QueryOutput() - cannot convert %d channels", channels);
+
+            const amf_size  planeSize = (amf_size) GetAudioSampleSize(m_outSampleFormat) * decoded_frame.nb_samples;
+            const void*     ppIn[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+            void*           ppOut[AMF_AUDIO_CONVERT_MAX_CHANNELS];
+            for (amf_int32 ch = 0; ch < channels; ch++)
+            {
+                ppIn[ch] = IsAudioPlanar(decodedFormat) ? decoded_frame.extended_data[ch] : decoded_frame.extended_data[0];
+                ppOut[ch] = pMemOut + (IsAudioPlanar(m_outSampleFormat) ? ch * planeSize : 0);
+            }
+            err = AMFAudioConvert(decodedFormat, ppIn, m_outSampleFormat, ppOut, channels, (amf_size) decoded_frame.nb_samples);
+            AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AMFAudioConvert failed");
         }
 
 
@@ -120,6 +120,7 @@ namespace amf
         amf_bool                    m_bEof;
 
         AVCodecContext*             m_pCodecContext;
+        AMF_AUDIO_FORMAT            m_outSampleFormat;
         amf_pts                     m_SeekPts;
 
         AMFBufferPtr                m_pExtraData;
@@ -72,6 +72,7 @@ const AMFEnumDescriptionEntry AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION[] =
 //-------------------------------------------------------------------------------------------------
 AMFAudioEncoderFFMPEGImpl::AMFAudioEncoderFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
+    m_pPacketPool(new AMFPacketBufferPoolFFMPEG()),
     m_bEncodingEnabled(true),
     m_bEof(false),
     m_isEncDrained(false),
@@ -852,20 +853,10 @@ AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::InitializeFrame(AMFAudioBuf
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::PacketToBuffer(const AVPacket& avPacket, AMFBuffer** ppOutBuffer)
+AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::PacketToBuffer(AVPacket& avPacket, AMFBuffer** ppOutBuffer)
 {
     AMF_RETURN_IF_FALSE(avPacket.size > 0, AMF_INVALID_ARG, L"PacketToBuffer() - packet size should be greater than 0");
 
-
-    // allocate and fill output buffer - if we fail the memory
-    // allocation, we probably have more problems than worrying
-    // about recovery at this point, but still try
-    AMF_RESULT err = m_pContext->AllocBuffer(AMF_MEMORY_HOST, avPacket.size, ppOutBuffer);
-    AMF_RETURN_IF_FAILED(err, L"PacketToBuffer() - AllocBuffer failed");
-
-    amf_uint8 *pMemOut = static_cast<uint8_t*>((*ppOutBuffer)->GetNative());
-    memcpy(pMemOut, avPacket.data, avPacket.size);
-
     // get the pts fo the ffmpeg frame returned - we will
     // calculate our pts relative to what ffmpeg gives us
     if (m_firstFFMPEGPts == LLONG_MIN)
@@ -879,6 +870,11 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::PacketToBuffer(const AVPacke
     const amf_pts duration = av_rescale_q(avPacket.duration, m_pCodecContext->time_base, AMF_TIME_BASE_Q);
     const amf_pts pts      = m_firstFramePts + av_rescale_q(avPacket.pts - m_firstFFMPEGPts, m_pCodecContext->time_base, AMF_TIME_BASE_Q);
 
+    // the output buffer references the packet payload instead of
+    // copying it - the packet is left blank after this call
+    AMF_RESULT err = m_pPacketPool->WrapPacket(m_pContext, &avPacket, ppOutBuffer);
+    AMF_RETURN_IF_FAILED(err, L"PacketToBuffer() - WrapPacket failed");
+
     (*ppOutBuffer)->SetDuration(duration);
     (*ppOutBuffer)->SetPts(pts);
 
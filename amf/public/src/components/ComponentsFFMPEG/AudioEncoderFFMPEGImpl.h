@@ -36,6 +36,7 @@
 #include "public/include/components/FFMPEGAudioEncoder.h"
 #include "public/common/PropertyStorageExImpl.h"
 #include "public/include/core/Context.h"
+#include "PacketBufferFFMPEG.h"
 
 extern "C"
 {
@@ -100,7 +101,7 @@ namespace amf
         AMF_RESULT  AMF_STD_CALL  GetNewFrame(AMFAudioBuffer** pNewBuffer, amf_int32 requiredSize);
         AMF_RESULT  AMF_STD_CALL  SplitOrCombineFrames(AMFAudioBuffer* pInBuffer, amf_int32 requiredSize);
         AMF_RESULT  AMF_STD_CALL  InitializeFrame(AMFAudioBuffer* pInBuffer, AVFrame& avFrame);
-        AMF_RESULT  AMF_STD_CALL  PacketToBuffer(const AVPacket& avPacket, AMFBuffer** ppOutBuffer);
+        AMF_RESULT  AMF_STD_CALL  PacketToBuffer(AVPacket& avPacket, AMFBuffer** ppOutBuffer);
         AMF_RESULT  AMF_STD_CALL  UpdatePacketProperties(AMFBuffer* pOutBuffer);
 
         AMF_RESULT  AMF_STD_CALL  SubmitFrame(AMFAudioBuffer* pInBuffer);
@@ -111,6 +112,7 @@ namespace amf
       mutable AMFCriticalSection  m_sync;
 
         AMFContextPtr                 m_pContext;
+        AMFPacketBufferPoolFFMPEGPtr  m_pPacketPool;
         amf_bool                      m_bEncodingEnabled;
 
         AVCodecContext*               m_pCodecContext;
@@ -107,6 +107,7 @@ bool BaseEncoderFFMPEGImpl::SendThread::Process(amf_ulong& /*ulID*/, amf::AMFSur
 // like the enumeration so leave the mode parameter as int
 BaseEncoderFFMPEGImpl::BaseEncoderFFMPEGImpl(AMFContext* pContext)
   : m_spContext(pContext),
+    m_pPacketPool(new AMFPacketBufferPoolFFMPEG()),
     m_bEncodingEnabled(true),
     m_isEOF(false),
     m_videoFrameSubmitCount(0), m_videoFrameQueryCount(0),
@@ -432,19 +433,16 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::QueryOutput(AMFData** ppData)
         //       some stream parameters at the end of encoding)."
         if (ret >= 0 && avPacket.size > 0)
         {
-            // allocate and fill output buffer - if we fail the memory
-            // allocation, we probably have more problems than worrying
-            // about recovery at this point, but still try
-            AMFBufferPtr pBufferOut;
-            AMF_RESULT err = m_spContext->AllocBuffer(AMF_MEMORY_HOST, avPacket.size, &pBufferOut);
-            AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocBuffer failed");
-
-            amf_uint8* pMemOut = static_cast<amf_uint8*>(pBufferOut->GetNative());
-            memcpy(pMemOut, avPacket.data, avPacket.size);
-
             // for PTS -always 100 nanos
             amf_pts duration = av_rescale_q(avPacket.duration, m_pCodecContext->time_base, AMF_TIME_BASE_Q);
             amf_pts pts = av_rescale_q(avPacket.pts, m_pCodecContext->time_base, AMF_TIME_BASE_Q);
+            const bool keyFrame = (avPacket.flags & AV_PKT_FLAG_KEY) != 0;
+
+            // the output buffer references the packet payload instead of
+            // copying it - the packet is left blank after this call
+            AMFBufferPtr pBufferOut;
+            AMF_RESULT err = m_pPacketPool->WrapPacket(m_spContext, &avPacket, &pBufferOut);
+            AMF_RETURN_IF_FAILED(err, L"QueryOutput() - WrapPacket failed");
             pBufferOut->SetProperty(AMF_VIDEO_ENCODER_PRESENTATION_TIME_STAMP, pts);
 
             // copy input data properties to the encoded packet
@@ -492,7 +490,7 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::QueryOutput(AMFData** ppData)
                     }
 
                     // check key frame
-                    if (avPacket.flags & AV_PKT_FLAG_KEY)
+                    if (keyFrame)
                     {
                         // Set output video frame type for muxer
                         switch (m_pCodecContext->codec_id)
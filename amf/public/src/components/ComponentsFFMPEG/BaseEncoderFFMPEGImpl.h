@@ -17,6 +17,7 @@
 #include "public/common/Thread.h"
 #include "public/include/core/Context.h"
 #include "public/include/core/Compute.h"
+#include "PacketBufferFFMPEG.h"
 #include <memory>
 #include <deque>
 #include <set>
@@ -124,6 +125,7 @@ namespace amf
       };
 
         AMFContextPtr                   m_spContext;
+        AMFPacketBufferPoolFFMPEGPtr    m_pPacketPool;
         amf_bool                        m_bEncodingEnabled;
 
         AVCodecContext*                 m_pCodecContext;
@@ -62,6 +62,12 @@ extern "C"
 
 using namespace amf;
 
+static const amf_size   PACKET_RING_CAPACITY          = 256;
+static const amf_int64  READ_AHEAD_BYTES_DEFAULT      = 8 * 1024 * 1024;
+static const amf_pts    READ_AHEAD_DURATION_DEFAULT   = 2 * AMF_SECOND;
+static const amf_ulong  READ_AHEAD_IDLE_TIMEOUT       = 50; // ms - reader sleep when caches are full or at EOF
+static const amf_ulong  READ_AHEAD_LOCK_TIMEOUT       = 10; // ms - reader re-checks the stop request in between
+
 
 
 static const AMFEnumDescriptionEntry VIDEO_CODEC_IDS_ENUM[] =
@@ -137,6 +143,82 @@ void  ClearPacket(AVPacket* pPacket)
 
 
 
+//
+//
+// AMFPacketRingFFMPEG
+//
+//
+
+//-------------------------------------------------------------------------------------------------
+AMFPacketRingFFMPEG::AMFPacketRingFFMPEG(amf_size capacity)
+    : m_Packets(capacity, nullptr),
+      m_iHead(0),
+      m_iCount(0),
+      m_iBytes(0),
+      m_iDuration(0)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMFPacketRingFFMPEG::~AMFPacketRingFFMPEG()
+{
+    Clear();
+}
+//-------------------------------------------------------------------------------------------------
+void AMFPacketRingFFMPEG::Push(AVPacket* pPacket)
+{
+    if (m_iCount == m_Packets.size())
+    {
+        // unroll into a twice larger ring so the oldest packet lands at index 0
+        amf_vector<AVPacket*> packets(AMF_MAX(m_Packets.size() * 2, (amf_size)16), nullptr);
+        for (amf_size i = 0; i < m_iCount; i++)
+        {
+            packets[i] = m_Packets[(m_iHead + i) % m_Packets.size()];
+        }
+        m_Packets.swap(packets);
+        m_iHead = 0;
+    }
+    m_Packets[(m_iHead + m_iCount) % m_Packets.size()] = pPacket;
+    m_iCount++;
+
+    m_iBytes += pPacket->size;
+    if (pPacket->duration > 0)
+    {
+        m_iDuration += pPacket->duration;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AVPacket* AMFPacketRingFFMPEG::Pop()
+{
+    if (m_iCount == 0)
+    {
+        return nullptr;
+    }
+    AVPacket* pPacket = m_Packets[m_iHead];
+    m_Packets[m_iHead] = nullptr;
+    m_iHead = (m_iHead + 1) % m_Packets.size();
+    m_iCount--;
+
+    m_iBytes -= pPacket->size;
+    if (pPacket->duration > 0)
+    {
+        m_iDuration -= pPacket->duration;
+    }
+    return pPacket;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFPacketRingFFMPEG::Clear()
+{
+    while (m_iCount != 0)
+    {
+        ClearPacket(Pop());
+    }
+    m_iHead = 0;
+    m_iBytes = 0;
+    m_iDuration = 0;
+}
+
+
+
 //
 //
 // AMFOutputDemuxerImpl
@@ -148,7 +230,9 @@ AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::AMFOutputDemuxerImpl(AMFFileDemu
     : m_pHost(pHost),
       m_iIndexFFmpeg(index),
       m_bEnabled(false),
-      m_iPacketCount(0)
+      m_packetsCache(PACKET_RING_CAPACITY),
+      m_iPacketCount(0),
+      m_bStarved(false)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -173,16 +257,37 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::QueryOu
     // if we do, return the first packet from the list...
     AMF_RESULT  err    = AMF_OK;
     AVPacket*   packet = nullptr;
-    if (!m_packetsCache.empty())
+    const bool  bReadAhead = m_pHost->m_ReadAheadThread.IsRunning();
+    if (!m_packetsCache.IsEmpty())
     {
         // don't forget to remove the packet from the list now that we "read" it
-        packet = m_packetsCache.front();
-        m_packetsCache.pop_front();
+        packet = m_packetsCache.Pop();
+        m_bStarved = false;
+        if (bReadAhead)
+        {
+            m_pHost->m_ReadAheadWake.SetEvent();
+        }
     }
     else
     {
-        // if we don't have any packets cached, look to find the next one
-        err = m_pHost->FindNextPacket(m_iIndexFFmpeg, &packet, true);
+        // if we don't have any packets cached, look to find the next one;
+        // with read-ahead running only the reader thread may touch the file,
+        // reading here would reorder packets against what it already queued
+        if (bReadAhead)
+        {
+            if (!m_pHost->m_bReadAheadEof && !m_pHost->m_bForceEof)
+            {
+                // lifts the read-ahead caps until this stream gets a packet
+                m_bStarved = true;
+                m_pHost->m_ReadAheadWake.SetEvent();
+                return AMF_REPEAT;
+            }
+            err = m_pHost->m_bForceEof ? AMF_EOF : m_pHost->m_eReadAheadError;
+        }
+        else
+        {
+            err = m_pHost->FindNextPacket(m_iIndexFFmpeg, &packet, true);
+        }
         if (err != AMF_OK)
         {
             if(err == AMF_EOF)
@@ -230,21 +335,29 @@ AMF_RESULT  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::CachePacket(AVPacket
         return AMF_FAIL;
     }
        // add the packet to the cache...
-    m_packetsCache.push_back(pPacket);
+    m_packetsCache.Push(pPacket);
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
 void  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::ClearPacketCache()
 {
-    for (amf_list<AVPacket*>::iterator it = m_packetsCache.begin(); it != m_packetsCache.end(); ++it)
-    {
-        ClearPacket(*it);
-    }
-    m_packetsCache.clear();
+    m_packetsCache.Clear();
+    m_bStarved = false;
 }
 bool        AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::IsCached()
 {
-    return m_packetsCache.size() != 0;
+    return !m_packetsCache.IsEmpty();
+}
+//-------------------------------------------------------------------------------------------------
+bool        AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::IsCacheFull()
+{
+    return m_packetsCache.GetBytes() >= m_pHost->m_iReadAheadBytes;
+}
+//-------------------------------------------------------------------------------------------------
+bool        AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::HasEnoughCached()
+{
+    const AVStream* ist = m_pHost->m_pInputContext->streams[m_iIndexFFmpeg];
+    return av_rescale_q(m_packetsCache.GetDuration(), ist->time_base, AMF_TIME_BASE_Q) >= m_pHost->m_ptsReadAheadDuration;
 }
 //-------------------------------------------------------------------------------------------------
 void        AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::OnPropertyChanged(const wchar_t* pName)
@@ -305,13 +418,23 @@ AMFFileDemuxerFFMPEGImpl::AMFVideoOutputDemuxerImpl::AMFVideoOutputDemuxerImpl(A
     }
 
     // allocate a buffer to store the extra data
+    const amf_uint8* pExtraData = ist->codecpar->extradata;
+    amf_size extraDataSize = ist->codecpar->extradata_size;
+#ifdef __USE_H264Mp4ToAnnexB
+    if (pHost->m_bVideoAnnexB && pHost->m_VideoAnnexB.IsActive())
+    {
+        // packets go out with start codes, the parameter sets have to match
+        pExtraData = pHost->m_VideoAnnexB.GetHeaders();
+        extraDataSize = pHost->m_VideoAnnexB.GetHeadersSize();
+    }
+#endif
     AMFBufferPtr spBuffer;
-    if(ist->codecpar->extradata_size > 0)
+    if(extraDataSize > 0)
     {
-        AMF_RESULT err = m_pHost->m_pContext->AllocBuffer(AMF_MEMORY_HOST, ist->codecpar->extradata_size, &spBuffer);
+        AMF_RESULT err = m_pHost->m_pContext->AllocBuffer(AMF_MEMORY_HOST, extraDataSize, &spBuffer);
         if ((err == AMF_OK) && spBuffer->GetNative())
         {
-            memcpy(spBuffer->GetNative(), ist->codecpar->extradata, ist->codecpar->extradata_size);
+            memcpy(spBuffer->GetNative(), pExtraData, extraDataSize);
         }
     }
 
@@ -432,6 +555,7 @@ AMFFileDemuxerFFMPEGImpl::AMFAudioOutputDemuxerImpl::AMFAudioOutputDemuxerImpl(A
 //-------------------------------------------------------------------------------------------------
 AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
+    m_pPacketPool(new AMFPacketBufferPoolFFMPEG()),
     m_pInputContext(NULL),
     m_ptsDuration(0),
     m_ptsPosition(0),
@@ -442,8 +566,16 @@ AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
     m_bStreamingMode(true),
     m_iVideoStreamIndexFFmpeg(-1),
     m_iAudioStreamIndexFFmpeg(-1),
+    m_iDefaultStreamIndex(-1),
     m_bTerminated(true),
-    m_bStreaming(false)
+    m_bStreaming(false),
+    m_bReadAhead(false),
+    m_iReadAheadBytes(READ_AHEAD_BYTES_DEFAULT),
+    m_ptsReadAheadDuration(READ_AHEAD_DURATION_DEFAULT),
+    m_bReadAheadEof(false),
+    m_eReadAheadError(AMF_EOF),
+    m_ReadAheadThread(this),
+    m_bVideoAnnexB(false)
 //    m_bSyncAV(false)
 {
     g_AMFFactory.Init();
@@ -458,7 +590,12 @@ AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
 //        AMFPropertyInfoBool(FFMPEG_DEMUXER_SYNC_AV, L"Sync Audio and Video by PTS", false, false),
         AMFPropertyInfoBool(FFMPEG_DEMUXER_CHECK_MVC, L"Check MVC", true, false),
         AMFPropertyInfoBool(FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE, L"Stream mode", true, false),
-        AMFPropertyInfoBool(FFMPEG_DEMUXER_LISTEN, L"Listen", false, false)
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_LISTEN, L"Listen", false, false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_READ_AHEAD, L"Read ahead on a background thread", false, false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_READ_AHEAD_BYTES, L"Read ahead cache bytes per stream", READ_AHEAD_BYTES_DEFAULT, 64 * 1024, LLONG_MAX, false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_READ_AHEAD_DURATION, L"Read ahead cache duration per stream", READ_AHEAD_DURATION_DEFAULT, 0, LLONG_MAX, false),
+        AMFPropertyInfoPath(FFMPEG_DEMUXER_INDEX_PATH, L"Keyframe index file", L"", false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_VIDEO_ANNEXB, L"Video as Annex B", false, false)
 
     AMFPrimitivePropertyInfoMapEnd
 
@@ -481,6 +618,11 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*for
         Close();
     }
 
+    GetProperty(FFMPEG_DEMUXER_READ_AHEAD, &m_bReadAhead);
+    GetProperty(FFMPEG_DEMUXER_READ_AHEAD_BYTES, &m_iReadAheadBytes);
+    GetProperty(FFMPEG_DEMUXER_READ_AHEAD_DURATION, &m_ptsReadAheadDuration);
+    GetProperty(FFMPEG_DEMUXER_VIDEO_ANNEXB, &m_bVideoAnnexB);
+
     AMF_RESULT res = Open();
     if (res == AMF_OK)
     {
@@ -488,6 +630,8 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*for
         Seek(pos, AMF_SEEK_PREV, -1);
 
         ReadRangeSettings();
+
+        StartReadAhead();
     }
 
     return res;
@@ -503,6 +647,8 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Terminate()
 {
     AMFLock lock(&m_sync);
 
+    StopReadAhead();
+
     m_ptsPosition = GetMinPosition();
     m_ptsSeekPos = -1;
     m_bTerminated = true;
@@ -544,17 +690,28 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::QueryOutput(AMFData** ppData)
     AVPacket* pPacket = nullptr;
     for (size_t idx = 0; idx < m_OutputStreams.size(); idx++)
     {
-        if (!m_OutputStreams[idx]->m_packetsCache.empty())
+        if (!m_OutputStreams[idx]->m_packetsCache.IsEmpty())
         {
             // get the packet
-            pPacket = m_OutputStreams[idx]->m_packetsCache.front();
-            m_OutputStreams[idx]->m_packetsCache.pop_front();
+            pPacket = m_OutputStreams[idx]->m_packetsCache.Pop();
             break;
         }
     }
 
     // if we haven't found a cached packet, read another one
-    if (!pPacket)
+    if (m_ReadAheadThread.IsRunning())
+    {
+        m_ReadAheadWake.SetEvent();
+        if (!pPacket)
+        {
+            if (m_bForceEof)
+            {
+                return AMF_EOF;
+            }
+            return m_bReadAheadEof ? m_eReadAheadError : AMF_REPEAT;
+        }
+    }
+    else if (!pPacket)
     {
         AMF_RESULT err = FindNextPacket(-1, &pPacket, false);
         if (err != AMF_OK)
@@ -606,6 +763,9 @@ AMF_RESULT AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::Seek(amf_pts ptsPos, AMF_SEEK_
         return AMF_OK;
     }
 
+    // the reader thread must not touch the input context while we reposition it
+    StopReadAhead();
+
     int flags = 0;
     switch (eType)
     {
@@ -641,7 +801,14 @@ AMF_RESULT AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::Seek(amf_pts ptsPos, AMF_SEEK_
         int64_t    offset = av_rescale_q(ptsPos, AMF_TIME_BASE_Q, ist->time_base);
 
         // AVSEEK_FLAG_BACKWARD means that we need packet before ptsPos
-        int ret = av_seek_frame(m_pInputContext, stream_index, offset, flags);
+        const amf_int64 bytesRead = m_pInputContext->pb != NULL ? m_pInputContext->pb->bytes_read : 0;
+        int ret = SeekFrame(stream_index, offset, eType, flags);
+        if (m_pInputContext->pb != NULL)
+        {
+            // what the seek itself read from the file - bisecting and probing shows up here
+            AMFTraceDebug(AMF_FACILITY, L"Seek() - read %" LPRId64 L" bytes while seeking", m_pInputContext->pb->bytes_read - bytesRead);
+        }
+        m_KeyframeIndex.BreakRun();
         if (ret<0)
         {
             // sometimes failed av_seek_frame cause further av_read functions return errors too.
@@ -660,6 +827,8 @@ AMF_RESULT AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::Seek(amf_pts ptsPos, AMF_SEEK_
     ReadRangeSettings();
 
     m_ptsSeekPos = ptsPos;
+
+    StartReadAhead();
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -888,6 +1057,25 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
         res = OpenAsImageSequence(convertedfilename, fmt, options);
     }
 
+#ifdef __USE_H264Mp4ToAnnexB
+    // stays inactive for streams that already carry start codes
+    m_VideoAnnexB.Terminate();
+    if (m_iVideoStreamIndexFFmpeg >= 0)
+    {
+        const AVCodecParameters* par = m_pInputContext->streams[m_iVideoStreamIndexFFmpeg]->codecpar;
+        Mp4ToAnnexB::Codec codec = Mp4ToAnnexB::CODEC_UNKNOWN;
+        switch (par->codec_id)
+        {
+        case AV_CODEC_ID_H264:  codec = Mp4ToAnnexB::CODEC_H264; break;
+        case AV_CODEC_ID_HEVC:  codec = Mp4ToAnnexB::CODEC_HEVC; break;
+        }
+        if (m_VideoAnnexB.Init(codec, par->extradata, par->extradata_size) != AMF_OK)
+        {
+            AMFTraceWarning(AMF_FACILITY, L"Open() - unsupported video extradata, packets are passed unchanged");
+        }
+    }
+#endif
+
     int videoIndex = -1;
     amf_vector<AMFOutputDemuxerImplPtr>  outputStreams;
     for (amf_int32 i = 0; i < static_cast<amf_int32>(m_pInputContext->nb_streams); i++)
@@ -922,6 +1110,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
     }
     m_OutputStreams = outputStreams;
 
+    LoadKeyframeIndex();
 
 
     if (m_iVideoStreamIndexFFmpeg >= 0 && m_pInputContext->streams[m_iVideoStreamIndexFFmpeg]->codecpar->codec_id == AV_CODEC_ID_H264)
@@ -971,16 +1160,22 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Close()
 {
     AMFLock lock(&m_sync);
 
+    StopReadAhead();
+
     if (m_pInputContext != NULL)
     {
+        SaveKeyframeIndex();
         avformat_close_input(&m_pInputContext);
         m_pInputContext = NULL;
     }
+    m_KeyframeIndex.Reset(0);
 
     ClearCachedPackets();
 
     m_iVideoStreamIndexFFmpeg = -1;
     m_iAudioStreamIndexFFmpeg = -1;
+    m_StreamTiming.clear();
+    m_iDefaultStreamIndex = -1;
     m_bForceEof = false;
     m_iPacketCount = 0;
     m_ptsPosition = GetMinPosition();
@@ -1000,14 +1195,40 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
     pkt.dts = AV_NOPTS_VALUE;
     pkt.pts = AV_NOPTS_VALUE;
 //    amf_pts currTime = amf_high_precision_clock();
-    if (m_bForceEof || av_read_frame(m_pInputContext, &pkt) < 0)
+    if (m_bForceEof)
+    {
+        return AMF_EOF;
+    }
+    const int ret = av_read_frame(m_pInputContext, &pkt);
+    if (ret < 0)
     {
 //        AMFTraceInfo(AMF_FACILITY, L"ReadPacket() - EOF, END");
+        if (ret == AVERROR_EOF)
+        {
+            m_KeyframeIndex.MarkEof();
+        }
         return AMF_EOF;
     }
 //    amf_pts readDuration = amf_high_precision_clock() - currTime;
 
+    return ProcessPacket(&pkt, packet);
+}
+//-------------------------------------------------------------------------------------------------
+// fixes up timestamps of a freshly read packet and updates the read position;
+// on success the payload reference moves into a new heap packet
+AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ProcessPacket(AVPacket* pPkt, AVPacket **packet)
+{
+    *packet = NULL;
+
+    AVPacket& pkt = *pPkt;
     AVStream *ist = m_pInputContext->streams[pkt.stream_index];
+    UpdateStreamTiming(pkt.stream_index);
+
+    // index video keyframes with the raw timestamps av_seek_frame() works with
+    if ((pkt.flags & AV_PKT_FLAG_KEY) && pkt.pos >= 0 && pkt.dts != AV_NOPTS_VALUE && ist->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+    {
+        m_KeyframeIndex.Add(pkt.stream_index, pkt.dts, pkt.pos);
+    }
     FFStream* fst = ffstream(ist);
     int64_t wrap = 1LL << ist->pts_wrap_bits;
 
@@ -1060,6 +1281,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
     }
     if (OutOfRange())
     {
+        av_packet_unref(&pkt);
         return AMF_EOF;
     }
 
@@ -1160,6 +1382,68 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 stre
     return err;
 }
 //-------------------------------------------------------------------------------------------------
+// seeks onto the keyframe the index knows precedes (or follows) offset, falls back to a plain
+// av_seek_frame() which may have to probe the file when libavformat has no index of its own
+int AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::SeekFrame(amf_int32 streamIndex, amf_int64 offset, AMF_SEEK_TYPE eType, int flags)
+{
+    AMFKeyframeIndexFFMPEG::Entry entry = {};
+    if (m_KeyframeIndex.Find(streamIndex, offset, eType != AMF_SEEK_NEXT_KEYFRAME, entry))
+    {
+        // a byte seek lands on the keyframe without the bisection libavformat does through
+        // read_timestamp(), but timestamp generation restarts at the new position: only formats
+        // whose packets carry their own timestamps (TS, PS) go there directly, elementary streams
+        // (NOTIMESTAMPS, GENERIC_INDEX) seek to the keyframe timestamp
+        const int formatFlags = m_pInputContext->iformat->flags;
+        const bool bOwnTimestamps = (formatFlags & AVFMT_TS_DISCONT) != 0 &&
+                                    (formatFlags & (AVFMT_NOTIMESTAMPS | AVFMT_GENERIC_INDEX)) == 0;
+        if (bOwnTimestamps && (formatFlags & AVFMT_NO_BYTE_SEEK) == 0 &&
+            av_seek_frame(m_pInputContext, streamIndex, entry.pos, AVSEEK_FLAG_BYTE) >= 0)
+        {
+            return 0;
+        }
+        if (av_seek_frame(m_pInputContext, streamIndex, entry.dts, AVSEEK_FLAG_BACKWARD) >= 0)
+        {
+            return 0;
+        }
+        AMFTraceWarning(AMF_FACILITY, L"SeekFrame() - seek to indexed keyframe dts=%" LPRId64 L" failed", entry.dts);
+    }
+    return av_seek_frame(m_pInputContext, streamIndex, offset, flags);
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::LoadKeyframeIndex()
+{
+    m_KeyframeIndex.Reset(m_pInputContext != NULL ? (amf_int32)m_pInputContext->nb_streams : 0);
+
+    m_IndexPath.clear();
+    GetPropertyWString(FFMPEG_DEMUXER_INDEX_PATH, &m_IndexPath);
+    if (m_IndexPath.empty() || m_bStreaming || m_pInputContext == NULL || m_pInputContext->pb == NULL)
+    {
+        return;
+    }
+    AMF_RESULT res = m_KeyframeIndex.Load(m_IndexPath.c_str(), avio_size(m_pInputContext->pb), m_pInputContext->duration);
+    if (res == AMF_OK)
+    {
+        AMFTraceInfo(AMF_FACILITY, L"LoadKeyframeIndex() - loaded %s", m_IndexPath.c_str());
+    }
+    else if (res != AMF_NOT_FOUND)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"LoadKeyframeIndex() - ignoring %s", m_IndexPath.c_str());
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::SaveKeyframeIndex()
+{
+    if (m_IndexPath.empty() || m_bStreaming || m_pInputContext == NULL || m_pInputContext->pb == NULL || !m_KeyframeIndex.IsModified())
+    {
+        return;
+    }
+    AMF_RESULT res = m_KeyframeIndex.Save(m_IndexPath.c_str(), avio_size(m_pInputContext->pb), m_pInputContext->duration);
+    if (res != AMF_OK)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"SaveKeyframeIndex() - failed to write %s", m_IndexPath.c_str());
+    }
+}
+//-------------------------------------------------------------------------------------------------
 bool AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::OutOfRange()
 {
     amf_uint64 val = 0;
@@ -1183,36 +1467,60 @@ void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ClearCachedPackets()
     }
 }
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::BufferFromPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer)
+AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::BufferFromPacket(AVPacket* pPacket, AMFBuffer** ppBuffer)
 {
     AMF_RETURN_IF_FALSE(pPacket != NULL, AMF_INVALID_ARG, L"BufferFromPacket() - packet not passed in");
     AMF_RETURN_IF_FALSE(ppBuffer != NULL, AMF_INVALID_ARG, L"BufferFromPacket() - buffer pointer not passed in");
 
+#ifdef __USE_H264Mp4ToAnnexB
+    if (m_bVideoAnnexB && m_VideoAnnexB.IsActive() && pPacket->stream_index == m_iVideoStreamIndexFFmpeg)
+    {
+        // nobody else sees the payload until it is wrapped, 4 byte lengths become start codes in place
+        AMF_RETURN_IF_FALSE(av_packet_make_writable(pPacket) >= 0, AMF_OUT_OF_MEMORY, L"BufferFromPacket() - av_packet_make_writable failed");
+        AMF_RESULT err = m_VideoAnnexB.Rewrite(pPacket->data, pPacket->size, (pPacket->flags & AV_PKT_FLAG_KEY) != 0, Mp4ToAnnexB::REWRITE_IN_PLACE);
+        AMF_RETURN_IF_FAILED(err, L"BufferFromPacket() - Annex B rewrite failed");
 
-    // Reproduce FFMPEG packet allocate logic (file libavcodec/avpacket.c function av_packet_duplicate)
-    // ...
-    //    data = av_malloc(pkt->size + FF_INPUT_BUFFER_PADDING_SIZE);
-    // ...
-    //MM this causes problems because there is no way to set real buffer size. Allocation has 32 byte alignment - should be enough.
-    AMF_RESULT err = m_pContext->AllocBuffer(AMF_MEMORY_HOST, pPacket->size + AV_INPUT_BUFFER_PADDING_SIZE, ppBuffer);
-    AMF_RETURN_IF_FAILED(err, L"BufferFromPacket() - AllocBuffer failed");
-
-    AMFBuffer* pBuffer = *ppBuffer;
-    err = pBuffer->SetSize(pPacket->size);
-    AMF_RETURN_IF_FAILED(err, L"BufferFromPacket() - SetSize failed");
+        if (m_VideoAnnexB.GetSegmentCount() != 1 || m_VideoAnnexB.GetSegments()[0].pData != pPacket->data)
+        {
+            // shorter length prefixes grow the packet - gather the segments into a new buffer
+            err = m_pContext->AllocBuffer(AMF_MEMORY_HOST, m_VideoAnnexB.GetOutputSize(), ppBuffer);
+            AMF_RETURN_IF_FAILED(err, L"BufferFromPacket() - AllocBuffer failed");
+            m_VideoAnnexB.Gather(static_cast<amf_uint8*>((*ppBuffer)->GetNative()));
+            return UpdateBufferProperties(*ppBuffer, pPacket);
+        }
+    }
+#endif
 
-    // get the memory location and check the buffer was indeed allocated
-    void* pMem = pBuffer->GetNative();
-    AMF_RETURN_IF_FALSE(pMem != NULL, AMF_INVALID_POINTER, L"BufferFromPacket() - GetMemory failed");
+    // the properties below only need the timing fields of the packet,
+    // keep a shallow copy as the payload reference moves into the buffer
+    AVPacket packetInfo = *pPacket;
 
-    // copy the packet memory and don't forget to
-    // clear data padding like it is done by FFMPEG
-    memcpy(pMem, pPacket->data, pPacket->size);
-    memset(reinterpret_cast<amf_int8*>(pMem)+pPacket->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    // no copy - the buffer references the packet payload, which libavformat
+    // already allocated with AV_INPUT_BUFFER_PADDING_SIZE zeroed bytes at the end
+    AMF_RESULT err = m_pPacketPool->WrapPacket(m_pContext, pPacket, ppBuffer);
+    AMF_RETURN_IF_FAILED(err, L"BufferFromPacket() - WrapPacket failed");
 
     // now that we created the buffer, it's time to update
     // it's properties from the packet information...
-    return UpdateBufferProperties(pBuffer, pPacket);
+    return UpdateBufferProperties(*ppBuffer, &packetInfo);
+}
+//-------------------------------------------------------------------------------------------------
+// called with m_sync held by the only thread that reads packets, right after av_read_frame()
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateStreamTiming(amf_int32 streamIndex)
+{
+    if (streamIndex >= (amf_int32)m_StreamTiming.size())
+    {
+        m_StreamTiming.resize(m_pInputContext->nb_streams);
+    }
+    const AVStream* ist = m_pInputContext->streams[streamIndex];
+    StreamTiming& timing = m_StreamTiming[streamIndex];
+    timing.firstDts  = cffstream(ist)->first_dts;
+    timing.startTime = ist->start_time;
+    timing.timeBase  = ist->time_base;
+    timing.frameRate = ist->r_frame_rate;
+    timing.codecType = ist->codecpar->codec_type;
+
+    m_iDefaultStreamIndex = av_find_default_stream_index(m_pInputContext);
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuffer* pBuffer, const AVPacket* pPacket)
@@ -1220,28 +1528,28 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuf
     AMF_RETURN_IF_FALSE(pBuffer != NULL, AMF_INVALID_ARG, L"UpdateBufferProperties() - buffer not passed in");
     AMF_RETURN_IF_FALSE(pPacket != NULL, AMF_INVALID_ARG, L"UpdateBufferProperties() - packet not passed in");
 
-    const AVStream*  ist = m_pInputContext->streams[pPacket->stream_index];
-    AMF_RETURN_IF_FALSE(ist != NULL, AMF_UNEXPECTED, L"UpdateBufferProperties() - stream not available");
+    AMF_RETURN_IF_FALSE(pPacket->stream_index >= 0 && pPacket->stream_index < (int)m_StreamTiming.size(), AMF_UNEXPECTED,
+        L"UpdateBufferProperties() - stream not available");
+    const StreamTiming timing = m_StreamTiming[pPacket->stream_index];
 
-    amf_int64 first_dts = cffstream(ist)->first_dts;
-    if (first_dts != AV_NOPTS_VALUE)
+    if (timing.firstDts != AV_NOPTS_VALUE)
     {
-        ((AVPacket*)pPacket)->dts += first_dts;
+        ((AVPacket*)pPacket)->dts += timing.firstDts;
     }
 
-    const amf_int64  pts = av_rescale_q(pPacket->dts, ist->time_base, AMF_TIME_BASE_Q);
+    const amf_int64  pts = av_rescale_q(pPacket->dts, timing.timeBase, AMF_TIME_BASE_Q);
     pBuffer->SetPts(pts - GetMinPosition());
 
     AttachAVPacketInfo(pBuffer, pPacket);
 
     pBuffer->SetProperty(L"FFMPEG:FirstPtsOffset", AMFVariant(m_ptsInitialMinPosition));
 
-    if (ist->start_time != AV_NOPTS_VALUE)
+    if (timing.startTime != AV_NOPTS_VALUE)
     {
-        pBuffer->SetProperty(L"FFMPEG:start_time", AMFVariant(ist->start_time));
+        pBuffer->SetProperty(L"FFMPEG:start_time", AMFVariant(timing.startTime));
     }
-    pBuffer->SetProperty(L"FFMPEG:time_base_den", AMFVariant(ist->time_base.den));
-    pBuffer->SetProperty(L"FFMPEG:time_base_num", AMFVariant(ist->time_base.num));
+    pBuffer->SetProperty(L"FFMPEG:time_base_den", AMFVariant(timing.timeBase.den));
+    pBuffer->SetProperty(L"FFMPEG:time_base_num", AMFVariant(timing.timeBase.num));
 
 
     if ((m_iVideoStreamIndexFFmpeg == -1 || pPacket->stream_index == m_iVideoStreamIndexFFmpeg) && m_ptsSeekPos != -1)
@@ -1255,8 +1563,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuf
         {
             pBuffer->SetProperty(L"EndSeeking", AMFVariant(true));
 
-            int default_stream_index = av_find_default_stream_index(m_pInputContext);
-            if (pPacket->stream_index == default_stream_index)
+            if (pPacket->stream_index == m_iDefaultStreamIndex)
             {
                 m_ptsSeekPos = -1;
             }
@@ -1273,17 +1580,17 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuf
 
     amf_int32 outputIndex = FromFFmpegToOutputIndex(pPacket->stream_index);
     // update buffer duration, based on the type if info stored
-    if (ist->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+    if (timing.codecType == AVMEDIA_TYPE_VIDEO)
     {
         pBuffer->SetProperty(FFMPEG_DEMUXER_BUFFER_TYPE, AMFVariant(AMF_STREAM_VIDEO));
-        UpdateBufferVideoDuration(pBuffer, pPacket, ist);
+        UpdateBufferVideoDuration(pBuffer, pPacket, timing);
 //        AMFTraceWarning(AMF_FACILITY, L"Video count=%lld size=%d PTS=%5.2f", m_OutputStreams[outputIndex]->GetPacketCount(), (int)pBuffer->GetSize(), pBuffer->GetPts() / 10000.);
 
     }
-    else if (ist->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+    else if (timing.codecType == AVMEDIA_TYPE_AUDIO)
     {
         pBuffer->SetProperty(FFMPEG_DEMUXER_BUFFER_TYPE, AMFVariant(AMF_STREAM_AUDIO));
-        UpdateBufferAudioDuration(pBuffer, pPacket, ist);
+        UpdateBufferAudioDuration(pBuffer, pPacket, timing);
 //        AMFTraceWarning(AMF_FACILITY, L"Audio count=%lld size=%d PTS=%5.2f", m_OutputStreams[outputIndex]->GetPacketCount(), (int)pBuffer->GetSize(),  pBuffer->GetPts() / 10000.);
     }
     if (outputIndex >= 0)
@@ -1294,12 +1601,12 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuf
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
-void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferVideoDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const AVStream *ist)
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferVideoDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const StreamTiming& timing)
 {
     if (pPacket->duration != 0)
     {
-        amf_int64 durationByFFMPEG    = av_rescale_q(pPacket->duration, ist->time_base, AMF_TIME_BASE_Q);
-        amf_int64 durationByFrameRate = (amf_int64)((amf_double)AMF_SECOND / ((amf_double)ist->r_frame_rate.num / (amf_double)ist->r_frame_rate.den));
+        amf_int64 durationByFFMPEG    = av_rescale_q(pPacket->duration, timing.timeBase, AMF_TIME_BASE_Q);
+        amf_int64 durationByFrameRate = (amf_int64)((amf_double)AMF_SECOND / ((amf_double)timing.frameRate.num / (amf_double)timing.frameRate.den));
         if (abs(durationByFrameRate - durationByFFMPEG)> AMF_MIN(durationByFrameRate, durationByFFMPEG) / 2)
         {
             durationByFFMPEG = durationByFrameRate;
@@ -1309,11 +1616,11 @@ void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferVideoDuration(AMFBuffer
     }
 }
 //-------------------------------------------------------------------------------------------------
-void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferAudioDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const AVStream *ist)
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferAudioDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const StreamTiming& timing)
 {
     if (pPacket->duration != 0)
     {
-        amf_int64 durationByFFMPEG = av_rescale_q(pPacket->duration, ist->time_base, AMF_TIME_BASE_Q);
+        amf_int64 durationByFFMPEG = av_rescale_q(pPacket->duration, timing.timeBase, AMF_TIME_BASE_Q);
         pBuffer->SetDuration(durationByFFMPEG);
     }
 }
@@ -1437,7 +1744,6 @@ bool AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::CheckH264MVC()
     {
         bool sps = false;
         bool mvc = false;
-        m_H264Mp4ToAnnexB.ProcessExtradata(ist->codecpar->extradata, ist->codecpar->extradata_size);
         FindSPSAndMVC(ist->codecpar->extradata, ist->codecpar->extradata_size, sps, mvc);
         if (mvc)
         {
@@ -1445,6 +1751,7 @@ bool AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::CheckH264MVC()
         }
     }
 
+    amf_vector<amf_uint8> annexb;
     amf_int iVideoFrames = 5; // look forward for this number of frames
     while (true){
         AVPacket *packet = NULL;
@@ -1489,11 +1796,15 @@ bool AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::CheckH264MVC()
         bool sps = false;
         bool mvc = false;
 
-        amf_uint8 *annexb = NULL;
-        amf_size annexb_size = 0;
-        m_H264Mp4ToAnnexB.Filter(&annexb, &annexb_size, (amf_uint8*)packet->data, packet->size);
+        // the packet is cached for output and has to stay as is - gather a copy
+        annexb.clear();
+        if (m_VideoAnnexB.Rewrite(packet->data, packet->size, false, Mp4ToAnnexB::INSERT_HEADERS) == AMF_OK)
+        {
+            annexb.resize(m_VideoAnnexB.GetOutputSize());
+            m_VideoAnnexB.Gather(annexb.empty() ? NULL : &annexb[0]);
+        }
 
-        FindSPSAndMVC(annexb, (amf_int)annexb_size, sps, mvc);
+        FindSPSAndMVC(annexb.empty() ? NULL : &annexb[0], (amf_int)annexb.size(), sps, mvc);
         if (mvc)
         {
             return true;
@@ -1564,6 +1875,155 @@ bool AMF_STD_CALL       AMFFileDemuxerFFMPEGImpl::IsCached()
     }
     return false;
 }
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL       AMFFileDemuxerFFMPEGImpl::StartReadAhead()
+{
+    AMFLock lock(&m_sync);
+
+    if (!m_bReadAhead || m_bTerminated || m_pInputContext == NULL || m_ReadAheadThread.IsRunning())
+    {
+        return;
+    }
+    m_bReadAheadEof = false;
+    m_eReadAheadError = AMF_EOF;
+    if (!m_ReadAheadThread.Start())
+    {
+        AMFTraceWarning(AMF_FACILITY, L"StartReadAhead() - failed to start reader thread, reading synchronously");
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// safe to call with m_sync held: the reader never blocks on m_sync without checking
+// for the stop request and blocking I/O is aborted through InterruptCallback()
+void AMF_STD_CALL       AMFFileDemuxerFFMPEGImpl::StopReadAhead()
+{
+    if (!m_ReadAheadThread.IsRunning())
+    {
+        return;
+    }
+    m_ReadAheadThread.RequestStop();
+    m_ReadAheadWake.SetEvent();
+    m_ReadAheadThread.WaitForStop();
+    m_bReadAheadEof = false;
+    m_eReadAheadError = AMF_EOF;
+}
+//-------------------------------------------------------------------------------------------------
+// balanced like a player: stop when any stream hits its byte budget or when all
+// enabled streams hold enough duration, so one stream can't starve the other - unless
+// a stream is waiting on an empty cache: then keep reading like the synchronous path
+// does, or a badly interleaved file or an undrained stream would stall that output
+bool AMF_STD_CALL       AMFFileDemuxerFFMPEGImpl::IsReadAheadFull()
+{
+    bool bEnough = true;
+    bool bCapped = false;
+    for (amf_vector<AMFOutputDemuxerImplPtr>::iterator it = m_OutputStreams.begin(); it != m_OutputStreams.end(); ++it)
+    {
+        if (!(*it)->m_bEnabled)
+        {
+            continue;
+        }
+        if ((*it)->m_bStarved && (*it)->m_packetsCache.IsEmpty())
+        {
+            return false;
+        }
+        bCapped = bCapped || (*it)->IsCacheFull();
+        bEnough = bEnough && (*it)->HasEnoughCached();
+    }
+    return bCapped || bEnough;
+}
+//-------------------------------------------------------------------------------------------------
+// one reader iteration - returns false when there is nothing to do and the thread can idle
+bool AMF_STD_CALL       AMFFileDemuxerFFMPEGImpl::ReadAhead()
+{
+    // m_sync is never held across av_read_frame() so outputs keep draining their caches
+    // while the read blocks on disk or network
+    AMFLock lock(&m_sync, READ_AHEAD_LOCK_TIMEOUT);
+    if (!lock.IsLocked())
+    {
+        return true;
+    }
+    if (m_bReadAheadEof || m_bForceEof || IsReadAheadFull())
+    {
+        return false;
+    }
+    AVFormatContext* pInputContext = m_pInputContext;
+    lock.Unlock();
+
+    AVPacket pkt = {};
+    pkt.dts = AV_NOPTS_VALUE;
+    pkt.pts = AV_NOPTS_VALUE;
+    const int ret = av_read_frame(pInputContext, &pkt);
+
+    while (!lock.Lock(READ_AHEAD_LOCK_TIMEOUT))
+    {
+        if (m_ReadAheadThread.StopRequested())
+        {
+            break;
+        }
+    }
+    if (!lock.IsLocked() || m_ReadAheadThread.StopRequested())
+    {
+        // Seek() or Close() is waiting for us - the packet is stale anyway
+        av_packet_unref(&pkt);
+        return true;
+    }
+    if (ret == AVERROR(EAGAIN))
+    {
+        // nothing available yet (network, pipes) - idle and try again
+        return false;
+    }
+    if (ret < 0)
+    {
+        if (ret == AVERROR_EOF)
+        {
+            m_KeyframeIndex.MarkEof();
+        }
+        else
+        {
+            AMFTraceError(AMF_FACILITY, L"ReadAhead() - av_read_frame() failed, error=%d", ret);
+            m_eReadAheadError = (ret == AVERROR(ENOMEM)) ? AMF_OUT_OF_MEMORY : AMF_FAIL;
+        }
+        m_bReadAheadEof = true;
+        return true;
+    }
+
+    AVPacket* pPacket = nullptr;
+    const AMF_RESULT err = ProcessPacket(&pkt, &pPacket);
+    if (err != AMF_OK)
+    {
+        // AMF_EOF when the packet is past the configured range
+        m_eReadAheadError = err;
+        m_bReadAheadEof = true;
+        return true;
+    }
+
+    const amf_int32 outputIndex = FromFFmpegToOutputIndex(pPacket->stream_index);
+    if (outputIndex >= 0)
+    {
+        m_OutputStreams[outputIndex]->CachePacket(pPacket);
+    }
+    else
+    {
+        ClearPacket(pPacket);
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+int AMFFileDemuxerFFMPEGImpl::InterruptCallback(void* opaque)
+{
+    AMFFileDemuxerFFMPEGImpl* pThis = reinterpret_cast<AMFFileDemuxerFFMPEGImpl*>(opaque);
+    return pThis->m_ReadAheadThread.StopRequested() ? 1 : 0;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFFileDemuxerFFMPEGImpl::AMFReadAheadThread::Run()
+{
+    while (!StopRequested())
+    {
+        if (!m_pHost->ReadAhead())
+        {
+            m_pHost->m_ReadAheadWake.Lock(READ_AHEAD_IDLE_TIMEOUT);
+        }
+    }
+}
 amf_int32   AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::GetOutputCount()
 {
     AMFLock lock(&m_sync);
@@ -1604,6 +2064,13 @@ AMF_RESULT AMFFileDemuxerFFMPEGImpl::OpenFile(
     amf_bool& bIsImage)
 {
     bIsImage = false;
+
+    // allocate the context up front so blocking I/O can be interrupted when the reader thread is stopped
+    m_pInputContext = avformat_alloc_context();
+    AMF_RETURN_IF_FALSE(m_pInputContext != NULL, AMF_OUT_OF_MEMORY, L"OpenFile() - avformat_alloc_context failed");
+    m_pInputContext->interrupt_callback.callback = InterruptCallback;
+    m_pInputContext->interrupt_callback.opaque = this;
+
     int ret = avformat_open_input(&m_pInputContext, filename.c_str(), pFmt, &pOptions);
 	if (ret < 0)
 	{
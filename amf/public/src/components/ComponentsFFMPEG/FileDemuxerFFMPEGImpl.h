@@ -39,6 +39,8 @@
 #include "public/include/core/Context.h"
 
 #include "H264Mp4ToAnnexB.h"
+#include "PacketBufferFFMPEG.h"
+#include "KeyframeIndexFFMPEG.h"
 
 extern "C"
 {
@@ -62,8 +64,36 @@ namespace amf
 {
 
     //-------------------------------------------------------------------------------------------------
+    // FIFO of demuxed packets on a preallocated ring; it only grows (doubling) when a
+    // synchronous read has to park more packets for a stream than the initial capacity
+    class AMFPacketRingFFMPEG
+    {
+    public:
+        AMFPacketRingFFMPEG(amf_size capacity);
+        ~AMFPacketRingFFMPEG();
+
+        void        Push(AVPacket* pPacket);
+        AVPacket*   Pop();
+        void        Clear();
+
+        bool        IsEmpty() const         { return m_iCount == 0; }
+        amf_size    GetCount() const        { return m_iCount; }
+        amf_int64   GetBytes() const        { return m_iBytes; }
+        amf_int64   GetDuration() const     { return m_iDuration; } // in stream time base
+
+    private:
+        amf_vector<AVPacket*>   m_Packets;
+        amf_size                m_iHead;
+        amf_size                m_iCount;
+        amf_int64               m_iBytes;
+        amf_int64               m_iDuration;
+
+        AMFPacketRingFFMPEG(const AMFPacketRingFFMPEG&);
+        AMFPacketRingFFMPEG& operator=(const AMFPacketRingFFMPEG&);
+    };
+    //-------------------------------------------------------------------------------------------------
 
-    class AMFFileDemuxerFFMPEGImpl : 
+    class AMFFileDemuxerFFMPEGImpl :
         public AMFInterfaceBase,
         public AMFMediaSource,
         public AMFPropertyStorageExImpl<AMFComponentEx>
@@ -98,14 +128,17 @@ namespace amf
             amf_int32                   m_iIndexFFmpeg;
             bool                        m_bEnabled;
             // packet cache...
-            amf_list<AVPacket*>        m_packetsCache;
+            AMFPacketRingFFMPEG        m_packetsCache;
             amf_int64                  m_iPacketCount;
+            bool                       m_bStarved;      // asked for a packet and found the cache empty
 
 
             // packet handling helper methods
             AMF_RESULT  CachePacket(AVPacket* pPacket);
             void        ClearPacketCache();
             bool        IsCached();
+            bool        IsCacheFull();
+            bool        HasEnoughCached();
             amf_int64   GetPacketCount() { return m_iPacketCount; }
         };
         typedef AMFInterfacePtr_T<AMFOutputDemuxerImpl>    AMFOutputDemuxerImplPtr;
@@ -129,6 +162,20 @@ namespace amf
             virtual ~AMFAudioOutputDemuxerImpl()    {};
         };
 
+    //-------------------------------------------------------------------------------------------------
+
+        class AMFReadAheadThread :
+            public AMFThread
+        {
+        public:
+            AMFReadAheadThread(AMFFileDemuxerFFMPEGImpl* pHost) : m_pHost(pHost) {}
+
+        protected:
+            virtual void Run();
+
+            AMFFileDemuxerFFMPEGImpl*   m_pHost;
+        };
+
 
     public:
         // interface access
@@ -190,14 +237,30 @@ namespace amf
 
         // helper functions
         AMF_RESULT AMF_STD_CALL  ReadPacket(AVPacket **packet);
+        AMF_RESULT AMF_STD_CALL  ProcessPacket(AVPacket* pPkt, AVPacket **packet);
         AMF_RESULT AMF_STD_CALL  FindNextPacket(amf_int32 streamIndex, AVPacket **packet, bool saveSkipped);
         bool       AMF_STD_CALL  OutOfRange();
         void       AMF_STD_CALL  ClearCachedPackets();
+        int        AMF_STD_CALL  SeekFrame(amf_int32 streamIndex, amf_int64 offset, AMF_SEEK_TYPE eType, int flags);
+        void       AMF_STD_CALL  LoadKeyframeIndex();
+        void       AMF_STD_CALL  SaveKeyframeIndex();
+
+        AMF_RESULT AMF_STD_CALL  BufferFromPacket(AVPacket* pPacket, AMFBuffer** ppBuffer);
+        // stream fields UpdateBufferProperties() needs - av_read_frame() updates them, so the thread
+        // that reads packets copies them under m_sync and buffers are stamped from the copy
+        struct StreamTiming
+        {
+            amf_int64       firstDts;
+            amf_int64       startTime;
+            AVRational      timeBase;
+            AVRational      frameRate;
+            AVMediaType     codecType;
+        };
+        void       AMF_STD_CALL  UpdateStreamTiming(amf_int32 streamIndex);
 
-        AMF_RESULT AMF_STD_CALL  BufferFromPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer);
         AMF_RESULT AMF_STD_CALL  UpdateBufferProperties(AMFBuffer* pBuffer, const AVPacket* pPacket);
-        void       AMF_STD_CALL  UpdateBufferVideoDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const AVStream *ist);
-        void       AMF_STD_CALL  UpdateBufferAudioDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const AVStream *ist);
+        void       AMF_STD_CALL  UpdateBufferVideoDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const StreamTiming& timing);
+        void       AMF_STD_CALL  UpdateBufferAudioDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const StreamTiming& timing);
 
         void AMF_STD_CALL        FindSPSAndMVC(const amf_uint8 *buf, amf_int buf_size, bool &has_sps, bool &has_mvc) const;
         bool AMF_STD_CALL        CheckH264MVC();
@@ -211,10 +274,18 @@ namespace amf
         AMF_RESULT OpenAsImageSequence(amf_string filename, AVInputFormat* pFmt, AVDictionary* pOptions);
         AMF_RESULT OpenFile(amf_string filename, AVInputFormat* pFmt, AVDictionary* pOptions, amf_bool& bIsImage);
 
+        // background read-ahead
+        void       AMF_STD_CALL  StartReadAhead();
+        void       AMF_STD_CALL  StopReadAhead();
+        bool       AMF_STD_CALL  ReadAhead();
+        bool       AMF_STD_CALL  IsReadAheadFull();
+        static int               InterruptCallback(void* opaque);
+
     private:
       mutable AMFCriticalSection  m_sync;
 
         AMFContextPtr                        m_pContext;
+        AMFPacketBufferPoolFFMPEGPtr         m_pPacketPool;
         amf_vector<AMFOutputDemuxerImplPtr>  m_OutputStreams;
 
         amf_int32               FromFFmpegToOutputIndex(amf_int32 indexFFmpeg);
@@ -240,12 +311,29 @@ namespace amf
         amf_int32               m_iVideoStreamIndexFFmpeg;
         amf_int32               m_iAudioStreamIndexFFmpeg;
 
+        amf_vector<StreamTiming> m_StreamTiming;    // by FFmpeg stream index
+        amf_int32               m_iDefaultStreamIndex;
+
 #ifdef __USE_H264Mp4ToAnnexB
-        amf::H264Mp4ToAnnexB    m_H264Mp4ToAnnexB;
+        amf::Mp4ToAnnexB        m_VideoAnnexB;
 #endif
+        bool                    m_bVideoAnnexB;     // latched on Init
 
         bool                    m_bStreaming;
 
+        // read-ahead settings are latched on Init
+        bool                    m_bReadAhead;
+        amf_int64               m_iReadAheadBytes;
+        amf_pts                 m_ptsReadAheadDuration;
+        bool                    m_bReadAheadEof;
+        AMF_RESULT              m_eReadAheadError;  // returned once m_bReadAheadEof is set, AMF_EOF unless the read failed
+        AMFEvent                m_ReadAheadWake;
+        AMFReadAheadThread      m_ReadAheadThread;
+
+        // keyframes seen while reading, used to seek without probing
+        AMFKeyframeIndexFFMPEG  m_KeyframeIndex;
+        amf_wstring             m_IndexPath;
+
         AMFFileDemuxerFFMPEGImpl(const AMFFileDemuxerFFMPEGImpl&);
         AMFFileDemuxerFFMPEGImpl& operator=(const AMFFileDemuxerFFMPEGImpl&);
     };
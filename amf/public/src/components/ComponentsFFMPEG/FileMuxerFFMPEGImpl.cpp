@@ -643,6 +643,31 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Open()
         return AMF_FILE_NOT_OPEN;
     }
 
+    // raw elementary streams from MP4 framed input are rewritten here rather than by the
+    // bitstream filter libavformat inserts on its own, which copies every packet
+    m_AnnexB.Terminate();
+    if (m_pOutputContext->nb_streams == 1)
+    {
+        const AVCodecParameters* par = m_pOutputContext->streams[0]->codecpar;
+        Mp4ToAnnexB::Codec codec = Mp4ToAnnexB::CODEC_UNKNOWN;
+        if (par->codec_id == AV_CODEC_ID_H264 && strcmp(file_oformat->name, "h264") == 0)
+        {
+            codec = Mp4ToAnnexB::CODEC_H264;
+        }
+        else if (par->codec_id == AV_CODEC_ID_HEVC && strcmp(file_oformat->name, "hevc") == 0)
+        {
+            codec = Mp4ToAnnexB::CODEC_HEVC;
+        }
+        else if (par->codec_id == AV_CODEC_ID_AV1 && strcmp(file_oformat->name, "obu") == 0)
+        {
+            codec = Mp4ToAnnexB::CODEC_AV1;
+        }
+        if (m_AnnexB.Init(codec, par->extradata, par->extradata_size) != AMF_OK)
+        {
+            AMFTraceWarning(AMF_FACILITY, L"Open() - unsupported extradata, packets are written unchanged");
+        }
+    }
+
     AMF_RESULT err = WriteHeader();
     AMF_RETURN_IF_FAILED(err,  L"Open() - WriteHeader() failed");
 
@@ -804,7 +829,25 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WriteData(AMFData* pData, amf_i
         //pkt.pts = AV_NOPTS_VALUE;
         //pkt.dts = AV_NOPTS_VALUE;
 //        amf_int64 ptsFFmpeg = pkt.pts;
-        if (av_interleaved_write_frame(m_pOutputContext,&pkt)<0)
+        if (m_AnnexB.IsActive())
+        {
+            // raw stream - no interleaving, the segments go straight to the file;
+            // the input may be shared behind a splitter, so it is never rewritten in place
+            amf_int64 flags = 0;
+            pData->GetProperty(L"FFMPEG:flags", &flags);
+            const bool bKeyFrame = ((pkt.flags | flags) & AV_PKT_FLAG_KEY) != 0;
+
+            err = m_AnnexB.Rewrite(pkt.data, pkt.size, bKeyFrame, Mp4ToAnnexB::INSERT_HEADERS);
+            AMF_RETURN_IF_FAILED(err, L"WriteData() - Annex B rewrite failed");
+
+            const Mp4ToAnnexB::Segment* pSegments = m_AnnexB.GetSegments();
+            for (amf_size i = 0; i < m_AnnexB.GetSegmentCount(); i++)
+            {
+                avio_write(m_pOutputContext->pb, pSegments[i].pData, (int)pSegments[i].size);
+            }
+            AMF_RETURN_IF_FALSE(m_pOutputContext->pb->error >= 0, AMF_FAIL, L"WriteData() - avio_write failed");
+        }
+        else if (av_interleaved_write_frame(m_pOutputContext,&pkt)<0)
         {
             return AMF_FAIL;
         }
@@ -53,6 +53,7 @@ extern "C"
 #include "public/common/PropertyStorageExImpl.h"
 #include "public/include/core/Context.h"
 #include "public/include/core/CurrentTime.h"
+#include "H264Mp4ToAnnexB.h"
 
 
 
@@ -195,6 +196,7 @@ namespace amf
         bool                    m_bPtsOffsetIsCalculated;
         amf_pts                 m_ptsOffset;
         bool                    m_isUsageTrim;
+        Mp4ToAnnexB             m_AnnexB;       // MP4 framed input written to a raw elementary stream
     };
 
  //   typedef AMFInterfacePtr_T<AMFFileMuxerFFMPEGImpl>    AMFFileMuxerFFMPEGPtr;
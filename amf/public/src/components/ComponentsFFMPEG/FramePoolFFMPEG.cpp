@@ -0,0 +1,371 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "FramePoolFFMPEG.h"
+#include "public/common/TraceAdapter.h"
+
+#define AMF_FACILITY L"AMFFramePoolFFMPEG"
+
+using namespace amf;
+
+// minimum line alignment - wide enough for the AVX-512 paths in libavcodec
+static const int DIRECT_LINE_ALIGN = 64;
+// frames kept in flight on top of the codec's own reference depth:
+// the one being returned and the one still held downstream
+static const int DIRECT_EXTRA_FRAMES = 2;
+// surface observers kept for reuse; anything released beyond this is freed
+static const amf_size MAX_FREE_HOLDERS = 32;
+
+//-------------------------------------------------------------------------------------------------
+static AVPixelFormat GetDirectPixFormat(AMF_SURFACE_FORMAT format)
+{
+    switch (format)
+    {
+    case AMF_SURFACE_NV12:      return AV_PIX_FMT_NV12;
+    case AMF_SURFACE_YUV420P:   return AV_PIX_FMT_YUV420P;
+    case AMF_SURFACE_P010:      return AV_PIX_FMT_P010LE;
+    default:                    return AV_PIX_FMT_NONE;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static bool IsMatchingPixFormat(AVPixelFormat expected, int format)
+{
+    if (expected == AV_PIX_FMT_NONE)
+    {
+        return false;
+    }
+    // full range 4:2:0 has the same memory layout
+    return (format == expected) || ((expected == AV_PIX_FMT_YUV420P) && (format == AV_PIX_FMT_YUVJ420P));
+}
+//-------------------------------------------------------------------------------------------------
+class AMFFramePoolFFMPEG::SurfaceHolder : public AMFSurfaceObserver
+{
+public:
+    SurfaceHolder() : m_pBuffer(nullptr)
+    {
+    }
+    virtual ~SurfaceHolder()
+    {
+        av_buffer_unref(&m_pBuffer);
+    }
+    virtual void AMF_STD_CALL OnSurfaceDataRelease(AMFSurface* /*pSurface*/) override
+    {
+        // hands the frame memory back to the buffer pool
+        av_buffer_unref(&m_pBuffer);
+
+        // the pool can go away together with its last outstanding surface and
+        // take this holder with it, so nothing may touch members after this
+        AMFFramePoolFFMPEG* pPool = m_pPool.Detach();
+        pPool->ReturnHolder(this);
+        pPool->Release();
+    }
+
+    AVBufferRef*            m_pBuffer;
+    AMFFramePoolFFMPEGPtr   m_pPool;
+};
+//-------------------------------------------------------------------------------------------------
+AMFFramePoolFFMPEG::AMFFramePoolFFMPEG(AMF_SURFACE_FORMAT format)
+  : m_eFormat(format),
+    m_ePixFormat(GetDirectPixFormat(format)),
+    m_pBufferPool(nullptr),
+    m_uBufferSize(0),
+    m_pCopyPool(nullptr),
+    m_uCopyBufferSize(0)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMFFramePoolFFMPEG::~AMFFramePoolFFMPEG()
+{
+    for (amf_vector<SurfaceHolder*>::iterator it = m_freeHolders.begin(); it != m_freeHolders.end(); ++it)
+    {
+        delete *it;
+    }
+    m_freeHolders.clear();
+
+    // buffers still referenced by frames keep the pool itself alive until they come back
+    av_buffer_pool_uninit(&m_pBufferPool);
+    av_buffer_pool_uninit(&m_pCopyPool);
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL AMFFramePoolFFMPEG::Attach(AVCodecContext* pCodecContext)
+{
+    if ((pCodecContext == nullptr) || (m_ePixFormat == AV_PIX_FMT_NONE))
+    {
+        return;
+    }
+    pCodecContext->opaque      = this;
+    pCodecContext->get_buffer2 = GetBuffer2;
+}
+//-------------------------------------------------------------------------------------------------
+int AMFFramePoolFFMPEG::GetBuffer2(AVCodecContext* pCodecContext, AVFrame* pFrame, int flags)
+{
+    // called from the decoder threads when frame threading is on
+    AMFFramePoolFFMPEG* pThis = static_cast<AMFFramePoolFFMPEG*>(pCodecContext->opaque);
+    if ((pThis != nullptr) && ((pCodecContext->codec->capabilities & AV_CODEC_CAP_DR1) != 0))
+    {
+        if (pThis->AllocFrame(pCodecContext, pFrame) == 0)
+        {
+            return 0;
+        }
+    }
+    return avcodec_default_get_buffer2(pCodecContext, pFrame, flags);
+}
+//-------------------------------------------------------------------------------------------------
+int AMFFramePoolFFMPEG::AllocFrame(AVCodecContext* pCodecContext, AVFrame* pFrame)
+{
+    if (IsMatchingPixFormat(m_ePixFormat, pFrame->format) == false)
+    {
+        return AVERROR(ENOSYS);
+    }
+
+    // the decoder may write past the visible area up to the aligned
+    // dimensions, so size the planes the same way the default allocator does
+    int width  = pFrame->width;
+    int height = pFrame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS] = {};
+    avcodec_align_dimensions2(pCodecContext, &width, &height, linesizeAlign);
+
+    int lineAlign = DIRECT_LINE_ALIGN;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+    {
+        lineAlign = AMF_MAX(lineAlign, linesizeAlign[i]);
+    }
+
+    // YUV420P chroma pitch is half of the luma pitch, so the luma pitch
+    // needs twice the alignment; NV12 / P010 chroma share the luma pitch
+    const bool      bThreePlanes = (m_ePixFormat == AV_PIX_FMT_YUV420P);
+    const int       bytesPerSample = (m_ePixFormat == AV_PIX_FMT_P010LE) ? 2 : 1;
+    const amf_size  hPitch = FFALIGN(width * bytesPerSample, bThreePlanes ? 2 * lineAlign : lineAlign);
+    const amf_size  vPitch = FFALIGN(height, 2);
+    const amf_size  lumaSize = hPitch * vPitch;
+    const amf_size  bufferSize = lumaSize + lumaSize / 2 + 16 + lineAlign - 1;
+
+    AVBufferRef* pBuffer = nullptr;
+    {
+        AMFLock lock(&m_sync);
+
+        if ((m_pBufferPool == nullptr) || (m_uBufferSize != bufferSize))
+        {
+            // resolution change - frames of the old size return to the old pool
+            av_buffer_pool_uninit(&m_pBufferPool);
+            m_pBufferPool = av_buffer_pool_init(bufferSize, av_buffer_alloc);
+            if (m_pBufferPool == nullptr)
+            {
+                m_uBufferSize = 0;
+                return AVERROR(ENOMEM);
+            }
+            m_uBufferSize = bufferSize;
+
+            // fill the pool to the depth the decoder can hold at once so the
+            // steady state never allocates: references, reordering delay,
+            // one frame per decoding thread plus the frames on their way out
+            const int depth = AMF_MAX(pCodecContext->refs, 1) + pCodecContext->has_b_frames +
+                              AMF_MAX(pCodecContext->thread_count, 1) + DIRECT_EXTRA_FRAMES;
+            amf_vector<AVBufferRef*> prefill;
+            prefill.reserve(depth);
+            for (int i = 0; i < depth; i++)
+            {
+                AVBufferRef* pPrefill = av_buffer_pool_get(m_pBufferPool);
+                if (pPrefill == nullptr)
+                {
+                    break;
+                }
+                prefill.push_back(pPrefill);
+            }
+            for (amf_vector<AVBufferRef*>::iterator it = prefill.begin(); it != prefill.end(); ++it)
+            {
+                av_buffer_unref(&(*it));
+            }
+            AMFTraceDebug(AMF_FACILITY, L"AllocFrame() - %dx%d, pitch %d, %d frames", pFrame->width, pFrame->height, (int)hPitch, depth);
+        }
+
+        pBuffer = av_buffer_pool_get(m_pBufferPool);
+    }
+    if (pBuffer == nullptr)
+    {
+        return AVERROR(ENOMEM);
+    }
+
+    // one buffer, planes at the vertical pitch - the AMF host surface layout
+    pFrame->buf[0]      = pBuffer;
+    pFrame->data[0]     = pBuffer->data;
+    pFrame->linesize[0] = (int)hPitch;
+    pFrame->data[1]     = pFrame->data[0] + lumaSize;
+    if (bThreePlanes)
+    {
+        pFrame->linesize[1] = (int)(hPitch / 2);
+        pFrame->data[2]     = pFrame->data[1] + (hPitch / 2) * (vPitch / 2);
+        pFrame->linesize[2] = (int)(hPitch / 2);
+    }
+    else
+    {
+        pFrame->linesize[1] = (int)hPitch;
+    }
+    pFrame->extended_data = pFrame->data;
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL AMFFramePoolFFMPEG::IsDirect(const AVFrame& frame) const
+{
+    if (IsMatchingPixFormat(m_ePixFormat, frame.format) == false)
+    {
+        return false;
+    }
+    // the default allocator uses one buffer per plane, ours one for all of them;
+    // cropping that moves the plane pointers also rules out wrapping the frame
+    if ((frame.buf[0] == nullptr) || (frame.buf[1] != nullptr) || (frame.data[0] != frame.buf[0]->data) || (frame.linesize[0] <= 0))
+    {
+        return false;
+    }
+
+    const ptrdiff_t lumaSize = frame.data[1] - frame.data[0];
+    if ((lumaSize <= 0) || (lumaSize % frame.linesize[0] != 0))
+    {
+        return false;
+    }
+    const ptrdiff_t vPitch = lumaSize / frame.linesize[0];
+    if ((vPitch < frame.height) || (frame.buf[0]->size < (size_t)(lumaSize + lumaSize / 2)))
+    {
+        return false;
+    }
+
+    if (m_ePixFormat == AV_PIX_FMT_YUV420P)
+    {
+        return (frame.linesize[1] == frame.linesize[0] / 2) && (frame.linesize[2] == frame.linesize[1]) &&
+               (frame.data[2] == frame.data[1] + frame.linesize[1] * (vPitch / 2));
+    }
+    return frame.linesize[1] == frame.linesize[0];
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFFramePoolFFMPEG::WrapFrame(AMFContext* pContext, AVFrame* pFrame, AMFSurface** ppSurface)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pContext, L"WrapFrame() - context not passed in");
+    AMF_RETURN_IF_INVALID_POINTER(pFrame, L"WrapFrame() - frame not passed in");
+    AMF_RETURN_IF_INVALID_POINTER(ppSurface, L"WrapFrame() - surface pointer not passed in");
+    AMF_RETURN_IF_FALSE(IsDirect(*pFrame), AMF_INVALID_ARG, L"WrapFrame() - frame was not allocated by the pool");
+
+    const amf_int32 hPitch = pFrame->linesize[0];
+    const amf_int32 vPitch = (amf_int32)((pFrame->data[1] - pFrame->data[0]) / hPitch);
+
+    AMF_RESULT err = WrapBuffer(pContext, pFrame->buf[0], pFrame->width, pFrame->height, hPitch, vPitch, ppSurface);
+    AMF_RETURN_IF_FAILED(err, L"WrapFrame() - WrapBuffer failed");
+
+    // the surface took the buffer reference - the data pointers of the frame stay
+    // valid for as long as the surface lives, and unref of the frame skips it
+    pFrame->buf[0] = nullptr;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFFramePoolFFMPEG::AllocSurface(AMFContext* pContext, amf_int32 width, amf_int32 height, AMFSurface** ppSurface)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pContext, L"AllocSurface() - context not passed in");
+    AMF_RETURN_IF_INVALID_POINTER(ppSurface, L"AllocSurface() - surface pointer not passed in");
+    if (m_ePixFormat == AV_PIX_FMT_NONE)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+
+    // same layout as the direct frames, without the decoder's padding
+    const bool      bThreePlanes = (m_ePixFormat == AV_PIX_FMT_YUV420P);
+    const int       bytesPerSample = (m_ePixFormat == AV_PIX_FMT_P010LE) ? 2 : 1;
+    const amf_size  hPitch = FFALIGN(width * bytesPerSample, bThreePlanes ? 2 * DIRECT_LINE_ALIGN : DIRECT_LINE_ALIGN);
+    const amf_size  vPitch = FFALIGN(height, 2);
+    const amf_size  lumaSize = hPitch * vPitch;
+    const amf_size  bufferSize = lumaSize + lumaSize / 2;
+
+    AVBufferRef* pBuffer = nullptr;
+    {
+        AMFLock lock(&m_sync);
+
+        if ((m_pCopyPool == nullptr) || (m_uCopyBufferSize != bufferSize))
+        {
+            // resolution change - surfaces of the old size return to the old pool;
+            // the pool grows to the number of surfaces in flight and stays there
+            av_buffer_pool_uninit(&m_pCopyPool);
+            m_pCopyPool = av_buffer_pool_init(bufferSize, av_buffer_alloc);
+            m_uCopyBufferSize = (m_pCopyPool != nullptr) ? bufferSize : 0;
+            AMF_RETURN_IF_FALSE(m_pCopyPool != nullptr, AMF_OUT_OF_MEMORY, L"AllocSurface() - av_buffer_pool_init failed");
+        }
+        pBuffer = av_buffer_pool_get(m_pCopyPool);
+    }
+    AMF_RETURN_IF_FALSE(pBuffer != nullptr, AMF_OUT_OF_MEMORY, L"AllocSurface() - av_buffer_pool_get failed");
+
+    AMF_RESULT err = WrapBuffer(pContext, pBuffer, width, height, (amf_int32)hPitch, (amf_int32)vPitch, ppSurface);
+    if (err != AMF_OK)
+    {
+        av_buffer_unref(&pBuffer);
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFFramePoolFFMPEG::WrapBuffer(AMFContext* pContext, AVBufferRef* pBuffer, amf_int32 width, amf_int32 height,
+                                                       amf_int32 hPitch, amf_int32 vPitch, AMFSurface** ppSurface)
+{
+    SurfaceHolder* pHolder = nullptr;
+    {
+        AMFLock lock(&m_sync);
+        if (m_freeHolders.empty() == false)
+        {
+            pHolder = m_freeHolders.back();
+            m_freeHolders.pop_back();
+        }
+    }
+    if (pHolder == nullptr)
+    {
+        pHolder = new SurfaceHolder();
+    }
+
+    AMF_RESULT err = pContext->CreateSurfaceFromHostNative(m_eFormat, width, height, hPitch, vPitch, pBuffer->data, ppSurface, pHolder);
+    if (err != AMF_OK)
+    {
+        ReturnHolder(pHolder);
+        AMF_RETURN_IF_FAILED(err, L"WrapBuffer() - CreateSurfaceFromHostNative failed");
+    }
+
+    pHolder->m_pBuffer = pBuffer;
+    pHolder->m_pPool = this;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL AMFFramePoolFFMPEG::ReturnHolder(SurfaceHolder* pHolder)
+{
+    {
+        AMFLock lock(&m_sync);
+        if (m_freeHolders.size() < MAX_FREE_HOLDERS)
+        {
+            m_freeHolders.push_back(pHolder);
+            return;
+        }
+    }
+    delete pHolder;
+}
+//-------------------------------------------------------------------------------------------------
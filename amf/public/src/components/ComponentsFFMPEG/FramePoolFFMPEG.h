@@ -0,0 +1,115 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// direct rendering for the FFmpeg software video decoder: a get_buffer2 hook that hands
+// libavcodec pooled frames laid out exactly like AMF host surfaces, so frames whose decoder
+// format matches the output surface format can go out without a copy; frames that still need
+// converting are copied into pooled output surfaces
+#pragma once
+
+#include "public/include/core/Context.h"
+#include "public/common/InterfaceImpl.h"
+#include "public/common/Thread.h"
+#include "public/common/AMFSTL.h"
+
+extern "C"
+{
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4244)
+#endif
+
+    #include "libavcodec/avcodec.h"
+    #include "libavutil/buffer.h"
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+}
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Every frame is one AVBufferPool buffer holding all planes at a common vertical pitch, which is
+    // the layout AMFContext::CreateSurfaceFromHostNative expects. The pool is pre-filled to the
+    // codec's reference depth, so steady-state decode does not allocate frame memory. The surface
+    // wrapping the frame keeps the buffer reference through a recycled observer, like
+    // AMFPacketBufferPoolFFMPEG does for packets.
+    // libavcodec's software decoders output planar YUV420P / YUV420P10, so NV12 and P010 output
+    // surfaces are never direct; AllocSurface() serves them from a second buffer pool instead.
+    //-------------------------------------------------------------------------------------------------
+    class AMFFramePoolFFMPEG : public AMFInterfaceImpl<AMFInterface>
+    {
+    public:
+        AMFFramePoolFFMPEG(AMF_SURFACE_FORMAT format);
+        virtual ~AMFFramePoolFFMPEG();
+
+        // installs the get_buffer2 hook - call before avcodec_open2, the pool
+        // has to outlive the codec context
+        void AMF_STD_CALL       Attach(AVCodecContext* pCodecContext);
+
+        // true if the decoder wrote this frame straight into one of our buffers
+        bool AMF_STD_CALL       IsDirect(const AVFrame& frame) const;
+
+        // wraps the planes of a direct frame in a host surface without copying;
+        // the frame gives up its buffer reference but its other fields stay valid
+        AMF_RESULT AMF_STD_CALL WrapFrame(AMFContext* pContext, AVFrame* pFrame, AMFSurface** ppSurface);
+
+        // host surface of the pool format to copy a converted frame into, recycled when released;
+        // AMF_NOT_SUPPORTED for formats the pool doesn't lay out
+        AMF_RESULT AMF_STD_CALL AllocSurface(AMFContext* pContext, amf_int32 width, amf_int32 height, AMFSurface** ppSurface);
+
+    private:
+        class SurfaceHolder;
+        friend class SurfaceHolder;
+
+        static int              GetBuffer2(AVCodecContext* pCodecContext, AVFrame* pFrame, int flags);
+        int                     AllocFrame(AVCodecContext* pCodecContext, AVFrame* pFrame);
+        // on success the surface owns pBuffer
+        AMF_RESULT AMF_STD_CALL WrapBuffer(AMFContext* pContext, AVBufferRef* pBuffer, amf_int32 width, amf_int32 height,
+                                           amf_int32 hPitch, amf_int32 vPitch, AMFSurface** ppSurface);
+        void AMF_STD_CALL       ReturnHolder(SurfaceHolder* pHolder);
+
+        mutable AMFCriticalSection  m_sync;
+        const AMF_SURFACE_FORMAT    m_eFormat;
+        AVPixelFormat               m_ePixFormat;
+
+        AVBufferPool*               m_pBufferPool;
+        amf_size                    m_uBufferSize;
+
+        AVBufferPool*               m_pCopyPool;        // output surfaces of the copy path
+        amf_size                    m_uCopyBufferSize;
+
+        amf_vector<SurfaceHolder*>  m_freeHolders;
+    };
+    typedef AMFInterfacePtr_T<AMFFramePoolFFMPEG>    AMFFramePoolFFMPEGPtr;
+} // namespace amf
@@ -34,299 +34,415 @@
 #include "H264Mp4ToAnnexB.h"
 #include "public/common/AMFFactory.h"
 #include "public/common/TraceAdapter.h"
-#include <limits.h>
 
 using namespace amf;
 
+#define AMF_FACILITY L"Mp4ToAnnexB"
+
 //-------------------------------------------------------------------------------------------------
-// class H264Mp4ToAnnexB
+// class Mp4ToAnnexB
 //------------------------------------------------------------------------------------------------
 #ifndef AV_RB16
 #   define AV_RB16(x)                           \
     ((((const amf_uint8*)(x))[0] << 8) |         \
      ((const amf_uint8*)(x))[1])
 #endif
+#ifndef AV_RB24
+#   define AV_RB24(x)                           \
+    ((((const amf_uint8*)(x))[0] << 16) |        \
+     (((const amf_uint8*)(x))[1] <<  8) |        \
+     ((const amf_uint8*)(x))[2])
+#endif
 #ifndef AV_RB32
 #   define AV_RB32(x)                           \
-    ((((const amf_uint8*)(x))[0] << 24) |        \
+    ((amf_uint32(((const amf_uint8*)(x))[0]) << 24) | \
      (((const amf_uint8*)(x))[1] << 16) |        \
      (((const amf_uint8*)(x))[2] <<  8) |        \
      ((const amf_uint8*)(x))[3])
 #endif
-#ifndef AV_WB32
-#   define AV_WB32(p, d) do {                   \
-        ((amf_uint8*)(p))[3] = (d);              \
-        ((amf_uint8*)(p))[2] = (d)>>8;           \
-        ((amf_uint8*)(p))[1] = (d)>>16;          \
-        ((amf_uint8*)(p))[0] = (d)>>24;          \
-        } while(0)
-#endif
 
-#define AMF_INPUT_BUFFER_PADDING_SIZE 8
+#ifdef __USE_H264Mp4ToAnnexB
 
+static const amf_uint8 naluHeader[4] = { 0, 0, 0, 1 };
+static const amf_uint8 temporalDelimiter[2] = { 0x12, 0x00 }; // OBU_TEMPORAL_DELIMITER with obu_has_size_field and a zero size
+
+// H.264 nal_unit_type
+#define H264_NAL_IDR_SLICE          5
+#define H264_NAL_SPS                7
+#define H264_NAL_PPS                8
+// HEVC nal_unit_type
+#define HEVC_NAL_BLA_W_LP           16
+#define HEVC_NAL_RSV_IRAP_VCL23     23
+#define HEVC_NAL_VPS                32
+#define HEVC_NAL_PPS                34
+// AV1 obu_type
+#define AV1_OBU_SEQUENCE_HEADER     1
+#define AV1_OBU_TEMPORAL_DELIMITER  2
 
-#ifdef __USE_H264Mp4ToAnnexB
 //------------------------------------------------------------------------------------------------
-H264Mp4ToAnnexB::H264Mp4ToAnnexB() :
-m_lengthSize(0),
-m_firstIDR(0),
-m_pExtradata(NULL),
-m_ExtradataSize(0),
-m_pOutBuf(NULL),
-m_outBufSize(0)
+Mp4ToAnnexB::Mp4ToAnnexB() :
+    m_codec(CODEC_UNKNOWN),
+    m_lengthSize(0),
+    m_bFirst(true),
+    m_outputSize(0)
 {
     g_AMFFactory.Init();
 }
 //-------------------------------------------------------------------------------------------------
-H264Mp4ToAnnexB::~H264Mp4ToAnnexB()
+Mp4ToAnnexB::~Mp4ToAnnexB()
 {
-    if (m_pExtradata != NULL)
-    {
-        free(m_pExtradata);
-    }
-
-    if (m_pOutBuf != NULL)
-    {
-        free(m_pOutBuf);
-    }
-
     g_AMFFactory.Terminate();
 }
 //-------------------------------------------------------------------------------------------------
-static const amf_uint8 naluHeader[4] = { 0, 0, 0, 1 };
-int H264Mp4ToAnnexB::ProcessExtradata(const amf_uint8* pExtraData, amf_size extraDataSize)
+AMF_RESULT Mp4ToAnnexB::Init(Codec codec, const amf_uint8* pExtraData, amf_size extraDataSize)
 {
-    amf_uint16 unitSize;
-    amf_size totalSize = 0;
-    amf_uint8 *pOutData = NULL;
-    amf_uint8 unitNB = 0;
-    amf_uint8 spsDone = 0;
-    amf_uint8 spsSeen = 0;
-    amf_uint8 ppsSeen = 0;
+    Terminate();
+
+    // no extradata or the stream is already Annex B - nothing to rewrite
+    if (pExtraData == NULL)
+    {
+        return AMF_OK;
+    }
 
-    // check if data already parocessed - if get annexB streams
-    if (extraDataSize < 4)
+    AMF_RESULT res = AMF_OK;
+    switch (codec)
     {
-        return 1;
+    case CODEC_H264:
+        if (extraDataSize >= 7 && pExtraData[0] == 1)
+        {
+            res = ParseAvcC(pExtraData, extraDataSize);
+        }
+        break;
+    case CODEC_HEVC:
+        if (extraDataSize >= 23 && pExtraData[0] == 1)
+        {
+            res = ParseHvcC(pExtraData, extraDataSize);
+        }
+        break;
+    case CODEC_AV1:
+        // av1C: marker + version, profile / level, tier / bit depth / subsampling, delay - followed by the config OBUs
+        if (extraDataSize >= 4 && pExtraData[0] == 0x81)
+        {
+            m_Headers.assign(pExtraData + 4, pExtraData + extraDataSize);
+            m_codec = CODEC_AV1;
+        }
+        break;
+    default:
+        break;
     }
-    if (pExtraData[0] != 1 && memcmp(pExtraData, naluHeader, 4) == 0)
+    if (res != AMF_OK)
     {
-        m_pExtradata = (amf_uint8*)malloc(extraDataSize);
-        memcpy(m_pExtradata, pExtraData, extraDataSize);
-        m_ExtradataSize = extraDataSize;
-        m_firstIDR = 1;
-        return 0;
+        Terminate();
     }
-
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+void Mp4ToAnnexB::Terminate()
+{
+    m_codec = CODEC_UNKNOWN;
+    m_lengthSize = 0;
+    m_bFirst = true;
+    m_Headers.clear();
+    m_Segments.clear();
+    m_outputSize = 0;
+}
+//-------------------------------------------------------------------------------------------------
+void Mp4ToAnnexB::Reset()
+{
+    m_bFirst = true;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Mp4ToAnnexB::ParseAvcC(const amf_uint8* pExtraData, amf_size extraDataSize)
+{
+    const amf_uint8* pEnd = pExtraData + extraDataSize;
     const amf_uint8* extradata = pExtraData + 4;
 
     // retrieve length coded size for future use - AVCC nal units have size of this length at the beginning
-    m_lengthSize = (*extradata++ & 0x3) + 1;
-    if (m_lengthSize == 3)
+    const amf_uint32 lengthSize = (*extradata++ & 0x3) + 1;
+    AMF_RETURN_IF_FALSE(lengthSize != 3, AMF_INVALID_FORMAT, L"ParseAvcC() - invalid NAL length size");
+
+    // sps unit(s) followed by pps unit(s), each group starts with a count
+    amf_uint32 unitCount[2] = { 0, 0 };
+    for (int group = 0; group < 2; group++)
     {
-        return 1; // error - wrong value
+        AMF_RETURN_IF_FALSE(extradata < pEnd, AMF_INVALID_FORMAT, L"ParseAvcC() - truncated extradata");
+        amf_uint32 unitNB = group == 0 ? (*extradata++ & 0x1f) : *extradata++;
+        unitCount[group] = unitNB;
+        while (unitNB--)
+        {
+            AMF_RETURN_IF_FALSE(extradata + 2 <= pEnd, AMF_INVALID_FORMAT, L"ParseAvcC() - truncated extradata");
+            const amf_size unitSize = AV_RB16(extradata);
+            AMF_RETURN_IF_FALSE(extradata + 2 + unitSize <= pEnd, AMF_INVALID_FORMAT, L"ParseAvcC() - truncated extradata");
+            m_Headers.insert(m_Headers.end(), naluHeader, naluHeader + 4);
+            m_Headers.insert(m_Headers.end(), extradata + 2, extradata + 2 + unitSize);
+            extradata += 2 + unitSize;
+        }
     }
 
-    // retrieve sps and pps unit(s)
-    unitNB = *extradata++ & 0x1f; // number of sps unit(s) 
-    if (!unitNB)
+    if (unitCount[0] == 0)
     {
-        goto pps;
+        AMFTraceWarning(AMF_FACILITY, L"ParseAvcC() - SPS NALU missing or invalid. The resulting stream may not play.");
     }
-    else
+    if (unitCount[1] == 0)
     {
-        spsSeen = 1;
+        AMFTraceWarning(AMF_FACILITY, L"ParseAvcC() - PPS NALU missing or invalid. The resulting stream may not play.");
     }
+    m_lengthSize = lengthSize;
+    m_codec = CODEC_H264;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Mp4ToAnnexB::ParseHvcC(const amf_uint8* pExtraData, amf_size extraDataSize)
+{
+    const amf_uint8* pEnd = pExtraData + extraDataSize;
 
-    while (unitNB--)
-    {
-        void *tmp;
+    // lengthSizeMinusOne sits in the last byte of the fixed 22 byte part, the NAL unit arrays follow
+    const amf_uint32 lengthSize = (pExtraData[21] & 0x3) + 1;
+    AMF_RETURN_IF_FALSE(lengthSize != 3, AMF_INVALID_FORMAT, L"ParseHvcC() - invalid NAL length size");
 
-        unitSize = AV_RB16(extradata);
-        totalSize += unitSize + 4;
-        if (totalSize > INT_MAX - AMF_INPUT_BUFFER_PADDING_SIZE ||
-            extradata + 2 + unitSize > pExtraData + extraDataSize) {
-            free(pOutData);
-            return 1;
-        }
-        tmp = realloc(pOutData, totalSize + AMF_INPUT_BUFFER_PADDING_SIZE);
-        if (!tmp) {
-            free(pOutData);
-            return 1;
-        }
-        pOutData = (amf_uint8*)tmp;
-        memcpy(pOutData + totalSize - unitSize - 4, naluHeader, 4);
-        memcpy(pOutData + totalSize - unitSize, extradata + 2, unitSize);
-        extradata += 2 + unitSize;
-    pps:
-        if (!unitNB && !spsDone++) {
-            unitNB = *extradata++; // number of pps unit(s) 
-            if (unitNB)
-                ppsSeen = 1;
+    amf_uint32 arrayCount = pExtraData[22];
+    const amf_uint8* extradata = pExtraData + 23;
+    while (arrayCount--)
+    {
+        AMF_RETURN_IF_FALSE(extradata + 3 <= pEnd, AMF_INVALID_FORMAT, L"ParseHvcC() - truncated extradata");
+        amf_uint32 unitNB = AV_RB16(extradata + 1);
+        extradata += 3;
+        while (unitNB--)
+        {
+            AMF_RETURN_IF_FALSE(extradata + 2 <= pEnd, AMF_INVALID_FORMAT, L"ParseHvcC() - truncated extradata");
+            const amf_size unitSize = AV_RB16(extradata);
+            AMF_RETURN_IF_FALSE(extradata + 2 + unitSize <= pEnd, AMF_INVALID_FORMAT, L"ParseHvcC() - truncated extradata");
+            m_Headers.insert(m_Headers.end(), naluHeader, naluHeader + 4);
+            m_Headers.insert(m_Headers.end(), extradata + 2, extradata + 2 + unitSize);
+            extradata += 2 + unitSize;
         }
     }
 
-    if (pOutData)
-        memset(pOutData + totalSize, 0, AMF_INPUT_BUFFER_PADDING_SIZE);
-
-    if (!spsSeen){
-        AMFTraceError(AMF_FACILITY, L"ProcessExtradata() - Warning: SPS NALU missing or invalid. The resulting stream may not play. ");
-    }
-    if (!ppsSeen){
-        AMFTraceError(AMF_FACILITY, L"ProcessExtradata() - Warning: PPS NALU missing or invalid. The resulting stream may not play. ");
+    if (m_Headers.empty())
+    {
+        AMFTraceWarning(AMF_FACILITY, L"ParseHvcC() - VPS/SPS/PPS NALUs missing. The resulting stream may not play.");
     }
-    m_pExtradata = pOutData;
-    m_ExtradataSize = totalSize;
-    m_firstIDR = 1;
-    return 0;
+    m_lengthSize = lengthSize;
+    m_codec = CODEC_HEVC;
+    return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
-int H264Mp4ToAnnexB::Filter(amf_uint8** pOutBuf, amf_size* pOutBufSize, amf_uint8* pBuf, amf_size bufSize)
+AMF_RESULT Mp4ToAnnexB::Rewrite(amf_uint8* pBuf, amf_size bufSize, bool bKeyFrame, amf_uint32 flags)
 {
-    amf_uint8 unitType = 0;
-    amf_int32 nalSize = 0;
-    amf_uint32 cumulSize = 0;
-    const amf_uint8* pBufEnd = pBuf + bufSize;
+    m_Segments.clear();
+    m_outputSize = 0;
 
-    // check if data already parocessed - if get annexB streams
-    if (bufSize>4 && memcmp(pBuf, naluHeader, 4) == 0)
-    {
-        *pOutBuf = pBuf;
-        *pOutBufSize = bufSize;
+    AMF_RETURN_IF_FALSE(pBuf != NULL || bufSize == 0, AMF_INVALID_ARG, L"Rewrite() - no data");
 
-        return 0;
+    AMF_RESULT res = AMF_OK;
+    switch (m_codec)
+    {
+    case CODEC_H264:
+    case CODEC_HEVC:
+        res = RewriteNALUs(pBuf, bufSize, bKeyFrame, flags);
+        break;
+    case CODEC_AV1:
+        res = RewriteOBUs(pBuf, bufSize, bKeyFrame, flags);
+        break;
+    default:
+        AddSegment(pBuf, bufSize);
+        break;
     }
-
-
-    /* nothing to filter */
-    if (!m_pExtradata || m_ExtradataSize < 6 || m_lengthSize == 0)
+    if (res != AMF_OK)
     {
-        *pOutBuf = pBuf;
-        *pOutBufSize = bufSize;
-
-        return 0;
+        m_Segments.clear();
+        m_outputSize = 0;
+    }
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Mp4ToAnnexB::RewriteNALUs(amf_uint8* pBuf, amf_size bufSize, bool bKeyFrame, amf_uint32 flags)
+{
+    // check if data already processed - if get annexB streams
+    if (bufSize > 4 && (AV_RB24(pBuf) == 1 || AV_RB32(pBuf) == 1))
+    {
+        AddSegment(pBuf, bufSize);
+        return AMF_OK;
     }
 
-    *pOutBufSize = 0;
-    *pOutBuf = NULL;
-
-    AMF_RESULT res = AMF_OK;
-
-    do
+    // validate the whole packet before touching it, a half rewritten packet can't be passed on
+    const amf_uint8* pBufEnd = pBuf + bufSize;
+    amf_uint8* pPayloadEnd = pBuf;
+    bool bRandomAccess = bKeyFrame;
+    bool bParameterSets = false;
+    for (amf_uint8* p = pBuf; p < pBufEnd; )
     {
-        if (pBuf + m_lengthSize > pBufEnd)
+        AMF_RETURN_IF_FALSE(p + m_lengthSize <= pBufEnd, AMF_INVALID_DATA_TYPE, L"Rewrite() - truncated NAL unit length");
+        amf_size nalSize = 0;
+        for (amf_uint32 i = 0; i < m_lengthSize; i++)
         {
-            res = AMF_FAIL;
-            break;
+            nalSize = (nalSize << 8) | p[i];
         }
-
-        if (m_lengthSize == 1)
+        const amf_uint8* pNal = p + m_lengthSize;
+        // trailing zeros - stop
+        if (nalSize == 0 || (m_codec == CODEC_H264 && (*pNal & 0x1f) == 0))
         {
-            nalSize = pBuf[0];
+            break;
         }
-        else if (m_lengthSize == 2)
+        AMF_RETURN_IF_FALSE(nalSize <= amf_size(pBufEnd - pNal), AMF_INVALID_DATA_TYPE, L"Rewrite() - NAL unit size %d exceeds the packet", (int)nalSize);
+
+        if (m_codec == CODEC_H264)
         {
-            nalSize = AV_RB16(pBuf);
+            const amf_uint8 unitType = *pNal & 0x1f;
+            bRandomAccess |= unitType == H264_NAL_IDR_SLICE;
+            bParameterSets |= unitType == H264_NAL_SPS || unitType == H264_NAL_PPS;
         }
         else
         {
-            nalSize = AV_RB32(pBuf);
+            AMF_RETURN_IF_FALSE(nalSize >= 2, AMF_INVALID_DATA_TYPE, L"Rewrite() - NAL unit too short");
+            const amf_uint8 unitType = (*pNal >> 1) & 0x3f;
+            bRandomAccess |= unitType >= HEVC_NAL_BLA_W_LP && unitType <= HEVC_NAL_RSV_IRAP_VCL23;
+            bParameterSets |= unitType >= HEVC_NAL_VPS && unitType <= HEVC_NAL_PPS;
         }
+        p += m_lengthSize + nalSize;
+        pPayloadEnd = p;
+    }
 
-        pBuf += m_lengthSize;
-        unitType = *pBuf & 0x1f;
+    // out-of-band parameter sets go in front of the first picture and every random access point
+    if ((flags & INSERT_HEADERS) != 0 && (m_bFirst || bRandomAccess) && !bParameterSets && !m_Headers.empty())
+    {
+        AddSegment(&m_Headers[0], m_Headers.size());
+    }
+    m_bFirst = false;
 
-        if (unitType == 0) //MM added this condition to remove trailing zeros
+    const bool bInPlace = (flags & REWRITE_IN_PLACE) != 0 && m_lengthSize == 4;
+    for (amf_uint8* p = pBuf; p < pPayloadEnd; )
+    {
+        amf_size nalSize = 0;
+        for (amf_uint32 i = 0; i < m_lengthSize; i++)
         {
-            break;
+            nalSize = (nalSize << 8) | p[i];
         }
+        if (bInPlace)
+        {
+            // same size as the length prefix - the packet stays one contiguous segment
+            memcpy(p, naluHeader, 4);
+            AddSegment(p, 4 + nalSize);
+        }
+        else
+        {
+            AddSegment(naluHeader, 4);
+            AddSegment(p + m_lengthSize, nalSize);
+        }
+        p += m_lengthSize + nalSize;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT Mp4ToAnnexB::RewriteOBUs(amf_uint8* pBuf, amf_size bufSize, bool bKeyFrame, amf_uint32 flags)
+{
+    // MP4 samples hold low overhead bitstream format OBUs (AV1 spec section 5) without temporal delimiters;
+    // only the last OBU may omit obu_size
+    const amf_uint8* pBufEnd = pBuf + bufSize;
+    bool bTemporalDelimiter = false;
+    bool bSequenceHeader = false;
+    const amf_uint8* pSizeless = NULL;
+    for (const amf_uint8* p = pBuf; p < pBufEnd; )
+    {
+        const amf_uint8 obuHeader = p[0];
+        AMF_RETURN_IF_FALSE((obuHeader & 0x80) == 0, AMF_INVALID_DATA_TYPE, L"Rewrite() - OBU forbidden bit set");
+        const amf_uint8 obuType = (obuHeader >> 3) & 0xf;
+        const amf_size headerSize = (obuHeader & 0x4) != 0 ? 2 : 1;
+        AMF_RETURN_IF_FALSE(p + headerSize <= pBufEnd, AMF_INVALID_DATA_TYPE, L"Rewrite() - truncated OBU header");
 
-        if (pBuf + nalSize > pBufEnd || nalSize < 0)
+        if (p == pBuf)
         {
-            res = AMF_FAIL;
+            bTemporalDelimiter = obuType == AV1_OBU_TEMPORAL_DELIMITER;
         }
+        bSequenceHeader |= obuType == AV1_OBU_SEQUENCE_HEADER;
 
-        /* prepend only to the first type 5 NAL unit of an IDR picture */
-        //MM - 6 comes first in some files - try this
-        //        if (first_idr && unit_type == 5 ) {
-        if (m_firstIDR && (unitType == 5 || unitType == 6 || unitType == 1))
+        if ((obuHeader & 0x2) == 0)
         {
-            if (AllocAndCopy(pOutBufSize, m_pExtradata, m_ExtradataSize, pBuf, nalSize) < 0)
-            {
-                res = AMF_FAIL;
-                break;
-            }
-            m_firstIDR = 0;
+            pSizeless = p;
+            break;
         }
-        else
+        // leb128 obu_size
+        amf_uint64 obuSize = 0;
+        amf_size lebSize = 0;
+        for (;;)
         {
-            if (AllocAndCopy(pOutBufSize, NULL, 0, pBuf, nalSize) < 0)
+            AMF_RETURN_IF_FALSE(lebSize < 8 && p + headerSize + lebSize < pBufEnd, AMF_INVALID_DATA_TYPE, L"Rewrite() - invalid OBU size");
+            const amf_uint8 byte = p[headerSize + lebSize];
+            obuSize |= amf_uint64(byte & 0x7f) << (7 * lebSize);
+            lebSize++;
+            if ((byte & 0x80) == 0)
             {
-                res = AMF_FAIL;
                 break;
             }
         }
-
-        pBuf += nalSize;
-        cumulSize += nalSize + m_lengthSize;
-    } while (cumulSize < bufSize);
-
-    if (res == AMF_OK)
-    {
-        *pOutBuf = m_pOutBuf;
-        return 1;
+        AMF_RETURN_IF_FALSE(obuSize <= amf_uint64(pBufEnd - p - headerSize - lebSize), AMF_INVALID_DATA_TYPE, L"Rewrite() - OBU size exceeds the packet");
+        p += headerSize + lebSize + amf_size(obuSize);
     }
-    else
+
+    if ((flags & INSERT_HEADERS) != 0)
     {
-        if (pOutBuf != NULL)
+        if (!bTemporalDelimiter)
         {
-            free(*pOutBuf);
+            AddSegment(temporalDelimiter, sizeof(temporalDelimiter));
+        }
+        if ((m_bFirst || bKeyFrame) && !bSequenceHeader && !m_Headers.empty())
+        {
+            AddSegment(&m_Headers[0], m_Headers.size());
         }
-
-        *pOutBufSize = 0;
-
-        return 0;
     }
+    m_bFirst = false;
 
+    if (pSizeless == NULL)
+    {
+        AddSegment(pBuf, bufSize);
+        return AMF_OK;
+    }
 
+    // everything before the last OBU passes through, the last one gets its obu_size written out
+    AddSegment(pBuf, pSizeless - pBuf);
+    const amf_size headerSize = (pSizeless[0] & 0x4) != 0 ? 2 : 1;
+    amf_size obuSize = pBufEnd - pSizeless - headerSize;
+    memcpy(m_OBUHeader, pSizeless, headerSize);
+    m_OBUHeader[0] |= 0x2;
+    amf_size pos = headerSize;
+    do
+    {
+        m_OBUHeader[pos] = amf_uint8(obuSize & 0x7f);
+        obuSize >>= 7;
+        if (obuSize != 0)
+        {
+            m_OBUHeader[pos] |= 0x80;
+        }
+        pos++;
+    } while (obuSize != 0);
+    AddSegment(m_OBUHeader, pos);
+    AddSegment(pSizeless + headerSize, pBufEnd - pSizeless - headerSize);
+    return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
-int H264Mp4ToAnnexB::AllocAndCopy(amf_size* pOutBufSize, const amf_uint8* pSpsPps, amf_size spsPpsSize, const amf_uint8* pInData, amf_size inDataSize)
+void Mp4ToAnnexB::AddSegment(const amf_uint8* pData, amf_size size)
 {
-    amf_size offset = *pOutBufSize;
-    amf_uint8 nal_header_size = offset ? 3 : 4;
-
-    *pOutBufSize += spsPpsSize + inDataSize + nal_header_size;
-
-    if (*pOutBufSize > m_outBufSize) //MM fast realloc
-    {
-        m_pOutBuf = reinterpret_cast<amf_uint8*>(realloc(m_pOutBuf, *pOutBufSize));
-        m_outBufSize = *pOutBufSize;
-    }
-    if (!m_pOutBuf)
-    {
-        return -1;
-    }
-
-    if (pSpsPps)
+    if (size == 0)
     {
-        memcpy(m_pOutBuf + offset, pSpsPps, spsPpsSize);
+        return;
     }
-
-    memcpy(m_pOutBuf + spsPpsSize + nal_header_size + offset, pInData, inDataSize);
-
-    if (!offset)
+    m_outputSize += size;
+    if (!m_Segments.empty() && m_Segments.back().pData + m_Segments.back().size == pData)
     {
-        AV_WB32(m_pOutBuf + spsPpsSize, 1);
+        m_Segments.back().size += size;
+        return;
     }
-    else
+    Segment segment = { pData, size };
+    m_Segments.push_back(segment);
+}
+//-------------------------------------------------------------------------------------------------
+void Mp4ToAnnexB::Gather(amf_uint8* pDst) const
+{
+    for (amf_vector<Segment>::const_iterator it = m_Segments.begin(); it != m_Segments.end(); ++it)
     {
-        (m_pOutBuf + offset + spsPpsSize)[0] = 0;
-        (m_pOutBuf + offset + spsPpsSize)[1] = 0;
-        (m_pOutBuf + offset + spsPpsSize)[2] = 1;
+        memcpy(pDst, it->pData, it->size);
+        pDst += it->size;
     }
-
-    return 0;
 }
 //-------------------------------------------------------------------------------------------------
-#endif// __USE_H264Mp4ToAnnexB
\ No newline at end of file
+#endif
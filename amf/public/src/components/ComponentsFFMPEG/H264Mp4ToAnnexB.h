@@ -33,6 +33,7 @@
 #pragma once
 
 #include "public/include/components/Component.h"
+#include "public/common/AMFSTL.h"
 
 #define __USE_H264Mp4ToAnnexB
 
@@ -41,34 +42,76 @@ namespace amf
 
     //-------------------------------------------------------------------------------------------------
 #ifdef __USE_H264Mp4ToAnnexB
-    class H264Mp4ToAnnexB
+    // rewrites MP4 sample framing (avcC / hvcC length prefixes, av1C OBUs) into an elementary stream
+    // the output is a scatter list pointing into the input packet, the parameter sets and a few
+    // static start codes - the payload is never copied
+    class Mp4ToAnnexB
     {
     public:
-        H264Mp4ToAnnexB();
-        ~H264Mp4ToAnnexB();
+        enum Codec
+        {
+            CODEC_UNKNOWN = 0,
+            CODEC_H264,
+            CODEC_HEVC,
+            CODEC_AV1,
+        };
 
-        int ProcessExtradata(const amf_uint8* pExtraData, amf_size extraDataSize);
-        int Filter(amf_uint8** pOutBuf, amf_size* pOutBufSize, amf_uint8* pBuf, amf_size bufSize);
+        enum Flags
+        {
+            REWRITE_IN_PLACE    = 0x1,  // 4 byte length prefixes are overwritten by start codes, the packet stays contiguous
+            INSERT_HEADERS      = 0x2,  // parameter sets / sequence header before random access points, AV1 temporal delimiters
+        };
 
-        void*  GetExtraData()      { return m_pExtradata; }
-        size_t GetExtraDataSize()  { return m_ExtradataSize; }
+        struct Segment
+        {
+            const amf_uint8*    pData;
+            amf_size            size;
+        };
+
+        Mp4ToAnnexB();
+        ~Mp4ToAnnexB();
+
+        // parses avcC / hvcC / av1C extradata; anything else leaves the rewriter inactive
+        AMF_RESULT  Init(Codec codec, const amf_uint8* pExtraData, amf_size extraDataSize);
+        void        Terminate();
+        void        Reset();    // the next packet gets the headers again, e.g. after a seek
+
+        bool        IsActive() const            { return m_codec != CODEC_UNKNOWN; }
+        amf_uint32  GetLengthSize() const       { return m_lengthSize; }
+
+        // parameter sets in Annex B form, the AV1 config OBUs as stored in av1C
+        const amf_uint8*    GetHeaders() const      { return m_Headers.empty() ? NULL : &m_Headers[0]; }
+        amf_size            GetHeadersSize() const  { return m_Headers.size(); }
+
+        // the segments stay valid until the next call or until the packet is released
+        AMF_RESULT  Rewrite(amf_uint8* pBuf, amf_size bufSize, bool bKeyFrame, amf_uint32 flags);
+
+        const Segment*  GetSegments() const     { return m_Segments.empty() ? NULL : &m_Segments[0]; }
+        amf_size        GetSegmentCount() const { return m_Segments.size(); }
+        amf_size        GetOutputSize() const   { return m_outputSize; }
+        void            Gather(amf_uint8* pDst) const;
 
     protected:
-        int AllocAndCopy(amf_size* pOutBufSize, const amf_uint8* pSpsPps, amf_size spsPpsSize, const amf_uint8* pInData, amf_size inDataSize);
+        AMF_RESULT  ParseAvcC(const amf_uint8* pExtraData, amf_size extraDataSize);
+        AMF_RESULT  ParseHvcC(const amf_uint8* pExtraData, amf_size extraDataSize);
+        AMF_RESULT  RewriteNALUs(amf_uint8* pBuf, amf_size bufSize, bool bKeyFrame, amf_uint32 flags);
+        AMF_RESULT  RewriteOBUs(amf_uint8* pBuf, amf_size bufSize, bool bKeyFrame, amf_uint32 flags);
+        void        AddSegment(const amf_uint8* pData, amf_size size);
 
     private:
-        H264Mp4ToAnnexB(const H264Mp4ToAnnexB&);
-        H264Mp4ToAnnexB& operator=(const H264Mp4ToAnnexB&);
+        Mp4ToAnnexB(const Mp4ToAnnexB&);
+        Mp4ToAnnexB& operator=(const Mp4ToAnnexB&);
 
     private:
-        amf_uint8  m_lengthSize;
-        amf_uint8  m_firstIDR;
-        amf_uint8  *m_pExtradata;
-        amf_size   m_ExtradataSize;
-        amf_uint8  *m_pOutBuf;
-        amf_size   m_outBufSize;
+        Codec                   m_codec;
+        amf_uint32              m_lengthSize;
+        bool                    m_bFirst;
+        amf_vector<amf_uint8>   m_Headers;
+        amf_vector<Segment>     m_Segments;     // capacity is kept between packets
+        amf_size                m_outputSize;
+        amf_uint8               m_OBUHeader[10];// AV1 OBU header + leb128 size for an OBU stored without a size field
     };
 #endif
 
 
-}
\ No newline at end of file
+}
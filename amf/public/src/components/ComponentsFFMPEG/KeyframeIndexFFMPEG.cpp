@@ -0,0 +1,286 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "KeyframeIndexFFMPEG.h"
+#include "public/common/DataStream.h"
+#include "public/common/TraceAdapter.h"
+
+#include <algorithm>
+
+#define AMF_FACILITY L"AMFKeyframeIndexFFMPEG"
+
+using namespace amf;
+
+static const char       INDEX_FILE_MAGIC[8] = { 'A', 'M', 'F', 'K', 'F', 'I', 'X', '1' };
+static const amf_int64  INDEX_FILE_MAX_SIZE = 256 * 1024 * 1024;
+
+namespace
+{
+    struct EntryDtsLess
+    {
+        bool operator()(const AMFKeyframeIndexFFMPEG::Entry& entry, amf_int64 dts) const { return entry.dts < dts; }
+        bool operator()(amf_int64 dts, const AMFKeyframeIndexFFMPEG::Entry& entry) const { return dts < entry.dts; }
+    };
+
+    template<typename T>
+    void WriteValue(amf_vector<amf_uint8>& data, T value)
+    {
+        const amf_uint8* pValue = reinterpret_cast<const amf_uint8*>(&value);
+        data.insert(data.end(), pValue, pValue + sizeof(T));
+    }
+
+    template<typename T>
+    bool ReadValue(const amf_vector<amf_uint8>& data, amf_size& offset, T& value)
+    {
+        if (offset + sizeof(T) > data.size())
+        {
+            return false;
+        }
+        memcpy(&value, &data[offset], sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+AMFKeyframeIndexFFMPEG::AMFKeyframeIndexFFMPEG()
+    : m_bModified(false)
+{
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndexFFMPEG::Reset(amf_int32 streamCount)
+{
+    m_Streams.clear();
+    m_Streams.resize(streamCount > 0 ? streamCount : 0);
+    for (amf_size i = 0; i < m_Streams.size(); i++)
+    {
+        m_Streams[i].iCursor = -1;
+        m_Streams[i].bEofLinked = false;
+    }
+    m_bModified = false;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndexFFMPEG::BreakRun()
+{
+    for (amf_size i = 0; i < m_Streams.size(); i++)
+    {
+        m_Streams[i].iCursor = -1;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndexFFMPEG::Add(amf_int32 stream, amf_int64 dts, amf_int64 pos)
+{
+    if (stream < 0 || stream >= (amf_int32)m_Streams.size())
+    {
+        return;
+    }
+    StreamIndex& index = m_Streams[stream];
+    amf_vector<Entry>& entries = index.entries;
+
+    amf_vector<Entry>::iterator it = std::lower_bound(entries.begin(), entries.end(), dts, EntryDtsLess());
+    const amf_int64 i = it - entries.begin();
+    bool bInserted = false;
+    if (it == entries.end() || it->dts != dts)
+    {
+        if (it == entries.end())
+        {
+            index.bEofLinked = false;
+        }
+        Entry entry = { dts, pos, false };
+        entries.insert(it, entry);
+        if (index.iCursor >= i)
+        {
+            index.iCursor = -1; // timestamps went backwards - don't link across
+        }
+        bInserted = true;
+        m_bModified = true;
+    }
+
+    // linked when read right after the previous keyframe; a new keyframe showing up inside
+    // a linked gap means timestamps differ between runs, so that gap is not trusted anymore
+    if (i > 0)
+    {
+        const bool bLinked = (index.iCursor == i - 1) || (!bInserted && entries[i - 1].bLinked);
+        if (entries[i - 1].bLinked != bLinked)
+        {
+            entries[i - 1].bLinked = bLinked;
+            m_bModified = true;
+        }
+    }
+    index.iCursor = i;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndexFFMPEG::MarkEof()
+{
+    for (amf_size i = 0; i < m_Streams.size(); i++)
+    {
+        StreamIndex& index = m_Streams[i];
+        if (!index.entries.empty() && index.iCursor == (amf_int64)index.entries.size() - 1 && !index.bEofLinked)
+        {
+            index.bEofLinked = true;
+            m_bModified = true;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFKeyframeIndexFFMPEG::Find(amf_int32 stream, amf_int64 dts, bool bBackward, Entry& entry) const
+{
+    if (stream < 0 || stream >= (amf_int32)m_Streams.size())
+    {
+        return false;
+    }
+    const StreamIndex& index = m_Streams[stream];
+    const amf_vector<Entry>& entries = index.entries;
+    if (entries.empty())
+    {
+        return false;
+    }
+
+    if (bBackward)
+    {
+        amf_vector<Entry>::const_iterator it = std::upper_bound(entries.begin(), entries.end(), dts, EntryDtsLess());
+        if (it == entries.begin())
+        {
+            return false;
+        }
+        --it;
+        const bool bLast = (it + 1 == entries.end());
+        if (bLast ? !index.bEofLinked : !it->bLinked)
+        {
+            return false;
+        }
+        entry = *it;
+        return true;
+    }
+
+    amf_vector<Entry>::const_iterator it = std::lower_bound(entries.begin(), entries.end(), dts, EntryDtsLess());
+    if (it == entries.end() || it == entries.begin() || !(it - 1)->bLinked)
+    {
+        return false;
+    }
+    entry = *it;
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndexFFMPEG::Load(const wchar_t* pPath, amf_int64 fileSize, amf_int64 duration)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pPath, L"Load() - path not passed in");
+
+    AMFDataStreamPtr pStream;
+    AMF_RESULT res = AMFDataStream::OpenDataStream(pPath, AMFSO_READ, AMFFS_SHARE_READ, &pStream);
+    if (res != AMF_OK)
+    {
+        return AMF_NOT_FOUND; // no sidecar yet
+    }
+    amf_int64 size = 0;
+    AMF_RETURN_IF_FAILED(pStream->GetSize(&size), L"Load() - GetSize() failed");
+    AMF_RETURN_IF_FALSE(size > 0 && size < INDEX_FILE_MAX_SIZE, AMF_INVALID_DATA_TYPE, L"Load() - invalid index file size %" LPRId64, size);
+
+    amf_vector<amf_uint8> data((amf_size)size);
+    amf_size read = 0;
+    AMF_RETURN_IF_FAILED(pStream->Read(&data[0], data.size(), &read), L"Load() - Read() failed");
+    AMF_RETURN_IF_FALSE(read == data.size(), AMF_INVALID_DATA_TYPE, L"Load() - index file truncated");
+
+    AMF_RETURN_IF_FALSE(data.size() > sizeof(INDEX_FILE_MAGIC) && memcmp(&data[0], INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC)) == 0,
+        AMF_INVALID_DATA_TYPE, L"Load() - not a keyframe index file");
+    amf_size offset = sizeof(INDEX_FILE_MAGIC);
+
+    amf_int64 fileSizeSaved = 0;
+    amf_int64 durationSaved = 0;
+    amf_int32 streamCount = 0;
+    AMF_RETURN_IF_FALSE(ReadValue(data, offset, fileSizeSaved) && ReadValue(data, offset, durationSaved) && ReadValue(data, offset, streamCount),
+        AMF_INVALID_DATA_TYPE, L"Load() - index file truncated");
+    // written for another version of the media file
+    if (fileSizeSaved != fileSize || durationSaved != duration || streamCount != (amf_int32)m_Streams.size())
+    {
+        return AMF_NOT_FOUND;
+    }
+
+    amf_vector<StreamIndex> streams(m_Streams.size());
+    for (amf_size s = 0; s < streams.size(); s++)
+    {
+        amf_int32 bEofLinked = 0;
+        amf_int64 count = 0;
+        AMF_RETURN_IF_FALSE(ReadValue(data, offset, bEofLinked) && ReadValue(data, offset, count), AMF_INVALID_DATA_TYPE, L"Load() - index file truncated");
+        AMF_RETURN_IF_FALSE(count >= 0 && count <= (amf_int64)((data.size() - offset) / (2 * sizeof(amf_int64) + sizeof(amf_int32))),
+            AMF_INVALID_DATA_TYPE, L"Load() - invalid entry count");
+
+        streams[s].iCursor = -1;
+        streams[s].bEofLinked = bEofLinked != 0;
+        streams[s].entries.resize((amf_size)count);
+        for (amf_size i = 0; i < streams[s].entries.size(); i++)
+        {
+            Entry& entry = streams[s].entries[i];
+            amf_int32 bLinked = 0;
+            AMF_RETURN_IF_FALSE(ReadValue(data, offset, entry.dts) && ReadValue(data, offset, entry.pos) && ReadValue(data, offset, bLinked),
+                AMF_INVALID_DATA_TYPE, L"Load() - index file truncated");
+            entry.bLinked = bLinked != 0;
+            AMF_RETURN_IF_FALSE(i == 0 || streams[s].entries[i - 1].dts < entry.dts, AMF_INVALID_DATA_TYPE, L"Load() - entries not sorted");
+        }
+    }
+
+    m_Streams.swap(streams);
+    m_bModified = false;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndexFFMPEG::Save(const wchar_t* pPath, amf_int64 fileSize, amf_int64 duration)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pPath, L"Save() - path not passed in");
+
+    amf_vector<amf_uint8> data;
+    data.insert(data.end(), INDEX_FILE_MAGIC, INDEX_FILE_MAGIC + sizeof(INDEX_FILE_MAGIC));
+    WriteValue(data, fileSize);
+    WriteValue(data, duration);
+    WriteValue(data, (amf_int32)m_Streams.size());
+    for (amf_size s = 0; s < m_Streams.size(); s++)
+    {
+        const StreamIndex& index = m_Streams[s];
+        WriteValue(data, (amf_int32)(index.bEofLinked ? 1 : 0));
+        WriteValue(data, (amf_int64)index.entries.size());
+        for (amf_size i = 0; i < index.entries.size(); i++)
+        {
+            WriteValue(data, index.entries[i].dts);
+            WriteValue(data, index.entries[i].pos);
+            WriteValue(data, (amf_int32)(index.entries[i].bLinked ? 1 : 0));
+        }
+    }
+
+    AMFDataStreamPtr pStream;
+    AMF_RETURN_IF_FAILED(AMFDataStream::OpenDataStream(pPath, AMFSO_WRITE, AMFFS_EXCLUSIVE, &pStream), L"Save() - failed to open %s", pPath);
+    amf_size written = 0;
+    AMF_RETURN_IF_FAILED(pStream->Write(&data[0], data.size(), &written), L"Save() - Write() failed");
+    AMF_RETURN_IF_FALSE(written == data.size(), AMF_FAIL, L"Save() - short write");
+
+    m_bModified = false;
+    return AMF_OK;
+}
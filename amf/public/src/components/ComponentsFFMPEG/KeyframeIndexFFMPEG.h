@@ -0,0 +1,89 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// per stream index of keyframe timestamps and byte offsets collected while packets are read,
+// so the demuxer can seek straight onto the keyframe preceding a position; can be persisted
+// into a sidecar file to skip the collection on the next open of the same file
+#pragma once
+
+#include "public/include/core/Result.h"
+#include "public/common/AMFSTL.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Entries are only trusted when the run of packets between them was read without a jump:
+    // a keyframe is "linked" to the next one when both were read in one sequential run, which
+    // proves there is no other keyframe in between. Lookups that end in an unlinked gap fail
+    // and the caller falls back to a regular libavformat seek.
+    //-------------------------------------------------------------------------------------------------
+    class AMFKeyframeIndexFFMPEG
+    {
+    public:
+        struct Entry
+        {
+            amf_int64   dts;        // in stream time base, as returned by libavformat
+            amf_int64   pos;        // byte offset of the packet in the file
+            bool        bLinked;    // the next entry was read right after this one
+        };
+
+        AMFKeyframeIndexFFMPEG();
+
+        void        Reset(amf_int32 streamCount);
+        // the read position jumped - the next Add() does not link to the previous keyframe
+        void        BreakRun();
+        void        Add(amf_int32 stream, amf_int64 dts, amf_int64 pos);
+        // the run reached the end of the file - no keyframes follow the last ones read
+        void        MarkEof();
+
+        // bBackward: last keyframe at or before dts, otherwise first keyframe at or after dts;
+        // succeeds only when the index proves there is no closer keyframe
+        bool        Find(amf_int32 stream, amf_int64 dts, bool bBackward, Entry& entry) const;
+
+        bool        IsModified() const      { return m_bModified; }
+
+        // fileSize and duration identify the media file the sidecar was written for
+        AMF_RESULT  Load(const wchar_t* pPath, amf_int64 fileSize, amf_int64 duration);
+        AMF_RESULT  Save(const wchar_t* pPath, amf_int64 fileSize, amf_int64 duration);
+
+    private:
+        struct StreamIndex
+        {
+            amf_vector<Entry>   entries;
+            amf_int64           iCursor;    // entry read last in the current run, -1 if none
+            bool                bEofLinked; // the last entry was followed by the end of file
+        };
+
+        amf_vector<StreamIndex>     m_Streams;
+        bool                        m_bModified;
+    };
+} // namespace amf
@@ -0,0 +1,141 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "PacketBufferFFMPEG.h"
+#include "public/common/TraceAdapter.h"
+
+#define AMF_FACILITY L"AMFPacketBufferPoolFFMPEG"
+
+using namespace amf;
+
+// holders kept for reuse; anything released beyond this is freed
+static const amf_size MAX_FREE_HOLDERS = 64;
+
+//-------------------------------------------------------------------------------------------------
+class AMFPacketBufferPoolFFMPEG::PacketHolder : public AMFBufferObserver
+{
+public:
+    PacketHolder() : m_pPacket(av_packet_alloc())
+    {
+    }
+    virtual ~PacketHolder()
+    {
+        av_packet_free(&m_pPacket);
+    }
+    virtual void AMF_STD_CALL OnBufferDataRelease(AMFBuffer* /*pBuffer*/) override
+    {
+        av_packet_unref(m_pPacket);
+
+        // the pool can go away together with its last outstanding buffer and
+        // take this holder with it, so nothing may touch members after this
+        AMFPacketBufferPoolFFMPEG* pPool = m_pPool.Detach();
+        pPool->ReturnHolder(this);
+        pPool->Release();
+    }
+
+    AVPacket*                       m_pPacket;
+    AMFPacketBufferPoolFFMPEGPtr    m_pPool;
+};
+//-------------------------------------------------------------------------------------------------
+AMFPacketBufferPoolFFMPEG::AMFPacketBufferPoolFFMPEG()
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMFPacketBufferPoolFFMPEG::~AMFPacketBufferPoolFFMPEG()
+{
+    for (amf_vector<PacketHolder*>::iterator it = m_freeHolders.begin(); it != m_freeHolders.end(); ++it)
+    {
+        delete *it;
+    }
+    m_freeHolders.clear();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFPacketBufferPoolFFMPEG::WrapPacket(AMFContext* pContext, AVPacket* pPacket, AMFBuffer** ppBuffer)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pContext, L"WrapPacket() - context not passed in");
+    AMF_RETURN_IF_INVALID_POINTER(pPacket, L"WrapPacket() - packet not passed in");
+    AMF_RETURN_IF_INVALID_POINTER(ppBuffer, L"WrapPacket() - buffer pointer not passed in");
+
+    // packets without an AVBufferRef point into demuxer / encoder internals,
+    // give those their own padded buffer before anybody else holds on to them
+    if (pPacket->buf == nullptr)
+    {
+        AMF_RETURN_IF_FALSE(av_packet_make_refcounted(pPacket) >= 0, AMF_OUT_OF_MEMORY, L"WrapPacket() - av_packet_make_refcounted failed");
+    }
+
+    PacketHolder* pHolder = nullptr;
+    {
+        AMFLock lock(&m_sync);
+        if (m_freeHolders.empty() == false)
+        {
+            pHolder = m_freeHolders.back();
+            m_freeHolders.pop_back();
+        }
+    }
+    if (pHolder == nullptr)
+    {
+        pHolder = new PacketHolder();
+        if (pHolder->m_pPacket == nullptr)
+        {
+            delete pHolder;
+            pHolder = nullptr;
+        }
+    }
+    AMF_RETURN_IF_FALSE(pHolder != nullptr, AMF_OUT_OF_MEMORY, L"WrapPacket() - av_packet_alloc failed");
+
+    // the data pointer survives the move below, and nothing can release
+    // the buffer before we return it, so the holder can be filled afterwards
+    AMF_RESULT err = pContext->CreateBufferFromHostNative(pPacket->data, pPacket->size, ppBuffer, pHolder);
+    if (err != AMF_OK)
+    {
+        ReturnHolder(pHolder);
+        AMF_RETURN_IF_FAILED(err, L"WrapPacket() - CreateBufferFromHostNative failed");
+    }
+
+    pHolder->m_pPool = this;
+    av_packet_move_ref(pHolder->m_pPacket, pPacket);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL AMFPacketBufferPoolFFMPEG::ReturnHolder(PacketHolder* pHolder)
+{
+    {
+        AMFLock lock(&m_sync);
+        if (m_freeHolders.size() < MAX_FREE_HOLDERS)
+        {
+            m_freeHolders.push_back(pHolder);
+            return;
+        }
+    }
+    delete pHolder;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// host AMFBuffers that reference the payload of a ref-counted AVPacket instead of copying it;
+// used by the demuxer for packets coming out of libavformat and by the encoders for packets
+// coming out of libavcodec
+#pragma once
+
+#include "public/include/core/Context.h"
+#include "public/common/InterfaceImpl.h"
+#include "public/common/Thread.h"
+#include "public/common/AMFSTL.h"
+
+extern "C"
+{
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4244)
+#endif
+
+    #include "libavcodec/avcodec.h"
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+}
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // The buffers are created with AMFContext::CreateBufferFromHostNative, so downstream components
+    // see an ordinary runtime buffer. The AVPacket reference is kept by a holder that is the buffer
+    // observer and is dropped when the runtime releases the buffer data. Holders are recycled, so
+    // in steady state wrapping a packet costs no heap allocation on our side.
+    //-------------------------------------------------------------------------------------------------
+    class AMFPacketBufferPoolFFMPEG : public AMFInterfaceImpl<AMFInterface>
+    {
+    public:
+        AMFPacketBufferPoolFFMPEG();
+        virtual ~AMFPacketBufferPoolFFMPEG();
+
+        // takes over the reference held by pPacket - on success pPacket is left blank
+        AMF_RESULT AMF_STD_CALL WrapPacket(AMFContext* pContext, AVPacket* pPacket, AMFBuffer** ppBuffer);
+
+    private:
+        class PacketHolder;
+        friend class PacketHolder;
+
+        void AMF_STD_CALL ReturnHolder(PacketHolder* pHolder);
+
+        AMFCriticalSection          m_sync;
+        amf_vector<PacketHolder*>   m_freeHolders;
+    };
+    typedef AMFInterfacePtr_T<AMFPacketBufferPoolFFMPEG>    AMFPacketBufferPoolFFMPEGPtr;
+} // namespace amf
@@ -0,0 +1,479 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "PixelRepack.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || (defined(__i386__) && defined(__SSE2__))
+    #define REPACK_SIMD_X86
+    #include <immintrin.h>
+    #include "public/common/CPUCaps.h"
+    #if defined(_MSC_VER)
+        #define REPACK_TARGET_SSSE3
+        #define REPACK_TARGET_AVX2
+    #else
+        #define REPACK_TARGET_SSSE3 __attribute__((target("ssse3")))
+        #define REPACK_TARGET_AVX2  __attribute__((target("avx2")))
+    #endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define REPACK_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+using namespace amf;
+
+#if defined(REPACK_SIMD_X86)
+// CPUCaps.h declares the cpuid snapshot but leaves its definition to one translation unit
+const InstructionSet::InstructionSet_Internal InstructionSet::CPU_Rep;
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// scalar reference: the loops VideoDecoderFFMPEGImpl used before, also used for the SIMD tails
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV8_Scalar(const amf_uint8* pU, const amf_uint8* pV, amf_uint8* pUV, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        *pUV++ = *pU++;
+        *pUV++ = *pV++;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV16_Scalar(const amf_uint16* pU, const amf_uint16* pV, amf_uint16* pUV, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        *pUV++ = amf_uint16(*pU++ << shift);
+        *pUV++ = amf_uint16(*pV++ << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void ShiftLeft16_Scalar(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[x] = amf_uint16(pIn[x] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48ToRGBA8_Scalar(const amf_uint8* pIn, amf_uint8* pOut, amf_size count, bool bBigEndian)
+{
+    // keep the most significant byte of every component
+    const amf_size msb = bBigEndian ? 0 : 1;
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[4 * x + 0] = pIn[6 * x + 0 + msb];
+        pOut[4 * x + 1] = pIn[6 * x + 2 + msb];
+        pOut[4 * x + 2] = pIn[6 * x + 4 + msb];
+        pOut[4 * x + 3] = 255;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGBA64ToRGBA8_Scalar(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pOut[4 * x + 0] = pIn[8 * x + 1];
+        pOut[4 * x + 1] = pIn[8 * x + 3];
+        pOut[4 * x + 2] = pIn[8 * x + 5];
+        pOut[4 * x + 3] = pIn[8 * x + 7];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48ToRGBA16_Scalar(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, bool bBigEndian)
+{
+    if (bBigEndian)
+    {
+        const amf_uint8* pBytes = (const amf_uint8*)pIn;
+        for (amf_size x = 0; x < count; x++)
+        {
+            pOut[4 * x + 0] = amf_uint16((pBytes[6 * x + 0] << 8) | pBytes[6 * x + 1]);
+            pOut[4 * x + 1] = amf_uint16((pBytes[6 * x + 2] << 8) | pBytes[6 * x + 3]);
+            pOut[4 * x + 2] = amf_uint16((pBytes[6 * x + 4] << 8) | pBytes[6 * x + 5]);
+            pOut[4 * x + 3] = 65535;
+        }
+    }
+    else
+    {
+        for (amf_size x = 0; x < count; x++)
+        {
+            pOut[4 * x + 0] = pIn[3 * x + 0];
+            pOut[4 * x + 1] = pIn[3 * x + 1];
+            pOut[4 * x + 2] = pIn[3 * x + 2];
+            pOut[4 * x + 3] = 65535;
+        }
+    }
+}
+
+#if defined(REPACK_SIMD_X86)
+//-------------------------------------------------------------------------------------------------
+// SSE2
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV8_SSE2(const amf_uint8* pU, const amf_uint8* pV, amf_uint8* pUV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i u = _mm_loadu_si128((const __m128i*)(pU + x));
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pV + x));
+        _mm_storeu_si128((__m128i*)(pUV + 2 * x), _mm_unpacklo_epi8(u, v));
+        _mm_storeu_si128((__m128i*)(pUV + 2 * x + 16), _mm_unpackhi_epi8(u, v));
+    }
+    InterleaveUV8_Scalar(pU + x, pV + x, pUV + 2 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV16_SSE2(const amf_uint16* pU, const amf_uint16* pV, amf_uint16* pUV, amf_size count, amf_int32 shift)
+{
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i u = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pU + x)), shiftCount);
+        const __m128i v = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pV + x)), shiftCount);
+        _mm_storeu_si128((__m128i*)(pUV + 2 * x), _mm_unpacklo_epi16(u, v));
+        _mm_storeu_si128((__m128i*)(pUV + 2 * x + 8), _mm_unpackhi_epi16(u, v));
+    }
+    InterleaveUV16_Scalar(pU + x, pV + x, pUV + 2 * x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+static void ShiftLeft16_SSE2(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, amf_int32 shift)
+{
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(pIn + x));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(pIn + x + 8));
+        _mm_storeu_si128((__m128i*)(pOut + x), _mm_sll_epi16(a, shiftCount));
+        _mm_storeu_si128((__m128i*)(pOut + x + 8), _mm_sll_epi16(b, shiftCount));
+    }
+    ShiftLeft16_Scalar(pIn + x, pOut + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+static void RGBA64ToRGBA8_SSE2(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        const __m128i a = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(pIn + 8 * x)), 8);
+        const __m128i b = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(pIn + 8 * x + 16)), 8);
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x), _mm_packus_epi16(a, b));
+    }
+    RGBA64ToRGBA8_Scalar(pIn + 8 * x, pOut + 4 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+// SSSE3: RGB48 is handled 8 pixels (48 bytes) at a time as four 12-byte windows of two pixels;
+// the last window is loaded from byte 32 so that nothing past the 8 pixels is read
+//-------------------------------------------------------------------------------------------------
+REPACK_TARGET_SSSE3
+static void RGB48ToRGBA8_SSSE3(const amf_uint8* pIn, amf_uint8* pOut, amf_size count, bool bBigEndian)
+{
+    const char m = bBigEndian ? 0 : 1;
+    const char z = char(0x80);
+    const __m128i shuffle     = _mm_setr_epi8(m, m + 2, m + 4, z, m + 6, m + 8, m + 10, z, z, z, z, z, z, z, z, z);
+    const __m128i shuffleLast = _mm_setr_epi8(m + 4, m + 6, m + 8, z, m + 10, m + 12, m + 14, z, z, z, z, z, z, z, z, z);
+    const __m128i alpha       = _mm_set1_epi32(int(0xFF000000));
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const amf_uint8* pSrc = pIn + 6 * x;
+        const __m128i p01 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 0)), shuffle);
+        const __m128i p23 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 12)), shuffle);
+        const __m128i p45 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 24)), shuffle);
+        const __m128i p67 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 32)), shuffleLast);
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x), _mm_or_si128(_mm_unpacklo_epi64(p01, p23), alpha));
+        _mm_storeu_si128((__m128i*)(pOut + 4 * x + 16), _mm_or_si128(_mm_unpacklo_epi64(p45, p67), alpha));
+    }
+    RGB48ToRGBA8_Scalar(pIn + 6 * x, pOut + 4 * x, count - x, bBigEndian);
+}
+//-------------------------------------------------------------------------------------------------
+REPACK_TARGET_SSSE3
+static void RGB48ToRGBA16_SSSE3(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, bool bBigEndian)
+{
+    const char z = char(0x80);
+    const __m128i shuffle = bBigEndian ?
+        _mm_setr_epi8(1, 0, 3, 2, 5, 4, z, z, 7, 6, 9, 8, 11, 10, z, z) :
+        _mm_setr_epi8(0, 1, 2, 3, 4, 5, z, z, 6, 7, 8, 9, 10, 11, z, z);
+    const __m128i shuffleLast = bBigEndian ?
+        _mm_setr_epi8(5, 4, 7, 6, 9, 8, z, z, 11, 10, 13, 12, 15, 14, z, z) :
+        _mm_setr_epi8(4, 5, 6, 7, 8, 9, z, z, 10, 11, 12, 13, 14, 15, z, z);
+    const __m128i alpha = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const amf_uint8* pSrc = (const amf_uint8*)(pIn + 3 * x);
+        __m128i* pDst = (__m128i*)(pOut + 4 * x);
+        _mm_storeu_si128(pDst + 0, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 0)), shuffle), alpha));
+        _mm_storeu_si128(pDst + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 12)), shuffle), alpha));
+        _mm_storeu_si128(pDst + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 24)), shuffle), alpha));
+        _mm_storeu_si128(pDst + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 32)), shuffleLast), alpha));
+    }
+    RGB48ToRGBA16_Scalar(pIn + 3 * x, pOut + 4 * x, count - x, bBigEndian);
+}
+//-------------------------------------------------------------------------------------------------
+// AVX2: unpack works within 128-bit lanes, so results are put back in order with lane permutes
+//-------------------------------------------------------------------------------------------------
+REPACK_TARGET_AVX2
+static void InterleaveUV8_AVX2(const amf_uint8* pU, const amf_uint8* pV, amf_uint8* pUV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        const __m256i u = _mm256_loadu_si256((const __m256i*)(pU + x));
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(pV + x));
+        const __m256i lo = _mm256_unpacklo_epi8(u, v);
+        const __m256i hi = _mm256_unpackhi_epi8(u, v);
+        _mm256_storeu_si256((__m256i*)(pUV + 2 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(pUV + 2 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    InterleaveUV8_SSE2(pU + x, pV + x, pUV + 2 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+REPACK_TARGET_AVX2
+static void InterleaveUV16_AVX2(const amf_uint16* pU, const amf_uint16* pV, amf_uint16* pUV, amf_size count, amf_int32 shift)
+{
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m256i u = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pU + x)), shiftCount);
+        const __m256i v = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pV + x)), shiftCount);
+        const __m256i lo = _mm256_unpacklo_epi16(u, v);
+        const __m256i hi = _mm256_unpackhi_epi16(u, v);
+        _mm256_storeu_si256((__m256i*)(pUV + 2 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(pUV + 2 * x + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    InterleaveUV16_SSE2(pU + x, pV + x, pUV + 2 * x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+REPACK_TARGET_AVX2
+static void ShiftLeft16_AVX2(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, amf_int32 shift)
+{
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(pIn + x));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(pIn + x + 16));
+        _mm256_storeu_si256((__m256i*)(pOut + x), _mm256_sll_epi16(a, shiftCount));
+        _mm256_storeu_si256((__m256i*)(pOut + x + 16), _mm256_sll_epi16(b, shiftCount));
+    }
+    ShiftLeft16_SSE2(pIn + x, pOut + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+REPACK_TARGET_AVX2
+static void RGBA64ToRGBA8_AVX2(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m256i a = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(pIn + 8 * x)), 8);
+        const __m256i b = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(pIn + 8 * x + 32)), 8);
+        // packus leaves pixel pairs as 01 45 23 67
+        _mm256_storeu_si256((__m256i*)(pOut + 4 * x), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+    }
+    RGBA64ToRGBA8_SSE2(pIn + 8 * x, pOut + 4 * x, count - x);
+}
+#endif // REPACK_SIMD_X86
+
+#if defined(REPACK_SIMD_NEON)
+//-------------------------------------------------------------------------------------------------
+// NEON: structured loads and stores do the (de)interleaving
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV8_NEON(const amf_uint8* pU, const amf_uint8* pV, amf_uint8* pUV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        uint8x16x2_t uv;
+        uv.val[0] = vld1q_u8(pU + x);
+        uv.val[1] = vld1q_u8(pV + x);
+        vst2q_u8(pUV + 2 * x, uv);
+    }
+    InterleaveUV8_Scalar(pU + x, pV + x, pUV + 2 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV16_NEON(const amf_uint16* pU, const amf_uint16* pV, amf_uint16* pUV, amf_size count, amf_int32 shift)
+{
+    const int16x8_t shiftCount = vdupq_n_s16(int16_t(shift));
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        uint16x8x2_t uv;
+        uv.val[0] = vshlq_u16(vld1q_u16(pU + x), shiftCount);
+        uv.val[1] = vshlq_u16(vld1q_u16(pV + x), shiftCount);
+        vst2q_u16(pUV + 2 * x, uv);
+    }
+    InterleaveUV16_Scalar(pU + x, pV + x, pUV + 2 * x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+static void ShiftLeft16_NEON(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, amf_int32 shift)
+{
+    const int16x8_t shiftCount = vdupq_n_s16(int16_t(shift));
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        vst1q_u16(pOut + x, vshlq_u16(vld1q_u16(pIn + x), shiftCount));
+        vst1q_u16(pOut + x + 8, vshlq_u16(vld1q_u16(pIn + x + 8), shiftCount));
+    }
+    ShiftLeft16_Scalar(pIn + x, pOut + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48ToRGBA8_NEON(const amf_uint8* pIn, amf_uint8* pOut, amf_size count, bool bBigEndian)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const uint16x8x3_t rgb = vld3q_u16((const uint16_t*)(pIn + 6 * x));
+        uint8x8x4_t rgba;
+        for (int c = 0; c < 3; c++)
+        {
+            // the most significant byte is the high half of an LE sample, the low half of a BE one
+            rgba.val[c] = bBigEndian ? vmovn_u16(rgb.val[c]) : vshrn_n_u16(rgb.val[c], 8);
+        }
+        rgba.val[3] = vdup_n_u8(255);
+        vst4_u8(pOut + 4 * x, rgba);
+    }
+    RGB48ToRGBA8_Scalar(pIn + 6 * x, pOut + 4 * x, count - x, bBigEndian);
+}
+//-------------------------------------------------------------------------------------------------
+static void RGBA64ToRGBA8_NEON(const amf_uint8* pIn, amf_uint8* pOut, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const uint16x8x4_t in = vld4q_u16((const uint16_t*)(pIn + 8 * x));
+        uint8x8x4_t rgba;
+        for (int c = 0; c < 4; c++)
+        {
+            rgba.val[c] = vshrn_n_u16(in.val[c], 8);
+        }
+        vst4_u8(pOut + 4 * x, rgba);
+    }
+    RGBA64ToRGBA8_Scalar(pIn + 8 * x, pOut + 4 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48ToRGBA16_NEON(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, bool bBigEndian)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const uint16x8x3_t rgb = vld3q_u16(pIn + 3 * x);
+        uint16x8x4_t rgba;
+        for (int c = 0; c < 3; c++)
+        {
+            rgba.val[c] = bBigEndian ? vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(rgb.val[c]))) : rgb.val[c];
+        }
+        rgba.val[3] = vdupq_n_u16(65535);
+        vst4q_u16(pOut + 4 * x, rgba);
+    }
+    RGB48ToRGBA16_Scalar(pIn + 3 * x, pOut + 4 * x, count - x, bBigEndian);
+}
+#endif // REPACK_SIMD_NEON
+
+//-------------------------------------------------------------------------------------------------
+// dispatch
+//-------------------------------------------------------------------------------------------------
+static const AMFRepackKernels s_RepackScalar =
+{
+    "scalar", InterleaveUV8_Scalar, InterleaveUV16_Scalar, ShiftLeft16_Scalar,
+    RGB48ToRGBA8_Scalar, RGBA64ToRGBA8_Scalar, RGB48ToRGBA16_Scalar
+};
+#if defined(REPACK_SIMD_X86)
+static const AMFRepackKernels s_RepackSSE2 =
+{
+    "SSE2", InterleaveUV8_SSE2, InterleaveUV16_SSE2, ShiftLeft16_SSE2,
+    RGB48ToRGBA8_Scalar, RGBA64ToRGBA8_SSE2, RGB48ToRGBA16_Scalar
+};
+static const AMFRepackKernels s_RepackSSSE3 =
+{
+    "SSSE3", InterleaveUV8_SSE2, InterleaveUV16_SSE2, ShiftLeft16_SSE2,
+    RGB48ToRGBA8_SSSE3, RGBA64ToRGBA8_SSE2, RGB48ToRGBA16_SSSE3
+};
+static const AMFRepackKernels s_RepackAVX2 =
+{
+    "AVX2", InterleaveUV8_AVX2, InterleaveUV16_AVX2, ShiftLeft16_AVX2,
+    RGB48ToRGBA8_SSSE3, RGBA64ToRGBA8_AVX2, RGB48ToRGBA16_SSSE3
+};
+#endif
+#if defined(REPACK_SIMD_NEON)
+static const AMFRepackKernels s_RepackNEON =
+{
+    "NEON", InterleaveUV8_NEON, InterleaveUV16_NEON, ShiftLeft16_NEON,
+    RGB48ToRGBA8_NEON, RGBA64ToRGBA8_NEON, RGB48ToRGBA16_NEON
+};
+#endif
+//-------------------------------------------------------------------------------------------------
+const AMFRepackKernels* AMF_STD_CALL amf::GetRepackKernels(AMF_REPACK_LEVEL level)
+{
+    switch (level)
+    {
+    case AMF_REPACK_SCALAR:
+        return &s_RepackScalar;
+#if defined(REPACK_SIMD_X86)
+    case AMF_REPACK_SSE2:
+        return InstructionSet::SSE2() ? &s_RepackSSE2 : nullptr;
+    case AMF_REPACK_SSSE3:
+        return InstructionSet::SSE2() && InstructionSet::SSSE3() ? &s_RepackSSSE3 : nullptr;
+    case AMF_REPACK_AVX2:
+        // AVX state must also be enabled by the OS
+        return InstructionSet::SSSE3() && InstructionSet::OSXSAVE() && InstructionSet::AVX() && InstructionSet::AVX2() ?
+            &s_RepackAVX2 : nullptr;
+#endif
+#if defined(REPACK_SIMD_NEON)
+    case AMF_REPACK_NEON:
+        return &s_RepackNEON;
+#endif
+    default:
+        return nullptr;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static const AMFRepackKernels& SelectRepackKernels()
+{
+    for (int level = AMF_REPACK_LEVEL_COUNT - 1; level > AMF_REPACK_SCALAR; level--)
+    {
+        const AMFRepackKernels* pKernels = GetRepackKernels(AMF_REPACK_LEVEL(level));
+        if (pKernels != nullptr)
+        {
+            return *pKernels;
+        }
+    }
+    return s_RepackScalar;
+}
+//-------------------------------------------------------------------------------------------------
+const AMFRepackKernels& AMF_STD_CALL amf::GetRepackKernels()
+{
+    static const AMFRepackKernels& s_Best = SelectRepackKernels();
+    return s_Best;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,74 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// host-side pixel repacking used by the FFmpeg video decoder when copying decoded frames
+// into AMF surfaces; every kernel processes one line and has scalar and SIMD versions that
+// produce identical output
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+namespace amf
+{
+    enum AMF_REPACK_LEVEL
+    {
+        AMF_REPACK_SCALAR = 0,
+        AMF_REPACK_SSE2,
+        AMF_REPACK_SSSE3,
+        AMF_REPACK_AVX2,
+        AMF_REPACK_NEON,
+        AMF_REPACK_LEVEL_COUNT
+    };
+
+    struct AMFRepackKernels
+    {
+        const char* pName;
+
+        // U and V lines into one UV line: count pairs
+        void (*InterleaveUV8)(const amf_uint8* pU, const amf_uint8* pV, amf_uint8* pUV, amf_size count);
+        // 16-bit U and V lines into one UV line, moving LSB-aligned samples up by shift bits
+        void (*InterleaveUV16)(const amf_uint16* pU, const amf_uint16* pV, amf_uint16* pUV, amf_size count, amf_int32 shift);
+        // LSB-aligned 10/12-bit samples to MSB-aligned: count samples
+        void (*ShiftLeft16)(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, amf_int32 shift);
+        // RGB48 (LE or BE) to RGBA8 with opaque alpha: count pixels
+        void (*RGB48ToRGBA8)(const amf_uint8* pIn, amf_uint8* pOut, amf_size count, bool bBigEndian);
+        // RGBA64LE to RGBA8, keeping the high byte of each component
+        void (*RGBA64ToRGBA8)(const amf_uint8* pIn, amf_uint8* pOut, amf_size count);
+        // RGB48 (LE or BE) to 16-bit RGBA with opaque alpha
+        void (*RGB48ToRGBA16)(const amf_uint16* pIn, amf_uint16* pOut, amf_size count, bool bBigEndian);
+    };
+
+    // best kernels for the running CPU, selected once through CPUCaps.h
+    const AMFRepackKernels& AMF_STD_CALL GetRepackKernels();
+    // kernels for a specific level or nullptr if this build or CPU does not support it
+    const AMFRepackKernels* AMF_STD_CALL GetRepackKernels(AMF_REPACK_LEVEL level);
+}
@@ -56,6 +56,7 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
     m_videoFrameQueryCount(0),
     m_eFormat(AMF_SURFACE_UNKNOWN),
     m_FrameRate(AMFConstructRate(25,1)),
+    m_InputQueue(16),
     m_CopyPipeline(&m_InputQueue)
 {
     g_AMFFactory.Init();
@@ -220,6 +221,11 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT form
 
     m_pCodecContext->strict_std_compliance = FF_COMPLIANCE_STRICT; // MM to try compliance
 
+    // let libavcodec decode straight into pooled frames laid out like
+    // host surfaces - formats that need repacking keep the default allocator
+    m_pFramePool = new AMFFramePoolFFMPEG(m_eFormat);
+    m_pFramePool->Attach(m_pCodecContext);
+
     if (avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
     {
         Terminate();
@@ -253,6 +259,8 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Terminate()
         av_free(m_pCodecContext);
         m_pCodecContext = nullptr;
     }
+    // the codec context refers to the frame pool, so it goes second
+    m_pFramePool = nullptr;
 
     m_videoFrameSubmitCount = 0;
     m_videoFrameQueryCount = 0;
@@ -532,13 +540,26 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     // from that, but try anyway
     AMF_RESULT err = AMF_OK;
     AMFSurfacePtr pSurfaceOut;
-    if (m_pOutputDataCallback != nullptr)
+    const bool bDirect = (m_pOutputDataCallback == nullptr) && (m_pFramePool != nullptr) && m_pFramePool->IsDirect(picture);
+    if (bDirect)
+    {
+        // the decoder wrote the frame into a pooled host surface layout, so
+        // it goes out as it is - the surface keeps the frame memory referenced
+        err = m_pFramePool->WrapFrame(m_pContext, &picture, &pSurfaceOut);
+    }
+    else if (m_pOutputDataCallback != nullptr)
     {
         err = m_pOutputDataCallback->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, 0, 0, &pSurfaceOut);
     }
     else
     {
-        err = m_pContext->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, &pSurfaceOut);
+        // software decoders output planar 4:2:0, so NV12 / P010 always convert - into a
+        // recycled surface, steady state doesn't allocate on this path either
+        err = (m_pFramePool != nullptr) ? m_pFramePool->AllocSurface(m_pContext, m_pCodecContext->width, m_pCodecContext->height, &pSurfaceOut) : AMF_NOT_SUPPORTED;
+        if (err == AMF_NOT_SUPPORTED)
+        {
+            err = m_pContext->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, &pSurfaceOut);
+        }
     }
     AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocSurface failed");
 
@@ -571,102 +592,10 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     }
 
 
-    amf_bool  bIsPlanar = (m_eFormat == AMF_SURFACE_RGBA) ? false : true;
-    amf_int32 paddedLSB = (m_eFormat == AMF_SURFACE_P010) ? 6 :
-                          (m_eFormat == AMF_SURFACE_P012) ? 4 :
-                          (m_eFormat == AMF_SURFACE_P016) ? 0 : 0;
-    amf_int32 iThreadCount = 2;
-
-
-    //
-    // handle the Y plane
-    AMFPlanePtr pPlaneY = pSurfaceOut->GetPlane(AMF_PLANE_Y);
-    AMF_RETURN_IF_INVALID_POINTER(pPlaneY, L"QueryOutput() - pPlaneY is NULL");
-
-    if (pPlaneY->GetHeight() > 2160 && m_eFormat != AMF_SURFACE_P010 &&
-                                       m_eFormat != AMF_SURFACE_P012 &&
-                                       m_eFormat != AMF_SURFACE_P016)
-    {
-        CopyFrameThreaded(pPlaneY, picture, iThreadCount, false, false);
-    }
-    else if (picture.format == AV_PIX_FMT_YUV422P10LE)  //ProRes 10bit 4:2:2 from BM camera
-    {
-        CopyFrameYUV422(pPlaneY, picture);
-        bIsPlanar = false;
-    }
-    else if (picture.format == AV_PIX_FMT_YUV444P10LE || picture.format == AV_PIX_FMT_YUV444P12LE)  //YUV444
+    if (bDirect == false)
     {
-        CopyFrameYUV444(pPlaneY, picture);
-        bIsPlanar = false;
-    }
-    else if ((picture.format == AV_PIX_FMT_RGBA64LE) || //RGB -->RGBA
-             (picture.format == AV_PIX_FMT_RGB48LE)  || //RGB -->RGBA
-             (picture.format == AV_PIX_FMT_RGB48BE))    //RGB -->RGBA
-    {
-        CopyFrameRGB_FP16(pPlaneY, picture);
-        pSurfaceOut->SetProperty(VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC, AMF_COLOR_TRANSFER_CHARACTERISTIC_LINEAR);
-        bIsPlanar = false;
-    }
-    else if (pPlaneY->GetHPitch() == picture.linesize[0])   // AMF plane pitch and FFmpeg linesize match
-    {
-        CopyLineLSB((amf_uint8*) pPlaneY->GetNative(), picture.data[0], pPlaneY->GetHPitch() * pPlaneY->GetHeight(), paddedLSB);
-    }
-    else
-    {
-        amf_uint8 *pTmpMemOut = static_cast<amf_uint8*>(pPlaneY->GetNative());
-        amf_uint8 *pTmpMemIn  = picture.data[0];
-        amf_size  linesToCopy = pPlaneY->GetHeight();
-        amf_size  to_copy     = AMF_MIN(pPlaneY->GetHPitch(), std::abs(picture.linesize[0]));
-
-        while (linesToCopy > 0)
-        {
-            CopyLineLSB(pTmpMemOut, pTmpMemIn, to_copy, paddedLSB);
-            pTmpMemOut += pPlaneY->GetHPitch();
-            pTmpMemIn += picture.linesize[0];
-            linesToCopy -= 1;
-        }
-    }
-
-
-    //
-    // handle the UV plane
-    if (bIsPlanar)
-    {
-        if (pSurfaceOut->GetPlanesCount() == 3)
-        {
-            AMFPlanePtr pPlaneU = pSurfaceOut->GetPlane(AMF_PLANE_U);
-            AMF_RETURN_IF_INVALID_POINTER(pPlaneU, L"QueryOutput() - pPlaneUV is NULL");
-            AMFPlanePtr pPlaneV = pSurfaceOut->GetPlane(AMF_PLANE_V);
-            AMF_RETURN_IF_INVALID_POINTER(pPlaneV, L"QueryOutput() - pPlaneUV is NULL");
-
-            if (pPlaneU->GetHeight() > 2160 /2)
-            {
-                CopyFrameThreaded(pPlaneU, picture, iThreadCount, true, false);
-                CopyFrameThreaded(pPlaneV, picture, iThreadCount, false, true);
-            }
-            else
-            {
-                CopyFrameThreaded(pPlaneU, picture, 1, true, false);
-                CopyFrameThreaded(pPlaneV, picture, 1, false, true);
-            }
-
-        }
-        else 
-        {
-            AMFPlanePtr pPlaneUV = pSurfaceOut->GetPlane(AMF_PLANE_UV);
-            AMF_RETURN_IF_INVALID_POINTER(pPlaneUV, L"QueryOutput() - pPlaneUV is NULL");
-
-            if (pPlaneUV->GetHeight() > 2160 / 2 && m_eFormat != AMF_SURFACE_P010 &&
-                m_eFormat != AMF_SURFACE_P012 &&
-                m_eFormat != AMF_SURFACE_P016)
-            {
-                CopyFrameThreaded(pPlaneUV, picture, iThreadCount, true, true);
-            }
-            else
-            {
-                CopyFrameUV(pPlaneUV, picture, paddedLSB);
-            }
-        }
+        err = CopyFrame(pSurfaceOut, picture);
+        AMF_RETURN_IF_FAILED(err, L"QueryOutput() - CopyFrame failed");
     }
 
 
@@ -942,6 +871,111 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::GetColorInfo(AMFSurface* pSu
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrame(AMFSurface* pSurfaceOut, const AVFrame& picture)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pSurfaceOut, L"CopyFrame() - pSurfaceOut is NULL");
+
+    amf_bool  bIsPlanar = (m_eFormat == AMF_SURFACE_RGBA) ? false : true;
+    amf_int32 paddedLSB = (m_eFormat == AMF_SURFACE_P010) ? 6 :
+                          (m_eFormat == AMF_SURFACE_P012) ? 4 :
+                          (m_eFormat == AMF_SURFACE_P016) ? 0 : 0;
+    amf_int32 iThreadCount = 2;
+
+
+    //
+    // handle the Y plane
+    AMFPlanePtr pPlaneY = pSurfaceOut->GetPlane(AMF_PLANE_Y);
+    AMF_RETURN_IF_INVALID_POINTER(pPlaneY, L"CopyFrame() - pPlaneY is NULL");
+
+    if (pPlaneY->GetHeight() > 2160 && m_eFormat != AMF_SURFACE_P010 &&
+                                       m_eFormat != AMF_SURFACE_P012 &&
+                                       m_eFormat != AMF_SURFACE_P016)
+    {
+        CopyFrameThreaded(pPlaneY, picture, iThreadCount, false, false);
+    }
+    else if (picture.format == AV_PIX_FMT_YUV422P10LE)  //ProRes 10bit 4:2:2 from BM camera
+    {
+        CopyFrameYUV422(pPlaneY, picture);
+        bIsPlanar = false;
+    }
+    else if (picture.format == AV_PIX_FMT_YUV444P10LE || picture.format == AV_PIX_FMT_YUV444P12LE)  //YUV444
+    {
+        CopyFrameYUV444(pPlaneY, picture);
+        bIsPlanar = false;
+    }
+    else if ((picture.format == AV_PIX_FMT_RGBA64LE) || //RGB -->RGBA
+             (picture.format == AV_PIX_FMT_RGB48LE)  || //RGB -->RGBA
+             (picture.format == AV_PIX_FMT_RGB48BE))    //RGB -->RGBA
+    {
+        CopyFrameRGB_FP16(pPlaneY, picture);
+        pSurfaceOut->SetProperty(VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC, AMF_COLOR_TRANSFER_CHARACTERISTIC_LINEAR);
+        bIsPlanar = false;
+    }
+    else if (pPlaneY->GetHPitch() == picture.linesize[0])   // AMF plane pitch and FFmpeg linesize match
+    {
+        CopyLineLSB((amf_uint8*) pPlaneY->GetNative(), picture.data[0], pPlaneY->GetHPitch() * pPlaneY->GetHeight(), paddedLSB);
+    }
+    else
+    {
+        amf_uint8 *pTmpMemOut = static_cast<amf_uint8*>(pPlaneY->GetNative());
+        amf_uint8 *pTmpMemIn  = picture.data[0];
+        amf_size  linesToCopy = pPlaneY->GetHeight();
+        amf_size  to_copy     = AMF_MIN(pPlaneY->GetHPitch(), std::abs(picture.linesize[0]));
+
+        while (linesToCopy > 0)
+        {
+            CopyLineLSB(pTmpMemOut, pTmpMemIn, to_copy, paddedLSB);
+            pTmpMemOut += pPlaneY->GetHPitch();
+            pTmpMemIn += picture.linesize[0];
+            linesToCopy -= 1;
+        }
+    }
+
+
+    //
+    // handle the UV plane
+    if (bIsPlanar)
+    {
+        if (pSurfaceOut->GetPlanesCount() == 3)
+        {
+            AMFPlanePtr pPlaneU = pSurfaceOut->GetPlane(AMF_PLANE_U);
+            AMF_RETURN_IF_INVALID_POINTER(pPlaneU, L"CopyFrame() - pPlaneUV is NULL");
+            AMFPlanePtr pPlaneV = pSurfaceOut->GetPlane(AMF_PLANE_V);
+            AMF_RETURN_IF_INVALID_POINTER(pPlaneV, L"CopyFrame() - pPlaneUV is NULL");
+
+            if (pPlaneU->GetHeight() > 2160 /2)
+            {
+                CopyFrameThreaded(pPlaneU, picture, iThreadCount, true, false);
+                CopyFrameThreaded(pPlaneV, picture, iThreadCount, false, true);
+            }
+            else
+            {
+                CopyFrameThreaded(pPlaneU, picture, 1, true, false);
+                CopyFrameThreaded(pPlaneV, picture, 1, false, true);
+            }
+
+        }
+        else 
+        {
+            AMFPlanePtr pPlaneUV = pSurfaceOut->GetPlane(AMF_PLANE_UV);
+            AMF_RETURN_IF_INVALID_POINTER(pPlaneUV, L"CopyFrame() - pPlaneUV is NULL");
+
+            if (pPlaneUV->GetHeight() > 2160 / 2 && m_eFormat != AMF_SURFACE_P010 &&
+                m_eFormat != AMF_SURFACE_P012 &&
+                m_eFormat != AMF_SURFACE_P016)
+            {
+                CopyFrameThreaded(pPlaneUV, picture, iThreadCount, true, true);
+            }
+            else
+            {
+                CopyFrameUV(pPlaneUV, picture, paddedLSB);
+            }
+        }
+    }
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameThreaded(AMFPlane* pPlane, const AVFrame& picture, amf_int threadCount, bool isUPlane, bool isVPlane)
 {
     AMF_RETURN_IF_INVALID_POINTER(pPlane, L"CopyFrameThreaded() - pPlane is NULL");
@@ -1074,36 +1108,26 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameRGB_FP16(AMFPlane*
     const amf_size   uHeight      = pPlane->GetHeight();      //frame height
     AMF_RESULT       ret          = AMF_OK;
 
+    const AMFRepackKernels& kernels = GetRepackKernels();
+    const bool bBigEndian = iPixelFormat == AV_PIX_FMT_RGB48BE; //png
+
     if (m_eFormat == AMF_SURFACE_RGBA)
     {
         const amf_uint8* pSrc = pMemIn;
         amf_uint8* pDst = pMemOut;
         for (amf_size y = 0; y < uHeight; y++)
         {
-            for (amf_size x = 0; x < uWidth; x++)
+            if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
             {
-                if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 0];
-                    pDst[4 * x + 1] = pSrc[6 * x + 2];
-                    pDst[4 * x + 2] = pSrc[6 * x + 4];
-                    pDst[4 * x + 3] = 255;
-                }
-                else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 1];
-                    pDst[4 * x + 1] = pSrc[6 * x + 3];
-                    pDst[4 * x + 2] = pSrc[6 * x + 5];
-                    pDst[4 * x + 3] = 255;
-                }
-                else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
-                {
-                    pDst[4 * x + 0] = pSrc[8 * x + 1];
-                    pDst[4 * x + 1] = pSrc[8 * x + 3];
-                    pDst[4 * x + 2] = pSrc[8 * x + 5];
-                    pDst[4 * x + 3] = pSrc[8 * x + 7];
-                }
-                else
+                kernels.RGBA64ToRGBA8(pSrc, pDst, uWidth);
+            }
+            else if (iPixelFormat == AV_PIX_FMT_RGB48BE || iPixelFormat == AV_PIX_FMT_RGB48LE) //png, EXR
+            {
+                kernels.RGB48ToRGBA8(pSrc, pDst, uWidth, bBigEndian);
+            }
+            else
+            {
+                for (amf_size x = 0; x < uWidth; x++)
                 {
                     pDst[4 * x + 0] = pSrc[6 * x + 1];
                     pDst[4 * x + 1] = pSrc[6 * x + 3];
@@ -1128,38 +1152,11 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameRGB_FP16(AMFPlane*
                 pSrc += uPitchIn / sizeof(amf_uint16);
             }
         }
-        else
+        else if (iPixelFormat == AV_PIX_FMT_RGB48BE || iPixelFormat == AV_PIX_FMT_RGB48LE) //png, EXR
         {
             for (amf_size y = 0; y < uHeight; y++)
             {
-                for (amf_size x = 0; x < uWidth; x++)
-                {
-                    if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
-                    {
-                        amf_uint8* pTemp = 0;
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 0];
-                        pDst[4 * x + 0] = (pTemp[0] << 8) | pTemp[1];
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 1];
-                        pDst[4 * x + 1] = (pTemp[0] << 8) | pTemp[1];
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 2];
-                        pDst[4 * x + 2] = (pTemp[0] << 8) | pTemp[1];
-                        pDst[4 * x + 3] = 65535;
-                    }
-                    else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
-                    {
-                        pDst[4 * x + 0] = pSrc[3 * x + 0];
-                        pDst[4 * x + 1] = pSrc[3 * x + 1];
-                        pDst[4 * x + 2] = pSrc[3 * x + 2];
-                        pDst[4 * x + 3] = 65535;
-                    }
-                    else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
-                    {
-                        pDst[4 * x + 0] = pSrc[4 * x + 0];
-                        pDst[4 * x + 1] = pSrc[4 * x + 1];
-                        pDst[4 * x + 2] = pSrc[4 * x + 2];
-                        pDst[4 * x + 3] = pSrc[4 * x + 3];
-                    }
-                }
+                kernels.RGB48ToRGBA16(pSrc, pDst, uWidth, bBigEndian);
                 pDst += uPitchOut / sizeof(amf_uint16);
                 pSrc += uPitchIn / sizeof(amf_uint16);
             }
@@ -1184,24 +1181,18 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameUV(AMFPlane* pPlane
 
     amf_uint8* pTmpMemOut   = static_cast<amf_uint8*>(pPlaneUV->GetNative());
     amf_uint8* pTmpMemIn[2] = { picture.data[1], picture.data[2] };
+    const AMFRepackKernels& kernels = GetRepackKernels();
 
     // need to pack uv plane properly for 16-bit colour
     if (pPlaneUV->GetPixelSizeInBytes() == 4)
     {
         for (amf_size y = 0; y < uHeight; y++)
         {
-            amf_uint16* pLineMemOut = (amf_uint16*) pTmpMemOut;
-            amf_uint16* pLineMemIn1 = (amf_uint16*) pTmpMemIn[0];
-            amf_uint16* pLineMemIn2 = (amf_uint16*) pTmpMemIn[1];
-            for (amf_size x = 0; x < uWidth; x++)
-            {
-                // FFMPEG outputs in LSB format but we want MSB
-                // 10-bit example:
-                //     (LSB)         :  000000DD DDDDDDDD
-                //     we want (MSB) :  DDDDDDDD DD000000
-                *pLineMemOut++ = *pLineMemIn1++ << paddedLSB;
-                *pLineMemOut++ = *pLineMemIn2++ << paddedLSB;
-            }
+            // FFMPEG outputs in LSB format but we want MSB
+            // 10-bit example:
+            //     (LSB)         :  000000DD DDDDDDDD
+            //     we want (MSB) :  DDDDDDDD DD000000
+            kernels.InterleaveUV16((const amf_uint16*)pTmpMemIn[0], (const amf_uint16*)pTmpMemIn[1], (amf_uint16*)pTmpMemOut, uWidth, paddedLSB);
             pTmpMemOut += iOutStride;
             pTmpMemIn[0] += picture.linesize[1];
             pTmpMemIn[1] += picture.linesize[2];
@@ -1211,14 +1202,7 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameUV(AMFPlane* pPlane
     {
         for (amf_size y = 0; y < uHeight; y++)
         {
-            amf_uint8* pLineMemOut = pTmpMemOut;
-            amf_uint8* pLineMemIn1 = pTmpMemIn[0];
-            amf_uint8* pLineMemIn2 = pTmpMemIn[1];
-            for (amf_size x = 0; x < uWidth; x++)
-            {
-                *pLineMemOut++ = *pLineMemIn1++;
-                *pLineMemOut++ = *pLineMemIn2++;
-            }
+            kernels.InterleaveUV8(pTmpMemIn[0], pTmpMemIn[1], pTmpMemOut, uWidth);
             pTmpMemOut += iOutStride;
             pTmpMemIn[0] += picture.linesize[1];
             pTmpMemIn[1] += picture.linesize[2];
@@ -1244,13 +1228,7 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyLineLSB(amf_uint8* pMemO
         // modifying picture data directly messes up the 
         // decoder big time so we have to do it ourselves
         // by copying the data properly
-        const amf_uint16* pTmp16Src  = (const amf_uint16 *)pMemIn;
-              amf_uint16* pTmp16Dest = (amf_uint16 *)pMemOut;
-
-        for (amf_size lineIdx = 0; lineIdx < sizeToCopy >> 1; lineIdx++)
-        {
-            pTmp16Dest[lineIdx] = pTmp16Src[lineIdx] << paddedLSB;
-        }
+        GetRepackKernels().ShiftLeft16((const amf_uint16 *)pMemIn, (amf_uint16 *)pMemOut, sizeToCopy >> 1, paddedLSB);
     }
     else
     {
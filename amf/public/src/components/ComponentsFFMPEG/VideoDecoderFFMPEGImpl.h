@@ -37,6 +37,8 @@
 #include "public/include/components/ColorSpace.h"
 #include "public/include/core/Context.h"
 #include "public/common/PropertyStorageExImpl.h"
+#include "PixelRepack.h"
+#include "FramePoolFFMPEG.h"
 
 extern "C"
 {
@@ -106,6 +108,7 @@ namespace amf
         AMF_RESULT AMF_STD_CALL  GetHDRInfo(const AVMasteringDisplayMetadata* pInFFmpegMetadata, AMFHDRMetadata* pAMFHDRInfo);
         AMF_RESULT AMF_STD_CALL  GetColorInfo(AMFSurface* pSurfaceOut, const AVFrame& picture);
 
+        AMF_RESULT AMF_STD_CALL  CopyFrame(AMFSurface* pSurfaceOut, const AVFrame& picture);
         AMF_RESULT AMF_STD_CALL  CopyFrameThreaded(AMFPlane* pPlane, const AVFrame& picture, amf_int threadCount, bool isUPlane, bool isVPlane);
         AMF_RESULT AMF_STD_CALL  CopyFrameYUV422(AMFPlane* pPlane, const AVFrame& picture);
         AMF_RESULT AMF_STD_CALL  CopyFrameYUV444(AMFPlane* pPlane, const AVFrame& picture);
@@ -137,6 +140,7 @@ namespace amf
         bool                        m_bEof;
 
         AVCodecContext*             m_pCodecContext;
+        AMFFramePoolFFMPEGPtr       m_pFramePool;
         amf_pts                     m_SeekPts;
 
         AMFBufferPtr                m_pExtraData;
@@ -176,18 +180,11 @@ namespace amf
                 else
                 {
                     amf_size   toCopy = SrcLineSize;
+                    const AMFRepackKernels& kernels = GetRepackKernels();
 
                     for (amf_int i = lineStart; i < lineEnd; i++)
                     {
-                        amf_uint8 *pLineMemOut = pDst + i * DstLineSize;
-                        amf_uint8 *pLineMemIn1 = pSrc + i * SrcLineSize;
-                        amf_uint8 *pLineMemIn2 = pSrc1 + i * SrcLineSize;
-
-                        for (amf_size x = 0; x < toCopy; x++)
-                        {
-                            *pLineMemOut++ = *pLineMemIn1++;
-                            *pLineMemOut++ = *pLineMemIn2++;
-                        }
+                        kernels.InterleaveUV8(pSrc + i * SrcLineSize, pSrc1 + i * SrcLineSize, pDst + i * DstLineSize, toCopy);
                     }
                 }
                 if (amf_atomic_dec(pCounter) == 0)
@@ -196,7 +193,7 @@ namespace amf
                 }
             }
         };
-        AMFQueue<CopyTask> m_InputQueue;
+        AMFRingQueue<CopyTask> m_InputQueue; // lock-free: a few tasks per plane, one frame in flight
 
         class CopyThread : public AMFQueueThread<CopyTask, int>
         {